@@ -0,0 +1,534 @@
+#include <nano/lib/threading.hpp>
+#include <nano/node/message_trace.hpp>
+#include <nano/node/node.hpp>
+#include <nano/node/testing.hpp>
+#include <nano/secure/utility.hpp>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+nano::node_flags bench_flags ()
+{
+	// The node only hears from the trace
+	nano::node_flags flags;
+	flags.disable_udp = true;
+	flags.disable_tcp_realtime = true;
+	flags.disable_bootstrap_listener = true;
+	flags.disable_lazy_bootstrap = true;
+	flags.disable_legacy_bootstrap = true;
+	flags.disable_wallet_bootstrap = true;
+	flags.disable_ongoing_bootstrap = true;
+	flags.disable_rep_crawler = true;
+	flags.disable_ongoing_telemetry_requests = true;
+	flags.disable_initial_telemetry_requests = true;
+	return flags;
+}
+
+/** Where replayed messages come from. Replies to it, such as votes for confirm_req, are discarded */
+class replay_channel final : public nano::transport::channel
+{
+public:
+	explicit replay_channel (nano::node & node_a) :
+	nano::transport::channel (node_a),
+	endpoint (boost::asio::ip::address_v6::loopback (), 0)
+	{
+		set_network_version (node_a.network_params.protocol.protocol_version);
+	}
+	size_t hash_code () const override
+	{
+		std::hash<::nano::endpoint> hash;
+		return hash (endpoint);
+	}
+	bool operator== (nano::transport::channel const & other_a) const override
+	{
+		return &other_a == this;
+	}
+	void send_buffer (nano::shared_const_buffer const & buffer_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::buffer_drop_policy) override
+	{
+		if (callback_a)
+		{
+			auto size (buffer_a.size ());
+			node.background ([callback_a, size]() {
+				callback_a (boost::system::errc::make_error_code (boost::system::errc::success), size);
+			});
+		}
+	}
+	std::string to_string () const override
+	{
+		return "replay";
+	}
+	nano::endpoint get_endpoint () const override
+	{
+		return endpoint;
+	}
+	nano::tcp_endpoint get_tcp_endpoint () const override
+	{
+		return nano::transport::map_endpoint_to_tcp (endpoint);
+	}
+	nano::transport::transport_type get_type () const override
+	{
+		return nano::transport::transport_type::loopback;
+	}
+
+private:
+	nano::endpoint const endpoint;
+};
+
+class replay_visitor final : public nano::message_visitor
+{
+public:
+	replay_visitor (nano::node & node_a, std::shared_ptr<nano::transport::channel> const & channel_a, std::function<void(nano::block_hash const &)> const & published_a) :
+	node (node_a),
+	channel (channel_a),
+	published (published_a)
+	{
+	}
+	void keepalive (nano::keepalive const &) override
+	{
+	}
+	void publish (nano::publish const & message_a) override
+	{
+		published (message_a.block->hash ());
+		node.network.process_message (message_a, channel);
+	}
+	void confirm_req (nano::confirm_req const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void confirm_ack (nano::confirm_ack const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void bulk_pull (nano::bulk_pull const &) override
+	{
+	}
+	void bulk_pull_account (nano::bulk_pull_account const &) override
+	{
+	}
+	void bulk_push (nano::bulk_push const &) override
+	{
+	}
+	void frontier_req (nano::frontier_req const &) override
+	{
+	}
+	void node_id_handshake (nano::node_id_handshake const &) override
+	{
+	}
+	void telemetry_req (nano::telemetry_req const &) override
+	{
+	}
+	void telemetry_ack (nano::telemetry_ack const &) override
+	{
+	}
+	nano::node & node;
+	std::shared_ptr<nano::transport::channel> channel;
+	std::function<void(nano::block_hash const &)> published;
+};
+
+/** A benchmark result and which direction is an improvement */
+class metric final
+{
+public:
+	std::string name;
+	double value;
+	bool higher_is_better;
+};
+
+/**
+ * Generates a dev network ledger in \p path_a/ledger, with representatives holding the online weight minimum and
+ * funded accounts, and a trace in \p path_a/trace.bin of sends from those accounts, each batch followed by a vote
+ * from every representative and every 16th block by a confirm_req
+ */
+int generate (boost::filesystem::path const & path_a, unsigned blocks_a, unsigned representatives_a, unsigned accounts_a, unsigned rate_a)
+{
+	auto ledger_path (path_a / "ledger");
+	boost::filesystem::create_directories (ledger_path);
+	nano::network_params params;
+	nano::logging logging;
+	logging.init (ledger_path);
+	nano::work_pool work{ std::max (std::thread::hardware_concurrency (), 1u) };
+	boost::asio::io_context io_ctx;
+	auto node (std::make_shared<nano::node> (io_ctx, ledger_path, nano::node_config (nano::get_available_port (), logging), work, bench_flags ()));
+	if (node->init_error ())
+	{
+		std::cerr << "Error initializing ledger in " << ledger_path << std::endl;
+		return 1;
+	}
+	auto work_generate = [&node](nano::root const & root_a) {
+		return *node->work.generate (nano::work_version::work_1, root_a, node->network_params.network.publish_thresholds.epoch_1);
+	};
+
+	std::cout << boost::str (boost::format ("Seeding ledger with %1% representatives and %2% accounts\n") % representatives_a % accounts_a);
+	nano::block_builder builder;
+	auto const & genesis_key (params.ledger.dev_genesis_key);
+	auto genesis_latest (node->latest (genesis_key.pub));
+	auto genesis_balance (node->balance (genesis_key.pub));
+	uint64_t genesis_height (1);
+	std::vector<nano::keypair> representatives (representatives_a);
+	std::vector<nano::keypair> accounts (accounts_a);
+	std::vector<nano::block_hash> frontiers;
+	std::vector<nano::uint128_t> balances;
+	{
+		auto transaction (node->store.tx_begin_write ());
+		auto fund = [&](nano::keypair const & key_a, nano::account const & representative_a, nano::uint128_t const & amount_a) {
+			genesis_balance -= amount_a;
+			auto send = builder.state ()
+			            .account (genesis_key.pub)
+			            .previous (genesis_latest)
+			            .representative (genesis_key.pub)
+			            .balance (genesis_balance)
+			            .link (key_a.pub)
+			            .sign (genesis_key.prv, genesis_key.pub)
+			            .work (work_generate (genesis_latest))
+			            .build ();
+			genesis_latest = send->hash ();
+			++genesis_height;
+			release_assert (node->ledger.process (transaction, *send).code == nano::process_result::progress);
+			auto open = builder.state ()
+			            .account (key_a.pub)
+			            .previous (0)
+			            .representative (representative_a)
+			            .balance (amount_a)
+			            .link (genesis_latest)
+			            .sign (key_a.prv, key_a.pub)
+			            .work (work_generate (key_a.pub))
+			            .build ();
+			release_assert (node->ledger.process (transaction, *open).code == nano::process_result::progress);
+			node->store.confirmation_height_put (transaction, key_a.pub, nano::confirmation_height_info (1, open->hash ()));
+			return open->hash ();
+		};
+		auto representative_balance (node->config.online_weight_minimum.number () / representatives_a + 1);
+		for (auto const & representative : representatives)
+		{
+			fund (representative, representative.pub, representative_balance);
+		}
+		for (auto i (0u); i < accounts_a; ++i)
+		{
+			frontiers.push_back (fund (accounts[i], representatives[i % representatives_a].pub, nano::Gxrb_ratio));
+			balances.push_back (nano::Gxrb_ratio);
+		}
+		node->store.confirmation_height_put (transaction, genesis_key.pub, nano::confirmation_height_info (genesis_height, genesis_latest));
+	}
+
+	std::cout << boost::str (boost::format ("Generating a trace of %1% blocks at %2% blocks per second\n") % blocks_a % rate_a);
+	nano::message_trace_writer writer (path_a / "trace.bin");
+	if (writer.error ())
+	{
+		std::cerr << "Error creating " << (path_a / "trace.bin") << std::endl;
+		return 1;
+	}
+	uint64_t timestamp (0);
+	std::vector<nano::block_hash> batch;
+	for (auto i (0u); i < blocks_a; ++i)
+	{
+		auto index (i % accounts_a);
+		auto const & account (accounts[index]);
+		balances[index] -= 1;
+		auto send = builder.state ()
+		            .account (account.pub)
+		            .previous (frontiers[index])
+		            .representative (representatives[index % representatives_a].pub)
+		            .balance (balances[index])
+		            .link (accounts[(index + 1) % accounts_a].pub)
+		            .sign (account.prv, account.pub)
+		            .work (work_generate (frontiers[index]))
+		            .build_shared ();
+		frontiers[index] = send->hash ();
+		auto time (std::chrono::microseconds (static_cast<uint64_t> (i) * 1000000 / rate_a));
+		writer.write (nano::publish (send), time);
+		if (i % 16 == 15)
+		{
+			writer.write (nano::confirm_req (std::vector<std::pair<nano::block_hash, nano::root>>{ { send->hash (), send->root () } }), time);
+		}
+		batch.push_back (send->hash ());
+		if (batch.size () == nano::network::confirm_ack_hashes_max || i + 1 == blocks_a)
+		{
+			++timestamp;
+			for (auto const & representative : representatives)
+			{
+				writer.write (nano::confirm_ack (std::make_shared<nano::vote> (representative.pub, representative.prv, timestamp, batch)), time);
+			}
+			batch.clear ();
+		}
+	}
+	writer.flush ();
+	node->stop ();
+	std::cout << "Wrote " << ledger_path << " and " << (path_a / "trace.bin") << std::endl;
+	return 0;
+}
+
+/** Replays \p trace_a into a node running on a copy of the ledger in \p ledger_a. \p speed_a of 0 replays without pause */
+std::vector<metric> replay (boost::filesystem::path const & ledger_a, boost::filesystem::path const & trace_a, double speed_a, std::chrono::seconds idle_timeout_a, bool & error_a)
+{
+	std::vector<metric> result;
+	nano::message_trace_reader reader (trace_a);
+	if (reader.error ())
+	{
+		std::cerr << trace_a << " is not a message trace" << std::endl;
+		error_a = true;
+		return result;
+	}
+	// The ledger is copied so every run starts from the same state
+	auto path (nano::unique_path ());
+	boost::filesystem::create_directories (path);
+	for (auto const & file : { "data.ldb", "rocksdb" })
+	{
+		if (boost::filesystem::exists (ledger_a / file))
+		{
+			if (boost::filesystem::is_directory (ledger_a / file))
+			{
+				boost::filesystem::create_directories (path / file);
+				for (auto const & entry : boost::filesystem::directory_iterator (ledger_a / file))
+				{
+					boost::filesystem::copy_file (entry.path (), path / file / entry.path ().filename ());
+				}
+			}
+			else
+			{
+				boost::filesystem::copy_file (ledger_a / file, path / file);
+			}
+		}
+	}
+	nano::logging logging;
+	logging.init (path);
+	nano::work_pool work{ std::max (std::thread::hardware_concurrency (), 1u) };
+	boost::asio::io_context io_ctx;
+	nano::node_config config (nano::get_available_port (), logging);
+	config.enable_voting = false;
+	auto node (std::make_shared<nano::node> (io_ctx, path, config, work, bench_flags ()));
+	if (node->init_error ())
+	{
+		std::cerr << "Error opening ledger copied from " << ledger_a << std::endl;
+		error_a = true;
+		return result;
+	}
+	node->start ();
+	nano::thread_runner runner (io_ctx, node->config.io_threads);
+
+	nano::mutex mutex;
+	std::unordered_map<nano::block_hash, std::chrono::steady_clock::time_point> published;
+	std::vector<std::chrono::microseconds> latencies;
+	node->observers.blocks.add ([&](nano::election_status const & status_a, std::vector<nano::vote_with_weight_info> const &, nano::account const &, nano::uint128_t const &, bool) {
+		auto now (std::chrono::steady_clock::now ());
+		nano::lock_guard<nano::mutex> lock (mutex);
+		auto existing (published.find (status_a.winner->hash ()));
+		if (existing != published.end ())
+		{
+			latencies.push_back (std::chrono::duration_cast<std::chrono::microseconds> (now - existing->second));
+			published.erase (existing);
+		}
+	});
+	auto votes_processed = [&node]() {
+		return node->stats.count (nano::stat::type::vote, nano::stat::detail::vote_valid) + node->stats.count (nano::stat::type::vote, nano::stat::detail::vote_replay) + node->stats.count (nano::stat::type::vote, nano::stat::detail::vote_indeterminate) + node->stats.count (nano::stat::type::vote, nano::stat::detail::vote_invalid);
+	};
+
+	// Samples the counters while replaying, to tell when each kind of work last made progress
+	auto start (std::chrono::steady_clock::now ());
+	auto blocks_start (node->ledger.cache.block_count.load ());
+	auto cemented_start (node->ledger.cache.cemented_count.load ());
+	auto votes_start (votes_processed ());
+	std::atomic<bool> replaying{ true };
+	std::chrono::steady_clock::time_point blocks_end (start), cemented_end (start), votes_end (start);
+	uint64_t blocks (0), cemented (0), votes (0);
+	std::thread monitor ([&]() {
+		auto last_progress (std::chrono::steady_clock::now ());
+		while (replaying || std::chrono::steady_clock::now () - last_progress < idle_timeout_a)
+		{
+			std::this_thread::sleep_for (std::chrono::milliseconds (1));
+			auto now (std::chrono::steady_clock::now ());
+			auto update = [&now, &last_progress](uint64_t current_a, uint64_t & value_a, std::chrono::steady_clock::time_point & end_a) {
+				if (current_a != value_a)
+				{
+					value_a = current_a;
+					end_a = now;
+					last_progress = now;
+				}
+			};
+			update (node->ledger.cache.block_count - blocks_start, blocks, blocks_end);
+			update (node->ledger.cache.cemented_count - cemented_start, cemented, cemented_end);
+			update (votes_processed () - votes_start, votes, votes_end);
+			if (!replaying && node->block_processor.size () == 0 && node->vote_processor.empty () && node->confirmation_height_processor.awaiting_processing_size () == 0)
+			{
+				nano::lock_guard<nano::mutex> lock (mutex);
+				if (published.empty ())
+				{
+					break;
+				}
+			}
+		}
+	});
+
+	auto channel (std::make_shared<replay_channel> (*node));
+	replay_visitor visitor (*node, channel, [&](nano::block_hash const & hash_a) {
+		nano::lock_guard<nano::mutex> lock (mutex);
+		published.emplace (hash_a, std::chrono::steady_clock::now ());
+	});
+	nano::message_parser parser (node->network.publish_filter, node->block_uniquer, node->vote_uniquer, visitor, node->work);
+	nano::message_trace_reader::entry entry;
+	uint64_t messages (0);
+	while (reader.next (entry))
+	{
+		if (speed_a > 0)
+		{
+			std::this_thread::sleep_until (start + std::chrono::duration_cast<std::chrono::microseconds> (entry.time / speed_a));
+		}
+		parser.deserialize_buffer (entry.message.data (), entry.message.size ());
+		++messages;
+	}
+	replaying = false;
+	monitor.join ();
+
+	auto per_second = [&start](uint64_t count_a, std::chrono::steady_clock::time_point end_a) {
+		auto seconds (std::chrono::duration<double> (end_a - start).count ());
+		return seconds > 0 ? count_a / seconds : 0.0;
+	};
+	nano::lock_guard<nano::mutex> lock (mutex);
+	std::sort (latencies.begin (), latencies.end ());
+	auto percentile = [&latencies](double fraction_a) {
+		return latencies.empty () ? 0.0 : latencies[std::min (latencies.size () - 1, static_cast<size_t> (fraction_a * latencies.size ()))].count () / 1000.0;
+	};
+	std::cout << boost::str (boost::format ("Replayed %1% messages: %2% blocks, %3% votes, %4% cemented, %5% of %6% published blocks confirmed\n") % messages % blocks % votes % cemented % latencies.size () % (latencies.size () + published.size ()));
+	result.push_back ({ "blocks_per_second", per_second (blocks, blocks_end), true });
+	result.push_back ({ "votes_per_second", per_second (votes, votes_end), true });
+	result.push_back ({ "cemented_per_second", per_second (cemented, cemented_end), true });
+	result.push_back ({ "confirmation_latency_p50_ms", percentile (0.5), false });
+	result.push_back ({ "confirmation_latency_p99_ms", percentile (0.99), false });
+	node->stop ();
+	runner.stop_event_processing ();
+	runner.join ();
+	return result;
+}
+
+/** @return true if any metric regressed by more than \p tolerance_a from \p baseline_a */
+bool compare (std::vector<metric> const & metrics_a, boost::property_tree::ptree const & baseline_a, double tolerance_a)
+{
+	auto regressed (false);
+	std::cout << std::left << std::setw (32) << "metric" << std::setw (14) << "baseline" << std::setw (14) << "result" << "change" << std::endl;
+	for (auto const & metric : metrics_a)
+	{
+		auto baseline (baseline_a.get_optional<double> (metric.name));
+		if (!baseline || *baseline == 0)
+		{
+			std::cout << std::setw (32) << metric.name << std::setw (14) << "-" << std::setw (14) << metric.value << std::endl;
+			continue;
+		}
+		auto change ((metric.value - *baseline) / *baseline);
+		auto worse (metric.higher_is_better ? change < -tolerance_a : change > tolerance_a);
+		regressed = regressed || worse;
+		std::cout << std::setw (32) << metric.name << std::setw (14) << *baseline << std::setw (14) << metric.value << boost::str (boost::format ("%1$+.1f%%%2%") % (change * 100) % (worse ? " REGRESSION" : "")) << std::endl;
+	}
+	return regressed;
+}
+}
+
+int main (int argc, char * const * argv)
+{
+	nano::set_umask ();
+	boost::program_options::options_description description ("Command line options");
+
+	// clang-format off
+	description.add_options ()
+		("help", "Print out options")
+		("network", boost::program_options::value<std::string> ()->default_value ("dev"), "Network the ledger and trace belong to, live, beta, test or dev")
+		("generate", boost::program_options::value<std::string> (), "Generate a dev network ledger and trace in this directory, instead of replaying")
+		("blocks", boost::program_options::value<unsigned> ()->default_value (20000), "Blocks in a generated trace")
+		("representatives", boost::program_options::value<unsigned> ()->default_value (8), "Representatives voting in a generated trace")
+		("accounts", boost::program_options::value<unsigned> ()->default_value (256), "Accounts sending the blocks of a generated trace")
+		("rate", boost::program_options::value<unsigned> ()->default_value (1000), "Blocks per second of a generated trace")
+		("ledger", boost::program_options::value<std::string> (), "Data directory holding the ledger the trace was recorded against")
+		("trace", boost::program_options::value<std::string> (), "Message trace to replay, as recorded with --record_message_trace or generated")
+		("speed", boost::program_options::value<double> ()->default_value (0.0), "Replay at this multiple of the recorded pace, 0 replays as fast as the node accepts messages")
+		("idle_timeout", boost::program_options::value<unsigned> ()->default_value (10), "Seconds without progress after which the replay ends")
+		("baseline", boost::program_options::value<std::string> (), "Results of an earlier run to compare against")
+		("tolerance", boost::program_options::value<double> ()->default_value (0.1), "Fraction by which a metric may be worse than the baseline")
+		("output", boost::program_options::value<std::string> (), "Write the results to this file, to be used as a baseline");
+	// clang-format on
+
+	boost::program_options::variables_map vm;
+	try
+	{
+		boost::program_options::store (boost::program_options::parse_command_line (argc, argv, description), vm);
+	}
+	catch (boost::program_options::error const & err)
+	{
+		std::cerr << err.what () << std::endl;
+		return 1;
+	}
+	boost::program_options::notify (vm);
+	if (vm.count ("help"))
+	{
+		std::cout << description << std::endl;
+		return 0;
+	}
+	if (nano::network_constants::set_active_network (vm["network"].as<std::string> ()))
+	{
+		std::cerr << "Invalid network" << std::endl;
+		return 1;
+	}
+
+	if (vm.count ("generate"))
+	{
+		if (!nano::network_constants ().is_dev_network ())
+		{
+			std::cerr << "Traces can only be generated for the dev network" << std::endl;
+			return 1;
+		}
+		if (vm["representatives"].as<unsigned> () == 0 || vm["accounts"].as<unsigned> () == 0 || vm["rate"].as<unsigned> () == 0)
+		{
+			std::cerr << "representatives, accounts and rate must be positive" << std::endl;
+			return 1;
+		}
+		return generate (vm["generate"].as<std::string> (), vm["blocks"].as<unsigned> (), vm["representatives"].as<unsigned> (), vm["accounts"].as<unsigned> (), vm["rate"].as<unsigned> ());
+	}
+
+	if (!vm.count ("ledger") || !vm.count ("trace"))
+	{
+		std::cerr << "Either --generate or both --ledger and --trace are required" << std::endl;
+		return 1;
+	}
+	auto error (false);
+	auto metrics (replay (vm["ledger"].as<std::string> (), vm["trace"].as<std::string> (), vm["speed"].as<double> (), std::chrono::seconds (vm["idle_timeout"].as<unsigned> ()), error));
+	if (error)
+	{
+		return 1;
+	}
+	boost::property_tree::ptree results;
+	for (auto const & metric : metrics)
+	{
+		results.put (metric.name, metric.value);
+	}
+	if (vm.count ("output"))
+	{
+		boost::property_tree::write_json (vm["output"].as<std::string> (), results);
+	}
+	auto regressed (false);
+	if (vm.count ("baseline"))
+	{
+		boost::property_tree::ptree baseline;
+		try
+		{
+			boost::property_tree::read_json (vm["baseline"].as<std::string> (), baseline);
+		}
+		catch (boost::property_tree::json_parser_error const & err)
+		{
+			std::cerr << "Error reading baseline: " << err.what () << std::endl;
+			return 1;
+		}
+		regressed = compare (metrics, baseline, vm["tolerance"].as<double> ());
+	}
+	else
+	{
+		compare (metrics, boost::property_tree::ptree (), 0.0);
+	}
+	return regressed ? 1 : 0;
+}
@@ -457,6 +457,63 @@ TEST (block_uniquer, cleanup)
 	}
 }
 
+TEST (block_uniquer, many)
+{
+	nano::keypair key;
+	nano::block_uniquer uniquer;
+	std::vector<std::shared_ptr<nano::block>> blocks;
+	// Enough blocks for every shard to be rebuilt several times
+	for (auto i (0); i < 1000; ++i)
+	{
+		auto block (std::make_shared<nano::state_block> (0, 0, 0, 0, 0, key.prv, key.pub, i));
+		ASSERT_EQ (block, uniquer.unique (block));
+		blocks.push_back (block);
+	}
+	ASSERT_EQ (blocks.size (), uniquer.size ());
+	for (auto const & block : blocks)
+	{
+		auto copy (std::make_shared<nano::state_block> (*std::static_pointer_cast<nano::state_block> (block)));
+		ASSERT_EQ (block, uniquer.unique (copy));
+	}
+	ASSERT_EQ (blocks.size (), uniquer.size ());
+}
+
+TEST (block_uniquer, record)
+{
+	nano::keypair key;
+	nano::block_uniquer uniquer;
+	std::vector<std::shared_ptr<nano::block>> blocks{
+		std::make_shared<nano::send_block> (1, key.pub, 2, key.prv, key.pub, 3),
+		std::make_shared<nano::receive_block> (1, 2, key.prv, key.pub, 3),
+		std::make_shared<nano::open_block> (1, key.pub, key.pub, key.prv, key.pub, 3),
+		std::make_shared<nano::change_block> (1, key.pub, key.prv, key.pub, 3),
+		std::make_shared<nano::state_block> (key.pub, 1, key.pub, 2, 3, key.prv, key.pub, 4)
+	};
+	for (auto const & block : blocks)
+	{
+		std::vector<uint8_t> bytes;
+		{
+			nano::vectorstream stream (bytes);
+			block->serialize (stream);
+		}
+		nano::block_record record;
+		nano::bufferstream stream (bytes.data (), bytes.size ());
+		ASSERT_FALSE (record.deserialize (stream, block->type ()));
+		ASSERT_EQ (block->hash (), record.hash ());
+		ASSERT_EQ (block->full_hash (), record.full_hash ());
+		ASSERT_EQ (*block, *record.block ());
+		// Only the first block read is created, the same block read again is the one already known
+		nano::bufferstream stream1 (bytes.data (), bytes.size ());
+		auto block1 (nano::deserialize_block (stream1, block->type (), &uniquer));
+		ASSERT_EQ (*block, *block1);
+		nano::bufferstream stream2 (bytes.data (), bytes.size ());
+		ASSERT_EQ (block1, nano::deserialize_block (stream2, block->type (), &uniquer));
+		// A truncated block is an error
+		nano::bufferstream stream3 (bytes.data (), bytes.size () - 1);
+		ASSERT_TRUE (record.deserialize (stream3, block->type ()));
+	}
+}
+
 TEST (block_builder, from)
 {
 	std::error_code ec;
@@ -5,8 +5,69 @@
 
 #include <gtest/gtest.h>
 
+#include <boost/format.hpp>
+
 using namespace std::chrono_literals;
 
+namespace
+{
+/** Keeps the buffers sent through it instead of sending them */
+class recording_channel final : public nano::transport::channel
+{
+public:
+	recording_channel (nano::node & node_a, nano::endpoint const & endpoint_a) :
+	channel (node_a),
+	endpoint (endpoint_a)
+	{
+	}
+	size_t hash_code () const override
+	{
+		return std::hash<nano::endpoint> () (endpoint);
+	}
+	bool operator== (nano::transport::channel const & other_a) const override
+	{
+		return endpoint == other_a.get_endpoint ();
+	}
+	void send_buffer (nano::shared_const_buffer const & buffer_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::buffer_drop_policy) override
+	{
+		{
+			nano::lock_guard<nano::mutex> lock (mutex);
+			buffers.push_back (buffer_a);
+		}
+		if (callback_a)
+		{
+			callback_a (boost::system::errc::make_error_code (boost::system::errc::success), buffer_a.size ());
+		}
+	}
+	std::string to_string () const override
+	{
+		return boost::str (boost::format ("%1%") % endpoint);
+	}
+	nano::endpoint get_endpoint () const override
+	{
+		return endpoint;
+	}
+	nano::tcp_endpoint get_tcp_endpoint () const override
+	{
+		return nano::transport::map_endpoint_to_tcp (endpoint);
+	}
+	nano::transport::transport_type get_type () const override
+	{
+		return nano::transport::transport_type::loopback;
+	}
+	std::vector<nano::shared_const_buffer> sent ()
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		return buffers;
+	}
+
+private:
+	nano::endpoint const endpoint;
+	nano::mutex mutex;
+	std::vector<nano::shared_const_buffer> buffers;
+};
+}
+
 TEST (confirmation_solicitor, batches)
 {
 	nano::system system;
@@ -50,6 +111,40 @@ TEST (confirmation_solicitor, batches)
 	ASSERT_EQ (1, node2.stats.count (nano::stat::type::message, nano::stat::detail::confirm_req, nano::stat::dir::out));
 }
 
+// Requests for the same elections are serialized once and sent to every representative
+TEST (confirmation_solicitor, shared_requests)
+{
+	nano::system system;
+	nano::node_flags node_flags;
+	node_flags.disable_request_loop = true;
+	node_flags.disable_rep_crawler = true;
+	auto & node1 = *system.add_node (node_flags);
+	auto channel1 (std::make_shared<recording_channel> (node1, nano::endpoint (boost::asio::ip::address_v6::loopback (), 1000)));
+	auto channel2 (std::make_shared<recording_channel> (node1, nano::endpoint (boost::asio::ip::address_v6::loopback (), 1001)));
+	nano::keypair key;
+	std::vector<nano::representative> representatives{ { nano::dev_genesis_key.pub, nano::genesis_amount, channel1 }, { key.pub, nano::genesis_amount, channel2 } };
+	nano::confirmation_solicitor solicitor (node1.network, node1.config);
+	solicitor.prepare (representatives);
+	auto send (std::make_shared<nano::send_block> (nano::genesis_hash, nano::keypair ().pub, nano::genesis_amount - 100, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (nano::genesis_hash)));
+	send->sideband_set ({});
+	{
+		nano::lock_guard<nano::mutex> guard (node1.active.mutex);
+		for (size_t i (0); i < nano::network::confirm_req_hashes_max; ++i)
+		{
+			auto election (std::make_shared<nano::election> (node1, send, nullptr, nullptr, false, nano::election_behavior::normal));
+			ASSERT_FALSE (solicitor.add (*election));
+		}
+	}
+	solicitor.flush ();
+	ASSERT_TIMELY (3s, channel1->sent ().size () == 1 && channel2->sent ().size () == 1);
+	ASSERT_TIMELY (3s, 2 == node1.stats.count (nano::stat::type::message, nano::stat::detail::confirm_req, nano::stat::dir::out));
+	// Both representatives were sent the same serialized request
+	auto buffer1 (channel1->sent ().front ());
+	auto buffer2 (channel2->sent ().front ());
+	ASSERT_EQ (buffer1.begin ()->data (), buffer2.begin ()->data ());
+	ASSERT_EQ (buffer1.size (), buffer2.size ());
+}
+
 namespace nano
 {
 TEST (confirmation_solicitor, different_hash)
@@ -243,3 +243,73 @@ TEST (distributed_work, fail_resolve)
 	ASSERT_TIMELY (5s, done);
 	ASSERT_GE (nano::work_difficulty (nano::work_version::work_1, hash, *work), node->network_params.network.publish_thresholds.base);
 }
+
+TEST (distributed_work, peer_scores)
+{
+	nano::work_peer_scores scores;
+	std::vector<std::pair<std::string, uint16_t>> peers{ { "slow", 1 }, { "failing", 2 }, { "fast", 3 }, { "unknown", 4 } };
+	ASSERT_EQ (peers, scores.order (peers));
+	ASSERT_EQ (nano::work_peer_scores::hedge_delay_unknown, scores.hedge_delay ("fast:3"));
+	for (auto i (0); i < 4; ++i)
+	{
+		scores.success ("slow:1", 200ms);
+		scores.success ("fast:3", 10ms);
+		scores.failure ("failing:2");
+	}
+	ASSERT_EQ (3, scores.size ());
+	std::vector<std::pair<std::string, uint16_t>> expected{ { "unknown", 4 }, { "fast", 3 }, { "slow", 1 }, { "failing", 2 } };
+	ASSERT_EQ (expected, scores.order (peers));
+	// Consistent response times give a hedge delay close to the response time
+	ASSERT_GE (scores.hedge_delay ("fast:3"), 10ms);
+	ASSERT_LT (scores.hedge_delay ("fast:3"), scores.hedge_delay ("slow:1"));
+	ASSERT_LT (scores.hedge_delay ("slow:1"), 1s);
+	// Failures lower a peer's rank even if it was fast
+	for (auto i (0); i < 32; ++i)
+	{
+		scores.failure ("fast:3");
+	}
+	auto order (scores.order (peers));
+	ASSERT_EQ (peers[0], order[1]);
+	ASSERT_EQ (peers[2], order[2]);
+}
+
+TEST (distributed_work, peer_hedging)
+{
+	nano::system system;
+	nano::node_config node_config (nano::get_available_port (), system.logging);
+	node_config.work_threads = 0;
+	node_config.work_peer_hedging = true;
+	auto & node = *system.add_node (node_config);
+	nano::work_pool pool (1);
+	work_peer_profile slow_profile;
+	slow_profile.latency = 3s;
+	slow_profile.cancel_generation = true;
+	auto slow_peer (std::make_shared<fake_work_peer> (pool, node.io_ctx, nano::get_available_port (), slow_profile));
+	auto malicious_peer (std::make_shared<fake_work_peer> (pool, node.io_ctx, nano::get_available_port (), work_peer_type::malicious));
+	auto good_peer (std::make_shared<fake_work_peer> (pool, node.io_ctx, nano::get_available_port (), work_peer_type::good));
+	slow_peer->start ();
+	malicious_peer->start ();
+	good_peer->start ();
+	decltype (node.config.work_peers) peers;
+	peers.emplace_back ("::ffff:127.0.0.1", slow_peer->port ());
+	peers.emplace_back ("::ffff:127.0.0.1", malicious_peer->port ());
+	peers.emplace_back ("::ffff:127.0.0.1", good_peer->port ());
+	std::atomic<bool> done{ false };
+	auto callback = [&done](boost::optional<uint64_t> work_a) {
+		ASSERT_TRUE (work_a.is_initialized ());
+		done = true;
+	};
+	// Peers are contacted in order. The slow peer is hedged after the delay for unknown peers, the failure of the malicious one then moves on to the good peer at once
+	nano::timer<std::chrono::milliseconds> timer (nano::timer_state::started);
+	ASSERT_FALSE (node.distributed_work.make (nano::work_version::work_1, nano::block_hash (1), peers, node.network_params.network.publish_thresholds.base, callback, nano::account ()));
+	ASSERT_TIMELY (5s, done);
+	ASSERT_LT (timer.stop (), slow_profile.latency);
+	ASSERT_GE (timer.value (), nano::work_peer_scores::hedge_delay_unknown);
+	ASSERT_EQ (1, malicious_peer->generations_bad);
+	ASSERT_EQ (1, good_peer->generations_good);
+	ASSERT_TIMELY (5s, slow_peer->cancels == 1);
+	// The good peer is now asked first, and the malicious one last
+	auto order (node.distributed_work.scores.order (peers));
+	ASSERT_EQ (peers[2], order[0]);
+	ASSERT_EQ (peers[1], order[2]);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <nano/crypto_lib/random_pool.hpp>
 #include <nano/lib/errors.hpp>
 #include <nano/lib/locks.hpp>
 #include <nano/lib/numbers.hpp>
@@ -30,14 +31,32 @@ enum class work_peer_type
 	slow
 };
 
+/** Behaviour of a fake work peer, to simulate work peers of varying quality */
+class work_peer_profile final
+{
+public:
+	work_peer_type type{ work_peer_type::good };
+	/** Added before each response, on top of the generation time */
+	std::chrono::milliseconds latency{ 0 };
+	/** Up to this much is randomly added to the latency */
+	std::chrono::milliseconds jitter{ 0 };
+	/** Probability of responding with an error instead of generating work */
+	double failure_rate{ 0 };
+	/** Work is generated at most at this difficulty, regardless of the requested one. Zero for no limit */
+	uint64_t max_difficulty{ 0 };
+	/** Stop generating on work_cancel. Only for peers with their own work pool, as it cancels all work for the root */
+	bool cancel_generation{ false };
+};
+
 class work_peer_connection : public std::enable_shared_from_this<work_peer_connection>
 {
 	const std::string generic_error = "Unable to parse JSON";
 
 public:
-	work_peer_connection (asio::io_context & ioc_a, work_peer_type const type_a, nano::work_version const version_a, nano::work_pool & pool_a, std::function<void(bool const)> on_generation_a, std::function<void()> on_cancel_a) :
+	work_peer_connection (asio::io_context & ioc_a, work_peer_profile const & profile_a, nano::work_version const version_a, nano::work_pool & pool_a, std::function<void(bool const, std::chrono::microseconds const)> on_generation_a, std::function<void()> on_cancel_a) :
 	socket (ioc_a),
-	type (type_a),
+	profile (profile_a),
+	type (profile_a.type),
 	version (version_a),
 	work_pool (pool_a),
 	on_generation (on_generation_a),
@@ -52,13 +71,14 @@ public:
 	tcp::socket socket;
 
 private:
+	work_peer_profile const profile;
 	work_peer_type type;
 	nano::work_version version;
 	nano::work_pool & work_pool;
 	beast::flat_buffer buffer{ 8192 };
 	http::request<http::string_body> request;
 	http::response<http::dynamic_body> response;
-	std::function<void(bool const)> on_generation;
+	std::function<void(bool const, std::chrono::microseconds const)> on_generation;
 	std::function<void()> on_cancel;
 	asio::deadline_timer timer;
 
@@ -125,8 +145,19 @@ private:
 		beast::ostream (response.body ()) << ostream.str ();
 	}
 
-	void handle_cancel ()
+	/** Latency of the next response, including the random jitter */
+	boost::posix_time::milliseconds response_delay () const
+	{
+		auto jitter_l (profile.jitter.count () > 0 ? nano::random_pool::generate_word32 (0, static_cast<unsigned> (profile.jitter.count ())) : 0);
+		return boost::posix_time::milliseconds (profile.latency.count () + jitter_l + (type == work_peer_type::slow ? 500 : 0));
+	}
+
+	void handle_cancel (nano::block_hash const & hash_a)
 	{
+		if (profile.cancel_generation)
+		{
+			work_pool.cancel (hash_a);
+		}
 		on_cancel ();
 		ptree::ptree message_l;
 		message_l.put ("success", "");
@@ -136,14 +167,30 @@ private:
 		write_response ();
 	}
 
-	void handle_generate (nano::block_hash const & hash_a)
+	void handle_generate (nano::block_hash const & hash_a, uint64_t const difficulty_a)
 	{
-		if (type == work_peer_type::good)
+		if (type != work_peer_type::malicious && profile.failure_rate > 0 && nano::random_pool::generate_word32 (0, 9999) < profile.failure_rate * 10000)
+		{
+			auto this_l (shared_from_this ());
+			timer.expires_from_now (response_delay ());
+			timer.async_wait ([this_l](const boost::system::error_code & ec) {
+				this_l->on_generation (false, std::chrono::microseconds (0));
+				this_l->error ("Simulated failure");
+				this_l->write_response ();
+			});
+		}
+		else if (type != work_peer_type::malicious)
 		{
 			auto hash = hash_a;
-			auto request_difficulty = nano::work_threshold_base (version);
+			auto request_difficulty = difficulty_a;
+			if (profile.max_difficulty != 0)
+			{
+				request_difficulty = std::min (request_difficulty, profile.max_difficulty);
+			}
 			auto this_l (shared_from_this ());
-			work_pool.generate (version, hash, request_difficulty, [this_l, hash](boost::optional<uint64_t> work_a) {
+			auto generation_start (std::chrono::steady_clock::now ());
+			work_pool.generate (version, hash, request_difficulty, [this_l, hash, generation_start](boost::optional<uint64_t> work_a) {
+				auto generation_time (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - generation_start));
 				auto result = work_a.value_or (0);
 				auto result_difficulty (nano::work_difficulty (this_l->version, hash, result));
 				static nano::network_params params;
@@ -155,12 +202,12 @@ private:
 				std::stringstream ostream;
 				ptree::write_json (ostream, message_l);
 				beast::ostream (this_l->response.body ()) << ostream.str ();
-				// Delay response by 500ms as a slow peer, immediate async call for a good peer
-				this_l->timer.expires_from_now (boost::posix_time::milliseconds (this_l->type == work_peer_type::slow ? 500 : 0));
-				this_l->timer.async_wait ([this_l, result](const boost::system::error_code & ec) {
+				// Delay response by 500ms as a slow peer, immediate async call for a good peer, plus the profile latency
+				this_l->timer.expires_from_now (this_l->response_delay ());
+				this_l->timer.async_wait ([this_l, result, generation_time](const boost::system::error_code & ec) {
 					if (this_l->on_generation)
 					{
-						this_l->on_generation (result != 0);
+						this_l->on_generation (result != 0, generation_time);
 					}
 					this_l->write_response ();
 				});
@@ -169,7 +216,7 @@ private:
 		else if (type == work_peer_type::malicious)
 		{
 			// Respond immediately with no work
-			on_generation (false);
+			on_generation (false, std::chrono::microseconds (0));
 			write_response ();
 		}
 	}
@@ -182,11 +229,18 @@ private:
 		hash.decode_hex (hash_text);
 		if (action_text == "work_generate")
 		{
-			handle_generate (hash);
+			// Peers which didn't ask for a difficulty get the base threshold
+			auto difficulty (nano::work_threshold_base (version));
+			auto difficulty_text (tree_a.get_optional<std::string> ("difficulty"));
+			if (difficulty_text.is_initialized ())
+			{
+				nano::from_string_hex (*difficulty_text, difficulty);
+			}
+			handle_generate (hash, difficulty);
 		}
 		else if (action_text == "work_cancel")
 		{
-			handle_cancel ();
+			handle_cancel (hash);
 		}
 		else
 		{
@@ -200,11 +254,15 @@ class fake_work_peer : public std::enable_shared_from_this<fake_work_peer>
 public:
 	fake_work_peer () = delete;
 	fake_work_peer (nano::work_pool & pool_a, asio::io_context & ioc_a, unsigned short port_a, work_peer_type const type_a, nano::work_version const version_a = nano::work_version::work_1) :
+	fake_work_peer (pool_a, ioc_a, port_a, work_peer_profile{ type_a }, version_a)
+	{
+	}
+	fake_work_peer (nano::work_pool & pool_a, asio::io_context & ioc_a, unsigned short port_a, work_peer_profile const & profile_a, nano::work_version const version_a = nano::work_version::work_1) :
 	pool (pool_a),
 	endpoint (tcp::v4 (), port_a),
 	ioc (ioc_a),
 	acceptor (ioc_a, endpoint),
-	type (type_a),
+	profile (profile_a),
 	version (version_a)
 	{
 	}
@@ -219,16 +277,19 @@ public:
 	std::atomic<size_t> generations_good{ 0 };
 	std::atomic<size_t> generations_bad{ 0 };
 	std::atomic<size_t> cancels{ 0 };
+	/** Total time spent generating, including generations which were cancelled or lost to another peer */
+	std::atomic<uint64_t> generation_us{ 0 };
 
 private:
 	void listen ()
 	{
 		std::weak_ptr<fake_work_peer> this_w (shared_from_this ());
 		auto connection (std::make_shared<work_peer_connection> (
-		ioc, type, version, pool,
-		[this_w](bool const good_generation) {
+		ioc, profile, version, pool,
+		[this_w](bool const good_generation, std::chrono::microseconds const generation_time) {
 			if (auto this_l = this_w.lock ())
 			{
+				this_l->generation_us += generation_time.count ();
 				if (good_generation)
 				{
 					++this_l->generations_good;
@@ -260,7 +321,7 @@ private:
 	tcp::endpoint endpoint;
 	asio::io_context & ioc;
 	tcp::acceptor acceptor;
-	work_peer_type const type;
+	work_peer_profile const profile;
 	nano::work_version version;
 };
 }
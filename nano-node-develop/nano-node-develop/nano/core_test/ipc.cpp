@@ -1,4 +1,8 @@
+#include <nano/ipc_flatbuffers_lib/flatbuffer_producer.hpp>
+#include <nano/ipc_flatbuffers_lib/generated/flatbuffers/nanoapi_generated.h>
 #include <nano/lib/ipc_client.hpp>
+#include <nano/lib/ipc_shm.hpp>
+#include <nano/lib/threading.hpp>
 #include <nano/lib/tomlconfig.hpp>
 #include <nano/node/ipc/ipc_access_config.hpp>
 #include <nano/node/ipc/ipc_server.hpp>
@@ -86,6 +90,101 @@ TEST (ipc, synchronous)
 	ipc.stop ();
 }
 
+#if defined(__linux__)
+TEST (ipc, shared_memory)
+{
+	nano::system system (1);
+	auto & shared_memory (system.nodes[0]->config.ipc_config.transport_shared_memory);
+	shared_memory.enabled = true;
+	shared_memory.name = "/nano_core_test_ipc";
+	// Small rings, so that larger messages are split in frames
+	shared_memory.ring_size = 4096;
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc (*system.nodes[0], node_rpc_config);
+	// Requests are handled on the io threads, while this thread waits for responses
+	nano::thread_runner runner (system.io_ctx, 1);
+
+	nano::ipc::shm_client client;
+	ASSERT_FALSE (client.connect (shared_memory.name));
+	ASSERT_TRUE (client.connected ());
+
+	auto block_count = [](std::string const & response_a) {
+		std::stringstream ss (response_a);
+		boost::property_tree::ptree tree;
+		boost::property_tree::read_json (ss, tree);
+		return tree.get<int> ("count");
+	};
+	// The padding is ignored by the handler but makes the request span several frames
+	std::string padding (10000, 'x');
+	ASSERT_EQ (1, block_count (client.request (nano::ipc::payload_encoding::json_v1, R"({"action": "block_count", "padding": ")" + padding + "\"}")));
+
+	// A response larger than the ring
+	boost::property_tree::ptree request;
+	request.put ("action", "accounts_balances");
+	boost::property_tree::ptree accounts;
+	for (auto i (0); i < 64; ++i)
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("", nano::keypair ().pub.to_account ());
+		accounts.push_back (std::make_pair ("", entry));
+	}
+	request.add_child ("accounts", accounts);
+	std::stringstream request_ss;
+	boost::property_tree::write_json (request_ss, request);
+	auto balances_response (client.request (nano::ipc::payload_encoding::json_v1, request_ss.str ()));
+	ASSERT_GT (balances_response.size (), shared_memory.ring_size);
+	{
+		std::stringstream ss (balances_response);
+		boost::property_tree::ptree tree;
+		boost::property_tree::read_json (ss, tree);
+		ASSERT_EQ (64, tree.get_child ("balances").size ());
+	}
+
+	// Many outstanding requests on one connection, sent from several threads
+	std::atomic<int> completed{ 0 };
+	std::atomic<int> failed{ 0 };
+	std::vector<std::thread> threads;
+	for (auto i (0); i < 4; ++i)
+	{
+		threads.emplace_back ([&client, &completed, &failed, &block_count]() {
+			for (auto j (0); j < 50; ++j)
+			{
+				client.async_request (nano::ipc::payload_encoding::json_v1, R"({"action": "block_count"})", [&completed, &failed, &block_count](nano::error const & error_a, std::string const & response_a) {
+					if (!error_a && block_count (response_a) == 1)
+					{
+						++completed;
+					}
+					else
+					{
+						++failed;
+					}
+				});
+			}
+		});
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	ASSERT_TIMELY (10s, completed + failed == 200);
+	ASSERT_EQ (0, failed);
+
+	// Subscriptions need a session to push messages to, over shared memory they are refused
+	nanoapi::TopicConfirmationT topic;
+	auto topic_buffer (nano::ipc::flatbuffer_producer::make_buffer (topic));
+	auto topic_response (client.request (nano::ipc::payload_encoding::flatbuffers, std::string (reinterpret_cast<char const *> (topic_buffer->GetBufferPointer ()), topic_buffer->GetSize ())));
+	ASSERT_FALSE (topic_response.empty ());
+	ASSERT_EQ (nanoapi::Message_Error, nanoapi::GetEnvelope (topic_response.data ())->message_type ());
+
+	// Outstanding and later requests fail once the server stops
+	ipc.stop ();
+	ASSERT_FALSE (client.connected ());
+	ASSERT_TRUE (client.request (nano::ipc::payload_encoding::json_v1, R"({"action": "block_count"})").empty ());
+	system.stop ();
+	runner.join ();
+}
+#endif
+
 TEST (ipc, permissions_default_user)
 {
 	// Test empty/nonexistant access config. The default user still exists with default permissions.
@@ -0,0 +1,115 @@
+#include <nano/lib/json_writer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <sstream>
+
+namespace
+{
+std::string write_json (boost::property_tree::ptree const & tree_a)
+{
+	std::stringstream ostream;
+	boost::property_tree::write_json (ostream, tree_a);
+	return ostream.str ();
+}
+}
+
+TEST (json_writer, empty)
+{
+	std::string output;
+	nano::json_writer writer (output);
+	ASSERT_TRUE (writer.empty ());
+	writer.finish ();
+	ASSERT_EQ (write_json (boost::property_tree::ptree ()), output);
+}
+
+TEST (json_writer, values)
+{
+	boost::property_tree::ptree tree;
+	tree.put ("string", "value");
+	tree.put ("true", true);
+	tree.put ("false", false);
+	tree.put ("escaped", "quote\" backslash\\ slash/ newline\n tab\t control\x01 high\xc3\xa9");
+	std::string output;
+	nano::json_writer writer (output);
+	writer.put ("string", "value");
+	writer.put ("true", true);
+	writer.put ("false", false);
+	writer.put ("escaped", "quote\" backslash\\ slash/ newline\n tab\t control\x01 high\xc3\xa9");
+	ASSERT_FALSE (writer.empty ());
+	writer.finish ();
+	ASSERT_EQ (write_json (tree), output);
+}
+
+TEST (json_writer, nested)
+{
+	boost::property_tree::ptree tree;
+	tree.put ("a.b", "1");
+	tree.put ("a.c", "2");
+	boost::property_tree::ptree array;
+	boost::property_tree::ptree entry;
+	entry.put ("", "x");
+	array.push_back (std::make_pair ("", entry));
+	boost::property_tree::ptree object_entry;
+	object_entry.put ("d", "3");
+	array.push_back (std::make_pair ("", object_entry));
+	tree.add_child ("array", array);
+	std::string output;
+	nano::json_writer writer (output);
+	writer.start_object ("a");
+	writer.put ("b", "1");
+	writer.put ("c", "2");
+	writer.end ();
+	writer.start_array ("array");
+	writer.push_back ("x");
+	writer.start_object ();
+	writer.put ("d", "3");
+	writer.end ();
+	writer.end ();
+	writer.finish ();
+	ASSERT_EQ (write_json (tree), output);
+}
+
+// Property trees cannot represent empty objects and arrays, so write_json emits "" for them
+TEST (json_writer, empty_scopes)
+{
+	boost::property_tree::ptree tree;
+	tree.put ("object", "");
+	tree.put ("array", "");
+	std::string output;
+	nano::json_writer writer (output);
+	writer.start_object ("object");
+	writer.end ();
+	writer.start_array ("array");
+	writer.end ();
+	writer.finish ();
+	ASSERT_EQ (write_json (tree), output);
+}
+
+TEST (json_writer, trees)
+{
+	boost::property_tree::ptree child;
+	child.put ("x", "1");
+	child.put ("y.z", "2");
+	boost::property_tree::ptree tree;
+	tree.put ("first", "value");
+	tree.add_child ("child", child);
+	boost::property_tree::ptree array;
+	array.push_back (std::make_pair ("", child));
+	array.push_back (std::make_pair ("", child));
+	tree.add_child ("array", array);
+	std::string output;
+	nano::json_writer writer (output);
+	boost::property_tree::ptree first;
+	first.put ("first", "value");
+	writer.put_children (first);
+	writer.put_tree ("child", child);
+	writer.start_array ("array");
+	writer.push_back_tree (child);
+	writer.push_back_tree (child);
+	writer.end ();
+	writer.finish ();
+	ASSERT_EQ (write_json (tree), output);
+}
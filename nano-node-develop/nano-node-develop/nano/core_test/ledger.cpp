@@ -3885,3 +3885,60 @@ TEST (ledger, unconfirmed_frontiers)
 	ASSERT_EQ (uncemented_info1.cemented_frontier, uncemented_info2.cemented_frontier);
 	ASSERT_EQ (uncemented_info1.frontier, uncemented_info2.frontier);
 }
+
+TEST (ledger, account_index)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::stat stats;
+	nano::ledger ledger (*store, stats);
+	auto transaction (store->tx_begin_write ());
+	nano::genesis genesis;
+	store->initialize (transaction, genesis, ledger.cache);
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::keypair key1;
+	nano::send_block send1 (genesis.hash (), key1.pub, nano::genesis_amount - 50, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *pool.generate (genesis.hash ()));
+	ASSERT_EQ (nano::process_result::progress, ledger.process (transaction, send1).code);
+	ASSERT_FALSE (ledger.account_index);
+	ASSERT_FALSE (store->account_index_exists (transaction));
+	// A batch size of one commits part way through the genesis chain and resumes from there
+	ledger.account_index_build (transaction, 1);
+	ASSERT_TRUE (ledger.account_index);
+	ASSERT_TRUE (store->account_index_exists (transaction));
+	ASSERT_EQ (genesis.hash (), store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 1)));
+	ASSERT_EQ (send1.hash (), store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 2)));
+	ASSERT_TRUE (store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 3)).is_zero ());
+	// Blocks processed afterwards are indexed by the ledger
+	nano::send_block send2 (send1.hash (), key1.pub, nano::genesis_amount - 150, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *pool.generate (send1.hash ()));
+	ASSERT_EQ (nano::process_result::progress, ledger.process (transaction, send2).code);
+	ASSERT_EQ (send2.hash (), store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 3)));
+	auto pending_amounts = [&store, &transaction, &key1]() {
+		std::vector<std::pair<nano::block_hash, nano::uint128_t>> result;
+		for (auto i (store->pending_amounts_begin (transaction, nano::pending_amount_key (key1.pub, std::numeric_limits<nano::uint128_t>::max (), 0))), n (store->pending_amounts_end ()); i != n && nano::pending_amount_key (i->first).account == key1.pub; ++i)
+		{
+			nano::pending_amount_key const & key (i->first);
+			result.emplace_back (key.hash, key.amount ().number ());
+		}
+		return result;
+	};
+	// Largest amounts first
+	std::vector<std::pair<nano::block_hash, nano::uint128_t>> expected{ { send2.hash (), 100 }, { send1.hash (), 50 } };
+	ASSERT_EQ (expected, pending_amounts ());
+	nano::open_block open (send2.hash (), key1.pub, key1.pub, key1.prv, key1.pub, *pool.generate (key1.pub));
+	ASSERT_EQ (nano::process_result::progress, ledger.process (transaction, open).code);
+	ASSERT_EQ (open.hash (), store->account_height_get (transaction, nano::account_height_key (key1.pub, 1)));
+	expected = { { send1.hash (), 50 } };
+	ASSERT_EQ (expected, pending_amounts ());
+	// Rolling back send2 also rolls back the open block which received it
+	ASSERT_FALSE (ledger.rollback (transaction, send2.hash ()));
+	ASSERT_TRUE (store->account_height_get (transaction, nano::account_height_key (key1.pub, 1)).is_zero ());
+	ASSERT_TRUE (store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 3)).is_zero ());
+	ASSERT_EQ (send1.hash (), store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 2)));
+	ASSERT_EQ (expected, pending_amounts ());
+	ledger.account_index_clear (transaction);
+	ASSERT_FALSE (ledger.account_index);
+	ASSERT_FALSE (store->account_index_exists (transaction));
+	ASSERT_TRUE (store->account_height_get (transaction, nano::account_height_key (nano::dev_genesis_key.pub, 1)).is_zero ());
+	ASSERT_TRUE (pending_amounts ().empty ());
+}
@@ -8,7 +8,9 @@
 
 #include <chrono>
 #include <regex>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -122,6 +124,89 @@ TEST (logger, always_log)
 	ASSERT_STREQ (str.c_str (), output2);
 }
 
+TEST (logger, async)
+{
+	std::stringstream ss;
+	nano::boost_log_cerr_redirect redirect_cerr (ss.rdbuf ());
+	auto queue (std::make_shared<nano::log_queue> (false));
+	nano::logger_mt my_logger (20s, queue);
+	std::string moved ("logger.async2");
+	my_logger.always_log ("logger.async1");
+	my_logger.always_log (moved, " ", 3);
+	// Entries are captured by value, later changes are not seen
+	moved = "changed";
+	// Owning values are copied, the pointer they were read through may be gone when written
+	auto pointer (std::make_unique<int> (4));
+	my_logger.always_log ("logger.async", *pointer);
+	pointer.reset ();
+	// Character arrays are copied, they may be buffers on the stack
+	char buffer[] = "logger.async5";
+	my_logger.always_log (buffer);
+	buffer[12] = '6';
+	// Views don't own what they refer to, so they are formatted when logged
+	std::string viewed ("logger.async7");
+	my_logger.always_log (std::string_view (viewed));
+	viewed[12] = '8';
+	queue->flush ();
+
+	std::string str;
+	std::getline (ss, str, '\n');
+	ASSERT_EQ (str, "logger.async1");
+	std::getline (ss, str, '\n');
+	ASSERT_EQ (str, "logger.async2 3");
+	std::getline (ss, str, '\n');
+	ASSERT_EQ (str, "logger.async4");
+	std::getline (ss, str, '\n');
+	ASSERT_EQ (str, "logger.async5");
+	std::getline (ss, str, '\n');
+	ASSERT_EQ (str, "logger.async7");
+	ASSERT_EQ (0, queue->dropped ());
+}
+
+TEST (logger, async_threads)
+{
+	std::stringstream ss;
+	nano::boost_log_cerr_redirect redirect_cerr (ss.rdbuf ());
+	auto queue (std::make_shared<nano::log_queue> (false, 4));
+	nano::logger_mt my_logger (20s, queue);
+	auto const thread_count (4);
+	auto const count (500);
+	std::vector<std::thread> threads;
+	for (auto i (0); i < thread_count; ++i)
+	{
+		threads.emplace_back ([&my_logger, i, count] () {
+			for (auto j (0); j < count; ++j)
+			{
+				my_logger.always_log ("thread ", i, " entry ", j);
+			}
+		});
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	queue->flush ();
+
+	// Each thread's entries are written in order, entries which didn't fit the small buffers are counted
+	std::vector<int> last (thread_count, -1);
+	std::regex entry_regex ("thread (\\d+) entry (\\d+)");
+	size_t written (0);
+	std::string str;
+	while (std::getline (ss, str, '\n'))
+	{
+		std::smatch match;
+		if (std::regex_match (str, match, entry_regex))
+		{
+			auto thread (std::stoi (match[1]));
+			auto entry (std::stoi (match[2]));
+			ASSERT_LT (last[thread], entry);
+			last[thread] = entry;
+			++written;
+		}
+	}
+	ASSERT_EQ (thread_count * count, written + queue->dropped ());
+}
+
 TEST (logger, stable_filename)
 {
 	auto path (nano::unique_path ());
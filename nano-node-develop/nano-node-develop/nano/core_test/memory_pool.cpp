@@ -4,7 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <vector>
 
 namespace
@@ -54,6 +56,22 @@ size_t get_allocated_size ()
 	debug_assert (allocated.size () == 1);
 	return allocated.front ();
 }
+
+constexpr auto state_block_pool_size (nano::determine_shared_ptr_pool_size<nano::state_block> ());
+/** Whether the cache of the exiting thread was already closed when release_at_exit freed its block */
+std::atomic<bool> released_after_close{ false };
+
+/** Frees a block as its thread exits */
+class release_at_exit final
+{
+public:
+	~release_at_exit ()
+	{
+		released_after_close = nano::memory_pool_cache_closed<state_block_pool_size> ();
+		block.reset ();
+	}
+	std::shared_ptr<nano::state_block> block;
+};
 }
 
 TEST (memory_pool, validate_cleanup)
@@ -98,3 +116,86 @@ TEST (memory_pool, validate_cleanup)
 
 	ASSERT_TRUE (nano::purge_singleton_inactive_votes_cache_pool_memory ());
 }
+
+TEST (memory_pool, reuse)
+{
+	nano::memory_pool pool (64);
+	nano::memory_pool::thread_cache cache (pool);
+	auto object (cache.allocate ());
+	ASSERT_EQ (nano::memory_pool::batch_size, pool.reserved.load ());
+	cache.deallocate (object);
+	// The most recently freed object is handed out first
+	ASSERT_EQ (object, cache.allocate ());
+	cache.deallocate (object);
+	ASSERT_TRUE (cache.purge ());
+	ASSERT_EQ (0, pool.reserved.load ());
+	ASSERT_FALSE (pool.purge ());
+}
+
+TEST (memory_pool, thread_exit)
+{
+	nano::memory_pool pool (64);
+	std::thread thread ([&pool]() {
+		nano::memory_pool::thread_cache cache (pool);
+		std::vector<void *> objects;
+		for (auto i (0); i < 1024; ++i)
+		{
+			objects.push_back (cache.allocate ());
+		}
+		for (auto object : objects)
+		{
+			cache.deallocate (object);
+		}
+	});
+	thread.join ();
+	// Objects cached by the thread went back to the pool as it exited
+	ASSERT_EQ (1024, pool.reserved.load ());
+	ASSERT_TRUE (pool.purge ());
+	ASSERT_EQ (0, pool.reserved.load ());
+}
+
+TEST (memory_pool, free_after_cache_destroyed)
+{
+	if (!nano::get_use_memory_pools ())
+	{
+		return;
+	}
+	auto & pool (nano::memory_pool_instance<state_block_pool_size> ());
+	pool.purge ();
+	auto reserved (pool.reserved.load ());
+	std::thread thread ([]() {
+		// Constructed before the cache for its size, so it's destroyed after it and frees the block to the pool directly
+		static thread_local release_at_exit release;
+		release.block = nano::make_shared<nano::state_block> ();
+	});
+	thread.join ();
+	ASSERT_TRUE (released_after_close);
+	// Everything the thread reserved is back in the pool, including the block freed after its cache was destroyed
+	pool.purge ();
+	ASSERT_EQ (reserved, pool.reserved.load ());
+	// The flag is per thread
+	ASSERT_FALSE (nano::memory_pool_cache_closed<state_block_pool_size> ());
+}
+
+TEST (memory_pool, bounded_retention)
+{
+	nano::memory_pool pool (64);
+	nano::memory_pool::thread_cache cache (pool);
+	auto count (nano::memory_pool::retained_max * 2);
+	std::vector<void *> objects;
+	for (auto i (0u); i < count; ++i)
+	{
+		objects.push_back (cache.allocate ());
+	}
+	ASSERT_EQ (count, pool.reserved.load ());
+	for (auto object : objects)
+	{
+		cache.deallocate (object);
+	}
+	// Objects beyond what the pool and the cache keep were released
+	ASSERT_LE (pool.reserved.load (), nano::memory_pool::retained_max + 128);
+	ASSERT_GE (pool.reserved.load (), nano::memory_pool::retained_max);
+	cache.purge ();
+	pool.purge ();
+	ASSERT_EQ (0, pool.reserved.load ());
+}
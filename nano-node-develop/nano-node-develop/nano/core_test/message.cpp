@@ -1,6 +1,8 @@
 #include <nano/node/common.hpp>
+#include <nano/node/message_trace.hpp>
 #include <nano/node/network.hpp>
 #include <nano/secure/buffer.hpp>
+#include <nano/secure/utility.hpp>
 
 #include <gtest/gtest.h>
 
@@ -202,3 +204,29 @@ TEST (message, confirm_req_hash_batch_serialization)
 	ASSERT_EQ (header.block_type (), nano::block_type::not_a_block);
 	ASSERT_EQ (header.count_get (), req.roots_hashes.size ());
 }
+
+TEST (message, trace_round_trip)
+{
+	auto path (nano::unique_path ());
+	nano::keypair key;
+	auto block (std::make_shared<nano::send_block> (0, 1, 2, key.prv, 4, 5));
+	nano::publish publish (block);
+	nano::confirm_req confirm_req (std::vector<std::pair<nano::block_hash, nano::root>>{ { block->hash (), block->root () } });
+	{
+		nano::message_trace_writer writer (path);
+		ASSERT_FALSE (writer.error ());
+		writer.write (publish, std::chrono::microseconds (10));
+		writer.write (confirm_req, std::chrono::microseconds (20));
+	}
+	nano::message_trace_reader reader (path);
+	ASSERT_FALSE (reader.error ());
+	nano::message_trace_reader::entry entry;
+	ASSERT_TRUE (reader.next (entry));
+	ASSERT_EQ (std::chrono::microseconds (10), entry.time);
+	ASSERT_EQ (*publish.to_bytes (), entry.message);
+	ASSERT_TRUE (reader.next (entry));
+	ASSERT_EQ (std::chrono::microseconds (20), entry.time);
+	ASSERT_EQ (*confirm_req.to_bytes (), entry.message);
+	ASSERT_FALSE (reader.next (entry));
+	ASSERT_TRUE (nano::message_trace_reader (nano::unique_path ()).error ());
+}
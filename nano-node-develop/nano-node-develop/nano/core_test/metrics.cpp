@@ -0,0 +1,71 @@
+#include <nano/boost/beast/core/flat_buffer.hpp>
+#include <nano/boost/beast/http.hpp>
+#include <nano/node/metrics.hpp>
+#include <nano/node/testing.hpp>
+#include <nano/test_common/testutil.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <future>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+boost::beast::http::response<boost::beast::http::string_body> scrape (uint16_t port_a, std::string const & target_a)
+{
+	boost::asio::io_context io_ctx;
+	boost::asio::ip::tcp::socket socket (io_ctx);
+	socket.connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v6::loopback (), port_a));
+	boost::beast::http::request<boost::beast::http::empty_body> request (boost::beast::http::verb::get, target_a, 11);
+	boost::beast::http::write (socket, request);
+	boost::beast::flat_buffer buffer;
+	boost::beast::http::response<boost::beast::http::string_body> response;
+	boost::beast::http::read (socket, buffer, response);
+	return response;
+}
+}
+
+TEST (metrics, render)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.metrics_config.enabled = true;
+	config.metrics_config.port = nano::get_available_port ();
+	auto node (system.add_node (config));
+	ASSERT_NE (nullptr, node->metrics);
+	node->stats.add (nano::stat::type::ledger, nano::stat::detail::send, nano::stat::dir::in, 3);
+	node->stats.observe (nano::stat::latency::cementing, 2ms);
+	auto text (node->metrics->render ());
+	ASSERT_NE (std::string::npos, text.find ("nano_stat_total{type=\"ledger\",detail=\"send\",dir=\"in\"} 3\n"));
+	ASSERT_NE (std::string::npos, text.find ("nano_stat_total{type=\"ledger\",detail=\"all\",dir=\"in\"} 3\n"));
+	// Buckets are cumulative
+	ASSERT_NE (std::string::npos, text.find ("nano_latency_seconds_bucket{kind=\"cementing\",le=\"0.001000000\"} 0\n"));
+	ASSERT_NE (std::string::npos, text.find ("nano_latency_seconds_bucket{kind=\"cementing\",le=\"0.002500000\"} 1\n"));
+	ASSERT_NE (std::string::npos, text.find ("nano_latency_seconds_bucket{kind=\"cementing\",le=\"+Inf\"} 1\n"));
+	ASSERT_NE (std::string::npos, text.find ("nano_latency_seconds_sum{kind=\"cementing\"} 0.002000000\n"));
+	ASSERT_NE (std::string::npos, text.find ("nano_container_items{path=\"node/"));
+	ASSERT_NE (std::string::npos, text.find ("nano_store{vendor="));
+	ASSERT_TRUE (boost::ends_with (text, "# EOF\n"));
+}
+
+TEST (metrics, scrape)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.metrics_config.enabled = true;
+	config.metrics_config.port = nano::get_available_port ();
+	auto node (system.add_node (config));
+	node->stats.inc (nano::stat::type::ledger, nano::stat::detail::send);
+	auto metrics (std::async (std::launch::async, [port = config.metrics_config.port]() { return scrape (port, "/metrics"); }));
+	ASSERT_TIMELY (5s, metrics.wait_for (0s) == std::future_status::ready);
+	auto response (metrics.get ());
+	ASSERT_EQ (boost::beast::http::status::ok, response.result ());
+	ASSERT_EQ (nano::metrics_server::content_type, response[boost::beast::http::field::content_type]);
+	ASSERT_NE (std::string::npos, response.body ().find ("nano_stat_total{type=\"ledger\",detail=\"send\",dir=\"in\"} 1\n"));
+	auto missing (std::async (std::launch::async, [port = config.metrics_config.port]() { return scrape (port, "/other"); }));
+	ASSERT_TIMELY (5s, missing.wait_for (0s) == std::future_status::ready);
+	ASSERT_EQ (boost::beast::http::status::not_found, missing.get ().result ());
+}
@@ -1,4 +1,5 @@
 #include <nano/node/testing.hpp>
+#include <nano/node/transport/simulated.hpp>
 #include <nano/node/transport/udp.hpp>
 #include <nano/test_common/network.hpp>
 #include <nano/test_common/testutil.hpp>
@@ -928,10 +929,21 @@ TEST (network, bandwidth_limiter)
 	}
 	// Only sent messages below limit, so we don't expect any drops
 	ASSERT_TIMELY (1s, 0 == node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_EQ (message_limit, node.stats.count (nano::stat::type::message, nano::stat::detail::publish, nano::stat::dir::out));
 
-	// Send droppable message; drop stats should increase by one now
+	// Over the limit, messages wait for bandwidth. The queue holds a second of traffic
+	for (auto i = 0; i < message_limit; i += 2)
+	{
+		channel1->send (message);
+		channel2->send (message);
+	}
+	ASSERT_EQ (message_limit, node.stats.count (nano::stat::type::traffic_shaper_queue, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_EQ (0, node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+
+	// Send droppable message with the queue full; drop stats should increase by one now
 	channel1->send (message);
 	ASSERT_TIMELY (1s, 1 == node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_EQ (1, node.stats.count (nano::stat::type::traffic_shaper_drop, nano::stat::detail::publish, nano::stat::dir::out));
 
 	// Send non-droppable message, i.e. drop stats should not increase
 	channel2->send (message, nullptr, nano::buffer_drop_policy::no_limiter_drop);
@@ -940,6 +952,88 @@ TEST (network, bandwidth_limiter)
 	node.stop ();
 }
 
+TEST (network, bandwidth_limiter_per_peer)
+{
+	nano::system system;
+	nano::genesis genesis;
+	nano::publish message (genesis.open);
+	auto message_size = message.to_bytes ()->size ();
+	nano::node_config node_config (nano::get_available_port (), system.logging);
+	node_config.bandwidth_limit_per_peer = 2 * message_size;
+	node_config.bandwidth_limit_burst_ratio = 1.0;
+	auto & node = *system.add_node (node_config);
+	auto channel1 (node.network.udp_channels.create (node.network.endpoint ()));
+	auto channel2 (node.network.udp_channels.create (node.network.endpoint ()));
+	channel1->send (message);
+	channel1->send (message);
+	ASSERT_EQ (0, node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+	// A peer over its own limit is policed, without using other peers' bandwidth
+	channel1->send (message);
+	ASSERT_EQ (1, node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+	channel2->send (message);
+	ASSERT_EQ (1, node.stats.count (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_EQ (3, node.stats.count (nano::stat::type::message, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_EQ (0, node.stats.count (nano::stat::type::traffic_shaper_queue));
+}
+
+// Votes keep their latency while publishes saturate the bandwidth
+TEST (network, traffic_shaper_priority)
+{
+	nano::system system;
+	nano::genesis genesis;
+	nano::publish publish (genesis.open);
+	nano::confirm_ack confirm_ack (std::make_shared<nano::vote> (nano::dev_genesis_key.pub, nano::dev_genesis_key.prv, 0, std::vector<nano::block_hash>{ genesis.hash () }));
+	auto publish_size = publish.to_bytes ()->size ();
+	nano::node_config node_config (nano::get_available_port (), system.logging);
+	node_config.bandwidth_limit = 20 * publish_size;
+	node_config.bandwidth_limit_burst_ratio = 1.0;
+	auto & node = *system.add_node (node_config);
+	auto channel (node.network.udp_channels.create (node.network.endpoint ()));
+	// Exhaust the bandwidth and fill the publish queue
+	while (0 == node.stats.count (nano::stat::type::traffic_shaper_drop, nano::stat::detail::publish, nano::stat::dir::out))
+	{
+		channel->send (publish);
+	}
+	ASSERT_LT (0, node.network.shaper.size (nano::transport::traffic_type::publish));
+	auto publishes_sent (node.stats.count (nano::stat::type::message, nano::stat::detail::publish, nano::stat::dir::out));
+	channel->send (confirm_ack);
+	ASSERT_EQ (1, node.stats.count (nano::stat::type::traffic_shaper_queue, nano::stat::detail::vote, nano::stat::dir::out));
+	ASSERT_TIMELY (1s, 1 == node.stats.count (nano::stat::type::message, nano::stat::detail::confirm_ack, nano::stat::dir::out));
+	// At most the rest of the publish round went first, one more may have been in flight
+	ASSERT_GE (publishes_sent + nano::transport::traffic_shaper::quantum / publish_size + 2, node.stats.count (nano::stat::type::message, nano::stat::detail::publish, nano::stat::dir::out));
+	ASSERT_LT (0, node.network.shaper.size (nano::transport::traffic_type::publish));
+	ASSERT_EQ (0, node.stats.count (nano::stat::type::drop, nano::stat::detail::confirm_ack, nano::stat::dir::out));
+}
+
+TEST (network, traffic_shaper_stop)
+{
+	nano::system system;
+	nano::genesis genesis;
+	nano::publish publish (genesis.open);
+	nano::node_config node_config (nano::get_available_port (), system.logging);
+	node_config.bandwidth_limit = 4 * publish.to_bytes ()->size ();
+	node_config.bandwidth_limit_burst_ratio = 1.0;
+	auto & node = *system.add_node (node_config);
+	auto channel (node.network.udp_channels.create (node.network.endpoint ()));
+	std::atomic<unsigned> called{ 0 };
+	std::atomic<unsigned> failed{ 0 };
+	auto callback ([&called, &failed](boost::system::error_code const & ec_a, size_t) {
+		failed += ec_a ? 1 : 0;
+		++called;
+	});
+	unsigned sent (0);
+	while (node.network.shaper.size (nano::transport::traffic_type::publish) < 2)
+	{
+		channel->send (publish, callback);
+		++sent;
+	}
+	node.network.shaper.stop ();
+	// Messages still queued are dropped, their callbacks still learn about it
+	ASSERT_EQ (0, node.network.shaper.size (nano::transport::traffic_type::publish));
+	ASSERT_TIMELY (5s, called == sent);
+	ASSERT_LE (1, failed);
+}
+
 namespace nano
 {
 TEST (peer_exclusion, validate)
@@ -1036,18 +1130,23 @@ namespace nano
 {
 TEST (network, tcp_message_manager)
 {
-	nano::tcp_message_manager manager (1);
+	nano::stat stats;
+	nano::tcp_message_manager manager (stats, 1);
+	auto lane (nano::tcp_message_lane::generic);
 	nano::tcp_message_item item;
 	item.node_id = nano::account (100);
-	ASSERT_EQ (0, manager.entries.size ());
+	ASSERT_EQ (0, manager.size (lane));
 	manager.put_message (item);
-	ASSERT_EQ (1, manager.entries.size ());
-	ASSERT_EQ (manager.get_message ().node_id, item.node_id);
-	ASSERT_EQ (0, manager.entries.size ());
+	ASSERT_EQ (1, manager.size (lane));
+	ASSERT_EQ (manager.get_message (lane).node_id, item.node_id);
+	ASSERT_EQ (0, manager.size (lane));
 
-	// Fill the queue
-	manager.entries = decltype (manager.entries) (manager.max_entries, item);
-	ASSERT_EQ (manager.entries.size (), manager.max_entries);
+	// Fill the queue, a non-droppable lane is only bounded by the lane size
+	for (auto i (0u); i < manager.max_entries; ++i)
+	{
+		manager.put_message (item);
+	}
+	ASSERT_EQ (manager.size (lane), manager.max_entries);
 
 	// This task will wait until a message is consumed
 	auto future = std::async (std::launch::async, [&] {
@@ -1058,12 +1157,12 @@ TEST (network, tcp_message_manager)
 	// and prove that it waits on condition variable
 	std::this_thread::sleep_for (CI ? 200ms : 100ms);
 
-	ASSERT_EQ (manager.entries.size (), manager.max_entries);
-	ASSERT_EQ (manager.get_message ().node_id, item.node_id);
+	ASSERT_EQ (manager.size (lane), manager.max_entries);
+	ASSERT_EQ (manager.get_message (lane).node_id, item.node_id);
 	ASSERT_NE (std::future_status::timeout, future.wait_for (1s));
-	ASSERT_EQ (manager.entries.size (), manager.max_entries);
+	ASSERT_EQ (manager.size (lane), manager.max_entries);
 
-	nano::tcp_message_manager manager2 (2);
+	nano::tcp_message_manager manager2 (stats, 2);
 	size_t message_count = 10'000;
 	std::vector<std::thread> consumers;
 	for (auto i = 0; i < 4; ++i)
@@ -1071,7 +1170,7 @@ TEST (network, tcp_message_manager)
 		consumers.emplace_back ([&] {
 			for (auto i = 0; i < message_count; ++i)
 			{
-				ASSERT_EQ (manager.get_message ().node_id, item.node_id);
+				ASSERT_EQ (manager2.get_message (lane).node_id, item.node_id);
 			}
 		});
 	}
@@ -1081,7 +1180,7 @@ TEST (network, tcp_message_manager)
 		producers.emplace_back ([&] {
 			for (auto i = 0; i < message_count; ++i)
 			{
-				manager.put_message (item);
+				manager2.put_message (item);
 			}
 		});
 	}
@@ -1091,6 +1190,36 @@ TEST (network, tcp_message_manager)
 		t.join ();
 	}
 }
+
+TEST (network, tcp_message_manager_fairness)
+{
+	nano::stat stats;
+	nano::tcp_message_manager manager (stats, 4);
+	nano::tcp_message_item noisy;
+	noisy.message = std::make_shared<nano::publish> (nano::genesis ().open);
+	noisy.endpoint = nano::tcp_endpoint (boost::asio::ip::address_v6::loopback (), 1000);
+	auto quiet (noisy);
+	quiet.endpoint = nano::tcp_endpoint (boost::asio::ip::address_v6::loopback (), 1001);
+	auto lane (nano::tcp_message_lane::publish);
+	ASSERT_TRUE (nano::tcp_message_manager::droppable (lane));
+
+	// A noisy peer can't take more than its share of the lane, the rest is dropped without waiting
+	for (auto i (0u); i < manager.max_entries_per_connection + 5; ++i)
+	{
+		manager.put_message (noisy);
+	}
+	ASSERT_EQ (manager.max_entries_per_connection, manager.size (lane));
+	ASSERT_EQ (5, stats.count (nano::stat::type::tcp_lane_drop, nano::stat::detail::publish, nano::stat::dir::in));
+	ASSERT_EQ (0, manager.size (nano::tcp_message_lane::vote));
+
+	// A message of a quiet peer is served after at most one of the noisy peer
+	manager.put_message (quiet);
+	ASSERT_EQ (noisy.endpoint, manager.get_message (lane).endpoint);
+	ASSERT_EQ (quiet.endpoint, manager.get_message (lane).endpoint);
+	ASSERT_EQ (noisy.endpoint, manager.get_message (lane).endpoint);
+	ASSERT_EQ (manager.max_entries_per_connection - 2, manager.size (lane));
+	ASSERT_EQ (3, stats.latency_snapshot (nano::stat::latency::tcp_lane_publish).count);
+}
 }
 
 TEST (network, cleanup_purge)
@@ -1150,3 +1279,99 @@ TEST (network, loopback_channel)
 	++node1.network.port;
 	ASSERT_NE (channel1.get_endpoint (), node1.network.endpoint ());
 }
+
+namespace
+{
+nano::node_flags simulated_flags ()
+{
+	nano::node_flags flags;
+	flags.disable_udp = true;
+	flags.disable_tcp_realtime = true;
+	flags.disable_bootstrap_listener = true;
+	flags.disable_ongoing_telemetry_requests = true;
+	flags.disable_rep_crawler = true;
+	return flags;
+}
+}
+
+TEST (network, simulated_link)
+{
+	nano::system system;
+	auto & node1 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	auto & node2 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	nano::transport::simulated::simulator simulator (1);
+	simulator.add (node1);
+	simulator.add (node2);
+	nano::transport::simulated::link link;
+	link.latency = std::chrono::milliseconds (10);
+	simulator.connect (0, 1, link);
+	ASSERT_EQ (1, node1.network.size ());
+	ASSERT_EQ (1, node2.network.size ());
+	auto channel (node1.network.find_channel (simulator.endpoint (1)));
+	ASSERT_NE (nullptr, channel);
+	ASSERT_EQ (nano::transport::transport_type::simulated, channel->get_type ());
+	ASSERT_EQ (node2.node_id.pub, channel->get_node_id ());
+	node1.network.send_keepalive (channel);
+	ASSERT_TIMELY (5s, simulator.in_flight () != 0);
+	// Nothing arrives before the latency of the link has passed
+	ASSERT_FALSE (simulator.step (std::chrono::milliseconds (5)));
+	ASSERT_EQ (std::chrono::milliseconds (5), simulator.now ());
+	ASSERT_EQ (0, node2.stats.count (nano::stat::type::message, nano::stat::detail::keepalive, nano::stat::dir::in));
+	ASSERT_TRUE (simulator.step (std::chrono::seconds (1)));
+	ASSERT_EQ (std::chrono::milliseconds (10), simulator.now ());
+	ASSERT_TIMELY (5s, node2.stats.count (nano::stat::type::message, nano::stat::detail::keepalive, nano::stat::dir::in) != 0);
+	// Further keepalives may have been sent by the ongoing keepalive timer meanwhile
+	auto traffic (simulator.traffic_by_type ()[static_cast<size_t> (nano::message_type::keepalive)]);
+	ASSERT_GE (traffic.sent, 1);
+	ASSERT_GE (traffic.delivered, 1);
+	ASSERT_EQ (0, traffic.lost);
+}
+
+TEST (network, simulated_loss)
+{
+	nano::system system;
+	auto & node1 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	auto & node2 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	nano::transport::simulated::simulator simulator (1);
+	simulator.add (node1);
+	simulator.add (node2);
+	nano::transport::simulated::link link;
+	link.loss = 1.0;
+	simulator.connect (0, 1, link);
+	node1.network.send_keepalive (node1.network.find_channel (simulator.endpoint (1)));
+	ASSERT_TIMELY (5s, simulator.sends () != 0);
+	ASSERT_EQ (0, simulator.in_flight ());
+	ASSERT_FALSE (simulator.step (std::chrono::seconds (1)));
+	auto traffic (simulator.traffic_by_type ()[static_cast<size_t> (nano::message_type::keepalive)]);
+	ASSERT_EQ (traffic.sent, traffic.lost);
+	ASSERT_EQ (0, traffic.delivered);
+}
+
+TEST (network, simulated_confirmation)
+{
+	nano::system system;
+	auto & node1 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	auto & node2 (*system.add_node (simulated_flags (), nano::transport::transport_type::simulated));
+	nano::transport::simulated::simulator simulator (1);
+	simulator.add (node1);
+	simulator.add (node2);
+	nano::transport::simulated::link link;
+	link.latency = std::chrono::milliseconds (50);
+	link.bandwidth = 1024 * 1024;
+	simulator.connect (0, 1, link);
+	system.wallet (0)->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::genesis genesis;
+	nano::keypair key;
+	auto send (std::make_shared<nano::state_block> (nano::dev_genesis_key.pub, genesis.hash (), nano::dev_genesis_key.pub, nano::genesis_amount - nano::Gxrb_ratio, key.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	node1.process_active (send);
+	system.deadline_set (10s);
+	while (!node2.block_confirmed (send->hash ()))
+	{
+		simulator.step (simulator.now () + std::chrono::milliseconds (10));
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	// The block and at least one vote had to cross the link
+	ASSERT_GE (simulator.now (), std::chrono::milliseconds (100));
+	ASSERT_NE (0, simulator.traffic_by_type ()[static_cast<size_t> (nano::message_type::publish)].delivered);
+	ASSERT_NE (0, simulator.traffic_by_type ()[static_cast<size_t> (nano::message_type::confirm_ack)].delivered);
+}
@@ -4784,6 +4784,51 @@ TEST (node, pruning_depth)
 	ASSERT_TRUE (node1.ledger.block_exists (send2->hash ()));
 }
 
+TEST (node, process_local_batch_failure)
+{
+	nano::system system (1);
+	auto & node (*system.nodes[0]);
+	nano::keypair key;
+	nano::state_block_builder builder;
+	auto send1 = builder.make_block ()
+	             .account (nano::dev_genesis_key.pub)
+	             .previous (nano::genesis_hash)
+	             .representative (nano::dev_genesis_key.pub)
+	             .balance (nano::genesis_amount - 1)
+	             .link (key.pub)
+	             .sign (nano::dev_genesis_key.prv, nano::dev_genesis_key.pub)
+	             .work (*system.work.generate (nano::genesis_hash))
+	             .build_shared ();
+	// Signed with the wrong key
+	auto send2 = builder.make_block ()
+	             .account (nano::dev_genesis_key.pub)
+	             .previous (send1->hash ())
+	             .representative (nano::dev_genesis_key.pub)
+	             .balance (nano::genesis_amount - 2)
+	             .link (key.pub)
+	             .sign (key.prv, key.pub)
+	             .work (*system.work.generate (send1->hash ()))
+	             .build_shared ();
+	auto send3 = builder.make_block ()
+	             .account (nano::dev_genesis_key.pub)
+	             .previous (send2->hash ())
+	             .representative (nano::dev_genesis_key.pub)
+	             .balance (nano::genesis_amount - 3)
+	             .link (key.pub)
+	             .sign (nano::dev_genesis_key.prv, nano::dev_genesis_key.pub)
+	             .work (*system.work.generate (send2->hash ()))
+	             .build_shared ();
+	auto results (node.process_local (std::vector<std::shared_ptr<nano::block>>{ send1, send2, send3 }));
+	ASSERT_EQ (3, results.size ());
+	ASSERT_EQ (nano::process_result::progress, results[0].code);
+	ASSERT_EQ (nano::process_result::bad_signature, results[1].code);
+	// Not processed, so not kept as unchecked either
+	ASSERT_EQ (nano::process_result::gap_previous, results[2].code);
+	auto transaction (node.store.tx_begin_read ());
+	ASSERT_EQ (0, node.store.unchecked_count (transaction));
+	ASSERT_FALSE (node.store.block_exists (transaction, send3->hash ()));
+}
+
 namespace
 {
 void add_required_children_node_config_tree (nano::jsonconfig & tree)
@@ -5,6 +5,8 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
+
 using namespace std::chrono_literals;
 
 TEST (socket, drop_policy)
@@ -202,3 +204,68 @@ TEST (socket, concurrent_writes)
 		t.join ();
 	}
 }
+
+TEST (socket, write_coalescing)
+{
+	auto node_flags = nano::inactive_node_flag_defaults ();
+	node_flags.read_only = false;
+	nano::inactive_node inactivenode (nano::unique_path (), node_flags);
+	auto node = inactivenode.node;
+
+	nano::thread_runner runner (node->io_ctx, 1);
+
+	auto server_port (nano::get_available_port ());
+	boost::asio::ip::tcp::endpoint endpoint (boost::asio::ip::address_v6::any (), server_port);
+	auto server_socket = std::make_shared<nano::server_socket> (*node, endpoint, 1);
+	boost::system::error_code ec;
+	server_socket->start (ec);
+	ASSERT_FALSE (ec);
+
+	constexpr size_t message_count = 200;
+	auto received (std::make_shared<std::vector<uint8_t>> (message_count));
+	std::promise<boost::system::error_code> read_promise;
+	std::vector<std::shared_ptr<nano::socket>> connections;
+	server_socket->on_connection ([&connections, &read_promise, received](std::shared_ptr<nano::socket> const & new_connection, boost::system::error_code const & ec_a) {
+		connections.push_back (new_connection);
+		new_connection->async_read (received, message_count, [&read_promise, received](boost::system::error_code const & ec, size_t size_a) {
+			read_promise.set_value (ec);
+		});
+		return true;
+	});
+
+	// Writes issued while one is in progress are gathered into the next write
+	auto client = std::make_shared<nano::socket> (*node, boost::none);
+	std::vector<size_t> completed;
+	nano::util::counted_completion write_completion (message_count);
+	client->async_connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v6::loopback (), server_port), [client, &completed, &write_completion](boost::system::error_code const & ec_a) {
+		ASSERT_FALSE (ec_a);
+		for (size_t i = 0; i < message_count; ++i)
+		{
+			client->async_write (nano::shared_const_buffer (static_cast<uint8_t> (i)), [i, &completed, &write_completion](boost::system::error_code const & ec, size_t size_a) {
+				ASSERT_FALSE (ec);
+				ASSERT_EQ (1, size_a);
+				completed.push_back (i);
+				write_completion.increment ();
+			});
+		}
+	});
+	ASSERT_FALSE (write_completion.await_count_for (5s));
+	auto read_future (read_promise.get_future ());
+	ASSERT_EQ (std::future_status::ready, read_future.wait_for (5s));
+	ASSERT_FALSE (read_future.get ());
+
+	// Bytes arrive and callbacks are called in the order of the writes
+	for (size_t i = 0; i < message_count; ++i)
+	{
+		ASSERT_EQ (i, (*received)[i]);
+		ASSERT_EQ (i, completed[i]);
+	}
+	auto batches (node->stats.count (nano::stat::type::tcp, nano::stat::detail::tcp_write_batch, nano::stat::dir::out));
+	ASSERT_LE (message_count / nano::socket::write_batch_size_max, batches);
+	ASSERT_GT (message_count / 2, batches);
+	ASSERT_EQ (message_count, node->stats.count (nano::stat::type::traffic_tcp, nano::stat::detail::all, nano::stat::dir::out));
+
+	node->stop ();
+	runner.stop_event_processing ();
+	runner.join ();
+}
@@ -0,0 +1,116 @@
+#include <nano/lib/stats.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <thread>
+#include <tuple>
+
+TEST (stats, counters_sharded)
+{
+	nano::stat_counters counters (10, 4);
+	ASSERT_EQ (4, counters.shards);
+	std::vector<std::thread> threads;
+	for (auto i (0); i < 8; ++i)
+	{
+		threads.emplace_back ([&counters]() {
+			for (auto j (0); j < 1000; ++j)
+			{
+				counters.add (3, 1);
+				counters.add (9, 2);
+			}
+		});
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	ASSERT_EQ (0, counters.get (0));
+	ASSERT_EQ (8000, counters.get (3));
+	ASSERT_EQ (16000, counters.get (9));
+	counters.clear ();
+	ASSERT_EQ (0, counters.get (3));
+	ASSERT_EQ (0, counters.get (9));
+}
+
+TEST (stats, count)
+{
+	nano::stat stats;
+	stats.inc (nano::stat::type::ledger, nano::stat::detail::send);
+	stats.add (nano::stat::type::ledger, nano::stat::detail::receive, nano::stat::dir::in, 5);
+	stats.inc_detail_only (nano::stat::type::ledger, nano::stat::detail::open);
+	stats.inc (nano::stat::type::work, nano::stat::detail::precache_throttled, nano::stat::dir::out);
+	ASSERT_EQ (1, stats.count (nano::stat::type::ledger, nano::stat::detail::send));
+	ASSERT_EQ (5, stats.count (nano::stat::type::ledger, nano::stat::detail::receive));
+	ASSERT_EQ (1, stats.count (nano::stat::type::ledger, nano::stat::detail::open));
+	// Detail only updates don't count at the type level
+	ASSERT_EQ (6, stats.count (nano::stat::type::ledger));
+	ASSERT_EQ (0, stats.count (nano::stat::type::ledger, nano::stat::detail::send, nano::stat::dir::out));
+	// The last type, detail and direction don't overlap other counters
+	ASSERT_EQ (1, stats.count (nano::stat::type::work, nano::stat::detail::precache_throttled, nano::stat::dir::out));
+	ASSERT_EQ (1, stats.count (nano::stat::type::work, nano::stat::dir::out));
+	ASSERT_EQ (0, stats.count (nano::stat::type::work, nano::stat::detail::precache_throttled, nano::stat::dir::in));
+	stats.clear ();
+	ASSERT_EQ (0, stats.count (nano::stat::type::ledger));
+	ASSERT_EQ (0, stats.count (nano::stat::type::ledger, nano::stat::detail::receive));
+	stats.stop ();
+	stats.inc (nano::stat::type::ledger, nano::stat::detail::send);
+	ASSERT_EQ (0, stats.count (nano::stat::type::ledger, nano::stat::detail::send));
+}
+
+TEST (stats, log_counters)
+{
+	nano::stat stats;
+	stats.add (nano::stat::type::ledger, nano::stat::detail::send, nano::stat::dir::in, 3);
+	stats.inc (nano::stat::type::traffic_udp, nano::stat::dir::out);
+	stats.define_histogram (nano::stat::type::vote, nano::stat::detail::confirm_ack, nano::stat::dir::in, { 1, 10, 100 });
+	auto sink (stats.log_sink_json ());
+	stats.log_counters (*sink);
+	auto tree (static_cast<boost::property_tree::ptree *> (sink->to_object ()));
+	std::vector<std::tuple<std::string, std::string, std::string, uint64_t>> entries;
+	for (auto const & entry : tree->get_child ("entries"))
+	{
+		entries.emplace_back (entry.second.get<std::string> ("type"), entry.second.get<std::string> ("detail"), entry.second.get<std::string> ("dir"), entry.second.get<uint64_t> ("value"));
+	}
+	// Only counters which were updated or have a histogram are logged, in key order
+	decltype (entries) expected{
+		{ "traffic_udp", "", "out", 1 },
+		{ "ledger", "", "in", 3 },
+		{ "ledger", "send", "in", 3 },
+		{ "vote", "confirm_ack", "in", 0 }
+	};
+	ASSERT_EQ (expected, entries);
+}
+
+TEST (stats, observe_count)
+{
+	nano::stat stats;
+	std::vector<std::pair<uint64_t, uint64_t>> observed;
+	stats.observe_count (nano::stat::type::ledger, nano::stat::detail::send, nano::stat::dir::in, [&observed](uint64_t old_a, uint64_t new_a) {
+		observed.emplace_back (old_a, new_a);
+	});
+	stats.inc (nano::stat::type::ledger, nano::stat::detail::send);
+	stats.add (nano::stat::type::ledger, nano::stat::detail::send, nano::stat::dir::in, 4);
+	stats.inc (nano::stat::type::ledger, nano::stat::detail::receive);
+	decltype (observed) expected{ { 0, 1 }, { 1, 5 } };
+	ASSERT_EQ (expected, observed);
+}
+
+TEST (stats, latency_histogram)
+{
+	nano::stat stats;
+	stats.observe (nano::stat::latency::election, std::chrono::microseconds (50));
+	stats.observe (nano::stat::latency::election, std::chrono::microseconds (51));
+	stats.observe (nano::stat::latency::election, std::chrono::minutes (10));
+	auto snapshot (stats.latency_snapshot (nano::stat::latency::election));
+	ASSERT_EQ (3, snapshot.count);
+	// Bounds are inclusive
+	ASSERT_EQ (1, snapshot.buckets[0]);
+	ASSERT_EQ (1, snapshot.buckets[1]);
+	ASSERT_EQ (1, snapshot.buckets.back ());
+	ASSERT_EQ (std::chrono::minutes (10) + std::chrono::microseconds (101), snapshot.sum);
+	ASSERT_EQ (0, stats.latency_snapshot (nano::stat::latency::cementing).count);
+	stats.clear ();
+	ASSERT_EQ (0, stats.latency_snapshot (nano::stat::latency::election).count);
+}
@@ -104,6 +104,7 @@ TEST (toml, rpc_config_deserialize_defaults)
 	ASSERT_EQ (conf.rpc_process.ipc_address, defaults.rpc_process.ipc_address);
 	ASSERT_EQ (conf.rpc_process.ipc_port, defaults.rpc_process.ipc_port);
 	ASSERT_EQ (conf.rpc_process.num_ipc_connections, defaults.rpc_process.num_ipc_connections);
+	ASSERT_EQ (conf.rpc_process.ipc_shared_memory, defaults.rpc_process.ipc_shared_memory);
 
 	ASSERT_EQ (conf.rpc_logging.log_rpc, defaults.rpc_logging.log_rpc);
 }
@@ -118,10 +119,13 @@ TEST (toml, daemon_config_deserialize_defaults)
 	[node.httpcallback]
 	[node.ipc.local]
 	[node.ipc.tcp]
+	[node.ipc.shared_memory]
 	[node.logging]
 	[node.statistics.log]
 	[node.statistics.sampling]
 	[node.websocket]
+	[node.metrics]
+	[node.threading]
 	[node.lmdb]
 	[node.rocksdb]
 	[opencl]
@@ -143,6 +147,7 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.opencl.threads, defaults.opencl.threads);
 	ASSERT_EQ (conf.rpc_enable, defaults.rpc_enable);
 	ASSERT_EQ (conf.rpc.enable_sign_hash, defaults.rpc.enable_sign_hash);
+	ASSERT_EQ (conf.rpc.max_request_parallelism, defaults.rpc.max_request_parallelism);
 	ASSERT_EQ (conf.rpc.child_process.enable, defaults.rpc.child_process.enable);
 	ASSERT_EQ (conf.rpc.child_process.rpc_path, defaults.rpc.child_process.rpc_path);
 
@@ -151,6 +156,7 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.backup_before_upgrade, defaults.node.backup_before_upgrade);
 	ASSERT_EQ (conf.node.bandwidth_limit, defaults.node.bandwidth_limit);
 	ASSERT_EQ (conf.node.bandwidth_limit_burst_ratio, defaults.node.bandwidth_limit_burst_ratio);
+	ASSERT_EQ (conf.node.bandwidth_limit_per_peer, defaults.node.bandwidth_limit_per_peer);
 	ASSERT_EQ (conf.node.block_processor_batch_max_time, defaults.node.block_processor_batch_max_time);
 	ASSERT_EQ (conf.node.bootstrap_connections, defaults.node.bootstrap_connections);
 	ASSERT_EQ (conf.node.bootstrap_connections_max, defaults.node.bootstrap_connections_max);
@@ -167,6 +173,8 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.network_threads, defaults.node.network_threads);
 	ASSERT_EQ (conf.node.secondary_work_peers, defaults.node.secondary_work_peers);
 	ASSERT_EQ (conf.node.work_watcher_period, defaults.node.work_watcher_period);
+	ASSERT_EQ (conf.node.work_precache_cpu_share, defaults.node.work_precache_cpu_share);
+	ASSERT_EQ (conf.node.work_precache_delay, defaults.node.work_precache_delay);
 	ASSERT_EQ (conf.node.online_weight_minimum, defaults.node.online_weight_minimum);
 	ASSERT_EQ (conf.node.election_hint_weight_percent, defaults.node.election_hint_weight_percent);
 	ASSERT_EQ (conf.node.password_fanout, defaults.node.password_fanout);
@@ -184,6 +192,7 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.vote_generator_threshold, defaults.node.vote_generator_threshold);
 	ASSERT_EQ (conf.node.vote_minimum, defaults.node.vote_minimum);
 	ASSERT_EQ (conf.node.work_peers, defaults.node.work_peers);
+	ASSERT_EQ (conf.node.work_peer_hedging, defaults.node.work_peer_hedging);
 	ASSERT_EQ (conf.node.work_threads, defaults.node.work_threads);
 	ASSERT_EQ (conf.node.max_queued_requests, defaults.node.max_queued_requests);
 	ASSERT_EQ (conf.node.confirm_req_batches_max, defaults.node.confirm_req_batches_max);
@@ -210,6 +219,8 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.logging.rotation_size, defaults.node.logging.rotation_size);
 	ASSERT_EQ (conf.node.logging.single_line_record_value, defaults.node.logging.single_line_record_value);
 	ASSERT_EQ (conf.node.logging.stable_log_filename, defaults.node.logging.stable_log_filename);
+	ASSERT_EQ (conf.node.logging.async, defaults.node.logging.async);
+	ASSERT_EQ (conf.node.logging.async_buffer_size, defaults.node.logging.async_buffer_size);
 	ASSERT_EQ (conf.node.logging.timing_logging_value, defaults.node.logging.timing_logging_value);
 	ASSERT_EQ (conf.node.logging.active_update_value, defaults.node.logging.active_update_value);
 	ASSERT_EQ (conf.node.logging.upnp_details_logging_value, defaults.node.logging.upnp_details_logging_value);
@@ -220,6 +231,14 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.websocket_config.address, defaults.node.websocket_config.address);
 	ASSERT_EQ (conf.node.websocket_config.port, defaults.node.websocket_config.port);
 
+	ASSERT_EQ (conf.node.metrics_config.enabled, defaults.node.metrics_config.enabled);
+	ASSERT_EQ (conf.node.metrics_config.address, defaults.node.metrics_config.address);
+	ASSERT_EQ (conf.node.metrics_config.port, defaults.node.metrics_config.port);
+	ASSERT_EQ (conf.node.metrics_config.collect_interval, defaults.node.metrics_config.collect_interval);
+
+	ASSERT_EQ (conf.node.threading.cpus, defaults.node.threading.cpus);
+	ASSERT_EQ (conf.node.threading.isolate_block_processing, defaults.node.threading.isolate_block_processing);
+
 	ASSERT_EQ (conf.node.callback_address, defaults.node.callback_address);
 	ASSERT_EQ (conf.node.callback_port, defaults.node.callback_port);
 	ASSERT_EQ (conf.node.callback_target, defaults.node.callback_target);
@@ -233,6 +252,12 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.ipc_config.transport_tcp.io_timeout, defaults.node.ipc_config.transport_tcp.io_timeout);
 	ASSERT_EQ (conf.node.ipc_config.transport_tcp.io_threads, defaults.node.ipc_config.transport_tcp.io_threads);
 	ASSERT_EQ (conf.node.ipc_config.transport_tcp.port, defaults.node.ipc_config.transport_tcp.port);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.allow_unsafe, defaults.node.ipc_config.transport_shared_memory.allow_unsafe);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.enabled, defaults.node.ipc_config.transport_shared_memory.enabled);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.io_timeout, defaults.node.ipc_config.transport_shared_memory.io_timeout);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.name, defaults.node.ipc_config.transport_shared_memory.name);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.connections, defaults.node.ipc_config.transport_shared_memory.connections);
+	ASSERT_EQ (conf.node.ipc_config.transport_shared_memory.ring_size, defaults.node.ipc_config.transport_shared_memory.ring_size);
 	ASSERT_EQ (conf.node.ipc_config.flatbuffers.skip_unexpected_fields_in_json, defaults.node.ipc_config.flatbuffers.skip_unexpected_fields_in_json);
 	ASSERT_EQ (conf.node.ipc_config.flatbuffers.verify_buffers, defaults.node.ipc_config.flatbuffers.verify_buffers);
 
@@ -240,6 +265,9 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.diagnostics_config.txn_tracking.ignore_writes_below_block_processor_max_time, defaults.node.diagnostics_config.txn_tracking.ignore_writes_below_block_processor_max_time);
 	ASSERT_EQ (conf.node.diagnostics_config.txn_tracking.min_read_txn_time, defaults.node.diagnostics_config.txn_tracking.min_read_txn_time);
 	ASSERT_EQ (conf.node.diagnostics_config.txn_tracking.min_write_txn_time, defaults.node.diagnostics_config.txn_tracking.min_write_txn_time);
+	ASSERT_EQ (conf.node.diagnostics_config.tracing.enable, defaults.node.diagnostics_config.tracing.enable);
+	ASSERT_EQ (conf.node.diagnostics_config.tracing.sample_rate, defaults.node.diagnostics_config.tracing.sample_rate);
+	ASSERT_EQ (conf.node.diagnostics_config.tracing.buffer_size, defaults.node.diagnostics_config.tracing.buffer_size);
 
 	ASSERT_EQ (conf.node.stat_config.sampling_enabled, defaults.node.stat_config.sampling_enabled);
 	ASSERT_EQ (conf.node.stat_config.interval, defaults.node.stat_config.interval);
@@ -390,6 +418,7 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	backup_before_upgrade = true
 	bandwidth_limit = 999
 	bandwidth_limit_burst_ratio = 999.9
+	bandwidth_limit_per_peer = 999
 	block_processor_batch_max_time = 999
 	bootstrap_connections = 999
 	bootstrap_connections_max = 999
@@ -420,8 +449,11 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	vote_generator_threshold = 9
 	vote_minimum = "999"
 	work_peers = ["dev.org:999"]
+	work_peer_hedging = true
 	work_threads = 999
 	work_watcher_period = 999
+	work_precache_cpu_share = 0.1
+	work_precache_delay = 999
 	max_work_generate_multiplier = 1.0
 	max_queued_requests = 999
 	frontiers_confirmation = "always"
@@ -431,6 +463,11 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	min_read_txn_time = 999
 	min_write_txn_time = 999
 
+	[node.diagnostics.tracing]
+	enable = true
+	sample_rate = 999
+	buffer_size = 999
+
 	[node.httpcallback]
 	address = "dev.org"
 	port = 999
@@ -449,6 +486,14 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	io_threads = 999
 	port = 999
 
+	[node.ipc.shared_memory]
+	allow_unsafe = true
+	connections = 999
+	enable = true
+	io_timeout = 999
+	name = "/dev"
+	ring_size = 8192
+
 	[node.ipc.flatbuffers]
 	skip_unexpected_fields_in_json = false
 	verify_buffers = false
@@ -476,6 +521,8 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	rotation_size = 999
 	single_line_record = true
 	stable_log_filename = true
+	async = true
+	async_buffer_size = 999
 	timing = true
 	active_update = true
 	upnp_details = true
@@ -500,6 +547,17 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	enable = true
 	port = 999
 
+	[node.metrics]
+	address = "0:0:0:0:0:ffff:7f01:101"
+	enable = true
+	port = 999
+	collect_interval = 999
+
+	[node.threading]
+	io = "0-1"
+	block_processing = "2"
+	isolate_block_processing = true
+
 	[node.lmdb]
 	sync = "nosync_safe"
 	max_databases = 999
@@ -524,6 +582,7 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	[rpc]
 	enable = true
 	enable_sign_hash = true
+	max_request_parallelism = 999
 
 	[rpc.child_process]
 	enable = true
@@ -544,6 +603,7 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.opencl.threads, defaults.opencl.threads);
 	ASSERT_NE (conf.rpc_enable, defaults.rpc_enable);
 	ASSERT_NE (conf.rpc.enable_sign_hash, defaults.rpc.enable_sign_hash);
+	ASSERT_NE (conf.rpc.max_request_parallelism, defaults.rpc.max_request_parallelism);
 	ASSERT_NE (conf.rpc.child_process.enable, defaults.rpc.child_process.enable);
 	ASSERT_NE (conf.rpc.child_process.rpc_path, defaults.rpc.child_process.rpc_path);
 
@@ -552,6 +612,7 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.backup_before_upgrade, defaults.node.backup_before_upgrade);
 	ASSERT_NE (conf.node.bandwidth_limit, defaults.node.bandwidth_limit);
 	ASSERT_NE (conf.node.bandwidth_limit_burst_ratio, defaults.node.bandwidth_limit_burst_ratio);
+	ASSERT_NE (conf.node.bandwidth_limit_per_peer, defaults.node.bandwidth_limit_per_peer);
 	ASSERT_NE (conf.node.block_processor_batch_max_time, defaults.node.block_processor_batch_max_time);
 	ASSERT_NE (conf.node.bootstrap_connections, defaults.node.bootstrap_connections);
 	ASSERT_NE (conf.node.bootstrap_connections_max, defaults.node.bootstrap_connections_max);
@@ -571,6 +632,8 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.max_pruning_age, defaults.node.max_pruning_age);
 	ASSERT_NE (conf.node.max_pruning_depth, defaults.node.max_pruning_depth);
 	ASSERT_NE (conf.node.work_watcher_period, defaults.node.work_watcher_period);
+	ASSERT_NE (conf.node.work_precache_cpu_share, defaults.node.work_precache_cpu_share);
+	ASSERT_NE (conf.node.work_precache_delay, defaults.node.work_precache_delay);
 	ASSERT_NE (conf.node.online_weight_minimum, defaults.node.online_weight_minimum);
 	ASSERT_NE (conf.node.election_hint_weight_percent, defaults.node.election_hint_weight_percent);
 	ASSERT_NE (conf.node.password_fanout, defaults.node.password_fanout);
@@ -588,6 +651,7 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.vote_generator_threshold, defaults.node.vote_generator_threshold);
 	ASSERT_NE (conf.node.vote_minimum, defaults.node.vote_minimum);
 	ASSERT_NE (conf.node.work_peers, defaults.node.work_peers);
+	ASSERT_NE (conf.node.work_peer_hedging, defaults.node.work_peer_hedging);
 	ASSERT_NE (conf.node.work_threads, defaults.node.work_threads);
 	ASSERT_NE (conf.node.max_queued_requests, defaults.node.max_queued_requests);
 	ASSERT_EQ (conf.node.confirm_req_batches_max, defaults.node.confirm_req_batches_max);
@@ -614,6 +678,8 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.logging.rotation_size, defaults.node.logging.rotation_size);
 	ASSERT_NE (conf.node.logging.single_line_record_value, defaults.node.logging.single_line_record_value);
 	ASSERT_NE (conf.node.logging.stable_log_filename, defaults.node.logging.stable_log_filename);
+	ASSERT_NE (conf.node.logging.async, defaults.node.logging.async);
+	ASSERT_NE (conf.node.logging.async_buffer_size, defaults.node.logging.async_buffer_size);
 	ASSERT_NE (conf.node.logging.timing_logging_value, defaults.node.logging.timing_logging_value);
 	ASSERT_NE (conf.node.logging.active_update_value, defaults.node.logging.active_update_value);
 	ASSERT_NE (conf.node.logging.upnp_details_logging_value, defaults.node.logging.upnp_details_logging_value);
@@ -624,6 +690,16 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.websocket_config.address, defaults.node.websocket_config.address);
 	ASSERT_NE (conf.node.websocket_config.port, defaults.node.websocket_config.port);
 
+	ASSERT_NE (conf.node.metrics_config.enabled, defaults.node.metrics_config.enabled);
+	ASSERT_NE (conf.node.metrics_config.address, defaults.node.metrics_config.address);
+	ASSERT_NE (conf.node.metrics_config.port, defaults.node.metrics_config.port);
+	ASSERT_NE (conf.node.metrics_config.collect_interval, defaults.node.metrics_config.collect_interval);
+
+	ASSERT_NE (conf.node.threading.cpus, defaults.node.threading.cpus);
+	ASSERT_NE (conf.node.threading.isolate_block_processing, defaults.node.threading.isolate_block_processing);
+	ASSERT_EQ ((std::vector<unsigned>{ 0, 1 }), conf.node.threading.cpus[nano::thread_role::name::io]);
+	ASSERT_EQ ((std::vector<unsigned>{ 2 }), conf.node.threading.cpus[nano::thread_role::name::block_processing]);
+
 	ASSERT_NE (conf.node.callback_address, defaults.node.callback_address);
 	ASSERT_NE (conf.node.callback_port, defaults.node.callback_port);
 	ASSERT_NE (conf.node.callback_target, defaults.node.callback_target);
@@ -637,6 +713,12 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.ipc_config.transport_tcp.io_timeout, defaults.node.ipc_config.transport_tcp.io_timeout);
 	ASSERT_NE (conf.node.ipc_config.transport_tcp.io_threads, defaults.node.ipc_config.transport_tcp.io_threads);
 	ASSERT_NE (conf.node.ipc_config.transport_tcp.port, defaults.node.ipc_config.transport_tcp.port);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.allow_unsafe, defaults.node.ipc_config.transport_shared_memory.allow_unsafe);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.enabled, defaults.node.ipc_config.transport_shared_memory.enabled);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.io_timeout, defaults.node.ipc_config.transport_shared_memory.io_timeout);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.name, defaults.node.ipc_config.transport_shared_memory.name);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.connections, defaults.node.ipc_config.transport_shared_memory.connections);
+	ASSERT_NE (conf.node.ipc_config.transport_shared_memory.ring_size, defaults.node.ipc_config.transport_shared_memory.ring_size);
 	ASSERT_NE (conf.node.ipc_config.flatbuffers.skip_unexpected_fields_in_json, defaults.node.ipc_config.flatbuffers.skip_unexpected_fields_in_json);
 	ASSERT_NE (conf.node.ipc_config.flatbuffers.verify_buffers, defaults.node.ipc_config.flatbuffers.verify_buffers);
 
@@ -644,6 +726,9 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.diagnostics_config.txn_tracking.ignore_writes_below_block_processor_max_time, defaults.node.diagnostics_config.txn_tracking.ignore_writes_below_block_processor_max_time);
 	ASSERT_NE (conf.node.diagnostics_config.txn_tracking.min_read_txn_time, defaults.node.diagnostics_config.txn_tracking.min_read_txn_time);
 	ASSERT_NE (conf.node.diagnostics_config.txn_tracking.min_write_txn_time, defaults.node.diagnostics_config.txn_tracking.min_write_txn_time);
+	ASSERT_NE (conf.node.diagnostics_config.tracing.enable, defaults.node.diagnostics_config.tracing.enable);
+	ASSERT_NE (conf.node.diagnostics_config.tracing.sample_rate, defaults.node.diagnostics_config.tracing.sample_rate);
+	ASSERT_NE (conf.node.diagnostics_config.tracing.buffer_size, defaults.node.diagnostics_config.tracing.buffer_size);
 
 	ASSERT_NE (conf.node.stat_config.sampling_enabled, defaults.node.stat_config.sampling_enabled);
 	ASSERT_NE (conf.node.stat_config.interval, defaults.node.stat_config.interval);
@@ -676,6 +761,7 @@ TEST (toml, daemon_config_no_required)
 	[node.httpcallback]
 	[node.ipc.local]
 	[node.ipc.tcp]
+	[node.ipc.shared_memory]
 	[node.logging]
 	[node.statistics.log]
 	[node.statistics.sampling]
@@ -711,6 +797,7 @@ TEST (toml, rpc_config_deserialize_no_defaults)
 	io_threads = 999
 	ipc_address = "0:0:0:0:0:ffff:7f01:101"
 	ipc_port = 999
+	ipc_shared_memory = "/dev"
 	num_ipc_connections = 999
 	[logging]
 	log_rpc = false
@@ -734,6 +821,7 @@ TEST (toml, rpc_config_deserialize_no_defaults)
 	ASSERT_NE (conf.rpc_process.ipc_address, defaults.rpc_process.ipc_address);
 	ASSERT_NE (conf.rpc_process.ipc_port, defaults.rpc_process.ipc_port);
 	ASSERT_NE (conf.rpc_process.num_ipc_connections, defaults.rpc_process.num_ipc_connections);
+	ASSERT_NE (conf.rpc_process.ipc_shared_memory, defaults.rpc_process.ipc_shared_memory);
 
 	ASSERT_NE (conf.rpc_logging.log_rpc, defaults.rpc_logging.log_rpc);
 }
@@ -838,6 +926,53 @@ TEST (toml, daemon_config_deserialize_errors)
 
 		ASSERT_EQ (toml.get_error ().get_message (), "confirm_req_batches_max must be between 1 and 100");
 	}
+
+	{
+		std::stringstream ss;
+		ss << R"toml(
+		[node.threading]
+		io = "3-1"
+		)toml";
+
+		nano::tomlconfig toml;
+		toml.read (ss);
+		nano::daemon_config conf;
+		conf.deserialize_toml (toml);
+
+		ASSERT_EQ (toml.get_error ().get_message (), "io is not a valid CPU list");
+	}
+
+	{
+		std::stringstream ss;
+		ss << R"toml(
+		[node.threading]
+		io = "0-2"
+		block_processing = "2"
+		isolate_block_processing = true
+		)toml";
+
+		nano::tomlconfig toml;
+		toml.read (ss);
+		nano::daemon_config conf;
+		conf.deserialize_toml (toml);
+
+		ASSERT_EQ (toml.get_error ().get_message (), "io CPUs overlap the isolated block_processing CPUs");
+	}
+}
+
+TEST (toml, threading_cpu_list)
+{
+	std::vector<unsigned> cpus;
+	ASSERT_FALSE (nano::threading_config::parse_cpu_list ("", cpus));
+	ASSERT_TRUE (cpus.empty ());
+	ASSERT_FALSE (nano::threading_config::parse_cpu_list ("8, 0-3,2", cpus));
+	ASSERT_EQ ((std::vector<unsigned>{ 0, 1, 2, 3, 8 }), cpus);
+	ASSERT_EQ ("0-3,8", nano::threading_config::to_cpu_list (cpus));
+	ASSERT_EQ ("1,3-4", nano::threading_config::to_cpu_list ({ 1, 3, 4 }));
+	ASSERT_TRUE (nano::threading_config::parse_cpu_list ("3-1", cpus));
+	ASSERT_TRUE (nano::threading_config::parse_cpu_list ("0-", cpus));
+	ASSERT_TRUE (nano::threading_config::parse_cpu_list ("a", cpus));
+	ASSERT_TRUE (nano::threading_config::parse_cpu_list ("1,,2", cpus));
 }
 
 TEST (toml, daemon_read_config)
@@ -0,0 +1,193 @@
+#include <nano/lib/diagnosticsconfig.hpp>
+#include <nano/lib/tracing.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#include <sstream>
+#include <thread>
+
+namespace
+{
+/** Enables tracing for the scope of a test, tracing state is global */
+class scoped_tracing final
+{
+public:
+	explicit scoped_tracing (nano::tracing_config const & config_a)
+	{
+		nano::tracing::configure (config_a);
+		nano::tracing::clear ();
+	}
+	~scoped_tracing ()
+	{
+		nano::tracing::configure (nano::tracing_config{});
+		nano::tracing::clear ();
+	}
+};
+
+/** Spans of the dump as (thread, name, id) */
+std::vector<std::tuple<std::string, std::string, std::string>> spans ()
+{
+	std::stringstream stream (nano::tracing::dump_chrome_json ());
+	boost::property_tree::ptree tree;
+	boost::property_tree::read_json (stream, tree);
+	std::vector<std::tuple<std::string, std::string, std::string>> result;
+	for (auto const & event : tree.get_child ("traceEvents"))
+	{
+		if (event.second.get<std::string> ("ph") == "X")
+		{
+			result.emplace_back (event.second.get<std::string> ("tid"), event.second.get<std::string> ("name"), event.second.get<std::string> ("args.id"));
+		}
+	}
+	return result;
+}
+}
+
+TEST (tracing, record)
+{
+	nano::tracing_config config;
+	config.enable = true;
+	config.sample_rate = 1;
+	config.buffer_size = 4;
+	scoped_tracing tracing (config);
+	{
+		nano::tracing::span span (nano::tracing::span_type::block_process, 1);
+	}
+	{
+		nano::tracing::span span (nano::tracing::span_type::message_parse);
+		span.identify (2);
+	}
+	{
+		nano::tracing::span span (nano::tracing::span_type::message_parse, 3);
+		span.cancel ();
+	}
+	{
+		// Ending early records once, not again as the scope ends
+		nano::tracing::span span (nano::tracing::span_type::message_parse, 4);
+		span.end ();
+	}
+	auto recorded (spans ());
+	ASSERT_EQ (3, recorded.size ());
+	ASSERT_EQ ("block_process", std::get<1> (recorded[0]));
+	ASSERT_EQ (nano::to_string_hex (1), std::get<2> (recorded[0]));
+	ASSERT_EQ ("message_parse", std::get<1> (recorded[1]));
+	ASSERT_EQ (nano::to_string_hex (2), std::get<2> (recorded[1]));
+	ASSERT_EQ (nano::to_string_hex (4), std::get<2> (recorded[2]));
+	// Spans of other threads are in their own buffer
+	std::thread ([]() {
+		nano::tracing::span span (nano::tracing::span_type::cementing, 3);
+	})
+	.join ();
+	recorded = spans ();
+	ASSERT_EQ (4, recorded.size ());
+	ASSERT_NE (std::get<0> (recorded[0]), std::get<0> (recorded[3]));
+	nano::tracing::clear ();
+	ASSERT_TRUE (spans ().empty ());
+}
+
+TEST (tracing, ring_overwrite)
+{
+	nano::tracing_config config;
+	config.enable = true;
+	config.sample_rate = 1;
+	config.buffer_size = 4;
+	scoped_tracing tracing (config);
+	// A new thread, so its buffer has this capacity
+	std::thread ([]() {
+		for (uint64_t id (0); id < 10; ++id)
+		{
+			nano::tracing::span span (nano::tracing::span_type::election_vote, id);
+		}
+	})
+	.join ();
+	auto recorded (spans ());
+	ASSERT_EQ (4, recorded.size ());
+	for (uint64_t i (0); i < 4; ++i)
+	{
+		ASSERT_EQ (nano::to_string_hex (6 + i), std::get<2> (recorded[i]));
+	}
+}
+
+TEST (tracing, parent)
+{
+	nano::tracing_config config;
+	config.enable = true;
+	config.sample_rate = 16;
+	scoped_tracing tracing (config);
+	// A sampled vote and a block which is not sampled by itself
+	uint64_t vote (1);
+	while (!nano::tracing::sampled (vote))
+	{
+		++vote;
+	}
+	uint64_t block (1);
+	while (nano::tracing::sampled (block))
+	{
+		++block;
+	}
+	std::thread ([vote, block]() {
+		nano::tracing::span vote_span (nano::tracing::span_type::vote_process, vote);
+		{
+			nano::tracing::span election_span (nano::tracing::span_type::election_vote, block);
+		}
+		{
+			nano::tracing::span cancelled (nano::tracing::span_type::election_vote, block);
+			cancelled.cancel ();
+		}
+		// Parents are restored as spans end or are cancelled
+		nano::tracing::span sibling (nano::tracing::span_type::election_vote, block);
+	})
+	.join ();
+	std::stringstream stream (nano::tracing::dump_chrome_json ());
+	boost::property_tree::ptree tree;
+	boost::property_tree::read_json (stream, tree);
+	std::vector<std::pair<std::string, std::string>> recorded;
+	for (auto const & event : tree.get_child ("traceEvents"))
+	{
+		if (event.second.get<std::string> ("ph") == "X")
+		{
+			recorded.emplace_back (event.second.get<std::string> ("name"), event.second.get<std::string> ("args.parent", ""));
+		}
+	}
+	// The election_vote spans are kept with their sampled vote and linked to it
+	ASSERT_EQ (3, recorded.size ());
+	ASSERT_EQ ("election_vote", recorded[0].first);
+	ASSERT_EQ (nano::to_string_hex (vote), recorded[0].second);
+	ASSERT_EQ ("election_vote", recorded[1].first);
+	ASSERT_EQ (nano::to_string_hex (vote), recorded[1].second);
+	ASSERT_EQ ("vote_process", recorded[2].first);
+	ASSERT_TRUE (recorded[2].second.empty ());
+}
+
+TEST (tracing, disabled)
+{
+	scoped_tracing tracing (nano::tracing_config{});
+	{
+		nano::tracing::span span (nano::tracing::span_type::block_process, 1);
+	}
+	ASSERT_TRUE (spans ().empty ());
+}
+
+TEST (tracing, sampling)
+{
+	nano::tracing_config config;
+	config.enable = true;
+	config.sample_rate = 16;
+	scoped_tracing tracing (config);
+	size_t sampled (0);
+	std::thread ([&sampled]() {
+		for (uint64_t id (0); id < 16000; ++id)
+		{
+			nano::tracing::span span1 (nano::tracing::span_type::block_process, id);
+			nano::tracing::span span2 (nano::tracing::span_type::active_insert, id);
+			sampled += nano::tracing::sampled (id);
+		}
+	})
+	.join ();
+	ASSERT_GT (sampled, 800);
+	ASSERT_LT (sampled, 1200);
+	// Both spans of a sampled id are kept
+	auto recorded (spans ());
+	ASSERT_EQ (std::min<size_t> (2 * sampled, config.buffer_size), recorded.size ());
+}
@@ -3,6 +3,7 @@
 #include <nano/lib/threading.hpp>
 #include <nano/lib/timer.hpp>
 #include <nano/lib/utility.hpp>
+#include <nano/node/threadingconfig.hpp>
 #include <nano/secure/utility.hpp>
 
 #include <gtest/gtest.h>
@@ -11,6 +12,10 @@
 
 #include <future>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 using namespace std::chrono_literals;
 
 TEST (rate, basic)
@@ -116,6 +121,74 @@ TEST (thread, thread_pool)
 	ASSERT_TRUE (passed_sleep);
 }
 
+#if defined(__linux__)
+TEST (thread, set_cpus)
+{
+	cpu_set_t available;
+	ASSERT_EQ (0, sched_getaffinity (0, sizeof (available), &available));
+	unsigned first (0);
+	while (!CPU_ISSET (first, &available))
+	{
+		++first;
+	}
+	auto affinity = []() {
+		cpu_set_t set;
+		sched_getaffinity (0, sizeof (set), &set);
+		return set;
+	};
+	// A thread which already has its role is pinned too
+	std::promise<void> pinned;
+	std::promise<cpu_set_t> running_affinity;
+	std::thread running ([&]() {
+		nano::thread_role::set (nano::thread_role::name::epoch_upgrader);
+		pinned.get_future ().wait ();
+		running_affinity.set_value (affinity ());
+	});
+	nano::thread_role::set_cpus ({ { nano::thread_role::name::epoch_upgrader, { first } } }, { first });
+	pinned.set_value ();
+	auto running_set (running_affinity.get_future ().get ());
+	ASSERT_EQ (1, CPU_COUNT (&running_set));
+	ASSERT_TRUE (CPU_ISSET (first, &running_set));
+	running.join ();
+
+	// Threads given a role later are pinned once they take it, others keep off the isolated CPU
+	cpu_set_t started_set, other_set;
+	std::thread started ([&]() {
+		nano::thread_role::set (nano::thread_role::name::epoch_upgrader);
+		started_set = affinity ();
+	});
+	std::thread other ([&]() {
+		nano::thread_role::set (nano::thread_role::name::worker);
+		other_set = affinity ();
+	});
+	started.join ();
+	other.join ();
+	ASSERT_EQ (1, CPU_COUNT (&started_set));
+	ASSERT_TRUE (CPU_ISSET (first, &started_set));
+	if (CPU_COUNT (&available) > 1)
+	{
+		ASSERT_FALSE (CPU_ISSET (first, &other_set));
+	}
+
+	// An empty configuration gives pinned threads back every CPU of the process
+	std::promise<void> reset;
+	std::promise<cpu_set_t> reset_affinity;
+	std::promise<void> entered;
+	std::thread resetting ([&]() {
+		nano::thread_role::set (nano::thread_role::name::epoch_upgrader);
+		entered.set_value ();
+		reset.get_future ().wait ();
+		reset_affinity.set_value (affinity ());
+	});
+	entered.get_future ().wait ();
+	nano::threading_config{}.apply ();
+	reset.set_value ();
+	auto reset_set (reset_affinity.get_future ().get ());
+	resetting.join ();
+	ASSERT_TRUE (CPU_EQUAL (&available, &reset_set));
+}
+#endif
+
 TEST (thread_pool_alarm, one)
 {
 	nano::thread_pool workers (1u, nano::thread_role::name::unknown);
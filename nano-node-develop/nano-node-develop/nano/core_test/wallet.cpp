@@ -696,7 +696,9 @@ TEST (wallet, work_cache_delayed)
 	ASSERT_EQ (block1->hash (), node1.latest (nano::dev_genesis_key.pub));
 	auto block2 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100));
 	ASSERT_EQ (block2->hash (), node1.latest (nano::dev_genesis_key.pub));
-	ASSERT_EQ (block2->hash (), node1.wallets.delayed_work->operator[] (nano::dev_genesis_key.pub));
+	auto root (node1.wallets.precache.root (nano::dev_genesis_key.pub));
+	ASSERT_TRUE (root.is_initialized ());
+	ASSERT_EQ (block2->hash (), *root);
 	auto threshold (node1.default_difficulty (nano::work_version::work_1));
 	auto again (true);
 	system.deadline_set (10s);
@@ -711,6 +713,142 @@ TEST (wallet, work_cache_delayed)
 	ASSERT_GE (nano::work_difficulty (nano::work_version::work_1, block2->hash (), work1), threshold);
 }
 
+TEST (wallet, work_precache_hit)
+{
+	nano::system system (1);
+	auto & node1 (*system.nodes[0]);
+	auto wallet (system.wallet (0));
+	wallet->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key;
+	auto block1 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100));
+	ASSERT_NE (nullptr, block1);
+	auto threshold (node1.default_difficulty (nano::work_version::work_1));
+	auto precomputed = [&wallet, &node1, threshold, root = block1->hash ()]() {
+		uint64_t work (0);
+		return !wallet->store.work_get (node1.wallets.tx_begin_read (), nano::dev_genesis_key.pub, work) && nano::work_difficulty (nano::work_version::work_1, root, work) >= threshold;
+	};
+	ASSERT_TIMELY (10s, precomputed ());
+	ASSERT_LE (1, node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_generated));
+	auto hits (node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_hit));
+	auto block2 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100));
+	ASSERT_NE (nullptr, block2);
+	ASSERT_EQ (hits + 1, node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_hit));
+	// Work provided by the caller is not counted
+	auto block3 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100, *system.work.generate (block2->hash ())));
+	ASSERT_NE (nullptr, block3);
+	ASSERT_EQ (hits + 1, node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_hit));
+}
+
+TEST (wallet, work_precache_disabled)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.work_precache_cpu_share = 0;
+	auto & node1 (*system.add_node (config));
+	auto wallet (system.wallet (0));
+	wallet->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key;
+	auto block1 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100));
+	ASSERT_NE (nullptr, block1);
+	ASSERT_FALSE (node1.wallets.precache.root (nano::dev_genesis_key.pub).is_initialized ());
+	auto block2 (wallet->send_action (nano::dev_genesis_key.pub, key.pub, 100));
+	ASSERT_NE (nullptr, block2);
+	ASSERT_EQ (0, node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_generated));
+	ASSERT_LE (1, node1.stats.count (nano::stat::type::work, nano::stat::detail::precache_miss));
+}
+
+TEST (wallet, send_batch)
+{
+	nano::system system (1);
+	auto & node (*system.nodes[0]);
+	auto wallet (system.wallet (0));
+	wallet->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key1;
+	nano::keypair key2;
+	std::vector<nano::send_batch_item> items;
+	// More sends than the work window, to both destinations
+	for (auto i (0u); i < nano::wallet::send_batch_work_window + 6; ++i)
+	{
+		items.push_back ({ nano::dev_genesis_key.pub, (i % 2) ? key1.pub : key2.pub, i + 1, std::to_string (i) });
+	}
+	items.push_back ({ nano::dev_genesis_key.pub, key1.pub, nano::genesis_amount, boost::none });
+	items.push_back ({ nano::dev_genesis_key.pub, key1.pub, 0, boost::none });
+	items.push_back ({ key1.pub, key2.pub, 1, boost::none });
+	std::vector<std::pair<std::shared_ptr<nano::block>, std::error_code>> results (items.size ());
+	std::vector<size_t> order;
+	wallet->send_batch_action (items, [&results, &order](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+		results[index_a] = std::make_pair (block_a, ec_a);
+		order.push_back (index_a);
+	});
+	ASSERT_EQ (items.size (), order.size ());
+	nano::uint128_t balance (nano::genesis_amount);
+	nano::block_hash previous (nano::genesis_hash);
+	auto sends (items.size () - 3);
+	for (size_t i (0); i < sends; ++i)
+	{
+		auto const & block (results[i].first);
+		ASSERT_NE (nullptr, block);
+		ASSERT_EQ (previous, block->previous ());
+		balance -= items[i].amount;
+		ASSERT_EQ (balance, block->balance ().number ());
+		ASSERT_TRUE (node.ledger.block_exists (block->hash ()));
+		previous = block->hash ();
+	}
+	ASSERT_EQ (nano::error_common::insufficient_balance, results[sends].second);
+	ASSERT_EQ (nano::error_common::invalid_amount, results[sends + 1].second);
+	ASSERT_EQ (nano::error_common::account_not_found_wallet, results[sends + 2].second);
+	ASSERT_EQ (previous, node.latest (nano::dev_genesis_key.pub));
+	ASSERT_EQ (balance, node.balance (nano::dev_genesis_key.pub));
+	// Items with ids already sent return the same blocks
+	items.resize (2);
+	wallet->send_batch_action (items, [&results](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+		ASSERT_FALSE (ec_a);
+		ASSERT_EQ (results[index_a].first->hash (), block_a->hash ());
+	});
+	ASSERT_EQ (previous, node.latest (nano::dev_genesis_key.pub));
+}
+
+TEST (wallet, send_batch_duplicate_id)
+{
+	nano::system system (1);
+	auto & node (*system.nodes[0]);
+	auto wallet (system.wallet (0));
+	wallet->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key;
+	// The second item repeats the id of the first and must not send again
+	std::vector<nano::send_batch_item> items{ { nano::dev_genesis_key.pub, key.pub, 1, std::string ("id") }, { nano::dev_genesis_key.pub, key.pub, 1, std::string ("id") } };
+	std::vector<std::shared_ptr<nano::block>> results (items.size ());
+	wallet->send_batch_action (items, [&results](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+		ASSERT_FALSE (ec_a);
+		results[index_a] = block_a;
+	});
+	ASSERT_NE (nullptr, results[0]);
+	ASSERT_EQ (results[0], results[1]);
+	ASSERT_EQ (results[0]->hash (), node.latest (nano::dev_genesis_key.pub));
+	ASSERT_EQ (nano::genesis_amount - 1, node.balance (nano::dev_genesis_key.pub));
+}
+
+TEST (wallet, send_batch_work_failure)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.work_threads = 0;
+	auto & node (*system.add_node (config));
+	auto wallet (system.wallet (0));
+	wallet->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key;
+	std::vector<nano::send_batch_item> items{ { nano::dev_genesis_key.pub, key.pub, 1, boost::none }, { nano::dev_genesis_key.pub, key.pub, 1, boost::none } };
+	std::vector<std::error_code> results (items.size ());
+	wallet->send_batch_action (items, [&results](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+		ASSERT_EQ (nullptr, block_a);
+		results[index_a] = ec_a;
+	});
+	// The first block without work breaks the chain
+	ASSERT_EQ (nano::error_common::failure_work_generation, results[0]);
+	ASSERT_TRUE (results[1] == nano::error_common::failure_work_generation || results[1] == nano::error_process::gap_previous);
+	ASSERT_EQ (nano::genesis_hash, node.latest (nano::dev_genesis_key.pub));
+}
+
 TEST (wallet, insert_locked)
 {
 	nano::system system (1);
@@ -1279,3 +1417,36 @@ TEST (wallet, receive_pruned)
 	ASSERT_EQ (amount, node2.ledger.balance (node2.store.tx_begin_read (), open1->hash ()));
 	ASSERT_TIMELY (5s, node2.ledger.cache.cemented_count == 4);
 }
+
+TEST (wallet, kdf_derive_ahead)
+{
+	nano::kdf kdf (2);
+	std::vector<std::pair<std::string, nano::uint256_union>> inputs;
+	for (auto i (0); i < 4; ++i)
+	{
+		inputs.emplace_back (std::to_string (i % 2), nano::uint256_union (i / 2));
+	}
+	auto keys (kdf.phs (inputs));
+	ASSERT_EQ (inputs.size (), keys.size ());
+	// Only keys derived ahead are kept
+	ASSERT_EQ (0, kdf.ahead_size ());
+	// Derivations depend on both the password and the salt
+	ASSERT_NE (keys[0], keys[1]);
+	ASSERT_NE (keys[0], keys[2]);
+	kdf.derive_ahead (inputs);
+	ASSERT_EQ (4, kdf.ahead_size ());
+	// Keys derived ahead match a single derivation, and are taken by it
+	for (auto i (0u); i < inputs.size (); ++i)
+	{
+		nano::kdf single;
+		nano::raw_key key;
+		single.phs (key, inputs[i].first, inputs[i].second);
+		ASSERT_EQ (key, keys[i]);
+		kdf.phs (key, inputs[i].first, inputs[i].second);
+		ASSERT_EQ (key, keys[i]);
+		ASSERT_EQ (inputs.size () - i - 1, kdf.ahead_size ());
+	}
+	kdf.derive_ahead (inputs);
+	kdf.clear ();
+	ASSERT_EQ (0, kdf.ahead_size ());
+}
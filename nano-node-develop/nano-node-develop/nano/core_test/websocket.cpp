@@ -1,4 +1,5 @@
 #include <nano/core_test/fakes/websocket_client.hpp>
+#include <nano/ipc_flatbuffers_lib/generated/flatbuffers/nanoapi_generated.h>
 #include <nano/node/testing.hpp>
 #include <nano/node/websocket.hpp>
 #include <nano/test_common/telemetry.hpp>
@@ -920,3 +921,121 @@ TEST (websocket, new_unconfirmed_block)
 	ASSERT_EQ ("state", message_contents.get<std::string> ("type"));
 	ASSERT_EQ ("send", message_contents.get<std::string> ("subtype"));
 }
+
+// Test client subscribing to new unconfirmed blocks using the flatbuffers encoding
+TEST (websocket, new_unconfirmed_block_flatbuffers)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.websocket_config.enabled = true;
+	config.websocket_config.port = nano::get_available_port ();
+	auto node1 (system.add_node (config));
+
+	std::atomic<bool> ack_ready{ false };
+	auto task = ([&ack_ready, config, node1]() {
+		fake_websocket_client client (config.websocket_config.port);
+		client.send_message (R"json({"action": "subscribe", "topic": "new_unconfirmed_block", "encoding": "flatbuffers", "ack": "true"})json");
+		client.await_ack ();
+		ack_ready = true;
+		EXPECT_EQ (1, node1->websocket_server->subscriber_count (nano::websocket::topic::new_unconfirmed_block));
+		EXPECT_TRUE (node1->websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::new_unconfirmed_block));
+		return client.get_response ();
+	});
+	auto future = std::async (std::launch::async, task);
+
+	ASSERT_TIMELY (5s, ack_ready);
+
+	// Process a new block
+	nano::genesis genesis;
+	auto send1 (std::make_shared<nano::state_block> (nano::dev_genesis_key.pub, genesis.hash (), nano::dev_genesis_key.pub, nano::genesis_amount - 1, nano::dev_genesis_key.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	ASSERT_EQ (nano::process_result::progress, node1->process_local (send1).code);
+
+	ASSERT_TIMELY (5s, future.wait_for (0s) == std::future_status::ready);
+
+	// Check the response is a valid Envelope
+	boost::optional<std::string> response = future.get ();
+	ASSERT_TRUE (response);
+	auto buffer (reinterpret_cast<uint8_t const *> (response->data ()));
+	flatbuffers::Verifier verifier (buffer, response->size ());
+	ASSERT_TRUE (nanoapi::VerifyEnvelopeBuffer (verifier));
+	auto envelope (nanoapi::GetEnvelope (buffer));
+	ASSERT_EQ (nanoapi::Message::Message_EventNewUnconfirmedBlock, envelope->message_type ());
+	auto state (envelope->message_as_EventNewUnconfirmedBlock ()->block_as_BlockState ());
+	ASSERT_NE (nullptr, state);
+	ASSERT_EQ (send1->hash ().to_string (), state->hash ()->str ());
+	ASSERT_EQ (nanoapi::BlockSubType::BlockSubType_send, state->subtype ());
+}
+
+// Votes are included in flatbuffers confirmations when requested
+TEST (websocket, confirmation_flatbuffers_votes)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.websocket_config.enabled = true;
+	config.websocket_config.port = nano::get_available_port ();
+	auto node1 (system.add_node (config));
+
+	std::atomic<bool> ack_ready{ false };
+	auto task = ([&ack_ready, config, node1]() {
+		fake_websocket_client client (config.websocket_config.port);
+		client.send_message (R"json({"action": "subscribe", "topic": "confirmation", "encoding": "flatbuffers", "ack": "true", "options": {"confirmation_type": "active_quorum", "include_election_info_with_votes": "true"}})json");
+		client.await_ack ();
+		ack_ready = true;
+		EXPECT_TRUE (node1->websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::confirmation));
+		return client.get_response ();
+	});
+	auto future = std::async (std::launch::async, task);
+
+	ASSERT_TIMELY (5s, ack_ready);
+
+	// Confirm a state block for an in-wallet account
+	system.wallet (0)->insert_adhoc (nano::dev_genesis_key.prv);
+	nano::keypair key;
+	auto previous (node1->latest (nano::dev_genesis_key.pub));
+	auto send (std::make_shared<nano::state_block> (nano::dev_genesis_key.pub, previous, nano::dev_genesis_key.pub, nano::genesis_amount - 1, key.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (previous)));
+	node1->process_active (send);
+
+	ASSERT_TIMELY (5s, future.wait_for (0s) == std::future_status::ready);
+
+	boost::optional<std::string> response = future.get ();
+	ASSERT_TRUE (response);
+	auto buffer (reinterpret_cast<uint8_t const *> (response->data ()));
+	flatbuffers::Verifier verifier (buffer, response->size ());
+	ASSERT_TRUE (nanoapi::VerifyEnvelopeBuffer (verifier));
+	auto envelope (nanoapi::GetEnvelope (buffer));
+	ASSERT_EQ (nanoapi::Message::Message_EventConfirmation, envelope->message_type ());
+	auto confirmation (envelope->message_as_EventConfirmation ());
+	ASSERT_EQ (send->hash ().to_string (), confirmation->hash ()->str ());
+	ASSERT_EQ ("1", confirmation->amount ()->str ());
+	ASSERT_NE (nullptr, confirmation->election_info ());
+	auto votes (confirmation->election_info ()->votes ());
+	ASSERT_NE (nullptr, votes);
+	ASSERT_EQ (1, votes->size ());
+	ASSERT_EQ (nano::dev_genesis_key.pub.to_account (), votes->Get (0)->representative ()->str ());
+	ASSERT_EQ (send->hash ().to_string (), votes->Get (0)->hash ()->str ());
+	ASSERT_EQ (node1->balance (nano::dev_genesis_key.pub).convert_to<std::string> (), votes->Get (0)->weight ()->str ());
+}
+
+// Topics without a flatbuffers encoding fall back to json
+TEST (websocket, flatbuffers_unsupported_topic)
+{
+	nano::system system;
+	nano::node_config config (nano::get_available_port (), system.logging);
+	config.websocket_config.enabled = true;
+	config.websocket_config.port = nano::get_available_port ();
+	auto node1 (system.add_node (config));
+
+	auto task = ([config, &node1]() {
+		fake_websocket_client client (config.websocket_config.port);
+		client.send_message (R"json({"action": "subscribe", "topic": "stopped_election", "encoding": "flatbuffers", "ack": true})json");
+		client.await_ack ();
+		EXPECT_EQ (1, node1->websocket_server->subscriber_count (nano::websocket::topic::stopped_election));
+		EXPECT_FALSE (node1->websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::stopped_election));
+		client.send_message (R"json({"action": "unsubscribe", "topic": "stopped_election", "ack": true})json");
+		client.await_ack ();
+		EXPECT_EQ (0, node1->websocket_server->subscriber_count (nano::websocket::topic::stopped_election));
+	});
+	auto future = std::async (std::launch::async, task);
+
+	ASSERT_TIMELY (5s, future.wait_for (0s) == std::future_status::ready);
+}
@@ -2,6 +2,7 @@
 #include <nano/lib/blocks.hpp>
 #include <nano/lib/jsonconfig.hpp>
 #include <nano/lib/logger_mt.hpp>
+#include <nano/lib/stats.hpp>
 #include <nano/lib/timer.hpp>
 #include <nano/lib/work.hpp>
 #include <nano/node/logging.hpp>
@@ -197,3 +198,179 @@ TEST (work, eco_pow)
 	// It's possible under some unlucky circumstances that this fails to the random nature of valid work generation.
 	ASSERT_LT (future1.get (), future2.get ());
 }
+
+// Every kernel must find the same solutions as work_v1::value, including for nonces in each vector lane
+TEST (work, kernels)
+{
+	auto kernels (nano::work_v1::supported_kernels ());
+	ASSERT_EQ (nano::work_kernel::scalar, kernels.front ());
+	for (auto i (0); i < 100; ++i)
+	{
+		nano::root root;
+		nano::random_pool::generate_block (root.bytes.data (), root.bytes.size ());
+		nano::work_v1::precomputed_state state (root);
+		uint64_t start;
+		nano::random_pool::generate_block (reinterpret_cast<uint8_t *> (&start), sizeof (start));
+		// Solved every 16 nonces on average, so solutions land in different lanes
+		uint64_t difficulty (0xf000000000000000);
+		auto expected (start);
+		while (nano::work_v1::value (root, expected) < difficulty)
+		{
+			++expected;
+		}
+		for (auto kernel : kernels)
+		{
+			auto nonce (start);
+			uint64_t work (0);
+			uint64_t output (0);
+			// Small counts continue the search across calls
+			while (!nano::work_v1::search (kernel, state, difficulty, nonce, 3, work, output))
+			{
+				ASSERT_LT (nonce - start, 10000);
+			}
+			ASSERT_EQ (expected, work) << nano::to_string (kernel);
+			ASSERT_EQ (nano::work_v1::value (root, work), output) << nano::to_string (kernel);
+		}
+	}
+}
+
+TEST (work, kernel_pool)
+{
+	for (auto kernel : nano::work_v1::supported_kernels ())
+	{
+		nano::work_pool pool (std::numeric_limits<unsigned>::max (), std::chrono::nanoseconds (0), nullptr, kernel);
+		ASSERT_EQ (kernel, pool.kernel);
+		nano::root root (1);
+		uint64_t difficulty (0xff00000000000000);
+		auto work (pool.generate (nano::work_version::work_1, root, difficulty));
+		ASSERT_TRUE (work.is_initialized ());
+		ASSERT_GE (nano::work_difficulty (nano::work_version::work_1, root, *work), difficulty);
+	}
+}
+
+// A request which can't be solved does not hold up others, of any priority
+TEST (work, concurrent_requests)
+{
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::root hard (1);
+	std::promise<boost::optional<uint64_t>> hard_result;
+	nano::work_schedule schedule;
+	schedule.priority = nano::work_priority::high;
+	pool.generate (
+	nano::work_version::work_1, hard, std::numeric_limits<uint64_t>::max (), [&hard_result](boost::optional<uint64_t> const & work_a) {
+		hard_result.set_value (work_a);
+	},
+	schedule);
+	// Same priority, the threads are shared
+	nano::root easy (2);
+	auto work (pool.generate (nano::work_version::work_1, easy, nano::network_constants ().publish_thresholds.base, schedule));
+	ASSERT_TRUE (work.is_initialized ());
+	ASSERT_GE (nano::work_difficulty (nano::work_version::work_1, easy, *work), nano::network_constants ().publish_thresholds.base);
+	ASSERT_EQ (1, pool.size ());
+	pool.cancel (hard);
+	ASSERT_FALSE (hard_result.get_future ().get ().is_initialized ());
+	ASSERT_EQ (0, pool.size ());
+}
+
+TEST (work, priority)
+{
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::work_schedule low;
+	low.priority = nano::work_priority::low;
+	nano::root hard (1);
+	std::atomic<bool> hard_done{ false };
+	pool.generate (
+	nano::work_version::work_1, hard, std::numeric_limits<uint64_t>::max (), [&hard_done](boost::optional<uint64_t> const &) {
+		hard_done = true;
+	},
+	low);
+	nano::work_schedule high;
+	high.priority = nano::work_priority::high;
+	// Solved while the low priority request keeps being worked on afterwards
+	for (auto i (2); i < 10; ++i)
+	{
+		nano::root root (i);
+		ASSERT_TRUE (pool.generate (nano::work_version::work_1, root, nano::network_constants ().publish_thresholds.base, high).is_initialized ());
+	}
+	ASSERT_FALSE (hard_done);
+	pool.cancel (hard);
+	ASSERT_TRUE (hard_done);
+}
+
+// Only requests less urgent than a new one are preempted
+TEST (work, preempted)
+{
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	auto unsolvable (std::numeric_limits<uint64_t>::max ());
+	auto item = [&pool](nano::root const & root_a) {
+		nano::lock_guard<nano::mutex> lock (pool.mutex);
+		auto existing (std::find_if (pool.pending.begin (), pool.pending.end (), [&root_a](auto const & item_a) {
+			return item_a->item == root_a;
+		}));
+		return existing != pool.pending.end () ? *existing : nullptr;
+	};
+	auto working = [&pool](nano::work_item const & item_a) {
+		nano::lock_guard<nano::mutex> lock (pool.mutex);
+		return item_a.threads > 0;
+	};
+	nano::work_schedule low;
+	low.priority = nano::work_priority::low;
+	pool.generate (nano::work_version::work_1, nano::root (1), unsolvable, nullptr, low);
+	auto first (item (nano::root (1)));
+	ASSERT_NE (nullptr, first);
+	nano::timer<std::chrono::milliseconds> timer (nano::timer_state::started);
+	while (!working (*first))
+	{
+		ASSERT_LT (timer.since_start (), std::chrono::seconds (5));
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+	pool.generate (nano::work_version::work_1, nano::root (2), unsolvable, nullptr);
+	ASSERT_EQ (1, first->preempted);
+	auto second (item (nano::root (2)));
+	ASSERT_NE (nullptr, second);
+	// Requests of the same or a lower priority leave the threads alone
+	pool.generate (nano::work_version::work_1, nano::root (3), unsolvable, nullptr);
+	pool.generate (nano::work_version::work_1, nano::root (4), unsolvable, nullptr, low);
+	ASSERT_EQ (0, second->preempted);
+	for (auto i (1); i <= 4; ++i)
+	{
+		pool.cancel (nano::root (i));
+	}
+	ASSERT_EQ (0, pool.size ());
+}
+
+TEST (work, deadline)
+{
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::stat stats;
+	nano::work_pool::define_histograms (stats);
+	nano::work_schedule schedule;
+	schedule.deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (100);
+	schedule.stats = &stats;
+	ASSERT_FALSE (pool.generate (nano::work_version::work_1, nano::root (1), std::numeric_limits<uint64_t>::max (), schedule).is_initialized ());
+	ASSERT_EQ (0, pool.size ());
+	ASSERT_EQ (1, stats.count (nano::stat::type::work, nano::stat::detail::work_expired));
+}
+
+TEST (work, stats)
+{
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::stat stats;
+	nano::work_pool::define_histograms (stats);
+	nano::work_schedule schedule;
+	schedule.stats = &stats;
+	for (auto i (1); i <= 3; ++i)
+	{
+		ASSERT_TRUE (pool.generate (nano::work_version::work_1, nano::root (i), nano::network_constants ().publish_thresholds.base, schedule).is_initialized ());
+	}
+	ASSERT_EQ (3, stats.count (nano::stat::type::work, nano::stat::detail::work_solved));
+	for (auto detail : { nano::stat::detail::queue_wait, nano::stat::detail::solve_time })
+	{
+		uint64_t total (0);
+		for (auto const & bin : stats.get_histogram (nano::stat::type::work, detail, nano::stat::dir::in)->get_bins ())
+		{
+			total += bin.value;
+		}
+		ASSERT_EQ (3, total);
+	}
+}
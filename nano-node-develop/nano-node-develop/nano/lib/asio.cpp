@@ -1,5 +1,15 @@
 #include <nano/lib/asio.hpp>
 
+// Kernel headers older than 5.1 have no io_uring, the probe then reports it as unsupported
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define NANO_IO_URING_HEADER 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
 nano::shared_const_buffer::shared_const_buffer (const std::vector<uint8_t> & data) :
 m_data (std::make_shared<std::vector<uint8_t>> (data)),
 m_buffer (boost::asio::buffer (*m_data))
@@ -43,3 +53,33 @@ size_t nano::shared_const_buffer::size () const
 {
 	return m_buffer.size ();
 }
+
+std::string nano::io_backend ()
+{
+#if defined(BOOST_ASIO_HAS_IOCP)
+	return "iocp";
+#elif defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+	return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+	return "epoll";
+#elif defined(BOOST_ASIO_HAS_KQUEUE)
+	return "kqueue";
+#else
+	return "select";
+#endif
+}
+
+bool nano::io_uring_supported ()
+{
+	auto result (false);
+#if defined(NANO_IO_URING_HEADER) && defined(__NR_io_uring_setup)
+	io_uring_params params{};
+	auto fd (static_cast<int> (syscall (__NR_io_uring_setup, 1, &params)));
+	if (fd >= 0)
+	{
+		close (fd);
+		result = true;
+	}
+#endif
+	return result;
+}
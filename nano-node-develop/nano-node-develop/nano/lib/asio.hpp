@@ -28,6 +28,12 @@ private:
 
 static_assert (boost::asio::is_const_buffer_sequence<shared_const_buffer>::value, "Not ConstBufferSequence compliant");
 
+/** The mechanism asio uses for socket IO, which is chosen at build time. On Linux "epoll", or "io_uring" when built with NANO_IO_URING */
+std::string io_backend ();
+
+/** Returns true if the kernel can create io_uring instances. Always false on platforms other than Linux */
+bool io_uring_supported ();
+
 template <typename AsyncWriteStream, typename WriteHandler>
 BOOST_ASIO_INITFN_RESULT_TYPE (WriteHandler, void(boost::system::error_code, std::size_t))
 async_write (AsyncWriteStream & s, nano::shared_const_buffer const & buffer, WriteHandler && handler)
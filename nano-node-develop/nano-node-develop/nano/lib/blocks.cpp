@@ -33,6 +33,28 @@ std::shared_ptr<block> deserialize_block (nano::stream & stream_a)
 
 	return result;
 }
+
+template <typename block, typename hashables>
+std::shared_ptr<block> make_block (hashables const & hashables_a, nano::signature const & signature_a, uint64_t work_a)
+{
+	auto result (nano::make_shared<block> ());
+	result->hashables = hashables_a;
+	result->signature = signature_a;
+	result->work = work_a;
+	return result;
+}
+
+nano::block_hash full_hash (nano::block_hash const & hash_a, nano::signature const & signature_a, uint64_t work_a)
+{
+	nano::block_hash result;
+	blake2b_state state;
+	blake2b_init (&state, sizeof (result.bytes));
+	blake2b_update (&state, hash_a.bytes.data (), sizeof (hash_a));
+	blake2b_update (&state, signature_a.bytes.data (), sizeof (signature_a));
+	blake2b_update (&state, &work_a, sizeof (work_a));
+	blake2b_final (&state, result.bytes.data (), sizeof (result.bytes));
+	return result;
+}
 }
 
 void nano::block_memory_pool_purge ()
@@ -126,16 +148,7 @@ nano::block_hash const & nano::block::hash () const
 
 nano::block_hash nano::block::full_hash () const
 {
-	nano::block_hash result;
-	blake2b_state state;
-	blake2b_init (&state, sizeof (result.bytes));
-	blake2b_update (&state, hash ().bytes.data (), sizeof (hash ()));
-	auto signature (block_signature ());
-	blake2b_update (&state, signature.bytes.data (), sizeof (signature));
-	auto work (block_work ());
-	blake2b_update (&state, &work, sizeof (work));
-	blake2b_final (&state, result.bytes.data (), sizeof (result.bytes));
-	return result;
+	return ::full_hash (hash (), block_signature (), block_work ());
 }
 
 nano::block_sideband const & nano::block::sideband () const
@@ -1368,42 +1381,166 @@ std::shared_ptr<nano::block> nano::deserialize_block (nano::stream & stream_a)
 std::shared_ptr<nano::block> nano::deserialize_block (nano::stream & stream_a, nano::block_type type_a, nano::block_uniquer * uniquer_a)
 {
 	std::shared_ptr<nano::block> result;
+	if (uniquer_a != nullptr)
+	{
+		// Blocks already known, such as those republished by many peers, are found without creating another copy
+		nano::block_record record;
+		if (!record.deserialize (stream_a, type_a))
+		{
+			result = uniquer_a->unique (record);
+		}
+	}
+	else
+	{
+		switch (type_a)
+		{
+			case nano::block_type::receive:
+			{
+				result = ::deserialize_block<nano::receive_block> (stream_a);
+				break;
+			}
+			case nano::block_type::send:
+			{
+				result = ::deserialize_block<nano::send_block> (stream_a);
+				break;
+			}
+			case nano::block_type::open:
+			{
+				result = ::deserialize_block<nano::open_block> (stream_a);
+				break;
+			}
+			case nano::block_type::change:
+			{
+				result = ::deserialize_block<nano::change_block> (stream_a);
+				break;
+			}
+			case nano::block_type::state:
+			{
+				result = ::deserialize_block<nano::state_block> (stream_a);
+				break;
+			}
+			default:
+#ifndef NANO_FUZZER_TEST
+				debug_assert (false);
+#endif
+				break;
+		}
+	}
+	return result;
+}
+
+bool nano::block_record::deserialize (nano::stream & stream_a, nano::block_type type_a)
+{
+	auto error (false);
+	type = type_a;
 	switch (type_a)
 	{
+		case nano::block_type::send:
+			payload.send = nano::send_hashables (error, stream_a);
+			break;
 		case nano::block_type::receive:
-		{
-			result = ::deserialize_block<nano::receive_block> (stream_a);
+			payload.receive = nano::receive_hashables (error, stream_a);
+			break;
+		case nano::block_type::open:
+			payload.open = nano::open_hashables (error, stream_a);
+			break;
+		case nano::block_type::change:
+			payload.change = nano::change_hashables (error, stream_a);
+			break;
+		case nano::block_type::state:
+			payload.state = nano::state_hashables (error, stream_a);
 			break;
+		default:
+#ifndef NANO_FUZZER_TEST
+			debug_assert (false);
+#endif
+			error = true;
+			break;
+	}
+	if (!error)
+	{
+		try
+		{
+			nano::read (stream_a, signature);
+			nano::read (stream_a, work);
+			if (type_a == nano::block_type::state)
+			{
+				boost::endian::big_to_native_inplace (work);
+			}
 		}
-		case nano::block_type::send:
+		catch (std::runtime_error const &)
 		{
-			result = ::deserialize_block<nano::send_block> (stream_a);
-			break;
+			error = true;
 		}
+	}
+	return error;
+}
+
+nano::block_hash nano::block_record::hash () const
+{
+	nano::block_hash result;
+	blake2b_state hash_l;
+	auto status (blake2b_init (&hash_l, sizeof (result.bytes)));
+	debug_assert (status == 0);
+	switch (type)
+	{
+		case nano::block_type::send:
+			payload.send.hash (hash_l);
+			break;
+		case nano::block_type::receive:
+			payload.receive.hash (hash_l);
+			break;
 		case nano::block_type::open:
-		{
-			result = ::deserialize_block<nano::open_block> (stream_a);
+			payload.open.hash (hash_l);
 			break;
-		}
 		case nano::block_type::change:
-		{
-			result = ::deserialize_block<nano::change_block> (stream_a);
+			payload.change.hash (hash_l);
 			break;
-		}
 		case nano::block_type::state:
 		{
-			result = ::deserialize_block<nano::state_block> (stream_a);
+			// The preamble of nano::state_block::hash
+			nano::uint256_union preamble (static_cast<uint64_t> (nano::block_type::state));
+			blake2b_update (&hash_l, preamble.bytes.data (), preamble.bytes.size ());
+			payload.state.hash (hash_l);
 			break;
 		}
 		default:
-#ifndef NANO_FUZZER_TEST
 			debug_assert (false);
-#endif
 			break;
 	}
-	if (uniquer_a != nullptr)
+	status = blake2b_final (&hash_l, result.bytes.data (), sizeof (result.bytes));
+	debug_assert (status == 0);
+	return result;
+}
+
+nano::block_hash nano::block_record::full_hash () const
+{
+	return ::full_hash (hash (), signature, work);
+}
+
+std::shared_ptr<nano::block> nano::block_record::block () const
+{
+	std::shared_ptr<nano::block> result;
+	switch (type)
 	{
-		result = uniquer_a->unique (result);
+		case nano::block_type::send:
+			result = make_block<nano::send_block> (payload.send, signature, work);
+			break;
+		case nano::block_type::receive:
+			result = make_block<nano::receive_block> (payload.receive, signature, work);
+			break;
+		case nano::block_type::open:
+			result = make_block<nano::open_block> (payload.open, signature, work);
+			break;
+		case nano::block_type::change:
+			result = make_block<nano::change_block> (payload.change, signature, work);
+			break;
+		case nano::block_type::state:
+			result = make_block<nano::state_block> (payload.state, signature, work);
+			break;
+		default:
+			debug_assert (false);
+			break;
 	}
 	return result;
 }
@@ -1847,48 +1984,27 @@ bool nano::block_sideband::deserialize (nano::stream & stream_a, nano::block_typ
 
 std::shared_ptr<nano::block> nano::block_uniquer::unique (std::shared_ptr<nano::block> const & block_a)
 {
-	auto result (block_a);
-	if (result != nullptr)
+	std::shared_ptr<nano::block> result;
+	if (block_a != nullptr)
 	{
-		nano::uint256_union key (block_a->full_hash ());
-		nano::lock_guard<nano::mutex> lock (mutex);
-		auto & existing (blocks[key]);
-		if (auto block_l = existing.lock ())
-		{
-			result = block_l;
-		}
-		else
-		{
-			existing = block_a;
-		}
-		release_assert (std::numeric_limits<CryptoPP::word32>::max () > blocks.size ());
-		for (auto i (0); i < cleanup_count && !blocks.empty (); ++i)
-		{
-			auto random_offset (nano::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (blocks.size () - 1)));
-			auto existing (std::next (blocks.begin (), random_offset));
-			if (existing == blocks.end ())
-			{
-				existing = blocks.begin ();
-			}
-			if (existing != blocks.end ())
-			{
-				if (auto block_l = existing->second.lock ())
-				{
-					// Still live
-				}
-				else
-				{
-					blocks.erase (existing);
-				}
-			}
-		}
+		result = blocks.unique (block_a->full_hash (), block_a);
+	}
+	return result;
+}
+
+std::shared_ptr<nano::block> nano::block_uniquer::unique (nano::block_record const & record_a)
+{
+	auto full_hash (record_a.full_hash ());
+	auto result (blocks.find (full_hash));
+	if (result == nullptr)
+	{
+		result = blocks.unique (full_hash, record_a.block ());
 	}
 	return result;
 }
 
 size_t nano::block_uniquer::size ()
 {
-	nano::lock_guard<nano::mutex> lock (mutex);
 	return blocks.size ();
 }
 
@@ -6,6 +6,7 @@
 #include <nano/lib/numbers.hpp>
 #include <nano/lib/optional_ptr.hpp>
 #include <nano/lib/stream.hpp>
+#include <nano/lib/uniquer.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/lib/work.hpp>
 
@@ -396,6 +397,35 @@ public:
 	virtual void state_block (nano::state_block &) = 0;
 	virtual ~mutable_block_visitor () = default;
 };
+/**
+ * Fixed size, trivially copyable form of any block: its type and the hashables of that type, signature and work.
+ * Reading a block into a record on the stack, hashing it and finding it in the block_uniquer allocates nothing, the
+ * polymorphic block is only created by block () when it isn't known yet.
+ */
+class block_record final
+{
+public:
+	/** Reads a block of \p type_a serialized without its type. @return true on error */
+	bool deserialize (nano::stream &, nano::block_type type_a);
+	/** The same as nano::block::hash of this block */
+	nano::block_hash hash () const;
+	/** The same as nano::block::full_hash of this block */
+	nano::block_hash full_hash () const;
+	/** A new block with the contents of this record, allocated from the memory pool of its type */
+	std::shared_ptr<nano::block> block () const;
+	nano::block_type type{ nano::block_type::invalid };
+	union
+	{
+		nano::send_hashables send;
+		nano::receive_hashables receive;
+		nano::open_hashables open;
+		nano::change_hashables change;
+		nano::state_hashables state;
+	} payload;
+	nano::signature signature;
+	uint64_t work;
+};
+static_assert (std::is_trivially_copyable<nano::block_record>::value, "block_record must be copyable as plain bytes");
 /**
  * This class serves to find and return unique variants of a block in order to minimize memory usage
  */
@@ -405,12 +435,12 @@ public:
 	using value_type = std::pair<const nano::uint256_union, std::weak_ptr<nano::block>>;
 
 	std::shared_ptr<nano::block> unique (std::shared_ptr<nano::block> const &);
+	/** @return The known block equal to \p record_a, otherwise a new block created from it */
+	std::shared_ptr<nano::block> unique (nano::block_record const & record_a);
 	size_t size ();
 
 private:
-	nano::mutex mutex{ mutex_identifier (mutexes::block_uniquer) };
-	std::unordered_map<std::remove_const_t<value_type::first_type>, value_type::second_type> blocks;
-	static unsigned constexpr cleanup_count = 2;
+	nano::uniquer_table<nano::block> blocks{ mutex_identifier (mutexes::block_uniquer) };
 };
 
 std::unique_ptr<container_info_component> collect_container_info (block_uniquer & block_uniquer, std::string const & name);
@@ -102,6 +102,12 @@ uint16_t test_websocket_port ()
 	return boost::lexical_cast<uint16_t> (test_env);
 }
 
+uint16_t test_metrics_port ()
+{
+	auto test_env = nano::get_env_or_default ("NANO_TEST_METRICS_PORT", "17079");
+	return boost::lexical_cast<uint16_t> (test_env);
+}
+
 std::array<uint8_t, 2> test_magic_number ()
 {
 	auto test_env = get_env_or_default ("NANO_TEST_MAGIC_NUMBER", "RX");
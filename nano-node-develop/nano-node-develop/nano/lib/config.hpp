@@ -57,6 +57,7 @@ uint16_t test_node_port ();
 uint16_t test_rpc_port ();
 uint16_t test_ipc_port ();
 uint16_t test_websocket_port ();
+uint16_t test_metrics_port ();
 std::array<uint8_t, 2> test_magic_number ();
 
 /**
@@ -123,6 +124,7 @@ public:
 		default_rpc_port = is_live_network () ? 7076 : is_beta_network () ? 55000 : is_test_network () ? test_rpc_port () : 45000;
 		default_ipc_port = is_live_network () ? 7077 : is_beta_network () ? 56000 : is_test_network () ? test_ipc_port () : 46000;
 		default_websocket_port = is_live_network () ? 7078 : is_beta_network () ? 57000 : is_test_network () ? test_websocket_port () : 47000;
+		default_metrics_port = is_live_network () ? 7079 : is_beta_network () ? 58000 : is_test_network () ? test_metrics_port () : 48000;
 		request_interval_ms = is_dev_network () ? 20 : 500;
 	}
 
@@ -144,6 +146,7 @@ public:
 	uint16_t default_rpc_port;
 	uint16_t default_ipc_port;
 	uint16_t default_websocket_port;
+	uint16_t default_metrics_port;
 	unsigned request_interval_ms;
 
 	/** Returns the network this object contains values for */
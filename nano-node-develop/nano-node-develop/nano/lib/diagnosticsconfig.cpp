@@ -10,6 +10,11 @@ nano::error nano::diagnostics_config::serialize_json (nano::jsonconfig & json) c
 	txn_tracking_l.put ("min_write_txn_time", txn_tracking.min_write_txn_time.count ());
 	txn_tracking_l.put ("ignore_writes_below_block_processor_max_time", txn_tracking.ignore_writes_below_block_processor_max_time);
 	json.put_child ("txn_tracking", txn_tracking_l);
+	nano::jsonconfig tracing_l;
+	tracing_l.put ("enable", tracing.enable);
+	tracing_l.put ("sample_rate", tracing.sample_rate);
+	tracing_l.put ("buffer_size", tracing.buffer_size);
+	json.put_child ("tracing", tracing_l);
 	return json.get_error ();
 }
 
@@ -29,6 +34,13 @@ nano::error nano::diagnostics_config::deserialize_json (nano::jsonconfig & json)
 
 		txn_tracking_l->get_optional<bool> ("ignore_writes_below_block_processor_max_time", txn_tracking.ignore_writes_below_block_processor_max_time);
 	}
+	auto tracing_l (json.get_optional_child ("tracing"));
+	if (tracing_l)
+	{
+		tracing_l->get_optional<bool> ("enable", tracing.enable);
+		tracing_l->get_optional<unsigned> ("sample_rate", tracing.sample_rate);
+		tracing_l->get_optional<size_t> ("buffer_size", tracing.buffer_size);
+	}
 	return json.get_error ();
 }
 
@@ -40,6 +52,11 @@ nano::error nano::diagnostics_config::serialize_toml (nano::tomlconfig & toml) c
 	txn_tracking_l.put ("min_write_txn_time", txn_tracking.min_write_txn_time.count (), "Log stacktrace when write transactions are held longer than this duration.\ntype:milliseconds");
 	txn_tracking_l.put ("ignore_writes_below_block_processor_max_time", txn_tracking.ignore_writes_below_block_processor_max_time, "Ignore any block processor writes less than block_processor_batch_max_time.\ntype:bool");
 	toml.put_child ("txn_tracking", txn_tracking_l);
+	nano::tomlconfig tracing_l;
+	tracing_l.put ("enable", tracing.enable, "Enable or disable recording of block and vote lifecycle spans, which can be dumped with the trace_dump RPC. Requires a build with NANO_TRACING.\ntype:bool");
+	tracing_l.put ("sample_rate", tracing.sample_rate, "Record the spans of one in this many blocks and votes.\ntype:uint32");
+	tracing_l.put ("buffer_size", tracing.buffer_size, "Number of spans kept per thread, older spans are overwritten.\ntype:uint64");
+	toml.put_child ("tracing", tracing_l);
 	return toml.get_error ();
 }
 
@@ -59,5 +76,16 @@ nano::error nano::diagnostics_config::deserialize_toml (nano::tomlconfig & toml)
 
 		txn_tracking_l->get_optional<bool> ("ignore_writes_below_block_processor_max_time", txn_tracking.ignore_writes_below_block_processor_max_time);
 	}
+	auto tracing_l (toml.get_optional_child ("tracing"));
+	if (tracing_l)
+	{
+		tracing_l->get_optional<bool> ("enable", tracing.enable);
+		tracing_l->get_optional<unsigned> ("sample_rate", tracing.sample_rate);
+		tracing_l->get_optional<size_t> ("buffer_size", tracing.buffer_size);
+		if (tracing.sample_rate < 1)
+		{
+			toml.get_error ().set ("tracing.sample_rate must be at least 1");
+		}
+	}
 	return toml.get_error ();
 }
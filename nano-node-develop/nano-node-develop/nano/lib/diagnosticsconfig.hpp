@@ -18,6 +18,17 @@ public:
 	bool ignore_writes_below_block_processor_max_time{ true };
 };
 
+class tracing_config final
+{
+public:
+	/** If true, record spans of the block and vote lifecycle. Only effective in builds with NANO_TRACING */
+	bool enable{ false };
+	/** Record the spans of one in this many blocks and votes */
+	unsigned sample_rate{ 64 };
+	/** Spans kept per thread, older ones are overwritten */
+	size_t buffer_size{ 16384 };
+};
+
 /** Configuration options for diagnostics information */
 class diagnostics_config final
 {
@@ -28,5 +39,6 @@ public:
 	nano::error deserialize_toml (nano::tomlconfig &);
 
 	txn_tracking_config txn_tracking;
+	tracing_config tracing;
 };
 }
@@ -131,6 +131,10 @@ std::string nano::error_rpc_messages::message (int ev) const
 			return "Unknown error";
 		case nano::error_rpc::empty_response:
 			return "Empty response";
+		case nano::error_rpc::account_index_disabled:
+			return "Account index is not available, build it with --account_index_build";
+		case nano::error_rpc::bad_cursor:
+			return "Bad cursor";
 		case nano::error_rpc::bad_destination:
 			return "Bad destination account";
 		case nano::error_rpc::bad_difficulty_format:
@@ -223,6 +227,8 @@ std::string nano::error_rpc_messages::message (int ev) const
 			return "Signing by block hash is disabled";
 		case nano::error_rpc::source_not_found:
 			return "Source not found";
+		case nano::error_rpc::tracing_unavailable:
+			return "Tracing is not available, the node must be built with NANO_TRACING";
 	}
 
 	return "Invalid error code";
@@ -78,6 +78,8 @@ enum class error_rpc
 {
 	generic = 1,
 	empty_response,
+	account_index_disabled,
+	bad_cursor,
 	bad_destination,
 	bad_difficulty_format,
 	bad_key,
@@ -123,7 +125,8 @@ enum class error_rpc
 	requires_port_and_address,
 	rpc_control_disabled,
 	sign_hash_disabled,
-	source_not_found
+	source_not_found,
+	tracing_unavailable
 };
 
 /** process_result related errors */
@@ -0,0 +1,552 @@
+#include <nano/lib/ipc_shm.hpp>
+#include <nano/lib/threading.hpp>
+#include <nano/lib/utility.hpp>
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <new>
+
+#if defined(__linux__)
+#include <climits>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert (std::atomic<uint32_t>::is_always_lock_free && sizeof (std::atomic<uint32_t>) == sizeof (uint32_t), "Futexes operate on plain 32-bit words");
+
+namespace
+{
+#if defined(__linux__)
+/** Waits while \p word_a equals \p expected_a. The segment is shared between processes, so the futexes are not private. */
+void futex_wait (std::atomic<uint32_t> & word_a, uint32_t expected_a, std::chrono::milliseconds timeout_a)
+{
+	auto seconds (std::chrono::duration_cast<std::chrono::seconds> (timeout_a));
+	timespec timeout_l{ static_cast<time_t> (seconds.count ()), static_cast<long> (std::chrono::duration_cast<std::chrono::nanoseconds> (timeout_a - seconds).count ()) };
+	syscall (SYS_futex, reinterpret_cast<uint32_t *> (&word_a), FUTEX_WAIT, expected_a, &timeout_l, nullptr, 0);
+}
+
+void futex_wake (std::atomic<uint32_t> & word_a)
+{
+	syscall (SYS_futex, reinterpret_cast<uint32_t *> (&word_a), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+void futex_wait (std::atomic<uint32_t> &, uint32_t, std::chrono::milliseconds timeout_a)
+{
+	std::this_thread::sleep_for (timeout_a);
+}
+
+void futex_wake (std::atomic<uint32_t> &)
+{
+}
+#endif
+
+/** Waits are done in slices, so stop requests and timeouts are noticed even if a wakeup is missed */
+std::chrono::milliseconds const wait_slice{ 100 };
+
+size_t round_up (size_t size_a, size_t alignment_a)
+{
+	return (size_a + alignment_a - 1) / alignment_a * alignment_a;
+}
+}
+
+nano::ipc::shm_ring::shm_ring (nano::ipc::shm_ring_header & header_a, uint8_t * data_a, uint32_t capacity_a) :
+header (header_a),
+data (data_a),
+capacity (capacity_a)
+{
+	debug_assert (capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+uint32_t nano::ipc::shm_ring::max_frame_payload () const
+{
+	return capacity / 4;
+}
+
+bool nano::ipc::shm_ring::write_frame (nano::ipc::shm_frame_header const & header_a, uint8_t const * payload_a, std::chrono::steady_clock::time_point deadline_a, std::atomic<uint32_t> const & abort_a)
+{
+	debug_assert (header_a.size <= max_frame_payload ());
+	auto needed (static_cast<uint32_t> (sizeof (header_a)) + header_a.size);
+	auto head (header.head.load (std::memory_order_relaxed));
+	auto error (false);
+	while (!error && capacity - (head - header.tail.load ()) < needed)
+	{
+		header.producer_waiting.store (1);
+		// Checking again after announcing the wait ensures the consumer either sees the flag or we see its progress
+		auto tail (header.tail.load ());
+		if (capacity - (head - tail) < needed)
+		{
+			futex_wait (header.tail, tail, wait_slice);
+		}
+		error = abort_a.load () != 0 || std::chrono::steady_clock::now () >= deadline_a;
+	}
+	if (!error)
+	{
+		copy_in (head, reinterpret_cast<uint8_t const *> (&header_a), sizeof (header_a));
+		copy_in (head + sizeof (header_a), payload_a, header_a.size);
+		header.head.store (head + needed);
+		if (header.consumer_waiting.exchange (0) != 0)
+		{
+			futex_wake (header.head);
+		}
+	}
+	return error;
+}
+
+bool nano::ipc::shm_ring::try_write_frame (nano::ipc::shm_frame_header const & header_a, uint8_t const * payload_a)
+{
+	debug_assert (header_a.size <= max_frame_payload ());
+	auto needed (static_cast<uint32_t> (sizeof (header_a)) + header_a.size);
+	auto head (header.head.load (std::memory_order_relaxed));
+	auto result (capacity - (head - header.tail.load ()) >= needed);
+	if (!result)
+	{
+		header.producer_waiting.store (1);
+		// Checking again after announcing the wait ensures the consumer either sees the flag or we see its progress
+		result = capacity - (head - header.tail.load ()) >= needed;
+	}
+	if (result)
+	{
+		copy_in (head, reinterpret_cast<uint8_t const *> (&header_a), sizeof (header_a));
+		copy_in (head + sizeof (header_a), payload_a, header_a.size);
+		header.head.store (head + needed);
+		if (header.consumer_waiting.exchange (0) != 0)
+		{
+			futex_wake (header.head);
+		}
+	}
+	return result;
+}
+
+bool nano::ipc::shm_ring::try_read_frame (nano::ipc::shm_frame_header & header_a, std::vector<uint8_t> & payload_a)
+{
+	auto producer_waiting (false);
+	auto result (try_read_frame (header_a, payload_a, producer_waiting));
+	if (producer_waiting)
+	{
+		futex_wake (header.tail);
+	}
+	return result;
+}
+
+bool nano::ipc::shm_ring::try_read_frame (nano::ipc::shm_frame_header & header_a, std::vector<uint8_t> & payload_a, bool & producer_waiting_a)
+{
+	auto tail (header.tail.load (std::memory_order_relaxed));
+	auto available (header.head.load () - tail);
+	auto result (false);
+	if (available >= sizeof (header_a))
+	{
+		copy_out (tail, reinterpret_cast<uint8_t *> (&header_a), sizeof (header_a));
+		// Producers only publish whole frames, anything else is a corrupt ring which is never read from
+		if (header_a.size <= max_frame_payload () && available >= sizeof (header_a) + header_a.size)
+		{
+			payload_a.resize (header_a.size);
+			copy_out (tail + sizeof (header_a), payload_a.data (), header_a.size);
+			header.tail.store (tail + static_cast<uint32_t> (sizeof (header_a)) + header_a.size);
+			producer_waiting_a = header.producer_waiting.exchange (0) != 0;
+			result = true;
+		}
+	}
+	return result;
+}
+
+void nano::ipc::shm_ring::wait_readable (std::chrono::milliseconds timeout_a)
+{
+	auto head (header.head.load ());
+	if (head == header.tail.load (std::memory_order_relaxed))
+	{
+		header.consumer_waiting.store (1);
+		if (header.head.load () == head)
+		{
+			futex_wait (header.head, head, timeout_a);
+		}
+	}
+}
+
+void nano::ipc::shm_ring::reset ()
+{
+	header.head = 0;
+	header.tail = 0;
+	header.consumer_waiting = 0;
+	header.producer_waiting = 0;
+}
+
+void nano::ipc::shm_ring::copy_in (uint32_t position_a, uint8_t const * source_a, uint32_t size_a)
+{
+	auto offset (position_a & (capacity - 1));
+	auto first (std::min (size_a, capacity - offset));
+	std::memcpy (data + offset, source_a, first);
+	std::memcpy (data, source_a + first, size_a - first);
+}
+
+void nano::ipc::shm_ring::copy_out (uint32_t position_a, uint8_t * target_a, uint32_t size_a) const
+{
+	auto offset (position_a & (capacity - 1));
+	auto first (std::min (size_a, capacity - offset));
+	std::memcpy (target_a, data + offset, first);
+	std::memcpy (target_a + first, data, size_a - first);
+}
+
+nano::ipc::shm_segment::~shm_segment ()
+{
+#if defined(__linux__)
+	if (memory != nullptr)
+	{
+		munmap (memory, size);
+	}
+	if (!owned_name.empty ())
+	{
+		shm_unlink (owned_name.c_str ());
+	}
+#endif
+}
+
+nano::error nano::ipc::shm_segment::create (std::string const & name_a, uint32_t slot_count_a, uint32_t ring_size_a)
+{
+	nano::error error;
+#if defined(__linux__)
+	if (slot_count_a == 0 || ring_size_a < 4096 || (ring_size_a & (ring_size_a - 1)) != 0)
+	{
+		error = nano::error ("Shared memory IPC requires at least one connection and a ring size which is a power of two of at least 4096");
+	}
+	else
+	{
+		// A segment left behind by a node which did not shut down cleanly is replaced
+		shm_unlink (name_a.c_str ());
+		auto fd (shm_open (name_a.c_str (), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR));
+		if (fd != -1)
+		{
+			size = mapping_size (slot_count_a, ring_size_a);
+			if (ftruncate (fd, size) == 0)
+			{
+				auto memory_l (mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+				if (memory_l != MAP_FAILED)
+				{
+					memory = static_cast<uint8_t *> (memory_l);
+					owned_name = name_a;
+					auto header_l (new (memory) nano::ipc::shm_segment_header);
+					header_l->slot_count = slot_count_a;
+					header_l->ring_size = ring_size_a;
+					for (auto i (0u); i < slot_count_a; ++i)
+					{
+						new (slot_base (i)) nano::ipc::shm_slot_header;
+					}
+					header_l->version = version;
+					header_l->server_running = 1;
+					// Clients check the magic last, so they never see a partially initialized segment
+					std::atomic_thread_fence (std::memory_order_release);
+					header_l->magic = magic;
+				}
+				else
+				{
+					error = nano::error (boost::str (boost::format ("Unable to map shared memory segment %1%: %2%") % name_a % std::strerror (errno)));
+				}
+			}
+			else
+			{
+				error = nano::error (boost::str (boost::format ("Unable to size shared memory segment %1%: %2%") % name_a % std::strerror (errno)));
+			}
+			::close (fd);
+			if (error)
+			{
+				shm_unlink (name_a.c_str ());
+			}
+		}
+		else
+		{
+			error = nano::error (boost::str (boost::format ("Unable to create shared memory segment %1%: %2%") % name_a % std::strerror (errno)));
+		}
+	}
+#else
+	error = nano::error ("Shared memory IPC is not supported on this platform");
+#endif
+	return error;
+}
+
+nano::error nano::ipc::shm_segment::open (std::string const & name_a)
+{
+	nano::error error;
+#if defined(__linux__)
+	auto fd (shm_open (name_a.c_str (), O_RDWR, 0));
+	if (fd != -1)
+	{
+		struct stat stat_l;
+		if (fstat (fd, &stat_l) == 0 && static_cast<size_t> (stat_l.st_size) >= sizeof (nano::ipc::shm_segment_header))
+		{
+			auto memory_l (mmap (nullptr, stat_l.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+			if (memory_l != MAP_FAILED)
+			{
+				memory = static_cast<uint8_t *> (memory_l);
+				size = stat_l.st_size;
+				auto & header_l (header ());
+				auto magic_l (header_l.magic);
+				std::atomic_thread_fence (std::memory_order_acquire);
+				if (magic_l != magic || header_l.version != version || header_l.ring_size == 0 || header_l.slot_count == 0 || size < mapping_size (header_l.slot_count, header_l.ring_size))
+				{
+					error = nano::error ("Shared memory segment has an unexpected layout, the node may be running a different version");
+				}
+			}
+			else
+			{
+				error = nano::error (boost::str (boost::format ("Unable to map shared memory segment %1%: %2%") % name_a % std::strerror (errno)));
+			}
+		}
+		else
+		{
+			error = nano::error (boost::str (boost::format ("Invalid shared memory segment %1%") % name_a));
+		}
+		::close (fd);
+	}
+	else
+	{
+		error = nano::error (boost::str (boost::format ("Unable to open shared memory segment %1%, make sure ipc.shared_memory is enabled in the node config: %2%") % name_a % std::strerror (errno)));
+	}
+#else
+	error = nano::error ("Shared memory IPC is not supported on this platform");
+#endif
+	return error;
+}
+
+nano::ipc::shm_segment_header & nano::ipc::shm_segment::header () const
+{
+	debug_assert (memory != nullptr);
+	return *reinterpret_cast<nano::ipc::shm_segment_header *> (memory);
+}
+
+nano::ipc::shm_slot_header & nano::ipc::shm_segment::slot (uint32_t index_a) const
+{
+	return *reinterpret_cast<nano::ipc::shm_slot_header *> (slot_base (index_a));
+}
+
+nano::ipc::shm_ring nano::ipc::shm_segment::requests (uint32_t index_a) const
+{
+	auto ring_size (header ().ring_size);
+	return nano::ipc::shm_ring (slot (index_a).requests, slot_base (index_a) + round_up (sizeof (nano::ipc::shm_slot_header), 64), ring_size);
+}
+
+nano::ipc::shm_ring nano::ipc::shm_segment::responses (uint32_t index_a) const
+{
+	auto ring_size (header ().ring_size);
+	return nano::ipc::shm_ring (slot (index_a).responses, slot_base (index_a) + round_up (sizeof (nano::ipc::shm_slot_header), 64) + ring_size, ring_size);
+}
+
+void nano::ipc::shm_segment::notify_server () const
+{
+	auto & header_l (header ());
+	header_l.doorbell.fetch_add (1);
+	if (header_l.server_waiting.exchange (0) != 0)
+	{
+		futex_wake (header_l.doorbell);
+	}
+}
+
+void nano::ipc::shm_segment::wait_server (uint32_t observed_a, std::chrono::milliseconds timeout_a) const
+{
+	auto & header_l (header ());
+	header_l.server_waiting.store (1);
+	if (header_l.doorbell.load () == observed_a)
+	{
+		futex_wait (header_l.doorbell, observed_a, timeout_a);
+	}
+}
+
+uint8_t * nano::ipc::shm_segment::slot_base (uint32_t index_a) const
+{
+	debug_assert (index_a < header ().slot_count);
+	return memory + round_up (sizeof (nano::ipc::shm_segment_header), 64) + index_a * slot_stride ();
+}
+
+size_t nano::ipc::shm_segment::slot_stride () const
+{
+	return round_up (sizeof (nano::ipc::shm_slot_header), 64) + 2 * static_cast<size_t> (header ().ring_size);
+}
+
+size_t nano::ipc::shm_segment::mapping_size (uint32_t slot_count_a, uint32_t ring_size_a)
+{
+	return round_up (sizeof (nano::ipc::shm_segment_header), 64) + slot_count_a * (round_up (sizeof (nano::ipc::shm_slot_header), 64) + 2 * static_cast<size_t> (ring_size_a));
+}
+
+nano::ipc::shm_client::~shm_client ()
+{
+	close ();
+}
+
+nano::error nano::ipc::shm_client::connect (std::string const & name_a)
+{
+	debug_assert (!is_connected);
+	auto error (segment.open (name_a));
+	if (!error)
+	{
+		auto & header_l (segment.header ());
+		auto claimed (false);
+		for (auto i (0u); !claimed && i < header_l.slot_count; ++i)
+		{
+			auto expected (static_cast<uint32_t> (nano::ipc::shm_slot_state::free));
+			claimed = segment.slot (i).state.compare_exchange_strong (expected, static_cast<uint32_t> (nano::ipc::shm_slot_state::connected));
+			if (claimed)
+			{
+				slot_index = i;
+#if defined(__linux__)
+				segment.slot (i).client_pid = static_cast<int32_t> (getpid ());
+#endif
+			}
+		}
+		if (claimed)
+		{
+			is_connected = true;
+			thread = std::thread ([this]() {
+				nano::thread_role::set (nano::thread_role::name::ipc_shared_memory);
+				run ();
+			});
+		}
+		else
+		{
+			error = nano::error ("All shared memory IPC connections are in use");
+		}
+	}
+	return error;
+}
+
+void nano::ipc::shm_client::async_request (nano::ipc::payload_encoding encoding_a, std::string const & payload_a, std::function<void(nano::error const &, std::string const &)> callback_a)
+{
+	auto error (!connected ());
+	if (!error)
+	{
+		auto request_id (request_id_dispenser.fetch_add (1));
+		{
+			nano::lock_guard<nano::mutex> guard (pending_mutex);
+			pending.emplace (request_id, pending_request{ callback_a, std::string () });
+		}
+		auto ring (segment.requests (slot_index));
+		auto deadline (std::chrono::steady_clock::now () + io_timeout);
+		auto data (reinterpret_cast<uint8_t const *> (payload_a.data ()));
+		size_t written (0);
+		{
+			nano::lock_guard<nano::mutex> guard (write_mutex);
+			do
+			{
+				nano::ipc::shm_frame_header header;
+				header.request_id = request_id;
+				header.encoding = static_cast<uint8_t> (encoding_a);
+				header.size = static_cast<uint32_t> (std::min<size_t> (payload_a.size () - written, ring.max_frame_payload ()));
+				header.flags = static_cast<uint8_t> (written + header.size == payload_a.size () ? nano::ipc::shm_frame_flags::last : nano::ipc::shm_frame_flags::none);
+				error = ring.write_frame (header, data + written, deadline, stopped);
+				written += header.size;
+				// Wake the node for each frame, so it can consume long requests as they are written
+				segment.notify_server ();
+			} while (!error && written < payload_a.size ());
+		}
+		if (error)
+		{
+			nano::unique_lock<nano::mutex> lock (pending_mutex);
+			// The receiving thread may have already failed it
+			auto existing (pending.find (request_id));
+			if (existing != pending.end ())
+			{
+				pending.erase (existing);
+				lock.unlock ();
+				callback_a (nano::error ("Cannot write to the node"), std::string ());
+			}
+		}
+	}
+	else
+	{
+		callback_a (nano::error ("Not connected to the node"), std::string ());
+	}
+}
+
+std::string nano::ipc::shm_client::request (nano::ipc::payload_encoding encoding_a, std::string const & payload_a)
+{
+	std::promise<std::string> result_l;
+	async_request (encoding_a, payload_a, [&result_l](nano::error const &, std::string const & response_a) {
+		result_l.set_value (response_a);
+	});
+	return result_l.get_future ().get ();
+}
+
+void nano::ipc::shm_client::close ()
+{
+	if (is_connected.exchange (false))
+	{
+		stopped = 1;
+		if (thread.joinable ())
+		{
+			thread.join ();
+		}
+		fail_pending (nano::error ("Connection closed"));
+		segment.slot (slot_index).state = static_cast<uint32_t> (nano::ipc::shm_slot_state::closed);
+		segment.notify_server ();
+	}
+}
+
+bool nano::ipc::shm_client::connected () const
+{
+	return is_connected && segment.header ().server_running != 0 && segment.slot (slot_index).state == static_cast<uint32_t> (nano::ipc::shm_slot_state::connected);
+}
+
+void nano::ipc::shm_client::run ()
+{
+	auto ring (segment.responses (slot_index));
+	nano::ipc::shm_frame_header header;
+	std::vector<uint8_t> payload;
+	auto producer_waiting (false);
+	while (stopped == 0)
+	{
+		if (ring.try_read_frame (header, payload, producer_waiting))
+		{
+			if (producer_waiting)
+			{
+				// The node writes responses from the thread serving all connections, which waits on the doorbell
+				segment.notify_server ();
+			}
+			nano::unique_lock<nano::mutex> lock (pending_mutex);
+			auto existing (pending.find (header.request_id));
+			if (existing != pending.end ())
+			{
+				existing->second.response.append (reinterpret_cast<char const *> (payload.data ()), payload.size ());
+				if ((header.flags & static_cast<uint8_t> (nano::ipc::shm_frame_flags::last)) != 0)
+				{
+					auto request (std::move (existing->second));
+					pending.erase (existing);
+					lock.unlock ();
+					request.callback (nano::error (), request.response);
+				}
+			}
+		}
+		else if (segment.header ().server_running == 0)
+		{
+			fail_pending (nano::error ("The node stopped serving shared memory IPC"));
+			ring.wait_readable (wait_slice);
+		}
+		else if (segment.slot (slot_index).state == static_cast<uint32_t> (nano::ipc::shm_slot_state::disconnected))
+		{
+			fail_pending (nano::error ("The node closed the connection"));
+			ring.wait_readable (wait_slice);
+		}
+		else
+		{
+			ring.wait_readable (wait_slice);
+		}
+	}
+}
+
+void nano::ipc::shm_client::fail_pending (nano::error const & error_a)
+{
+	decltype (pending) pending_l;
+	{
+		nano::lock_guard<nano::mutex> guard (pending_mutex);
+		pending_l.swap (pending);
+	}
+	for (auto & request : pending_l)
+	{
+		request.second.callback (error_a, std::string ());
+	}
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <nano/lib/errors.hpp>
+#include <nano/lib/ipc.hpp>
+#include <nano/lib/locks.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace nano
+{
+namespace ipc
+{
+	/**
+	 * The shared memory transport is for IPC clients on the same host as the node.
+	 *
+	 * The node creates a segment with a fixed number of connection slots. A client claims a free slot, then exchanges
+	 * frames with the node through two single-producer, single-consumer byte rings in that slot, one per direction.
+	 * Waiting for an empty or full ring is done with futexes on the ring positions, so neither side spins.
+	 *
+	 * Each frame carries a request id, so a connection can have many outstanding requests and responses can complete
+	 * in any order. Messages larger than a chunk are split over several frames. Responses are therefore streamed to
+	 * the client as it consumes them, and can be larger than the ring. The node never waits on a response ring, a
+	 * client which frees space the node is waiting for rings the doorbell instead.
+	 *
+	 * This transport is only available on Linux.
+	 */
+	enum class shm_frame_flags : uint8_t
+	{
+		none = 0,
+		/** Set on the final frame of a message */
+		last = 1
+	};
+
+	/** Header preceding the payload of every frame. Both sides are on the same host, so integers are in host byte order. */
+	class shm_frame_header final
+	{
+	public:
+		uint32_t request_id{ 0 };
+		/** Number of payload bytes following the header */
+		uint32_t size{ 0 };
+		/** A payload_encoding value. Only meaningful for requests */
+		uint8_t encoding{ 0 };
+		/** shm_frame_flags */
+		uint8_t flags{ 0 };
+		uint16_t reserved{ 0 };
+	};
+
+	/** Ring positions shared between the processes. Positions only ever increase, wrapping at 2^32 */
+	class shm_ring_header final
+	{
+	public:
+		/** Bytes written by the producer */
+		std::atomic<uint32_t> head{ 0 };
+		/** Bytes consumed by the consumer */
+		std::atomic<uint32_t> tail{ 0 };
+		/** Set by the consumer before waiting on head */
+		std::atomic<uint32_t> consumer_waiting{ 0 };
+		/** Set by the producer before waiting on tail */
+		std::atomic<uint32_t> producer_waiting{ 0 };
+	};
+
+	/**
+	 * A view of one direction of a connection slot. There must be a single producer and a single consumer at a
+	 * time, callers with several producer threads serialize them.
+	 */
+	class shm_ring final
+	{
+	public:
+		shm_ring (nano::ipc::shm_ring_header & header_a, uint8_t * data_a, uint32_t capacity_a);
+		/** The largest payload a single frame may carry, which guarantees a whole frame always fits the ring */
+		uint32_t max_frame_payload () const;
+		/**
+		 * Writes a frame, waiting for the consumer to make space if needed.
+		 * @return true if space did not become available before \p deadline_a, or if \p abort_a became set
+		 */
+		bool write_frame (nano::ipc::shm_frame_header const & header_a, uint8_t const * payload_a, std::chrono::steady_clock::time_point deadline_a, std::atomic<uint32_t> const & abort_a);
+		/**
+		 * Writes a frame if there is space for it, without waiting. Otherwise flags the producer as waiting, so the
+		 * consumer reports when it frees space. Returns false if the frame was not written
+		 */
+		bool try_write_frame (nano::ipc::shm_frame_header const & header_a, uint8_t const * payload_a);
+		/** Reads the next frame if it is completely available. Returns false if there is none */
+		bool try_read_frame (nano::ipc::shm_frame_header & header_a, std::vector<uint8_t> & payload_a);
+		/** As try_read_frame, but instead of waking a waiting producer sets \p producer_waiting_a for the caller to notify it */
+		bool try_read_frame (nano::ipc::shm_frame_header & header_a, std::vector<uint8_t> & payload_a, bool & producer_waiting_a);
+		/** Waits for the producer to write more data, at most \p timeout_a */
+		void wait_readable (std::chrono::milliseconds timeout_a);
+		/** Empties the ring. Neither side may be using it */
+		void reset ();
+
+	private:
+		void copy_in (uint32_t position_a, uint8_t const * source_a, uint32_t size_a);
+		void copy_out (uint32_t position_a, uint8_t * target_a, uint32_t size_a) const;
+		nano::ipc::shm_ring_header & header;
+		uint8_t * data;
+		uint32_t capacity;
+	};
+
+	enum class shm_slot_state : uint32_t
+	{
+		free,
+		connected,
+		/** Set by a client when it disconnects, the node then empties the slot and frees it */
+		closed,
+		/** Set by the node when it drops a connection, such as a client not reading its responses. The client must still close it. */
+		disconnected
+	};
+
+	class shm_slot_header final
+	{
+	public:
+		/** A shm_slot_state value */
+		std::atomic<uint32_t> state{ static_cast<uint32_t> (nano::ipc::shm_slot_state::free) };
+		/** Process id of the client, so slots of clients which exit without disconnecting can be reclaimed */
+		std::atomic<int32_t> client_pid{ 0 };
+		alignas (64) nano::ipc::shm_ring_header requests;
+		alignas (64) nano::ipc::shm_ring_header responses;
+	};
+
+	class shm_segment_header final
+	{
+	public:
+		uint32_t magic{ 0 };
+		uint32_t version{ 0 };
+		uint32_t slot_count{ 0 };
+		uint32_t ring_size{ 0 };
+		/** Bumped by clients after writing a request, the node waits on it */
+		alignas (64) std::atomic<uint32_t> doorbell{ 0 };
+		std::atomic<uint32_t> server_waiting{ 0 };
+		/** Set by the node while it serves requests. Clients fail outstanding requests once it is cleared */
+		std::atomic<uint32_t> server_running{ 0 };
+	};
+
+	/** A mapping of the shared memory segment. The node creates it, clients open it. */
+	class shm_segment final
+	{
+	public:
+		shm_segment () = default;
+		shm_segment (shm_segment const &) = delete;
+		~shm_segment ();
+		/** Creates the segment \p name_a, replacing any left over from a previous run */
+		nano::error create (std::string const & name_a, uint32_t slot_count_a, uint32_t ring_size_a);
+		nano::error open (std::string const & name_a);
+		nano::ipc::shm_segment_header & header () const;
+		nano::ipc::shm_slot_header & slot (uint32_t index_a) const;
+		nano::ipc::shm_ring requests (uint32_t index_a) const;
+		nano::ipc::shm_ring responses (uint32_t index_a) const;
+		/** Rings the doorbell after a client wrote a request */
+		void notify_server () const;
+		/** Waits for the doorbell to change from \p observed_a, at most \p timeout_a */
+		void wait_server (uint32_t observed_a, std::chrono::milliseconds timeout_a) const;
+
+		static uint32_t constexpr magic = 0x4e53484d; // "NSHM"
+		static uint32_t constexpr version = 1;
+
+	private:
+		uint8_t * slot_base (uint32_t index_a) const;
+		size_t slot_stride () const;
+		static size_t mapping_size (uint32_t slot_count_a, uint32_t ring_size_a);
+		uint8_t * memory{ nullptr };
+		size_t size{ 0 };
+		/** Set on the node side, which removes the segment name when done */
+		std::string owned_name;
+	};
+
+	/**
+	 * Client of the shared memory transport. Requests can be sent from any thread. Responses are received on a
+	 * dedicated thread, which invokes the callbacks.
+	 */
+	class shm_client final
+	{
+	public:
+		shm_client () = default;
+		shm_client (shm_client const &) = delete;
+		~shm_client ();
+
+		/** Claims a connection slot in the node's segment \p name_a */
+		nano::error connect (std::string const & name_a);
+
+		/**
+		 * Sends a request without waiting for the response.
+		 * @param callback_a Called with the response, or an error if the request could not be completed. The
+		 * order of callbacks is unrelated to the order of requests. Callbacks run on the receiving thread and
+		 * must not block, as no other responses are received meanwhile.
+		 */
+		void async_request (nano::ipc::payload_encoding encoding_a, std::string const & payload_a, std::function<void(nano::error const &, std::string const &)> callback_a);
+
+		/** Sends a request and waits for the response. Returns an empty string on error. */
+		std::string request (nano::ipc::payload_encoding encoding_a, std::string const & payload_a);
+
+		/** Fails outstanding requests and releases the slot */
+		void close ();
+
+		/** False once closed, or once the node stopped serving the segment, after which a new client must connect */
+		bool connected () const;
+
+	private:
+		void run ();
+		void fail_pending (nano::error const & error_a);
+		class pending_request final
+		{
+		public:
+			std::function<void(nano::error const &, std::string const &)> callback;
+			std::string response;
+		};
+		nano::ipc::shm_segment segment;
+		uint32_t slot_index{ 0 };
+		std::atomic<bool> is_connected{ false };
+		std::atomic<uint32_t> stopped{ 0 };
+		std::atomic<uint32_t> request_id_dispenser{ 1 };
+		/** Serializes producers of the request ring */
+		nano::mutex write_mutex;
+		nano::mutex pending_mutex;
+		std::unordered_map<uint32_t, pending_request> pending;
+		std::thread thread;
+		std::chrono::seconds io_timeout{ 15 };
+	};
+}
+}
@@ -0,0 +1,228 @@
+#include <nano/lib/json_writer.hpp>
+#include <nano/lib/utility.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+nano::json_writer::json_writer (std::string & output_a) :
+output (output_a)
+{
+	output.append ("{\n");
+	scopes.push_back ({ scope_type::object, false });
+}
+
+void nano::json_writer::put (std::string const & key_a, std::string const & value_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::object);
+	begin_child ();
+	write_key (key_a);
+	write_value (value_a);
+}
+
+void nano::json_writer::put (std::string const & key_a, char const * value_a)
+{
+	put (key_a, std::string (value_a));
+}
+
+void nano::json_writer::put (std::string const & key_a, bool value_a)
+{
+	put (key_a, std::string (value_a ? "true" : "false"));
+}
+
+void nano::json_writer::push_back (std::string const & value_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::array);
+	begin_child ();
+	write_value (value_a);
+}
+
+void nano::json_writer::start_object (std::string const & key_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::object);
+	begin_child ();
+	write_key (key_a);
+	scopes.push_back ({ scope_type::object, false });
+}
+
+void nano::json_writer::start_object ()
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::array);
+	begin_child ();
+	scopes.push_back ({ scope_type::object, false });
+}
+
+void nano::json_writer::start_array (std::string const & key_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::object);
+	begin_child ();
+	write_key (key_a);
+	scopes.push_back ({ scope_type::array, false });
+}
+
+void nano::json_writer::end ()
+{
+	// The root object is closed by finish ()
+	debug_assert (scopes.size () > 1);
+	auto current (scopes.back ());
+	scopes.pop_back ();
+	if (current.has_children)
+	{
+		output.push_back ('\n');
+		output.append (4 * scopes.size (), ' ');
+		output.push_back (current.type == scope_type::object ? '}' : ']');
+	}
+	else
+	{
+		// Property trees cannot distinguish an empty object or array from an empty value
+		output.append ("\"\"");
+	}
+}
+
+void nano::json_writer::put_tree (std::string const & key_a, boost::property_tree::ptree const & tree_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::object);
+	begin_child ();
+	write_key (key_a);
+	write_tree (tree_a);
+}
+
+void nano::json_writer::push_back_tree (boost::property_tree::ptree const & tree_a)
+{
+	debug_assert (!scopes.empty () && scopes.back ().type == scope_type::array);
+	begin_child ();
+	write_tree (tree_a);
+}
+
+void nano::json_writer::put_children (boost::property_tree::ptree const & tree_a)
+{
+	for (auto const & child : tree_a)
+	{
+		put_tree (child.first, child.second);
+	}
+}
+
+void nano::json_writer::finish ()
+{
+	debug_assert (scopes.size () == 1);
+	if (scopes.back ().has_children)
+	{
+		output.push_back ('\n');
+	}
+	output.append ("}\n");
+	scopes.clear ();
+}
+
+bool nano::json_writer::empty () const
+{
+	debug_assert (!scopes.empty ());
+	return !scopes.front ().has_children;
+}
+
+void nano::json_writer::begin_child ()
+{
+	auto & current (scopes.back ());
+	if (!current.has_children)
+	{
+		// Nested scopes are opened lazily, as they must be written as "" if they end up empty
+		if (scopes.size () > 1)
+		{
+			output.push_back (current.type == scope_type::object ? '{' : '[');
+			output.push_back ('\n');
+		}
+		current.has_children = true;
+	}
+	else
+	{
+		output.append (",\n");
+	}
+	output.append (4 * scopes.size (), ' ');
+}
+
+void nano::json_writer::write_key (std::string const & key_a)
+{
+	output.push_back ('"');
+	escape (key_a);
+	output.append ("\": ");
+}
+
+void nano::json_writer::write_value (std::string const & value_a)
+{
+	output.push_back ('"');
+	escape (value_a);
+	output.push_back ('"');
+}
+
+void nano::json_writer::write_tree (boost::property_tree::ptree const & tree_a)
+{
+	// Same rules as write_json: leaves are values, and a tree with only unnamed children is an array
+	if (tree_a.empty ())
+	{
+		write_value (tree_a.data ());
+	}
+	else
+	{
+		auto is_array (tree_a.count (std::string ()) == tree_a.size ());
+		scopes.push_back ({ is_array ? scope_type::array : scope_type::object, false });
+		for (auto const & child : tree_a)
+		{
+			begin_child ();
+			if (!is_array)
+			{
+				write_key (child.first);
+			}
+			write_tree (child.second);
+		}
+		end ();
+	}
+}
+
+void nano::json_writer::escape (std::string const & text_a)
+{
+	// Matches boost::property_tree::json_parser::create_escapes, which escapes '/' and anything outside printable ASCII
+	for (auto character : text_a)
+	{
+		auto c (static_cast<unsigned char> (character));
+		if (c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) || (c >= 0x30 && c <= 0x5B) || c >= 0x5D)
+		{
+			output.push_back (character);
+		}
+		else if (c == '\b')
+		{
+			output.append ("\\b");
+		}
+		else if (c == '\f')
+		{
+			output.append ("\\f");
+		}
+		else if (c == '\n')
+		{
+			output.append ("\\n");
+		}
+		else if (c == '\r')
+		{
+			output.append ("\\r");
+		}
+		else if (c == '\t')
+		{
+			output.append ("\\t");
+		}
+		else if (c == '/')
+		{
+			output.append ("\\/");
+		}
+		else if (c == '"')
+		{
+			output.append ("\\\"");
+		}
+		else if (c == '\\')
+		{
+			output.append ("\\\\");
+		}
+		else
+		{
+			char const * hex_digits = "0123456789ABCDEF";
+			output.append ("\\u00");
+			output.push_back (hex_digits[c / 16]);
+			output.push_back (hex_digits[c % 16]);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <string>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Writes JSON directly into a string, without building a property tree first.
+ *
+ * The output is byte-compatible with boost::property_tree::write_json, so responses can be
+ * ported from property trees without changing what clients receive. This includes the property
+ * tree quirks: every value is a string, and empty objects and arrays are written as "".
+ *
+ * The root is always an object, which is opened on construction and closed by finish ().
+ */
+class json_writer final
+{
+public:
+	explicit json_writer (std::string & output_a);
+
+	/** Adds a string value to the current object */
+	void put (std::string const & key_a, std::string const & value_a);
+	void put (std::string const & key_a, char const * value_a);
+	/** Adds "true" or "false", as property_tree::put does for bools */
+	void put (std::string const & key_a, bool value_a);
+	/** Adds a string value to the current array */
+	void push_back (std::string const & value_a);
+
+	/** Opens an object as a member of the current object */
+	void start_object (std::string const & key_a);
+	/** Opens an object as an element of the current array */
+	void start_object ();
+	/** Opens an array as a member of the current object */
+	void start_array (std::string const & key_a);
+	/** Closes the innermost object or array */
+	void end ();
+
+	/** Writes \p tree_a as a member of the current object, exactly as write_json would */
+	void put_tree (std::string const & key_a, boost::property_tree::ptree const & tree_a);
+	/** Writes \p tree_a as an element of the current array, exactly as write_json would */
+	void push_back_tree (boost::property_tree::ptree const & tree_a);
+	/** Writes all children of \p tree_a as members of the current object */
+	void put_children (boost::property_tree::ptree const & tree_a);
+
+	/** Closes the root object. No other calls are allowed afterwards. */
+	void finish ();
+	/** Returns true if nothing was added to the root object */
+	bool empty () const;
+
+private:
+	enum class scope_type
+	{
+		object,
+		array
+	};
+	class scope final
+	{
+	public:
+		scope_type type;
+		bool has_children;
+	};
+	/** Writes the separator and indentation before a new child of the current scope */
+	void begin_child ();
+	void write_key (std::string const & key_a);
+	void write_value (std::string const & value_a);
+	void write_tree (boost::property_tree::ptree const & tree_a);
+	void escape (std::string const & text_a);
+	std::string & output;
+	std::vector<scope> scopes;
+};
+}
@@ -0,0 +1,199 @@
+#include <nano/lib/logger_mt.hpp>
+#include <nano/lib/threading.hpp>
+
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/mutable_constant.hpp>
+#include <boost/log/core/core.hpp>
+
+#include <algorithm>
+
+namespace
+{
+std::atomic<uint64_t> next_queue_id{ 1 };
+
+/** Buffers of the calling thread, by queue id */
+class thread_buffers final
+{
+public:
+	~thread_buffers ()
+	{
+		for (auto const & item : buffers)
+		{
+			item.second->retired = true;
+		}
+	}
+	std::vector<std::pair<uint64_t, std::shared_ptr<nano::detail::log_buffer>>> buffers;
+};
+thread_local thread_buffers current_buffers;
+
+size_t round_up_power_of_two (size_t value_a)
+{
+	size_t result (1);
+	while (result < value_a)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+boost::posix_time::ptime local_time (std::chrono::system_clock::time_point const & time_a)
+{
+	auto since_epoch (std::chrono::duration_cast<std::chrono::microseconds> (time_a.time_since_epoch ()));
+	auto utc (boost::posix_time::from_time_t (0) + boost::posix_time::microseconds (since_epoch.count ()));
+	return boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local (utc);
+}
+}
+
+nano::detail::log_buffer::log_buffer (size_t capacity_a) :
+slots (round_up_power_of_two (std::max<size_t> (capacity_a, 1))),
+mask (slots.size () - 1)
+{
+}
+
+nano::detail::log_buffer::~log_buffer ()
+{
+	consume ([](nano::detail::log_entry const &) {});
+}
+
+nano::log_queue::log_queue (bool flush_a, size_t buffer_size_a) :
+id (next_queue_id++),
+flush_sinks (flush_a),
+buffer_size (buffer_size_a),
+thread ([this]() {
+	nano::thread_role::set (nano::thread_role::name::log_writer);
+	run ();
+})
+{
+}
+
+nano::log_queue::~log_queue ()
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		stopped = true;
+	}
+	condition.notify_all ();
+	thread.join ();
+}
+
+nano::detail::log_buffer & nano::log_queue::thread_buffer ()
+{
+	auto & buffers_l (current_buffers.buffers);
+	auto existing (std::find_if (buffers_l.begin (), buffers_l.end (), [id = id](auto const & item_a) { return item_a.first == id; }));
+	if (existing == buffers_l.end ())
+	{
+		auto buffer (std::make_shared<nano::detail::log_buffer> (buffer_size));
+		{
+			std::lock_guard<std::mutex> guard (mutex);
+			buffers.push_back (buffer);
+		}
+		// Buffers of destroyed queues are no longer written
+		buffers_l.erase (std::remove_if (buffers_l.begin (), buffers_l.end (), [](auto const & item_a) { return item_a.second.use_count () == 1; }), buffers_l.end ());
+		buffers_l.emplace_back (id, buffer);
+		existing = buffers_l.end () - 1;
+	}
+	return *existing->second;
+}
+
+void nano::log_queue::flush ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	// A pass which started after this call has seen every message pushed before it
+	auto target (passes + 2);
+	idle = false;
+	condition.notify_all ();
+	condition.wait (lock, [this, target]() { return passes >= target || stopped; });
+}
+
+uint64_t nano::log_queue::dropped () const
+{
+	return dropped_count.load (std::memory_order_relaxed);
+}
+
+size_t nano::log_queue::write_available ()
+{
+	std::vector<std::shared_ptr<nano::detail::log_buffer>> buffers_l;
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		buffers_l = buffers;
+	}
+	// Source level attributes take precedence over the global timestamp, so records carry the time they were logged
+	boost::log::sources::severity_logger<nano::severity_level> source;
+	boost::log::attributes::mutable_constant<boost::posix_time::ptime> time_stamp (boost::posix_time::ptime{});
+	source.add_attribute ("TimeStamp", time_stamp);
+	auto write ([&source, &time_stamp](nano::severity_level severity_a, std::chrono::system_clock::time_point const & time_a, auto const & write_a) {
+		time_stamp.set (local_time (time_a));
+		auto record (source.open_record (boost::log::keywords::severity = severity_a));
+		if (record)
+		{
+			boost::log::record_ostream stream (record);
+			write_a (stream);
+			stream.flush ();
+			source.push_record (std::move (record));
+		}
+	});
+	size_t result (0);
+	std::vector<std::shared_ptr<nano::detail::log_buffer>> retired;
+	for (auto const & buffer : buffers_l)
+	{
+		// Checked first, as an exited thread's buffer is complete once written
+		if (buffer->retired)
+		{
+			retired.push_back (buffer);
+		}
+		result += buffer->consume ([&write](nano::detail::log_entry const & entry_a) {
+			write (entry_a.severity, entry_a.time, [&entry_a](boost::log::record_ostream & stream_a) { entry_a.write (stream_a); });
+		});
+	}
+	if (!retired.empty ())
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		buffers.erase (std::remove_if (buffers.begin (), buffers.end (), [&retired](auto const & buffer_a) { return std::find (retired.begin (), retired.end (), buffer_a) != retired.end (); }), buffers.end ());
+	}
+	auto dropped_l (dropped_count.load (std::memory_order_relaxed));
+	if (dropped_l != dropped_reported)
+	{
+		write (nano::severity_level::error, std::chrono::system_clock::now (), [dropped = dropped_l - dropped_reported](boost::log::record_ostream & stream_a) {
+			stream_a << dropped << " log messages were dropped, as the logging threads were faster than the log writer";
+		});
+		dropped_reported = dropped_l;
+		++result;
+	}
+	if (result != 0 && flush_sinks)
+	{
+		boost::log::core::get ()->flush ();
+	}
+	return result;
+}
+
+bool nano::log_queue::pending () const
+{
+	return dropped_count.load (std::memory_order_relaxed) != dropped_reported || std::any_of (buffers.begin (), buffers.end (), [](auto const & buffer_a) { return !buffer_a->empty (); });
+}
+
+void nano::log_queue::run ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	while (!stopped)
+	{
+		lock.unlock ();
+		auto written (write_available ());
+		lock.lock ();
+		++passes;
+		condition.notify_all ();
+		if (written == 0 && !stopped)
+		{
+			idle = true;
+			// Pairs with the fence in wake (), messages pushed before it are seen here, later ones wake the writer
+			std::atomic_thread_fence (std::memory_order_seq_cst);
+			if (pending ())
+			{
+				idle = false;
+			}
+			condition.wait (lock, [this]() { return !idle || stopped; });
+		}
+	}
+	lock.unlock ();
+	write_available ();
+}
@@ -7,9 +7,20 @@
 #include <boost/log/trivial.hpp>
 #include <boost/log/utility/manipulators/to_log.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace nano
 {
@@ -39,6 +50,232 @@ inline boost::log::formatting_ostream & operator<< (boost::log::formatting_ostre
 
 namespace nano
 {
+namespace detail
+{
+	/** A log message whose items are only formatted when written */
+	class log_entry
+	{
+	public:
+		log_entry (nano::severity_level severity_a) :
+		severity (severity_a),
+		time (std::chrono::system_clock::now ())
+		{
+		}
+		virtual ~log_entry () = default;
+		virtual void write (boost::log::record_ostream &) const = 0;
+		nano::severity_level const severity;
+		std::chrono::system_clock::time_point const time;
+	};
+
+	template <typename... Items>
+	class log_entry_items final : public log_entry
+	{
+	public:
+		template <typename... Args>
+		log_entry_items (nano::severity_level severity_a, Args &&... items_a) :
+		log_entry (severity_a),
+		items (std::forward<Args> (items_a)...)
+		{
+		}
+		void write (boost::log::record_ostream & stream_a) const override
+		{
+			std::apply ([&stream_a](auto const &... items_a) { (void)std::initializer_list<int>{ (stream_a << items_a, 0)... }; }, items);
+		}
+
+	private:
+		std::tuple<Items...> items;
+	};
+
+	/** Type trait for log items which own their value, so a copy stays valid once the caller's memory is reused */
+	template <typename T>
+	struct is_owning_log_item : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value>
+	{
+	};
+	template <typename Char, typename Traits, typename Allocator>
+	struct is_owning_log_item<std::basic_string<Char, Traits, Allocator>> : std::true_type
+	{
+	};
+	template <typename Rep, typename Period>
+	struct is_owning_log_item<std::chrono::duration<Rep, Period>> : std::true_type
+	{
+	};
+
+	/**
+	 * The value kept of an item until it is written. Character arrays and pointers are copied into a string, as a
+	 * buffer on the stack of the caller is indistinguishable from a string literal. Only owning items are kept as
+	 * they are, anything else, such as views and pointers, is formatted at once.
+	 */
+	template <typename T>
+	auto capture_log_item (T const & item_a)
+	{
+		using type = std::decay_t<T>;
+		if constexpr (std::is_array<T>::value && std::is_same<std::remove_cv_t<std::remove_extent_t<T>>, char>::value)
+		{
+			// Up to the terminator, a buffer which was filled completely has none
+			return std::string (item_a, std::find (item_a, item_a + std::extent<T>::value, '\0'));
+		}
+		else if constexpr (std::is_same<type, char const *>::value || std::is_same<type, char *>::value)
+		{
+			return std::string (item_a);
+		}
+		else if constexpr (is_owning_log_item<type>::value)
+		{
+			return type (item_a);
+		}
+		else
+		{
+			std::ostringstream stream;
+			stream << item_a;
+			return stream.str ();
+		}
+	}
+
+	/**
+	 * Entries logged by one thread, a single producer single consumer ring. Entries are constructed in place in the
+	 * slots, so logging doesn't allocate unless an item does.
+	 */
+	class log_buffer final
+	{
+	public:
+		explicit log_buffer (size_t capacity_a);
+		log_buffer (log_buffer const &) = delete;
+		~log_buffer ();
+		/** Storage for the next entry, or nullptr if the ring is full. Only called by the owning thread */
+		void * reserve ()
+		{
+			auto head_l (head.load (std::memory_order_relaxed));
+			return head_l - tail.load (std::memory_order_acquire) < slots.size () ? slots[head_l & mask].storage : nullptr;
+		}
+		/** Publishes the entry constructed in the storage from reserve () */
+		void commit ()
+		{
+			head.store (head.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+		/** Whether all published entries were consumed */
+		bool empty () const
+		{
+			return tail.load (std::memory_order_acquire) == head.load (std::memory_order_acquire);
+		}
+		/** Passes every published entry to \p write_a then destroys it. Only called by the flusher */
+		template <typename Write>
+		size_t consume (Write const & write_a)
+		{
+			auto tail_l (tail.load (std::memory_order_relaxed));
+			auto head_l (head.load (std::memory_order_acquire));
+			for (auto position (tail_l); position < head_l; ++position)
+			{
+				auto entry (reinterpret_cast<nano::detail::log_entry *> (slots[position & mask].storage));
+				write_a (*entry);
+				entry->~log_entry ();
+			}
+			tail.store (head_l, std::memory_order_release);
+			return head_l - tail_l;
+		}
+		/** Set when the owning thread exits */
+		std::atomic<bool> retired{ false };
+		static size_t constexpr entry_size = 128;
+
+	private:
+		class slot final
+		{
+		public:
+			alignas (std::max_align_t) unsigned char storage[entry_size];
+		};
+		std::vector<slot> slots;
+		size_t mask;
+		std::atomic<uint64_t> head{ 0 };
+		std::atomic<uint64_t> tail{ 0 };
+	};
+}
+
+/**
+ * Writes log messages on a background thread, so threads logging don't format messages or wait for the sinks.
+ * Each logging thread has its own buffer. When it is full, messages are dropped and the number dropped is logged
+ * once there is space again. Sinks see messages in order per thread, with the time they were logged.
+ */
+class log_queue final
+{
+public:
+	/**
+	 * @param flush_a Flush the sinks after each batch of messages
+	 * @param buffer_size_a Messages buffered per logging thread, rounded up to a power of two
+	 */
+	explicit log_queue (bool flush_a, size_t buffer_size_a = 1024);
+	log_queue (log_queue const &) = delete;
+	/** Writes the remaining messages */
+	~log_queue ();
+
+	template <typename... LogItems>
+	void push (nano::severity_level severity_level_a, LogItems const &... log_items_a)
+	{
+		auto & buffer (thread_buffer ());
+		auto storage (buffer.reserve ());
+		if (storage != nullptr)
+		{
+			using entry_type = nano::detail::log_entry_items<decltype (nano::detail::capture_log_item (log_items_a))...>;
+			if constexpr (sizeof (entry_type) <= nano::detail::log_buffer::entry_size)
+			{
+				new (storage) entry_type (severity_level_a, nano::detail::capture_log_item (log_items_a)...);
+			}
+			else
+			{
+				// Too large to defer, format now
+				std::ostringstream stream;
+				(void)std::initializer_list<int>{ (stream << log_items_a, 0)... };
+				new (storage) nano::detail::log_entry_items<std::string> (severity_level_a, stream.str ());
+			}
+			buffer.commit ();
+		}
+		else
+		{
+			dropped_count.fetch_add (1, std::memory_order_relaxed);
+		}
+		wake ();
+	}
+
+	/** Waits until messages pushed before the call are written */
+	void flush ();
+	/** Number of messages dropped because a buffer was full */
+	uint64_t dropped () const;
+
+private:
+	nano::detail::log_buffer & thread_buffer ();
+	/** Wakes the writer if it is waiting for messages. Only takes the mutex when it is */
+	void wake ()
+	{
+		// Pairs with the fence in run (), either the writer sees the new message or this sees it idle
+		std::atomic_thread_fence (std::memory_order_seq_cst);
+		if (idle.load (std::memory_order_relaxed))
+		{
+			{
+				std::lock_guard<std::mutex> guard (mutex);
+				idle = false;
+			}
+			condition.notify_all ();
+		}
+	}
+	/** Whether there are messages or drops to write. Requires the mutex */
+	bool pending () const;
+	void run ();
+	/** Writes the available messages of all buffers. Returns the number written */
+	size_t write_available ();
+	uint64_t const id;
+	bool const flush_sinks;
+	size_t const buffer_size;
+	std::atomic<uint64_t> dropped_count{ 0 };
+	/** Dropped messages already reported */
+	uint64_t dropped_reported{ 0 };
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<std::shared_ptr<nano::detail::log_buffer>> buffers;
+	/** Incremented after each pass over the buffers */
+	uint64_t passes{ 0 };
+	/** Set while the writer waits for messages, written with the mutex held */
+	std::atomic<bool> idle{ false };
+	bool stopped{ false };
+	std::thread thread;
+};
+
 // A wrapper around a boost logger object to allow minimum
 // time spaced output to prevent logging happening too quickly.
 class logger_mt
@@ -58,6 +295,11 @@ private:
 	template <typename... LogItems>
 	void output (nano::severity_level severity_level, LogItems &&... log_items)
 	{
+		if (queue != nullptr)
+		{
+			queue->push (severity_level, log_items...);
+			return;
+		}
 		boost::log::record rec = boost_logger_mt.open_record (boost::log::keywords::severity = severity_level);
 		if (rec)
 		{
@@ -79,6 +321,15 @@ public:
 	{
 	}
 
+	/**
+	 * @param queue_a If set, messages are written asynchronously by this queue
+	 */
+	logger_mt (std::chrono::milliseconds const & min_log_delta_a, std::shared_ptr<nano::log_queue> const & queue_a) :
+	min_log_delta (min_log_delta_a),
+	queue (queue_a)
+	{
+	}
+
 	/*
 	 * @param log_items A collection of objects with overloaded operator<< to be output to the log file
 	 * @params severity_level The severity level that this log message should have.
@@ -107,12 +358,11 @@ public:
 	bool try_log (nano::severity_level severity_level, LogItems &&... log_items)
 	{
 		auto error (true);
-		auto time_now = std::chrono::steady_clock::now ();
-		nano::unique_lock<nano::mutex> lk (last_log_time_mutex);
-		if (((time_now - last_log_time) > min_log_delta) || last_log_time == std::chrono::steady_clock::time_point{})
+		auto time_now (std::chrono::steady_clock::now ().time_since_epoch ().count ());
+		auto last_log_time_l (last_log_time.load (std::memory_order_relaxed));
+		// Only the thread which advances the last log time logs
+		if ((last_log_time_l == 0 || std::chrono::steady_clock::duration (time_now - last_log_time_l) > min_log_delta) && last_log_time.compare_exchange_strong (last_log_time_l, time_now, std::memory_order_relaxed))
 		{
-			last_log_time = time_now;
-			lk.unlock ();
 			output (severity_level, std::forward<LogItems> (log_items)...);
 			error = false;
 		}
@@ -132,8 +382,9 @@ public:
 	std::chrono::milliseconds min_log_delta{ 0 };
 
 private:
-	nano::mutex last_log_time_mutex;
-	std::chrono::steady_clock::time_point last_log_time;
+	/** Time since the clock's epoch of the last output by try_log, zero if none */
+	std::atomic<std::chrono::steady_clock::rep> last_log_time{ 0 };
 	boost::log::sources::severity_logger_mt<severity_level> boost_logger_mt;
+	std::shared_ptr<nano::log_queue> queue;
 };
 }
@@ -1,4 +1,7 @@
 #include <nano/lib/memory.hpp>
+#include <nano/lib/utility.hpp>
+
+#include <algorithm>
 
 namespace
 {
@@ -8,6 +11,20 @@ bool use_memory_pools{ false };
 #else
 bool use_memory_pools{ true };
 #endif
+
+/** Every memory_pool created, for collect_memory_pool_info */
+class pool_registry final
+{
+public:
+	nano::mutex mutex;
+	std::vector<nano::memory_pool *> pools;
+};
+
+pool_registry & registry ()
+{
+	static auto * registry_l (new pool_registry);
+	return *registry_l;
+}
 }
 
 bool nano::get_use_memory_pools ()
@@ -23,6 +40,145 @@ void nano::set_use_memory_pools (bool use_memory_pools_a)
 #endif
 }
 
+size_t constexpr nano::memory_pool::batch_size;
+size_t constexpr nano::memory_pool::retained_max;
+
+nano::memory_pool::memory_pool (size_t size_a) :
+size (size_a)
+{
+	auto & registry_l (registry ());
+	nano::lock_guard<nano::mutex> lock (registry_l.mutex);
+	registry_l.pools.push_back (this);
+}
+
+void nano::memory_pool::take (void ** entries_a, size_t count_a)
+{
+	size_t taken (0);
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		taken = std::min (count_a, free.size ());
+		std::copy (free.end () - taken, free.end (), entries_a);
+		free.resize (free.size () - taken);
+	}
+	for (auto i (taken); i < count_a; ++i)
+	{
+		entries_a[i] = ::operator new (size);
+	}
+	reserved += count_a - taken;
+}
+
+void nano::memory_pool::give (void * const * entries_a, size_t count_a)
+{
+	size_t kept (0);
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		kept = std::min (count_a, retained_max - std::min (retained_max, free.size ()));
+		free.insert (free.end (), entries_a, entries_a + kept);
+	}
+	for (auto i (kept); i < count_a; ++i)
+	{
+		::operator delete (entries_a[i]);
+	}
+	reserved -= count_a - kept;
+}
+
+void * nano::memory_pool::allocate ()
+{
+	void * result (nullptr);
+	take (&result, 1);
+	return result;
+}
+
+void nano::memory_pool::deallocate (void * object_a)
+{
+	give (&object_a, 1);
+}
+
+bool nano::memory_pool::purge ()
+{
+	std::vector<void *> free_l;
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		free_l.swap (free);
+	}
+	for (auto object : free_l)
+	{
+		::operator delete (object);
+	}
+	reserved -= free_l.size ();
+	return !free_l.empty ();
+}
+
+nano::memory_pool::thread_cache::thread_cache (nano::memory_pool & pool_a, bool * closed_a) :
+pool (pool_a),
+closed (closed_a)
+{
+}
+
+nano::memory_pool::thread_cache::~thread_cache ()
+{
+	if (closed != nullptr)
+	{
+		*closed = true;
+	}
+	pool.give (entries.data (), count);
+	count = 0;
+}
+
+void * nano::memory_pool::thread_cache::allocate ()
+{
+	if (count == 0)
+	{
+		pool.take (entries.data (), batch_size);
+		count = batch_size;
+	}
+	return entries[--count];
+}
+
+void nano::memory_pool::thread_cache::deallocate (void * object_a)
+{
+	if (count == entries.size ())
+	{
+		// Hand back the objects freed longest ago, the most recent ones are likelier to be in the CPU cache
+		pool.give (entries.data (), batch_size);
+		std::move (entries.begin () + batch_size, entries.end (), entries.begin ());
+		count -= batch_size;
+	}
+	entries[count++] = object_a;
+}
+
+bool nano::memory_pool::thread_cache::purge ()
+{
+	for (auto i (0u); i < count; ++i)
+	{
+		::operator delete (entries[i]);
+	}
+	pool.reserved -= count;
+	auto result (count != 0);
+	count = 0;
+	return result;
+}
+
+std::unique_ptr<nano::container_info_component> nano::collect_memory_pool_info (std::string const & name)
+{
+	auto composite = std::make_unique<container_info_composite> (name);
+	auto & registry_l (registry ());
+	nano::lock_guard<nano::mutex> guard (registry_l.mutex);
+	for (auto pool : registry_l.pools)
+	{
+		size_t pooled (0);
+		{
+			nano::lock_guard<nano::mutex> lock (pool->mutex);
+			pooled = pool->free.size ();
+		}
+		auto size (std::to_string (pool->size));
+		// Reserved objects not pooled are live or in thread caches
+		composite->add_component (std::make_unique<container_info_leaf> (container_info{ "reserved_" + size, pool->reserved, pool->size }));
+		composite->add_component (std::make_unique<container_info_leaf> (container_info{ "pooled_" + size, pooled, pool->size }));
+	}
+	return composite;
+}
+
 nano::cleanup_guard::cleanup_guard (std::vector<std::function<void()>> const & cleanup_funcs_a) :
 cleanup_funcs (cleanup_funcs_a)
 {
@@ -1,9 +1,12 @@
 #pragma once
 
-#include <boost/pool/pool_alloc.hpp>
+#include <nano/lib/locks.hpp>
 
+#include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace nano
@@ -12,6 +15,8 @@ namespace nano
 #define MEMORY_POOL_DISABLED
 #endif
 
+class container_info_component;
+
 bool get_use_memory_pools ();
 void set_use_memory_pools (bool use_memory_pools);
 
@@ -31,13 +36,160 @@ constexpr size_t determine_shared_ptr_pool_size ()
 	return size_control_block + sizeof (T);
 }
 
-/** Deallocates all memory from a singleton_pool (invalidates all existing pointers). Returns true if any memory was deallocated */
+/**
+ * Objects of one size, for the types allocated at a high rate through nano::make_shared.
+ * Each thread allocates from and frees to its own cache without locking. A cache which runs empty takes a batch of
+ * objects from the pool, and one which overflows hands a batch back. The pool keeps up to retained_max objects for
+ * reuse and returns the rest to the system allocator, so memory freed after a burst doesn't stay reserved forever.
+ */
+class memory_pool final
+{
+public:
+	explicit memory_pool (size_t size_a);
+	/** Takes a single object from the pool, bypassing thread caches */
+	void * allocate ();
+	/** Hands a single object back to the pool, bypassing thread caches */
+	void deallocate (void * object_a);
+	/** Free objects of one thread */
+	class thread_cache final
+	{
+	public:
+		/** \p closed_a, if given, is set once the cache is destroyed */
+		explicit thread_cache (nano::memory_pool & pool_a, bool * closed_a = nullptr);
+		/** Hands the cached objects back to the pool as the thread exits */
+		~thread_cache ();
+		void * allocate ();
+		void deallocate (void * object_a);
+		/** Frees the objects of this cache. @return true if there were any */
+		bool purge ();
+
+	private:
+		nano::memory_pool & pool;
+		std::array<void *, 128> entries;
+		size_t count{ 0 };
+		bool * closed;
+	};
+	/** Frees the objects kept by the pool, not those in thread caches. @return true if there were any */
+	bool purge ();
+	size_t const size;
+	/** Objects moved between a thread cache and the pool at once */
+	static size_t constexpr batch_size = 32;
+	/** Objects the pool keeps for reuse, further objects handed back are freed */
+	static size_t constexpr retained_max = 16 * 1024;
+	/** Objects obtained from the system allocator and not released yet, live or cached */
+	std::atomic<size_t> reserved{ 0 };
+
+private:
+	/** Moves up to \p count_a objects into \p entries_a, allocating those the pool doesn't have */
+	void take (void ** entries_a, size_t count_a);
+	/** Keeps up to retained_max of the \p count_a objects in \p entries_a and frees the rest */
+	void give (void * const * entries_a, size_t count_a);
+	mutable nano::mutex mutex;
+	std::vector<void *> free;
+
+	friend std::unique_ptr<nano::container_info_component> collect_memory_pool_info (std::string const &);
+};
+
+/** The pool for objects of \p size */
+template <size_t size>
+nano::memory_pool & memory_pool_instance ()
+{
+	// Never destroyed, objects may still be freed by static destructors
+	static auto * pool (new nano::memory_pool (size));
+	return *pool;
+}
+
+/**
+ * Whether the cache of the calling thread for objects of \p size is destroyed. Trivially destructible, so thread_local
+ * destructors running after the one of the cache can still read it and must then use the pool directly.
+ */
+template <size_t size>
+bool & memory_pool_cache_closed ()
+{
+	static thread_local bool closed{ false };
+	return closed;
+}
+
+/** The cache of the calling thread for objects of \p size, only valid while memory_pool_cache_closed is false */
+template <size_t size>
+nano::memory_pool::thread_cache & memory_pool_cache ()
+{
+	static thread_local nano::memory_pool::thread_cache cache (nano::memory_pool_instance<size> (), &nano::memory_pool_cache_closed<size> ());
+	return cache;
+}
+
+template <size_t size>
+void * memory_pool_allocate ()
+{
+	return !nano::memory_pool_cache_closed<size> () ? nano::memory_pool_cache<size> ().allocate () : nano::memory_pool_instance<size> ().allocate ();
+}
+
+template <size_t size>
+void memory_pool_deallocate (void * object_a)
+{
+	if (!nano::memory_pool_cache_closed<size> ())
+	{
+		nano::memory_pool_cache<size> ().deallocate (object_a);
+	}
+	else
+	{
+		nano::memory_pool_instance<size> ().deallocate (object_a);
+	}
+}
+
+/** Allocates single objects from the memory_pool of their size, such as the shared_ptr control blocks of make_shared.
+    Not final so the control block stores it as an empty base, keeping its size as determine_shared_ptr_pool_size expects */
+template <typename T>
+class pool_allocator
+{
+public:
+	using value_type = T;
+
+	pool_allocator () = default;
+	template <typename U>
+	pool_allocator (pool_allocator<U> const &)
+	{
+	}
+	T * allocate (size_t count_a)
+	{
+		return count_a == 1 ? static_cast<T *> (nano::memory_pool_allocate<sizeof (T)> ()) : static_cast<T *> (::operator new (count_a * sizeof (T)));
+	}
+	void deallocate (T * object_a, size_t count_a)
+	{
+		if (count_a == 1)
+		{
+			nano::memory_pool_deallocate<sizeof (T)> (object_a);
+		}
+		else
+		{
+			::operator delete (object_a);
+		}
+	}
+	template <typename U>
+	bool operator== (pool_allocator<U> const &) const
+	{
+		return true;
+	}
+	template <typename U>
+	bool operator!= (pool_allocator<U> const &) const
+	{
+		return false;
+	}
+};
+
+/** Frees the memory kept by the pool of shared_ptrs to T and the cache of the calling thread. Returns true if any memory was deallocated */
 template <typename object>
 bool purge_shared_ptr_singleton_pool_memory ()
 {
-	return boost::singleton_pool<boost::fast_pool_allocator_tag, nano::determine_shared_ptr_pool_size<object> ()>::purge_memory ();
+	constexpr auto size (nano::determine_shared_ptr_pool_size<object> ());
+	auto cached (!nano::memory_pool_cache_closed<size> () && nano::memory_pool_cache<size> ().purge ());
+	auto pooled (nano::memory_pool_instance<size> ().purge ());
+	return cached || pooled;
 }
 
+/** Objects reserved and pooled by every memory_pool in use */
+std::unique_ptr<nano::container_info_component> collect_memory_pool_info (std::string const & name);
+
 class cleanup_guard final
 {
 public:
@@ -53,7 +205,7 @@ std::shared_ptr<T> make_shared (Args &&... args)
 {
 	if (nano::get_use_memory_pools ())
 	{
-		return std::allocate_shared<T> (boost::fast_pool_allocator<T> (), std::forward<Args> (args)...);
+		return std::allocate_shared<T> (nano::pool_allocator<T> (), std::forward<Args> (args)...);
 	}
 	else
 	{
@@ -136,6 +136,7 @@ nano::error nano::rpc_config::serialize_toml (nano::tomlconfig & toml) const
 	rpc_process_l.put ("ipc_address", rpc_process.ipc_address, "Address of IPC server.\ntype:string,ip");
 	rpc_process_l.put ("ipc_port", rpc_process.ipc_port, "Listening port of IPC server.\ntype:uint16");
 	rpc_process_l.put ("num_ipc_connections", rpc_process.num_ipc_connections, "Number of IPC connections to establish.\ntype:uint32");
+	rpc_process_l.put ("ipc_shared_memory", rpc_process.ipc_shared_memory, "Name of the shared memory segment of the node's IPC server, see ipc.shared_memory in the node config. If set, it is used instead of TCP. Only for nodes on the same host, Linux only.\ntype:string");
 	toml.put_child ("process", rpc_process_l);
 
 	nano::tomlconfig rpc_logging_l;
@@ -177,6 +178,7 @@ nano::error nano::rpc_config::deserialize_toml (nano::tomlconfig & toml)
 			rpc_process_l->get_optional<boost::asio::ip::address_v6> ("ipc_address", ipc_address_l, boost::asio::ip::address_v6::loopback ());
 			rpc_process.ipc_address = address_l.to_string ();
 			rpc_process_l->get_optional<unsigned> ("num_ipc_connections", rpc_process.num_ipc_connections);
+			rpc_process_l->get_optional<std::string> ("ipc_shared_memory", rpc_process.ipc_shared_memory);
 		}
 	}
 
@@ -54,6 +54,8 @@ public:
 	std::string ipc_address;
 	uint16_t ipc_port{ network_constants.default_ipc_port };
 	unsigned num_ipc_connections{ (network_constants.is_live_network () || network_constants.is_test_network ()) ? 8u : network_constants.is_beta_network () ? 4u : 1u };
+	/** Name of the node's shared memory IPC segment. If set, requests are sent through it instead of the TCP connections. */
+	std::string ipc_shared_memory;
 	static unsigned json_version ()
 	{
 		return 1;
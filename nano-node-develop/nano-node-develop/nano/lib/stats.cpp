@@ -6,9 +6,11 @@
 #include <boost/format.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 nano::error nano::stat_config::deserialize_json (nano::jsonconfig & json)
 {
@@ -282,9 +284,87 @@ std::vector<nano::stat_histogram::bin> nano::stat_histogram::get_bins () const
 	return bins;
 }
 
+nano::stat_counters::stat_counters (size_t count_a, size_t shards_a) :
+count (count_a),
+shards (std::max<size_t> (shards_a, 1)),
+stride ((count_a + 7) / 8 * 8 + 8),
+counters (shards * stride)
+{
+	static_assert (sizeof (std::atomic<uint64_t>) * 8 == 64, "Padding assumes 8 counters per cache line");
+}
+
+uint64_t nano::stat_counters::get (size_t index_a) const
+{
+	debug_assert (index_a < count);
+	uint64_t result (0);
+	for (size_t i (0); i < shards; ++i)
+	{
+		result += counters[i * stride + index_a].load (std::memory_order_relaxed);
+	}
+	return result;
+}
+
+void nano::stat_counters::clear ()
+{
+	for (auto & counter : counters)
+	{
+		counter.store (0, std::memory_order_relaxed);
+	}
+}
+
+size_t nano::stat_counters::default_shards ()
+{
+	return std::min<size_t> (std::max (std::thread::hardware_concurrency (), 1u), 16);
+}
+
+std::array<std::chrono::microseconds, 20> const nano::stat_latency_histogram::bounds{
+	std::chrono::microseconds (50), std::chrono::microseconds (100), std::chrono::microseconds (250), std::chrono::microseconds (500),
+	std::chrono::milliseconds (1), std::chrono::microseconds (2500), std::chrono::milliseconds (5), std::chrono::milliseconds (10),
+	std::chrono::milliseconds (25), std::chrono::milliseconds (50), std::chrono::milliseconds (100), std::chrono::milliseconds (250),
+	std::chrono::milliseconds (500), std::chrono::seconds (1), std::chrono::milliseconds (2500), std::chrono::seconds (5),
+	std::chrono::seconds (10), std::chrono::seconds (30), std::chrono::seconds (60), std::chrono::seconds (300)
+};
+
+void nano::stat_latency_histogram::observe (std::chrono::nanoseconds const & duration_a)
+{
+	auto bucket (std::lower_bound (bounds.begin (), bounds.end (), duration_a) - bounds.begin ());
+	buckets[bucket].fetch_add (1, std::memory_order_relaxed);
+	sum_ns.fetch_add (static_cast<uint64_t> (std::max<int64_t> (duration_a.count (), 0)), std::memory_order_relaxed);
+}
+
+void nano::stat_latency_histogram::clear ()
+{
+	for (auto & bucket : buckets)
+	{
+		bucket.store (0, std::memory_order_relaxed);
+	}
+	sum_ns.store (0, std::memory_order_relaxed);
+}
+
+nano::stat_latency_histogram::snapshot nano::stat_latency_histogram::get () const
+{
+	nano::stat_latency_histogram::snapshot result;
+	for (size_t i (0); i < buckets.size (); ++i)
+	{
+		result.buckets[i] = buckets[i].load (std::memory_order_relaxed);
+		result.count += result.buckets[i];
+	}
+	result.sum = std::chrono::nanoseconds (sum_ns.load (std::memory_order_relaxed));
+	return result;
+}
+
 nano::stat::stat (nano::stat_config config) :
 config (config)
 {
+	slow_path = config.sampling_enabled || config.log_interval_counters > 0;
+}
+
+uint32_t nano::stat::key_of_index (size_t index)
+{
+	auto dir (index % dir_count);
+	auto detail (index / dir_count % detail_count);
+	auto type (index / dir_count / detail_count);
+	return static_cast<uint32_t> (type << 16 | detail << 8 | dir);
 }
 
 std::shared_ptr<nano::stat_entry> nano::stat::get_entry (uint32_t key)
@@ -339,21 +419,44 @@ void nano::stat::log_counters_impl (stat_log_sink & sink)
 		sink.write_header ("counters", walltime);
 	}
 
-	for (auto & it : entries)
+	// Counters are summed over their shards here rather than on update, so don't carry an update time
+	std::time_t time = std::chrono::system_clock::to_time_t (std::chrono::system_clock::now ());
+	tm local_tm = *localtime (&time);
+	for (size_t index (0); index < counters.count; ++index)
 	{
-		std::time_t time = std::chrono::system_clock::to_time_t (it.second->counter.get_timestamp ());
-		tm local_tm = *localtime (&time);
-
-		auto key = it.first;
-		std::string type = type_to_string (key);
-		std::string detail = detail_to_string (key);
-		std::string dir = dir_to_string (key);
-		sink.write_entry (local_tm, type, detail, dir, it.second->counter.get_value (), it.second->histogram.get ());
+		auto key = key_of_index (index);
+		auto value (counters.get (index));
+		nano::stat_histogram * histogram (nullptr);
+		auto existing (entries.find (key));
+		if (existing != entries.end ())
+		{
+			histogram = existing->second->histogram.get ();
+		}
+		if (value != 0 || histogram != nullptr)
+		{
+			std::string type = type_to_string (key);
+			std::string detail = detail_to_string (key);
+			std::string dir = dir_to_string (key);
+			sink.write_entry (local_tm, type, detail, dir, value, histogram);
+		}
 	}
 	sink.entries ()++;
 	sink.finalize ();
 }
 
+void nano::stat::visit_counters (std::function<void(std::string const &, std::string const &, std::string const &, uint64_t)> const & visitor) const
+{
+	for (size_t index (0); index < counters.count; ++index)
+	{
+		auto value (counters.get (index));
+		if (value != 0)
+		{
+			auto key (key_of_index (index));
+			visitor (type_to_string (key), detail_to_string (key), dir_to_string (key), value);
+		}
+	}
+}
+
 void nano::stat::log_samples (stat_log_sink & sink)
 {
 	nano::unique_lock<nano::mutex> lock (stat_mutex);
@@ -412,7 +515,7 @@ nano::stat_histogram * nano::stat::get_histogram (stat::type type, stat::detail
 	return entry->histogram.get ();
 }
 
-void nano::stat::update (uint32_t key_a, uint64_t value)
+void nano::stat::update_slow (uint32_t key_a, uint64_t value)
 {
 	static file_writer log_count (config.log_counters_filename);
 	static file_writer log_sample (config.log_samples_filename);
@@ -424,10 +527,12 @@ void nano::stat::update (uint32_t key_a, uint64_t value)
 	{
 		auto entry (get_entry_impl (key_a, config.interval, config.capacity));
 
-		// Counters
-		auto old (entry->counter.get_value ());
-		entry->counter.add (value);
-		entry->count_observers.notify (old, entry->counter.get_value ());
+		// Counters, which were already incremented
+		if (!entry->count_observers.observers.empty ())
+		{
+			auto current (counters.get (index_of (key_a)));
+			entry->count_observers.notify (current - value, current);
+		}
 
 		std::chrono::duration<double, std::milli> duration = now - log_last_count_writeout;
 		if (config.log_interval_counters > 0 && duration.count () > config.log_interval_counters)
@@ -486,6 +591,11 @@ void nano::stat::clear ()
 {
 	nano::unique_lock<nano::mutex> lock (stat_mutex);
 	entries.clear ();
+	counters.clear ();
+	for (auto & latency : latencies)
+	{
+		latency.clear ();
+	}
 	timestamp = std::chrono::steady_clock::now ();
 }
 
@@ -564,6 +674,23 @@ std::string nano::stat::type_to_string (uint32_t key)
 		case nano::stat::type::vote_generator:
 			res = "vote_generator";
 			break;
+		case nano::stat::type::work:
+			res = "work";
+			break;
+		case nano::stat::type::traffic_shaper_queue:
+			res = "traffic_shaper_queue";
+			break;
+		case nano::stat::type::traffic_shaper_drop:
+			res = "traffic_shaper_drop";
+			break;
+		case nano::stat::type::tcp_lane_drop:
+			res = "tcp_lane_drop";
+			break;
+		case nano::stat::type::rpc:
+			res = "rpc";
+			break;
+		case nano::stat::type::_last:
+			break;
 	}
 	return res;
 }
@@ -769,6 +896,9 @@ std::string nano::stat::detail_to_string (uint32_t key)
 		case nano::stat::detail::tcp_excluded:
 			res = "tcp_excluded";
 			break;
+		case nano::stat::detail::tcp_write_batch:
+			res = "tcp_write_batch";
+			break;
 		case nano::stat::detail::unreachable_host:
 			res = "unreachable_host";
 			break;
@@ -877,6 +1007,91 @@ std::string nano::stat::detail_to_string (uint32_t key)
 		case nano::stat::detail::generator_spacing:
 			res = "generator_spacing";
 			break;
+		case nano::stat::detail::work_solved:
+			res = "work_solved";
+			break;
+		case nano::stat::detail::work_cancelled:
+			res = "work_cancelled";
+			break;
+		case nano::stat::detail::work_expired:
+			res = "work_expired";
+			break;
+		case nano::stat::detail::queue_wait:
+			res = "queue_wait";
+			break;
+		case nano::stat::detail::solve_time:
+			res = "solve_time";
+			break;
+		case nano::stat::detail::precache_hit:
+			res = "precache_hit";
+			break;
+		case nano::stat::detail::precache_miss:
+			res = "precache_miss";
+			break;
+		case nano::stat::detail::precache_generated:
+			res = "precache_generated";
+			break;
+		case nano::stat::detail::precache_throttled:
+			res = "precache_throttled";
+			break;
+		case nano::stat::detail::request_shard:
+			res = "request_shard";
+			break;
+		case nano::stat::detail::vote:
+			res = "vote";
+			break;
+		case nano::stat::detail::bootstrap:
+			res = "bootstrap";
+			break;
+		case nano::stat::detail::telemetry:
+			res = "telemetry";
+			break;
+		case nano::stat::detail::generic:
+			res = "generic";
+			break;
+		case nano::stat::detail::_last:
+			break;
+	}
+	return res;
+}
+
+std::string nano::stat::latency_to_string (stat::latency latency)
+{
+	std::string res;
+	switch (latency)
+	{
+		case nano::stat::latency::block_processing:
+			res = "block_processing";
+			break;
+		case nano::stat::latency::vote_verification:
+			res = "vote_verification";
+			break;
+		case nano::stat::latency::election:
+			res = "election";
+			break;
+		case nano::stat::latency::cementing:
+			res = "cementing";
+			break;
+		case nano::stat::latency::write_queue_wait:
+			res = "write_queue_wait";
+			break;
+		case nano::stat::latency::tcp_lane_generic:
+			res = "tcp_lane_generic";
+			break;
+		case nano::stat::latency::tcp_lane_vote:
+			res = "tcp_lane_vote";
+			break;
+		case nano::stat::latency::tcp_lane_publish:
+			res = "tcp_lane_publish";
+			break;
+		case nano::stat::latency::tcp_lane_confirm_req:
+			res = "tcp_lane_confirm_req";
+			break;
+		case nano::stat::latency::tcp_lane_telemetry:
+			res = "tcp_lane_telemetry";
+			break;
+		case nano::stat::latency::_last:
+			break;
 	}
 	return res;
 }
@@ -893,6 +1108,8 @@ std::string nano::stat::dir_to_string (uint32_t key)
 		case nano::stat::dir::out:
 			res = "out";
 			break;
+		case nano::stat::dir::_last:
+			break;
 	}
 	return res;
 }
@@ -5,12 +5,15 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <initializer_list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace nano
 {
@@ -136,9 +139,6 @@ public:
 	/** Value within the current sample interval */
 	stat_datapoint sample_current;
 
-	/** Counting value for this entry, including the time of last update. This is never reset and only increases. */
-	stat_datapoint counter;
-
 	/** Optional histogram for this entry */
 	std::unique_ptr<stat_histogram> histogram;
 
@@ -149,6 +149,68 @@ public:
 	nano::observer_set<uint64_t, uint64_t> count_observers;
 };
 
+/**
+ * Counters for a fixed number of keys, allocated up front. Threads are spread over shards, each a separate array of
+ * all counters padded to whole cache lines, so incrementing is a relaxed atomic add to memory no other thread is
+ * likely to write. Values are only summed over the shards when read.
+ */
+class stat_counters final
+{
+public:
+	explicit stat_counters (size_t count_a, size_t shards_a = default_shards ());
+	void add (size_t index_a, uint64_t value_a)
+	{
+		debug_assert (index_a < count);
+		counters[thread_shard () % shards * stride + index_a].fetch_add (value_a, std::memory_order_relaxed);
+	}
+	uint64_t get (size_t index_a) const;
+	/** Resets all counters. Increments made at the same time may be lost */
+	void clear ();
+	size_t const count;
+	size_t const shards;
+	/** Hardware threads, up to 16 */
+	static size_t default_shards ();
+
+private:
+	/** A small number per thread, assigned in order of first use */
+	static unsigned thread_shard ()
+	{
+		static std::atomic<unsigned> dispenser{ 0 };
+		thread_local unsigned const result (dispenser++);
+		return result;
+	}
+	/** Distance between the shards in counters, whole cache lines with one line of padding */
+	size_t const stride;
+	std::vector<std::atomic<uint64_t>> counters;
+};
+
+/**
+ * Distribution of durations over fixed buckets, from tens of microseconds to minutes. Observations are relaxed atomic
+ * adds, so a snapshot taken while observing may be slightly inconsistent between the buckets, count and sum.
+ */
+class stat_latency_histogram final
+{
+public:
+	/** Upper bounds of the buckets, inclusive. A last bucket holds everything longer */
+	static std::array<std::chrono::microseconds, 20> const bounds;
+	void observe (std::chrono::nanoseconds const & duration_a);
+	void clear ();
+
+	class snapshot final
+	{
+	public:
+		/** Observations per bucket, not cumulative. The last is the unbounded bucket */
+		std::array<uint64_t, std::tuple_size<decltype (bounds)>::value + 1> buckets{};
+		uint64_t count{ 0 };
+		std::chrono::nanoseconds sum{ 0 };
+	};
+	nano::stat_latency_histogram::snapshot get () const;
+
+private:
+	std::array<std::atomic<uint64_t>, std::tuple_size<decltype (bounds)>::value + 1> buckets{};
+	std::atomic<uint64_t> sum_ns{ 0 };
+};
+
 /** Log sink interface */
 class stat_log_sink
 {
@@ -242,7 +304,15 @@ public:
 		requests,
 		filter,
 		telemetry,
-		vote_generator
+		vote_generator,
+		work,
+		traffic_shaper_queue,
+		traffic_shaper_drop,
+		tcp_lane_drop,
+		rpc,
+
+		/** Number of types */
+		_last
 	};
 
 	/** Optional detail type */
@@ -342,6 +412,7 @@ public:
 		tcp_write_drop,
 		tcp_write_no_socket_drop,
 		tcp_excluded,
+		tcp_write_batch,
 
 		// ipc
 		invocations,
@@ -384,14 +455,66 @@ public:
 		generator_broadcasts,
 		generator_replies,
 		generator_replies_discarded,
-		generator_spacing
+		generator_spacing,
+
+		// work pool
+		work_solved,
+		work_cancelled,
+		work_expired,
+		queue_wait,
+		solve_time,
+
+		// wallet work precache
+		precache_hit,
+		precache_miss,
+		precache_generated,
+		precache_throttled,
+
+		// rpc specific
+		request_shard,
+
+		// traffic shaper classes, besides confirm_req and publish
+		vote,
+		bootstrap,
+		telemetry,
+		generic,
+
+		/** Number of details */
+		_last
+	};
+
+	/** Durations with a latency histogram */
+	enum class latency : uint8_t
+	{
+		/** Processing a block in the block processor */
+		block_processing,
+		/** Checking the signatures of a batch of votes */
+		vote_verification,
+		/** From the start of an election until it is confirmed */
+		election,
+		/** Writing a batch of confirmation heights */
+		cementing,
+		/** Waiting to be the database writer */
+		write_queue_wait,
+		/** Waiting in a lane of realtime messages received over TCP, one per nano::tcp_message_lane */
+		tcp_lane_generic,
+		tcp_lane_vote,
+		tcp_lane_publish,
+		tcp_lane_confirm_req,
+		tcp_lane_telemetry,
+
+		/** Number of latencies */
+		_last
 	};
 
 	/** Direction of the stat. If the direction is irrelevant, use in */
 	enum class dir : uint8_t
 	{
 		in,
-		out
+		out,
+
+		/** Number of directions */
+		_last
 	};
 
 	/** Constructor using the default config values */
@@ -481,6 +604,26 @@ public:
 	/** Returns a non-owning histogram pointer, or nullptr if a histogram is not defined */
 	nano::stat_histogram * get_histogram (stat::type type, stat::detail detail, stat::dir dir);
 
+	/** Adds \p duration to the latency histogram of \p latency. Doesn't take a lock */
+	void observe (stat::latency latency, std::chrono::nanoseconds const & duration)
+	{
+		if (!stopped.load (std::memory_order_relaxed))
+		{
+			latencies[static_cast<size_t> (latency)].observe (duration);
+		}
+	}
+
+	nano::stat_latency_histogram::snapshot latency_snapshot (stat::latency latency) const
+	{
+		return latencies[static_cast<size_t> (latency)].get ();
+	}
+
+	/**
+	 * Calls \p visitor with the type, detail and direction names and the value of every non zero counter, in key order.
+	 * Doesn't take a lock, counters keep changing while visited.
+	 */
+	void visit_counters (std::function<void(std::string const &, std::string const &, std::string const &, uint64_t)> const & visitor) const;
+
 	/**
 	 * Add \p value to stat. If sampling is configured, this will update the current sample and
 	 * call any sample observers if the interval is over.
@@ -534,6 +677,7 @@ public:
 	void observe_count (stat::type type, stat::detail detail, stat::dir dir, std::function<void(uint64_t, uint64_t)> observer)
 	{
 		get_entry (key_of (type, detail, dir))->count_observers.add (observer);
+		slow_path = true;
 	}
 
 	/** Returns a potentially empty list of the last N samples, where N is determined by the 'capacity' configuration */
@@ -551,7 +695,7 @@ public:
 	/** Returns current value for the given counter at the detail level */
 	uint64_t count (stat::type type, stat::detail detail, stat::dir dir = stat::dir::in)
 	{
-		return get_entry (key_of (type, detail, dir))->counter.get_value ();
+		return counters.get (index_of (key_of (type, detail, dir)));
 	}
 
 	/** Returns the number of seconds since clear() was last called, or node startup if it's never called. */
@@ -572,6 +716,8 @@ public:
 	/** Returns string representation of detail */
 	static std::string detail_to_string (uint32_t key);
 
+	static std::string latency_to_string (stat::latency latency);
+
 	/** Stop stats being output */
 	void stop ();
 
@@ -585,6 +731,21 @@ private:
 		return static_cast<uint8_t> (type) << 16 | static_cast<uint8_t> (detail) << 8 | static_cast<uint8_t> (dir);
 	}
 
+	static size_t constexpr type_count = static_cast<size_t> (stat::type::_last);
+	static size_t constexpr detail_count = static_cast<size_t> (stat::detail::_last);
+	static size_t constexpr dir_count = static_cast<size_t> (stat::dir::_last);
+
+	/** Index of the counter for a key */
+	static size_t index_of (uint32_t key)
+	{
+		auto result (((key >> 16 & 0xff) * detail_count + (key >> 8 & 0xff)) * dir_count + (key & 0xff));
+		debug_assert (result < type_count * detail_count * dir_count);
+		return result;
+	}
+
+	/** Inverse of index_of */
+	static uint32_t key_of_index (size_t index);
+
 	/** Get entry for key, creating a new entry if necessary, using interval and sample count from config */
 	std::shared_ptr<nano::stat_entry> get_entry (uint32_t key);
 
@@ -595,11 +756,25 @@ private:
 	std::shared_ptr<nano::stat_entry> get_entry_impl (uint32_t key, size_t sample_interval, size_t max_samples);
 
 	/**
-	 * Update count and sample and call any observers on the key
+	 * Update count and sample and call any observers on the key. Unless sampling, counter logging or observers
+	 * are used this only increments the counter.
 	 * @param key a key constructor from stat::type, stat::detail and stat::direction
 	 * @value Amount to add to the counter
 	 */
-	void update (uint32_t key, uint64_t value);
+	void update (uint32_t key, uint64_t value)
+	{
+		if (!stopped.load (std::memory_order_relaxed))
+		{
+			counters.add (index_of (key), value);
+			if (slow_path.load (std::memory_order_relaxed))
+			{
+				update_slow (key, value);
+			}
+		}
+	}
+
+	/** Sampling, counter logging and observers, under the mutex */
+	void update_slow (uint32_t key, uint64_t value);
 
 	/** Unlocked implementation of log_counters() to avoid using recursive locking */
 	void log_counters_impl (stat_log_sink & sink);
@@ -613,13 +788,21 @@ private:
 	/** Configuration deserialized from config.json */
 	nano::stat_config config;
 
-	/** Stat entries are sorted by key to simplify processing of log output */
+	/** Counters for all keys */
+	nano::stat_counters counters{ type_count * detail_count * dir_count };
+
+	std::array<nano::stat_latency_histogram, static_cast<size_t> (stat::latency::_last)> latencies;
+
+	/** Set if updates need more than incrementing the counter */
+	std::atomic<bool> slow_path{ false };
+
+	/** Samples, histograms and observers. Entries are sorted by key to simplify processing of log output */
 	std::map<uint32_t, std::shared_ptr<nano::stat_entry>> entries;
 	std::chrono::steady_clock::time_point log_last_count_writeout{ std::chrono::steady_clock::now () };
 	std::chrono::steady_clock::time_point log_last_sample_writeout{ std::chrono::steady_clock::now () };
 
 	/** Whether stats should be output */
-	bool stopped{ false };
+	std::atomic<bool> stopped{ false };
 
 	/** All access to stat is thread safe, including calls from observers on the same thread */
 	nano::mutex stat_mutex;
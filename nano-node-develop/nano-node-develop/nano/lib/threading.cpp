@@ -7,10 +7,174 @@
 #include <future>
 #include <iostream>
 #include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
 
 namespace
 {
 thread_local nano::thread_role::name current_thread_role = nano::thread_role::name::unknown;
+
+#if defined(__linux__)
+std::chrono::nanoseconds thread_cpu_time (clockid_t clock_a)
+{
+	timespec time_l{};
+	clock_gettime (clock_a, &time_l);
+	return std::chrono::seconds (time_l.tv_sec) + std::chrono::nanoseconds (time_l.tv_nsec);
+}
+
+/**
+ * Threads with a role, so their CPU time can be read and they can be pinned to the CPUs of their role.
+ * Deliberately never destroyed, as threads may exit after static destruction
+ */
+class thread_cpu_registry final
+{
+public:
+	thread_cpu_registry ()
+	{
+		CPU_ZERO (&available);
+		sched_getaffinity (0, sizeof (available), &available);
+	}
+	/** Attributes the CPU time of the calling thread from now on to \p role_a */
+	void enter (nano::thread_role::name role_a)
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		auto now (thread_cpu_time (CLOCK_THREAD_CPUTIME_ID));
+		auto existing (threads.find (pthread_self ()));
+		if (existing != threads.end ())
+		{
+			exited[existing->second.role] += now - existing->second.start;
+			existing->second = thread{ role_a, now };
+		}
+		else
+		{
+			threads.emplace (pthread_self (), thread{ role_a, now });
+		}
+		if (pinned)
+		{
+			pin (pthread_self (), role_a);
+		}
+	}
+	void exit ()
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		auto existing (threads.find (pthread_self ()));
+		if (existing != threads.end ())
+		{
+			exited[existing->second.role] += thread_cpu_time (CLOCK_THREAD_CPUTIME_ID) - existing->second.start;
+			threads.erase (existing);
+		}
+	}
+	std::map<nano::thread_role::name, std::chrono::nanoseconds> cpu_time ()
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		auto result (exited);
+		// Threads unregister before exiting, so all registered threads can still be queried
+		for (auto const & item : threads)
+		{
+			clockid_t clock_l;
+			if (pthread_getcpuclockid (item.first, &clock_l) == 0)
+			{
+				result[item.second.role] += thread_cpu_time (clock_l) - item.second.start;
+			}
+		}
+		return result;
+	}
+
+	void set_cpus (std::map<nano::thread_role::name, std::vector<unsigned>> const & cpus_a, std::vector<unsigned> const & isolated_a)
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		cpus.clear ();
+		for (auto const & item : cpus_a)
+		{
+			cpus[item.first] = to_cpu_set (item.second);
+		}
+		others = available;
+		for (auto cpu : isolated_a)
+		{
+			if (cpu < CPU_SETSIZE)
+			{
+				CPU_CLR (cpu, &others);
+			}
+		}
+		// With nothing configured every thread is given back all CPUs of the process and later threads are left alone
+		pinned = !cpus_a.empty () || !isolated_a.empty ();
+		for (auto const & item : threads)
+		{
+			pin (item.first, item.second.role);
+		}
+	}
+
+private:
+	cpu_set_t to_cpu_set (std::vector<unsigned> const & cpus_a) const
+	{
+		cpu_set_t result;
+		CPU_ZERO (&result);
+		for (auto cpu : cpus_a)
+		{
+			if (cpu < CPU_SETSIZE)
+			{
+				CPU_SET (cpu, &result);
+			}
+		}
+		// CPUs the process may not use are left out, they would make the whole set invalid
+		CPU_AND (&result, &result, &available);
+		return result;
+	}
+	/** Restricts \p thread_a to the CPUs of \p role_a. An empty set leaves the thread where it is */
+	void pin (pthread_t thread_a, nano::thread_role::name role_a)
+	{
+		auto existing (cpus.find (role_a));
+		auto const & set_l (existing != cpus.end () ? existing->second : others);
+		if (CPU_COUNT (&set_l) > 0)
+		{
+			pthread_setaffinity_np (thread_a, sizeof (set_l), &set_l);
+		}
+	}
+	class thread final
+	{
+	public:
+		nano::thread_role::name role;
+		/** CPU time of the thread when it got the role */
+		std::chrono::nanoseconds start;
+	};
+	std::mutex mutex;
+	std::unordered_map<pthread_t, thread> threads;
+	std::map<nano::thread_role::name, std::chrono::nanoseconds> exited;
+	/** CPUs the process was started with */
+	cpu_set_t available;
+	/** Whether set_cpus was called, before that threads are left alone */
+	bool pinned{ false };
+	std::map<nano::thread_role::name, cpu_set_t> cpus;
+	/** CPUs of roles without their own */
+	cpu_set_t others;
+};
+
+thread_cpu_registry & cpu_registry ()
+{
+	static auto registry (new thread_cpu_registry);
+	return *registry;
+}
+
+/** Unregisters the thread when it exits */
+class thread_cpu_guard final
+{
+public:
+	~thread_cpu_guard ()
+	{
+		if (registered)
+		{
+			cpu_registry ().exit ();
+		}
+	}
+	bool registered{ false };
+};
+thread_local thread_cpu_guard cpu_guard;
+#endif
 }
 
 nano::thread_role::name nano::thread_role::get ()
@@ -87,6 +251,18 @@ std::string nano::thread_role::get_string (nano::thread_role::name role)
 		case nano::thread_role::name::db_parallel_traversal:
 			thread_role_name_string = "DB par traversl";
 			break;
+		case nano::thread_role::name::ipc_shared_memory:
+			thread_role_name_string = "IPC shm";
+			break;
+		case nano::thread_role::name::work_precache:
+			thread_role_name_string = "Work precache";
+			break;
+		case nano::thread_role::name::log_writer:
+			thread_role_name_string = "Log writer";
+			break;
+		case nano::thread_role::name::traffic_shaping:
+			thread_role_name_string = "Traffic shaping";
+			break;
 	}
 
 	/*
@@ -111,6 +287,26 @@ void nano::thread_role::set (nano::thread_role::name role)
 	nano::thread_role::set_os_name (thread_role_name_string);
 
 	current_thread_role = role;
+#if defined(__linux__)
+	cpu_registry ().enter (role);
+	cpu_guard.registered = true;
+#endif
+}
+
+std::map<nano::thread_role::name, std::chrono::nanoseconds> nano::thread_role::cpu_time ()
+{
+#if defined(__linux__)
+	return cpu_registry ().cpu_time ();
+#else
+	return {};
+#endif
+}
+
+void nano::thread_role::set_cpus (std::map<nano::thread_role::name, std::vector<unsigned>> const & cpus_a, std::vector<unsigned> const & isolated_a)
+{
+#if defined(__linux__)
+	cpu_registry ().set_cpus (cpus_a, isolated_a);
+#endif
 }
 
 void nano::thread_attributes::set (boost::thread::attributes & attrs)
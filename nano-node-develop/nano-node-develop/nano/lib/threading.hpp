@@ -9,6 +9,10 @@
 
 #include <boost/thread/thread.hpp>
 
+#include <chrono>
+#include <map>
+#include <vector>
+
 namespace nano
 {
 /*
@@ -38,7 +42,11 @@ namespace thread_role
 		request_aggregator,
 		state_block_signature_verification,
 		epoch_upgrader,
-		db_parallel_traversal
+		db_parallel_traversal,
+		ipc_shared_memory,
+		work_precache,
+		log_writer,
+		traffic_shaping
 	};
 	/*
 	 * Get/Set the identifier for the current thread
@@ -60,6 +68,20 @@ namespace thread_role
 	 * Internal only, should not be called directly
 	 */
 	void set_os_name (std::string const &);
+
+	/*
+	 * CPU time used by the threads of each role since they were given the role, including threads which exited.
+	 * Only measured on Linux, elsewhere this is empty
+	 */
+	std::map<nano::thread_role::name, std::chrono::nanoseconds> cpu_time ();
+
+	/*
+	 * Pins the threads of each role in \p cpus_a to its CPUs, both those running and those given the role later.
+	 * Threads of other roles may run on any CPU available to the process, except \p isolated_a.
+	 * Passing neither resets every thread to the CPUs the process was started with.
+	 * Only applied on Linux, elsewhere threads are never pinned
+	 */
+	void set_cpus (std::map<nano::thread_role::name, std::vector<unsigned>> const & cpus_a, std::vector<unsigned> const & isolated_a);
 }
 
 namespace thread_attributes
@@ -0,0 +1,241 @@
+#include <nano/lib/diagnosticsconfig.hpp>
+#include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+class span_record final
+{
+public:
+	nano::tracing::span_type type;
+	uint64_t id;
+	uint64_t parent;
+	std::chrono::nanoseconds start;
+	std::chrono::nanoseconds duration;
+};
+
+/**
+ * Ring of the spans recorded by one thread. Only the owning thread writes, other threads read it while dumping.
+ * Each slot is a seqlock: its sequence is odd while written, so readers discard slots overwritten while copied.
+ */
+class thread_buffer final
+{
+public:
+	thread_buffer (size_t capacity_a, uint32_t thread_id_a) :
+	thread_id (thread_id_a),
+	role (nano::thread_role::get_string ()),
+	slots (std::max<size_t> (capacity_a, 1))
+	{
+	}
+	void push (span_record const & record_a)
+	{
+		auto position (head.load (std::memory_order_relaxed));
+		auto & slot (slots[position % slots.size ()]);
+		slot.sequence.store (position * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence (std::memory_order_release);
+		slot.type.store (static_cast<uint8_t> (record_a.type), std::memory_order_relaxed);
+		slot.id.store (record_a.id, std::memory_order_relaxed);
+		slot.parent.store (record_a.parent, std::memory_order_relaxed);
+		slot.start.store (record_a.start.count (), std::memory_order_relaxed);
+		slot.duration.store (record_a.duration.count (), std::memory_order_relaxed);
+		slot.sequence.store (position * 2 + 2, std::memory_order_release);
+		head.store (position + 1, std::memory_order_release);
+	}
+	void collect (std::vector<span_record> & records_a) const
+	{
+		auto head_l (head.load (std::memory_order_acquire));
+		auto begin (std::max<uint64_t> (head_l > slots.size () ? head_l - slots.size () : 0, cleared.load (std::memory_order_relaxed)));
+		for (auto position (begin); position < head_l; ++position)
+		{
+			auto const & slot (slots[position % slots.size ()]);
+			auto sequence (slot.sequence.load (std::memory_order_acquire));
+			if (sequence == position * 2 + 2)
+			{
+				span_record record{ static_cast<nano::tracing::span_type> (slot.type.load (std::memory_order_relaxed)), slot.id.load (std::memory_order_relaxed), slot.parent.load (std::memory_order_relaxed), std::chrono::nanoseconds (slot.start.load (std::memory_order_relaxed)), std::chrono::nanoseconds (slot.duration.load (std::memory_order_relaxed)) };
+				std::atomic_thread_fence (std::memory_order_acquire);
+				if (slot.sequence.load (std::memory_order_relaxed) == sequence)
+				{
+					records_a.push_back (record);
+				}
+			}
+		}
+	}
+	void clear ()
+	{
+		cleared.store (head.load (std::memory_order_acquire), std::memory_order_relaxed);
+	}
+	bool empty () const
+	{
+		return cleared.load (std::memory_order_relaxed) == head.load (std::memory_order_relaxed);
+	}
+	uint32_t const thread_id;
+	std::string const role;
+	/** Set when the owning thread exits */
+	std::atomic<bool> retired{ false };
+
+private:
+	class slot final
+	{
+	public:
+		std::atomic<uint64_t> sequence{ 0 };
+		std::atomic<uint8_t> type{ 0 };
+		std::atomic<uint64_t> id{ 0 };
+		std::atomic<uint64_t> parent{ 0 };
+		std::atomic<int64_t> start{ 0 };
+		std::atomic<int64_t> duration{ 0 };
+	};
+	std::vector<slot> slots;
+	std::atomic<uint64_t> head{ 0 };
+	/** Spans before this position were discarded */
+	std::atomic<uint64_t> cleared{ 0 };
+};
+
+/** Buffers of all threads which recorded spans. Deliberately never destroyed, as threads may exit after static destruction */
+class buffer_registry final
+{
+public:
+	std::shared_ptr<thread_buffer> create ()
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		auto result (std::make_shared<thread_buffer> (capacity, next_thread_id++));
+		// Keep spans of exited threads until there are too many of them
+		size_t retired_count (0);
+		auto kept (std::remove_if (buffers.rbegin (), buffers.rend (), [&retired_count](auto const & buffer_a) {
+			return buffer_a->retired && (buffer_a->empty () || ++retired_count > max_retired);
+		}));
+		// Removing from the newest keeps the most recent exited threads, kept buffers are moved to the back
+		buffers.erase (buffers.begin (), kept.base ());
+		buffers.push_back (result);
+		return result;
+	}
+	std::vector<std::shared_ptr<thread_buffer>> all ()
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		return buffers;
+	}
+	void set_capacity (size_t capacity_a)
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		capacity = capacity_a;
+	}
+	static size_t constexpr max_retired = 64;
+
+private:
+	std::mutex mutex;
+	std::vector<std::shared_ptr<thread_buffer>> buffers;
+	size_t capacity{ 16384 };
+	uint32_t next_thread_id{ 1 };
+};
+
+buffer_registry & registry ()
+{
+	static auto registry (new buffer_registry);
+	return *registry;
+}
+
+/** Retires the thread's buffer when it exits */
+class thread_buffer_owner final
+{
+public:
+	~thread_buffer_owner ()
+	{
+		if (buffer)
+		{
+			buffer->retired = true;
+		}
+	}
+	std::shared_ptr<thread_buffer> buffer;
+};
+thread_local thread_buffer_owner current_buffer;
+}
+
+char const * nano::tracing::to_string (nano::tracing::span_type type_a)
+{
+	switch (type_a)
+	{
+		case nano::tracing::span_type::message_parse:
+			return "message_parse";
+		case nano::tracing::span_type::block_process:
+			return "block_process";
+		case nano::tracing::span_type::active_insert:
+			return "active_insert";
+		case nano::tracing::span_type::vote_process:
+			return "vote_process";
+		case nano::tracing::span_type::election_vote:
+			return "election_vote";
+		case nano::tracing::span_type::cementing:
+			return "cementing";
+		case nano::tracing::span_type::observers:
+			return "observers";
+		case nano::tracing::span_type::_last:
+			break;
+	}
+	return "unknown";
+}
+
+void nano::tracing::configure (nano::tracing_config const & config_a)
+{
+	registry ().set_capacity (config_a.buffer_size);
+	detail::sample_rate = std::max (config_a.sample_rate, 1u);
+	detail::enabled = config_a.enable;
+}
+
+void nano::tracing::detail::record (nano::tracing::span_type type_a, uint64_t id_a, uint64_t parent_a, std::chrono::steady_clock::time_point start_a, std::chrono::steady_clock::time_point end_a)
+{
+	if (!current_buffer.buffer)
+	{
+		current_buffer.buffer = registry ().create ();
+	}
+	current_buffer.buffer->push ({ type_a, id_a, parent_a, start_a.time_since_epoch (), end_a - start_a });
+}
+
+void nano::tracing::clear ()
+{
+	for (auto const & buffer : registry ().all ())
+	{
+		buffer->clear ();
+	}
+}
+
+std::string nano::tracing::dump_chrome_json ()
+{
+	std::ostringstream result;
+	result << std::fixed << std::setprecision (3);
+	result << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	auto first (true);
+	auto separator ([&result, &first]() {
+		result << (first ? "\n" : ",\n");
+		first = false;
+	});
+	std::vector<span_record> records;
+	for (auto const & buffer : registry ().all ())
+	{
+		separator ();
+		result << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":\"" << buffer->role << "\"}}";
+		records.clear ();
+		buffer->collect (records);
+		for (auto const & record : records)
+		{
+			separator ();
+			// Timestamps are microseconds, fractions keep nanosecond resolution
+			result << "{\"ph\":\"X\",\"cat\":\"nano\",\"name\":\"" << to_string (record.type) << "\",\"pid\":1,\"tid\":" << buffer->thread_id;
+			result << ",\"ts\":" << record.start.count () / 1000.0 << ",\"dur\":" << record.duration.count () / 1000.0;
+			result << ",\"args\":{\"id\":\"" << nano::to_string_hex (record.id) << "\"";
+			if (record.parent != 0)
+			{
+				result << ",\"parent\":\"" << nano::to_string_hex (record.parent) << "\"";
+			}
+			result << "}}";
+		}
+	}
+	result << "\n]}\n";
+	return result.str ();
+}
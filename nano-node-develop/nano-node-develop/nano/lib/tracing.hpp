@@ -0,0 +1,145 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace nano
+{
+class tracing_config;
+/**
+ * Spans of the block and vote lifecycle, recorded into a lock free ring buffer per thread and dumped as Chrome trace
+ * JSON, which chrome://tracing and Perfetto load.
+ * Instrumentation uses NANO_TRACE_SPAN, which is only compiled in when building with NANO_TRACING. Recording is then
+ * enabled by the diagnostics.tracing config. Spans are sampled by id, so all spans of a sampled block are kept.
+ * Each span records the id of the span enclosing it on the same thread as its parent, which links work keyed by
+ * different ids, such as the election_vote spans (block hash) of a vote_process span (vote signature).
+ */
+namespace tracing
+{
+	enum class span_type : uint8_t
+	{
+		message_parse,
+		block_process,
+		active_insert,
+		vote_process,
+		election_vote,
+		cementing,
+		observers,
+		_last
+	};
+	char const * to_string (nano::tracing::span_type);
+
+	/** Tracing state is process wide, so this is called once by the entry point rather than by each node */
+	void configure (nano::tracing_config const &);
+	/** Discards all recorded spans */
+	void clear ();
+	/** Spans in all thread buffers as a Chrome trace event object, oldest first */
+	std::string dump_chrome_json ();
+
+	class span;
+	namespace detail
+	{
+		inline std::atomic<bool> enabled{ false };
+		inline std::atomic<uint32_t> sample_rate{ 1 };
+		/** Innermost recording span of the thread, the parent of spans started in its scope */
+		inline thread_local nano::tracing::span * current{ nullptr };
+		void record (nano::tracing::span_type, uint64_t id_a, uint64_t parent_a, std::chrono::steady_clock::time_point start_a, std::chrono::steady_clock::time_point end_a);
+	}
+
+	/** Whether spans with \p id_a are recorded. Ids are mixed first, as some are small sequential numbers */
+	inline bool sampled (uint64_t id_a)
+	{
+		auto rate (detail::sample_rate.load (std::memory_order_relaxed));
+		return rate <= 1 || ((id_a * 0x9e3779b97f4a7c15ULL) >> 32) % rate == 0;
+	}
+
+	/** Block hashes identify spans of a block */
+	inline uint64_t id (nano::uint256_union const & hash_a)
+	{
+		return hash_a.qwords[0];
+	}
+
+	/** Signatures identify spans of a vote */
+	inline uint64_t id (nano::uint512_union const & signature_a)
+	{
+		return signature_a.qwords[0];
+	}
+
+	/**
+	 * Records the duration of its scope. The id can be given later, for work which only learns it while running.
+	 * Spans of a thread must end in the reverse order they started, as with nested scopes
+	 */
+	class span final
+	{
+	public:
+		explicit span (nano::tracing::span_type type_a, uint64_t id_a = 0) :
+		type (type_a),
+		id (id_a),
+		active (detail::enabled.load (std::memory_order_relaxed))
+		{
+			if (active)
+			{
+				parent = detail::current;
+				detail::current = this;
+				start = std::chrono::steady_clock::now ();
+			}
+		}
+		span (span const &) = delete;
+		~span ()
+		{
+			end ();
+		}
+		void identify (uint64_t id_a)
+		{
+			id = id_a;
+		}
+		/** Drops the span, such as when the work turned out to be invalid */
+		void cancel ()
+		{
+			if (active)
+			{
+				detail::current = parent;
+			}
+			active = false;
+		}
+		/** Records the span now rather than at the end of its scope, when only the start of the scope is traced */
+		void end ()
+		{
+			if (active)
+			{
+				auto parent_id (parent != nullptr ? parent->id : 0);
+				// Kept with its parent too, so a sampled vote keeps the election_vote spans of its blocks
+				if (sampled (id) || (parent != nullptr && sampled (parent_id)))
+				{
+					detail::record (type, id, parent_id, start, std::chrono::steady_clock::now ());
+				}
+				detail::current = parent;
+			}
+			active = false;
+		}
+
+	private:
+		nano::tracing::span_type type;
+		uint64_t id;
+		bool active;
+		nano::tracing::span * parent{ nullptr };
+		std::chrono::steady_clock::time_point start;
+	};
+}
+}
+
+#if NANO_TRACING
+#define NANO_TRACE_SPAN(name_a, type_a, id_a) nano::tracing::span name_a (nano::tracing::span_type::type_a, id_a)
+#define NANO_TRACE_IDENTIFY(name_a, id_a) name_a.identify (id_a)
+#define NANO_TRACE_CANCEL(name_a) name_a.cancel ()
+#define NANO_TRACE_END(name_a) name_a.end ()
+#else
+#define NANO_TRACE_SPAN(name_a, type_a, id_a)
+#define NANO_TRACE_IDENTIFY(name_a, id_a)
+#define NANO_TRACE_CANCEL(name_a)
+#define NANO_TRACE_END(name_a)
+#endif
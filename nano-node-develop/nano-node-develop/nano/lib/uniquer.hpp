@@ -0,0 +1,216 @@
+#pragma once
+
+#include <nano/lib/locks.hpp>
+#include <nano/lib/numbers.hpp>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Weak references to shared objects by their full hash, the table behind block_uniquer and vote_uniquer.
+ * Entries are spread over shards with their own lock, so the threads deserializing messages rarely contend. Each shard
+ * is an open addressing table with linear probing, a lookup touches a few adjacent entries and inserting allocates
+ * nothing until the shard grows. Entries of expired objects are reclaimed as unique sweeps over the shards in turn,
+ * or when a full shard is rebuilt.
+ */
+template <typename T>
+class uniquer_table final
+{
+public:
+	explicit uniquer_table (char const * mutex_name_a)
+	{
+		for (auto i (0u); i < shard_count; ++i)
+		{
+			shards.emplace_back (mutex_name_a);
+		}
+	}
+
+	/** @return The live object stored for \p key_a, otherwise stores and returns \p value_a */
+	std::shared_ptr<T> unique (nano::uint256_union const & key_a, std::shared_ptr<T> const & value_a)
+	{
+		auto result (value_a);
+		{
+			auto & shard_l (shards[key_a.qwords[0] % shard_count]);
+			nano::lock_guard<nano::mutex> lock (shard_l.mutex);
+			if ((shard_l.used + shard_l.reclaimed + 1) * 4 > shard_l.entries.size () * 3)
+			{
+				rebuild (shard_l);
+			}
+			auto mask (shard_l.entries.size () - 1);
+			auto free (shard_l.entries.size ());
+			auto done (false);
+			for (auto i (key_a.qwords[1] & mask); !done; i = (i + 1) & mask)
+			{
+				auto & entry_l (shard_l.entries[i]);
+				switch (entry_l.state)
+				{
+					case entry_state::empty:
+						// The key isn't stored, it goes into the first slot it may take
+						free = free != shard_l.entries.size () ? free : i;
+						if (shard_l.entries[free].state == entry_state::reclaimed)
+						{
+							--shard_l.reclaimed;
+						}
+						shard_l.entries[free] = { key_a, value_a, entry_state::used };
+						++shard_l.used;
+						done = true;
+						break;
+					case entry_state::reclaimed:
+						free = free != shard_l.entries.size () ? free : i;
+						break;
+					case entry_state::used:
+						if (entry_l.key == key_a)
+						{
+							if (auto existing = entry_l.value.lock ())
+							{
+								result = existing;
+							}
+							else
+							{
+								entry_l.value = value_a;
+							}
+							done = true;
+						}
+						break;
+				}
+			}
+		}
+		sweep ();
+		return result;
+	}
+
+	/** @return The live object stored for \p key_a, if any */
+	std::shared_ptr<T> find (nano::uint256_union const & key_a) const
+	{
+		std::shared_ptr<T> result;
+		auto const & shard_l (shards[key_a.qwords[0] % shard_count]);
+		nano::lock_guard<nano::mutex> lock (shard_l.mutex);
+		auto mask (shard_l.entries.size () - 1);
+		// Shards are rebuilt before they fill up, so a probe sequence always ends with an empty entry
+		for (auto i (key_a.qwords[1] & mask); shard_l.entries[i].state != entry_state::empty; i = (i + 1) & mask)
+		{
+			auto const & entry_l (shard_l.entries[i]);
+			if (entry_l.state == entry_state::used && entry_l.key == key_a)
+			{
+				result = entry_l.value.lock ();
+				break;
+			}
+		}
+		return result;
+	}
+
+	/** Entries not reclaimed yet, including those of expired objects */
+	size_t size () const
+	{
+		size_t result (0);
+		for (auto const & shard_l : shards)
+		{
+			nano::lock_guard<nano::mutex> lock (shard_l.mutex);
+			result += shard_l.used;
+		}
+		return result;
+	}
+
+	static size_t constexpr shard_count = 16;
+	/** Entries of a shard when created, a power of two */
+	static size_t constexpr initial_capacity = 8;
+	/** Entries checked for expired objects by each call to unique */
+	static unsigned constexpr cleanup_count = 2;
+
+private:
+	enum class entry_state : uint8_t
+	{
+		empty,
+		used,
+		/** Was used, keeps probe sequences running through it intact */
+		reclaimed
+	};
+	class entry final
+	{
+	public:
+		nano::uint256_union key;
+		std::weak_ptr<T> value;
+		entry_state state{ entry_state::empty };
+	};
+	class shard final
+	{
+	public:
+		explicit shard (char const * mutex_name_a) :
+		mutex (mutex_name_a),
+		entries (initial_capacity)
+		{
+		}
+		mutable nano::mutex mutex;
+		std::vector<entry> entries;
+		size_t used{ 0 };
+		size_t reclaimed{ 0 };
+		/** Next entry to be swept */
+		size_t cursor{ 0 };
+	};
+
+	/** Drops reclaimed and expired entries, growing \p shard_a so live entries fill at most half of it */
+	void rebuild (shard & shard_a)
+	{
+		std::vector<entry> live;
+		live.reserve (shard_a.used);
+		for (auto & entry_l : shard_a.entries)
+		{
+			if (entry_l.state == entry_state::used && !entry_l.value.expired ())
+			{
+				live.push_back (std::move (entry_l));
+			}
+		}
+		auto capacity (initial_capacity);
+		while (capacity < (live.size () + 1) * 2)
+		{
+			capacity *= 2;
+		}
+		shard_a.entries.assign (capacity, entry{});
+		auto mask (capacity - 1);
+		for (auto & entry_l : live)
+		{
+			auto i (entry_l.key.qwords[1] & mask);
+			while (shard_a.entries[i].state != entry_state::empty)
+			{
+				i = (i + 1) & mask;
+			}
+			shard_a.entries[i] = std::move (entry_l);
+		}
+		shard_a.used = live.size ();
+		shard_a.reclaimed = 0;
+		shard_a.cursor = 0;
+	}
+
+	void sweep ()
+	{
+		auto & shard_l (shards[next_sweep++ % shard_count]);
+		nano::lock_guard<nano::mutex> lock (shard_l.mutex);
+		for (auto i (0u); i < cleanup_count; ++i)
+		{
+			shard_l.cursor = shard_l.cursor % shard_l.entries.size ();
+			auto & entry_l (shard_l.entries[shard_l.cursor++]);
+			if (entry_l.state == entry_state::used && entry_l.value.expired ())
+			{
+				entry_l.value.reset ();
+				entry_l.state = entry_state::reclaimed;
+				--shard_l.used;
+				++shard_l.reclaimed;
+			}
+		}
+	}
+
+	std::deque<shard> shards;
+	std::atomic<size_t> next_sweep{ 0 };
+};
+
+template <typename T>
+size_t constexpr uniquer_table<T>::shard_count;
+template <typename T>
+size_t constexpr uniquer_table<T>::initial_capacity;
+template <typename T>
+unsigned constexpr uniquer_table<T>::cleanup_count;
+}
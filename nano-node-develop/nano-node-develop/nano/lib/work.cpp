@@ -1,6 +1,7 @@
 #include <nano/crypto_lib/random_pool.hpp>
 #include <nano/lib/blocks.hpp>
 #include <nano/lib/epoch.hpp>
+#include <nano/lib/stats.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/work.hpp>
 #include <nano/node/xorshift.hpp>
@@ -198,10 +199,28 @@ double nano::denormalized_multiplier (double const multiplier_a, uint64_t const
 	return multiplier;
 }
 
-nano::work_pool::work_pool (unsigned max_threads_a, std::chrono::nanoseconds pow_rate_limiter_a, std::function<boost::optional<uint64_t> (nano::work_version const, nano::root const &, uint64_t, std::atomic<int> &)> opencl_a) :
-ticket (0),
+std::string nano::to_string (nano::work_priority const priority_a)
+{
+	std::string result ("invalid");
+	switch (priority_a)
+	{
+		case nano::work_priority::high:
+			result = "high";
+			break;
+		case nano::work_priority::normal:
+			result = "normal";
+			break;
+		case nano::work_priority::low:
+			result = "low";
+			break;
+	}
+	return result;
+}
+
+nano::work_pool::work_pool (unsigned max_threads_a, std::chrono::nanoseconds pow_rate_limiter_a, std::function<boost::optional<uint64_t> (nano::work_version const, nano::root const &, uint64_t, std::atomic<int> &)> opencl_a, nano::work_kernel kernel_a) :
 done (false),
 pow_rate_limiter (pow_rate_limiter_a),
+kernel (kernel_a),
 opencl (opencl_a)
 {
 	static_assert (ATOMIC_INT_LOCK_FREE == 2, "Atomic int needed");
@@ -237,54 +256,63 @@ void nano::work_pool::loop (uint64_t thread)
 	// Quick RNG for work attempts.
 	xorshift1024star rng;
 	nano::random_pool::generate_block (reinterpret_cast<uint8_t *> (rng.s.data ()), rng.s.size () * sizeof (decltype (rng.s)::value_type));
-	uint64_t work;
-	uint64_t output;
-	blake2b_state hash;
-	blake2b_init (&hash, sizeof (output));
 	nano::unique_lock<nano::mutex> lock (mutex);
 	auto pow_sleep = pow_rate_limiter;
 	while (!done)
 	{
-		auto empty (pending.empty ());
-		if (thread == 0)
+		auto now (std::chrono::steady_clock::now ());
+		auto expired (expire (now));
+		if (!expired.empty ())
 		{
-			// Only work thread 0 notifies work observers
-			work_observers.notify (!empty);
+			lock.unlock ();
+			for (auto const & item : expired)
+			{
+				if (item->callback)
+				{
+					item->callback (boost::none);
+				}
+			}
+			lock.lock ();
+			continue;
 		}
-		if (!empty)
+		if (thread == 0 && working != !pending.empty ())
 		{
-			auto current_l (pending.front ());
-			int ticket_l (ticket);
+			// Only work thread 0 notifies work observers, when the pool starts or stops working
+			working = !pending.empty ();
+			work_observers.notify (working);
+		}
+		auto current_l (select ());
+		if (current_l != nullptr)
+		{
+			int ticket_l (current_l->ticket);
+			auto preempted_l (current_l->preempted.load ());
 			lock.unlock ();
-			output = 0;
+			uint64_t work{ 0 };
+			uint64_t output{ 0 };
+			auto found (false);
 			boost::optional<uint64_t> opt_work;
 			if (thread == 0 && opencl)
 			{
-				opt_work = opencl (current_l.version, current_l.item, current_l.difficulty, ticket);
+				opt_work = opencl (current_l->version, current_l->item, current_l->difficulty, current_l->ticket);
 			}
 			if (opt_work.is_initialized ())
 			{
 				work = *opt_work;
-				output = nano::work_v1::value (current_l.item, work);
+				output = nano::work_v1::value (current_l->item, work);
+				found = true;
 			}
 			else
 			{
-				// ticket != ticket_l indicates a different thread found a solution and we should stop
-				while (ticket == ticket_l && output < current_l.difficulty)
+				nano::work_v1::precomputed_state state (current_l->item);
+				// Nonces are tried in sequence from a random start, the space is large enough for threads not to overlap
+				auto nonce (rng.next ());
+				uint64_t attempts (0);
+				// A changed ticket means another thread found a solution or the request ended, a changed preempted count that a more urgent request arrived
+				while (current_l->ticket == ticket_l && current_l->preempted == preempted_l && !found && attempts < slice_attempts)
 				{
-					// Don't query main memory every iteration in order to reduce memory bus traffic
-					// All operations here operate on stack memory
-					// Count iterations down to zero since comparing to zero is easier than comparing to another number
-					unsigned iteration (256);
-					while (iteration && output < current_l.difficulty)
-					{
-						work = rng.next ();
-						blake2b_update (&hash, reinterpret_cast<uint8_t *> (&work), sizeof (work));
-						blake2b_update (&hash, current_l.item.bytes.data (), current_l.item.bytes.size ());
-						blake2b_final (&hash, reinterpret_cast<uint8_t *> (&output), sizeof (output));
-						blake2b_init (&hash, sizeof (output));
-						iteration -= 1;
-					}
+					// Don't query the shared state every attempt in order to reduce memory bus traffic
+					found = nano::work_v1::search (kernel, state, current_l->difficulty, nonce, 256, work, output);
+					attempts += 256;
 
 					// Add a rate limiter (if specified) to the pow calculation to save some CPUs which don't want to operate at full throttle
 					if (pow_sleep != std::chrono::nanoseconds (0))
@@ -294,55 +322,174 @@ void nano::work_pool::loop (uint64_t thread)
 				}
 			}
 			lock.lock ();
-			if (ticket == ticket_l)
+			release (*current_l);
+			if (found && current_l->ticket == ticket_l)
 			{
 				// If the ticket matches what we started with, we're the ones that found the solution
-				debug_assert (output >= current_l.difficulty);
-				debug_assert (current_l.difficulty == 0 || nano::work_v1::value (current_l.item, work) == output);
-				// Signal other threads to stop their work next time they check ticket
-				++ticket;
-				pending.pop_front ();
+				debug_assert (output >= current_l->difficulty);
+				debug_assert (current_l->difficulty == 0 || nano::work_v1::value (current_l->item, work) == output);
+				remove (current_l);
+				record (*current_l, std::chrono::steady_clock::now (), true);
 				lock.unlock ();
-				current_l.callback (work);
+				current_l->callback (work);
 				lock.lock ();
 			}
+			else if (current_l->ticket == ticket_l)
+			{
+				// The slice is over, requests which tie are served round robin
+				auto existing (std::find (pending.begin (), pending.end (), current_l));
+				if (existing != pending.end ())
+				{
+					pending.splice (pending.end (), pending, existing);
+				}
+			}
 			else
 			{
-				// A different thread found a solution
+				// A different thread found a solution or the request ended
 			}
 		}
 		else
 		{
-			// Wait for a work request
+			// Any pending request can be selected, so there is nothing to expire while waiting for one
 			producer_condition.wait (lock);
 		}
 	}
 }
 
-void nano::work_pool::cancel (nano::root const & root_a)
+std::shared_ptr<nano::work_item> nano::work_pool::select ()
 {
-	nano::lock_guard<nano::mutex> lock (mutex);
-	if (!done)
+	std::shared_ptr<nano::work_item> result;
+	auto client_threads_count = [this](nano::account const & client_a) {
+		auto existing (client_threads.find (client_a));
+		return existing != client_threads.end () ? existing->second : 0u;
+	};
+	// Lowest priority value, then fewest threads on the client, then on the request, then the longest waiting
+	auto better = [&client_threads_count](nano::work_item const & a, nano::work_item const & b) {
+		if (a.schedule.priority != b.schedule.priority)
+		{
+			return a.schedule.priority < b.schedule.priority;
+		}
+		auto a_client (client_threads_count (a.schedule.client));
+		auto b_client (client_threads_count (b.schedule.client));
+		if (a_client != b_client)
+		{
+			return a_client < b_client;
+		}
+		return a.threads < b.threads;
+	};
+	for (auto const & item : pending)
+	{
+		if (result == nullptr || better (*item, *result))
+		{
+			result = item;
+		}
+	}
+	if (result != nullptr)
+	{
+		if (result->threads == 0 && result->started == std::chrono::steady_clock::time_point ())
+		{
+			result->started = std::chrono::steady_clock::now ();
+		}
+		++result->threads;
+		++client_threads[result->schedule.client];
+	}
+	return result;
+}
+
+void nano::work_pool::release (nano::work_item & item_a)
+{
+	debug_assert (item_a.threads > 0);
+	--item_a.threads;
+	auto existing (client_threads.find (item_a.schedule.client));
+	debug_assert (existing != client_threads.end () && existing->second > 0);
+	if (--existing->second == 0)
+	{
+		client_threads.erase (existing);
+	}
+}
+
+std::vector<std::shared_ptr<nano::work_item>> nano::work_pool::expire (std::chrono::steady_clock::time_point const & now_a)
+{
+	std::vector<std::shared_ptr<nano::work_item>> result;
+	for (auto i (pending.begin ()), n (pending.end ()); i != n;)
 	{
-		if (!pending.empty ())
+		if ((*i)->schedule.deadline <= now_a)
 		{
-			if (pending.front ().item == root_a)
+			auto item (*i);
+			i = pending.erase (i);
+			++item->ticket;
+			if (item->schedule.stats != nullptr)
 			{
-				++ticket;
+				item->schedule.stats->inc (nano::stat::type::work, nano::stat::detail::work_expired);
 			}
+			result.push_back (item);
+		}
+		else
+		{
+			++i;
+		}
+	}
+	return result;
+}
+
+void nano::work_pool::remove (std::shared_ptr<nano::work_item> const & item_a)
+{
+	// Signal other threads to stop working on it next time they check the ticket
+	++item_a->ticket;
+	pending.remove (item_a);
+}
+
+void nano::work_pool::record (nano::work_item const & item_a, std::chrono::steady_clock::time_point const & now_a, bool solved_a)
+{
+	if (auto stats_l = item_a.schedule.stats)
+	{
+		stats_l->inc (nano::stat::type::work, solved_a ? nano::stat::detail::work_solved : nano::stat::detail::work_cancelled);
+		if (solved_a)
+		{
+			auto milliseconds = [](auto const & duration_a) {
+				return static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::milliseconds> (duration_a).count ());
+			};
+			stats_l->update_histogram (nano::stat::type::work, nano::stat::detail::queue_wait, nano::stat::dir::in, milliseconds (item_a.started - item_a.queued), 1);
+			stats_l->update_histogram (nano::stat::type::work, nano::stat::detail::solve_time, nano::stat::dir::in, milliseconds (now_a - item_a.started), 1);
 		}
-		pending.remove_if ([&root_a](decltype (pending)::value_type const & item_a) {
-			bool result{ false };
-			if (item_a.item == root_a)
+	}
+}
+
+void nano::work_pool::define_histograms (nano::stat & stats_a)
+{
+	// Milliseconds, the last bin collects everything from a minute
+	stats_a.define_histogram (nano::stat::type::work, nano::stat::detail::queue_wait, nano::stat::dir::in, { 0, 1, 10, 100, 1000, 10000, 60000, std::numeric_limits<uint64_t>::max () });
+	stats_a.define_histogram (nano::stat::type::work, nano::stat::detail::solve_time, nano::stat::dir::in, { 0, 1, 10, 100, 1000, 10000, 60000, std::numeric_limits<uint64_t>::max () });
+}
+
+void nano::work_pool::cancel (nano::root const & root_a)
+{
+	std::vector<std::shared_ptr<nano::work_item>> cancelled;
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		if (!done)
+		{
+			for (auto const & item : pending)
 			{
-				if (item_a.callback)
+				if (item->item == root_a)
 				{
-					item_a.callback (boost::none);
+					cancelled.push_back (item);
 				}
-				result = true;
 			}
-			return result;
-		});
+			auto now (std::chrono::steady_clock::now ());
+			for (auto const & item : cancelled)
+			{
+				remove (item);
+				record (*item, now, false);
+			}
+		}
+	}
+	for (auto const & item : cancelled)
+	{
+		if (item->callback)
+		{
+			item->callback (boost::none);
+		}
 	}
 }
 
@@ -351,19 +498,31 @@ void nano::work_pool::stop ()
 	{
 		nano::lock_guard<nano::mutex> lock (mutex);
 		done = true;
-		++ticket;
+		for (auto const & item : pending)
+		{
+			++item->ticket;
+		}
 	}
 	producer_condition.notify_all ();
 }
 
-void nano::work_pool::generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t> const &)> callback_a)
+void nano::work_pool::generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t> const &)> callback_a, nano::work_schedule const & schedule_a)
 {
 	debug_assert (!root_a.is_zero ());
 	if (!threads.empty ())
 	{
 		{
 			nano::lock_guard<nano::mutex> lock (mutex);
-			pending.emplace_back (version_a, root_a, difficulty_a, callback_a);
+			auto item (std::make_shared<nano::work_item> (version_a, root_a, difficulty_a, callback_a, schedule_a));
+			// Threads on less urgent requests switch at once instead of finishing their slice
+			for (auto const & existing : pending)
+			{
+				if (existing->threads > 0 && existing->schedule.priority > schedule_a.priority)
+				{
+					++existing->preempted;
+				}
+			}
+			pending.push_back (item);
 		}
 		producer_condition.notify_all ();
 	}
@@ -387,17 +546,19 @@ boost::optional<uint64_t> nano::work_pool::generate (nano::root const & root_a,
 	return generate (nano::work_version::work_1, root_a, difficulty_a);
 }
 
-boost::optional<uint64_t> nano::work_pool::generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a)
+boost::optional<uint64_t> nano::work_pool::generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, nano::work_schedule const & schedule_a)
 {
 	boost::optional<uint64_t> result;
 	if (!threads.empty ())
 	{
 		std::promise<boost::optional<uint64_t>> work;
 		std::future<boost::optional<uint64_t>> future = work.get_future ();
-		generate (version_a, root_a, difficulty_a, [&work](boost::optional<uint64_t> work_a) {
+		generate (
+		version_a, root_a, difficulty_a, [&work](boost::optional<uint64_t> work_a) {
 			work.set_value (work_a);
-		});
-		result = future.get ().value ();
+		},
+		schedule_a);
+		result = future.get ();
 	}
 	return result;
 }
@@ -415,7 +576,7 @@ std::unique_ptr<nano::container_info_component> nano::collect_container_info (wo
 		nano::lock_guard<nano::mutex> guard (work_pool.mutex);
 		count = work_pool.pending.size ();
 	}
-	auto sizeof_element = sizeof (decltype (work_pool.pending)::value_type);
+	auto sizeof_element = sizeof (nano::work_item);
 	auto composite = std::make_unique<container_info_composite> (name);
 	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "pending", count, sizeof_element }));
 	composite->add_component (collect_container_info (work_pool.work_observers, "work_observers"));
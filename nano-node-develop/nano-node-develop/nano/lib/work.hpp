@@ -4,12 +4,16 @@
 #include <nano/lib/locks.hpp>
 #include <nano/lib/numbers.hpp>
 #include <nano/lib/utility.hpp>
+#include <nano/lib/work_kernels.hpp>
 
 #include <boost/optional.hpp>
 #include <boost/thread/thread.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <list>
 #include <memory>
+#include <unordered_map>
 
 namespace nano
 {
@@ -44,42 +48,106 @@ namespace work_v1
 double normalized_multiplier (double const, uint64_t const);
 double denormalized_multiplier (double const, uint64_t const);
 class opencl_work;
+class stat;
+
+/** Scheduling classes of work_pool requests, the most urgent first */
+enum class work_priority : uint8_t
+{
+	/** Blocks being created by a wallet */
+	high,
+	/** External requests, such as RPC work_generate */
+	normal,
+	/** Background work, such as precaching and raising the difficulty of unconfirmed blocks */
+	low
+};
+std::string to_string (nano::work_priority const);
+
+/** How a work_pool request is scheduled */
+class work_schedule final
+{
+public:
+	nano::work_priority priority{ nano::work_priority::normal };
+	/** Threads are shared equally between the clients with requests of the same priority */
+	nano::account client{ 0 };
+	/** A request not solved by then fails */
+	std::chrono::steady_clock::time_point deadline{ std::chrono::steady_clock::time_point::max () };
+	/** Optional, receives the queue wait and solve time histograms. Must outlive the request */
+	nano::stat * stats{ nullptr };
+};
+
 class work_item final
 {
 public:
-	work_item (nano::work_version const version_a, nano::root const & item_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t> const &)> const & callback_a) :
-	version (version_a), item (item_a), difficulty (difficulty_a), callback (callback_a)
+	work_item (nano::work_version const version_a, nano::root const & item_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t> const &)> const & callback_a, nano::work_schedule const & schedule_a = nano::work_schedule ()) :
+	version (version_a), item (item_a), difficulty (difficulty_a), callback (callback_a), schedule (schedule_a)
 	{
 	}
 	nano::work_version const version;
 	nano::root const item;
 	uint64_t const difficulty;
 	std::function<void(boost::optional<uint64_t> const &)> const callback;
+	nano::work_schedule const schedule;
+	std::chrono::steady_clock::time_point const queued{ std::chrono::steady_clock::now () };
+	/** Set when the first thread starts on it */
+	std::chrono::steady_clock::time_point started;
+	/** Bumped when the item is solved, cancelled or expired, which stops the threads working on it */
+	std::atomic<int> ticket{ 0 };
+	/** Bumped when a more urgent request arrives, which stops the threads working on it until they reschedule */
+	std::atomic<unsigned> preempted{ 0 };
+	/** Number of threads working on it, protected by the pool mutex */
+	unsigned threads{ 0 };
 };
+
+/**
+ * Generates work on the CPU, and optionally OpenCL, for any number of requests at a time.
+ * Threads pick the most urgent priority with requests, and within it the client and then the request with the fewest
+ * threads, so several roots are worked on concurrently and one expensive request does not hold up the others.
+ * Threads reconsider their choice after each slice of attempts. A more urgent request preempts the threads working on
+ * less urgent ones, threads on requests of the same or a higher priority finish their slice.
+ */
 class work_pool final
 {
 public:
-	work_pool (unsigned, std::chrono::nanoseconds = std::chrono::nanoseconds (0), std::function<boost::optional<uint64_t> (nano::work_version const, nano::root const &, uint64_t, std::atomic<int> &)> = nullptr);
+	work_pool (unsigned, std::chrono::nanoseconds = std::chrono::nanoseconds (0), std::function<boost::optional<uint64_t> (nano::work_version const, nano::root const &, uint64_t, std::atomic<int> &)> = nullptr, nano::work_kernel = nano::work_v1::best_kernel ());
 	~work_pool ();
 	void loop (uint64_t);
 	void stop ();
 	void cancel (nano::root const &);
-	void generate (nano::work_version const, nano::root const &, uint64_t, std::function<void(boost::optional<uint64_t> const &)>);
-	boost::optional<uint64_t> generate (nano::work_version const, nano::root const &, uint64_t);
+	void generate (nano::work_version const, nano::root const &, uint64_t, std::function<void(boost::optional<uint64_t> const &)>, nano::work_schedule const & = nano::work_schedule ());
+	boost::optional<uint64_t> generate (nano::work_version const, nano::root const &, uint64_t, nano::work_schedule const & = nano::work_schedule ());
 	// For tests only
 	boost::optional<uint64_t> generate (nano::root const &);
 	boost::optional<uint64_t> generate (nano::root const &, uint64_t);
 	size_t size ();
+	/** Defines the histograms recorded for requests with work_schedule::stats */
+	static void define_histograms (nano::stat &);
+	/** Attempts made on a request before a thread reconsiders which to work on */
+	static uint64_t constexpr slice_attempts = 64 * 1024;
 	nano::network_constants network_constants;
-	std::atomic<int> ticket;
 	bool done;
 	std::vector<boost::thread> threads;
-	std::list<nano::work_item> pending;
+	/** Requests, in the order they are served when otherwise equal */
+	std::list<std::shared_ptr<nano::work_item>> pending;
+	/** Threads working per client, for fairness */
+	std::unordered_map<nano::account, unsigned> client_threads;
 	nano::mutex mutex{ mutex_identifier (mutexes::work_pool) };
 	nano::condition_variable producer_condition;
 	std::chrono::nanoseconds pow_rate_limiter;
+	/** CPU implementation used by the work threads */
+	nano::work_kernel const kernel;
 	std::function<boost::optional<uint64_t> (nano::work_version const, nano::root const &, uint64_t, std::atomic<int> &)> opencl;
 	nano::observer_set<bool> work_observers;
+
+private:
+	/** Picks the request to work on and assigns the thread to it, or returns nullptr if there is none */
+	std::shared_ptr<nano::work_item> select ();
+	void release (nano::work_item &);
+	/** Removes the requests past their deadline, returning them so their callbacks can be called without the lock */
+	std::vector<std::shared_ptr<nano::work_item>> expire (std::chrono::steady_clock::time_point const &);
+	/** Removes a request and stops the threads working on it */
+	void remove (std::shared_ptr<nano::work_item> const &);
+	void record (nano::work_item const &, std::chrono::steady_clock::time_point const &, bool solved_a);
+	bool working{ false };
 };
 
 std::unique_ptr<container_info_component> collect_container_info (work_pool & work_pool, std::string const & name);
@@ -0,0 +1,184 @@
+#include <nano/lib/numbers.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/lib/work_kernels.hpp>
+
+#include <cstring>
+
+#if defined(NANO_WORK_KERNELS_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+class scalar_ops final
+{
+public:
+	using vector = uint64_t;
+	static unsigned constexpr lanes = 1;
+	static vector set1 (uint64_t value_a)
+	{
+		return value_a;
+	}
+	static vector sequence (uint64_t first_a)
+	{
+		return first_a;
+	}
+	static void store (uint64_t * target_a, vector value_a)
+	{
+		*target_a = value_a;
+	}
+	static vector add (vector a, vector b)
+	{
+		return a + b;
+	}
+	static vector xor_ (vector a, vector b)
+	{
+		return a ^ b;
+	}
+	static vector rotr32 (vector a)
+	{
+		return (a >> 32) | (a << 32);
+	}
+	static vector rotr24 (vector a)
+	{
+		return (a >> 24) | (a << 40);
+	}
+	static vector rotr16 (vector a)
+	{
+		return (a >> 16) | (a << 48);
+	}
+	static vector rotr63 (vector a)
+	{
+		return (a >> 63) | (a << 1);
+	}
+};
+
+#if defined(NANO_WORK_KERNELS_X86)
+bool cpu_supports (nano::work_kernel kernel_a)
+{
+	auto result (false);
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid (info, 0);
+	auto max_leaf (info[0]);
+	__cpuid (info, 1);
+	// The OS must save the wider registers on context switches
+	auto osxsave ((info[2] & (1 << 27)) != 0);
+	if (osxsave && max_leaf >= 7)
+	{
+		auto xcr0 (_xgetbv (0));
+		__cpuidex (info, 7, 0);
+		switch (kernel_a)
+		{
+			case nano::work_kernel::avx2:
+				result = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+				break;
+			case nano::work_kernel::avx512:
+				result = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+				break;
+			default:
+				break;
+		}
+	}
+#else
+	__builtin_cpu_init ();
+	switch (kernel_a)
+	{
+		case nano::work_kernel::avx2:
+			result = __builtin_cpu_supports ("avx2");
+			break;
+		case nano::work_kernel::avx512:
+			result = __builtin_cpu_supports ("avx512f");
+			break;
+		default:
+			break;
+	}
+#endif
+	return result;
+}
+#endif
+}
+
+std::string nano::to_string (nano::work_kernel const kernel_a)
+{
+	std::string result ("invalid");
+	switch (kernel_a)
+	{
+		case nano::work_kernel::scalar:
+			result = "scalar";
+			break;
+		case nano::work_kernel::avx2:
+			result = "avx2";
+			break;
+		case nano::work_kernel::avx512:
+			result = "avx512";
+			break;
+	}
+	return result;
+}
+
+nano::work_v1::precomputed_state::precomputed_state (nano::root const & root_a)
+{
+	using namespace nano::work_v1::kernels;
+	std::fill (std::begin (m), std::end (m), 0);
+	static_assert (sizeof (root_a.bytes) == 4 * sizeof (uint64_t), "Root must fill four message words");
+	std::memcpy (&m[1], root_a.bytes.data (), sizeof (root_a.bytes));
+	// Parameter block of an unkeyed hash with an 8 byte digest
+	v[0] = blake2b_iv[0] ^ 0x01010000ULL ^ sizeof (uint64_t);
+	std::copy (std::begin (blake2b_iv) + 1, std::end (blake2b_iv), std::begin (v) + 1);
+	std::copy (std::begin (blake2b_iv), std::end (blake2b_iv), std::begin (v) + 8);
+	// A single final block holding the 40 message bytes
+	v[12] ^= message_words * sizeof (uint64_t);
+	v[14] = ~v[14];
+	g<scalar_ops, blake2b_sigma[0][2], blake2b_sigma[0][3]> (v[1], v[5], v[9], v[13], m);
+	g<scalar_ops, blake2b_sigma[0][4], blake2b_sigma[0][5]> (v[2], v[6], v[10], v[14], m);
+	g<scalar_ops, blake2b_sigma[0][6], blake2b_sigma[0][7]> (v[3], v[7], v[11], v[15], m);
+}
+
+std::vector<nano::work_kernel> nano::work_v1::supported_kernels ()
+{
+	std::vector<nano::work_kernel> result{ nano::work_kernel::scalar };
+#if defined(NANO_WORK_KERNELS_X86)
+	for (auto kernel : { nano::work_kernel::avx2, nano::work_kernel::avx512 })
+	{
+		if (cpu_supports (kernel))
+		{
+			result.push_back (kernel);
+		}
+	}
+#endif
+	return result;
+}
+
+nano::work_kernel nano::work_v1::best_kernel ()
+{
+	static nano::work_kernel const result (supported_kernels ().back ());
+	return result;
+}
+
+bool nano::work_v1::search (nano::work_kernel kernel_a, nano::work_v1::precomputed_state const & state_a, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a)
+{
+	auto result (false);
+	switch (kernel_a)
+	{
+#if defined(NANO_WORK_KERNELS_X86)
+		case nano::work_kernel::avx2:
+			result = search_avx2 (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+			break;
+		case nano::work_kernel::avx512:
+			result = search_avx512 (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+			break;
+#endif
+		case nano::work_kernel::scalar:
+			result = search_scalar (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+			break;
+		default:
+			release_assert (false && "Work kernel is not available on this platform");
+	}
+	return result;
+}
+
+bool nano::work_v1::search_scalar (nano::work_v1::precomputed_state const & state_a, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a)
+{
+	return nano::work_v1::kernels::search<scalar_ops> (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+}
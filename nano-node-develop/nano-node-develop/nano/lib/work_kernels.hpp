@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nano
+{
+class root;
+
+/** CPU implementations of the work_v1 nonce search */
+enum class work_kernel
+{
+	/** One nonce at a time, portable */
+	scalar,
+	/** Four nonces per instruction stream */
+	avx2,
+	/** Eight nonces per instruction stream */
+	avx512
+};
+std::string to_string (nano::work_kernel const);
+
+namespace work_v1
+{
+	/**
+	 * Blake2b state of the work hash after the steps which only depend on the root. The nonce is the first message word
+	 * and the root fills the next four, so of the first round only the G function mixing the nonce is left per attempt.
+	 * Plain arrays keep this usable from translation units compiled for other instruction sets.
+	 */
+	class precomputed_state final
+	{
+	public:
+		explicit precomputed_state (nano::root const &);
+		/** Working vector after the nonce independent columns of the first round */
+		uint64_t v[16];
+		/** Message words, m[0] is replaced by the nonce */
+		uint64_t m[16];
+	};
+
+	/** Kernels supported by this CPU, the fastest last */
+	std::vector<nano::work_kernel> supported_kernels ();
+	nano::work_kernel best_kernel ();
+
+	/**
+	 * Tries at least \p count_a consecutive nonces from \p nonce_a, rounded up to the kernel's lane count.
+	 * @return true if one reached \p difficulty_a, it is then set in \p work_a with its value in \p output_a. The
+	 * first solution in nonce order is returned, so every kernel gives the same result as scalar.
+	 * \p nonce_a is advanced past the nonces tried, so a search can be continued by calling again.
+	 */
+	bool search (nano::work_kernel, nano::work_v1::precomputed_state const &, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a);
+
+	// Implementations, each compiled for its instruction set. Only call those in supported_kernels
+	bool search_scalar (nano::work_v1::precomputed_state const &, uint64_t, uint64_t &, uint64_t, uint64_t &, uint64_t &);
+	bool search_avx2 (nano::work_v1::precomputed_state const &, uint64_t, uint64_t &, uint64_t, uint64_t &, uint64_t &);
+	bool search_avx512 (nano::work_v1::precomputed_state const &, uint64_t, uint64_t &, uint64_t, uint64_t &, uint64_t &);
+
+	namespace kernels
+	{
+		uint64_t constexpr blake2b_iv[8] = {
+			0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+			0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+		};
+
+		uint8_t constexpr blake2b_sigma[12][16] = {
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+			{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+			{ 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+			{ 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+			{ 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+			{ 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+			{ 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+			{ 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+			{ 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+			{ 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+			{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 }
+		};
+
+		/** Nonce (8 bytes) followed by the root (32 bytes), only the first five message words are non zero */
+		unsigned constexpr message_words = 5;
+
+		/**
+		 * The Blake2b mixing function over vectors of lanes. \p ops provides the vector type and its operations.
+		 * Message indices are template arguments, so additions of the zero words compile away.
+		 */
+		template <typename ops, unsigned x, unsigned y>
+		inline void g (typename ops::vector & a, typename ops::vector & b, typename ops::vector & c, typename ops::vector & d, typename ops::vector const * m)
+		{
+			a = ops::add (a, b);
+			if (x < message_words)
+			{
+				a = ops::add (a, m[x]);
+			}
+			d = ops::rotr32 (ops::xor_ (d, a));
+			c = ops::add (c, d);
+			b = ops::rotr24 (ops::xor_ (b, c));
+			a = ops::add (a, b);
+			if (y < message_words)
+			{
+				a = ops::add (a, m[y]);
+			}
+			d = ops::rotr16 (ops::xor_ (d, a));
+			c = ops::add (c, d);
+			b = ops::rotr63 (ops::xor_ (b, c));
+		}
+
+		template <typename ops, unsigned r>
+		inline void columns (typename ops::vector * v, typename ops::vector const * m)
+		{
+			g<ops, blake2b_sigma[r][0], blake2b_sigma[r][1]> (v[0], v[4], v[8], v[12], m);
+			g<ops, blake2b_sigma[r][2], blake2b_sigma[r][3]> (v[1], v[5], v[9], v[13], m);
+			g<ops, blake2b_sigma[r][4], blake2b_sigma[r][5]> (v[2], v[6], v[10], v[14], m);
+			g<ops, blake2b_sigma[r][6], blake2b_sigma[r][7]> (v[3], v[7], v[11], v[15], m);
+		}
+
+		template <typename ops, unsigned r>
+		inline void diagonals (typename ops::vector * v, typename ops::vector const * m)
+		{
+			g<ops, blake2b_sigma[r][8], blake2b_sigma[r][9]> (v[0], v[5], v[10], v[15], m);
+			g<ops, blake2b_sigma[r][10], blake2b_sigma[r][11]> (v[1], v[6], v[11], v[12], m);
+			g<ops, blake2b_sigma[r][12], blake2b_sigma[r][13]> (v[2], v[7], v[8], v[13], m);
+			g<ops, blake2b_sigma[r][14], blake2b_sigma[r][15]> (v[3], v[4], v[9], v[14], m);
+		}
+
+		template <typename ops, unsigned r>
+		inline void round (typename ops::vector * v, typename ops::vector const * m)
+		{
+			columns<ops, r> (v, m);
+			diagonals<ops, r> (v, m);
+		}
+
+		/** Work values of the nonces in \p nonce_a, bit exact with work_v1::value */
+		template <typename ops>
+		inline typename ops::vector value (nano::work_v1::precomputed_state const & state_a, typename ops::vector nonce_a)
+		{
+			typename ops::vector v[16];
+			for (auto i (0u); i < 16; ++i)
+			{
+				v[i] = ops::set1 (state_a.v[i]);
+			}
+			typename ops::vector m[message_words];
+			m[0] = nonce_a;
+			for (auto i (1u); i < message_words; ++i)
+			{
+				m[i] = ops::set1 (state_a.m[i]);
+			}
+			// The other columns of the first round are precomputed
+			g<ops, 0, 1> (v[0], v[4], v[8], v[12], m);
+			diagonals<ops, 0> (v, m);
+			round<ops, 1> (v, m);
+			round<ops, 2> (v, m);
+			round<ops, 3> (v, m);
+			round<ops, 4> (v, m);
+			round<ops, 5> (v, m);
+			round<ops, 6> (v, m);
+			round<ops, 7> (v, m);
+			round<ops, 8> (v, m);
+			round<ops, 9> (v, m);
+			round<ops, 10> (v, m);
+			round<ops, 11> (v, m);
+			// The 8 byte result is the first word of the chained state
+			auto h0 (blake2b_iv[0] ^ 0x01010000ULL ^ sizeof (uint64_t));
+			return ops::xor_ (ops::set1 (h0), ops::xor_ (v[0], v[8]));
+		}
+
+		template <typename ops>
+		inline bool search (nano::work_v1::precomputed_state const & state_a, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a)
+		{
+			auto result (false);
+			for (uint64_t tried (0); !result && tried < count_a; tried += ops::lanes)
+			{
+				uint64_t outputs[ops::lanes];
+				ops::store (outputs, value<ops> (state_a, ops::sequence (nonce_a)));
+				for (auto lane (0u); !result && lane < ops::lanes; ++lane)
+				{
+					if (outputs[lane] >= difficulty_a)
+					{
+						work_a = nonce_a + lane;
+						output_a = outputs[lane];
+						result = true;
+					}
+				}
+				nonce_a += ops::lanes;
+			}
+			return result;
+		}
+	}
+}
+}
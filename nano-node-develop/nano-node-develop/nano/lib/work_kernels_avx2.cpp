@@ -0,0 +1,58 @@
+#include <nano/lib/work_kernels.hpp>
+
+#include <immintrin.h>
+
+// Compiled with AVX2 enabled, only called when the CPU supports it
+namespace
+{
+class avx2_ops final
+{
+public:
+	using vector = __m256i;
+	static unsigned constexpr lanes = 4;
+	static vector set1 (uint64_t value_a)
+	{
+		return _mm256_set1_epi64x (static_cast<long long> (value_a));
+	}
+	static vector sequence (uint64_t first_a)
+	{
+		return _mm256_add_epi64 (set1 (first_a), _mm256_setr_epi64x (0, 1, 2, 3));
+	}
+	static void store (uint64_t * target_a, vector value_a)
+	{
+		_mm256_storeu_si256 (reinterpret_cast<__m256i *> (target_a), value_a);
+	}
+	static vector add (vector a, vector b)
+	{
+		return _mm256_add_epi64 (a, b);
+	}
+	static vector xor_ (vector a, vector b)
+	{
+		return _mm256_xor_si256 (a, b);
+	}
+	static vector rotr32 (vector a)
+	{
+		return _mm256_shuffle_epi32 (a, _MM_SHUFFLE (2, 3, 0, 1));
+	}
+	// Rotations by whole bytes are byte shuffles within each 64 bit lane
+	static vector rotr24 (vector a)
+	{
+		auto const mask (_mm256_setr_epi8 (3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, 3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10));
+		return _mm256_shuffle_epi8 (a, mask);
+	}
+	static vector rotr16 (vector a)
+	{
+		auto const mask (_mm256_setr_epi8 (2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, 2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9));
+		return _mm256_shuffle_epi8 (a, mask);
+	}
+	static vector rotr63 (vector a)
+	{
+		return _mm256_or_si256 (_mm256_srli_epi64 (a, 63), _mm256_add_epi64 (a, a));
+	}
+};
+}
+
+bool nano::work_v1::search_avx2 (nano::work_v1::precomputed_state const & state_a, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a)
+{
+	return nano::work_v1::kernels::search<avx2_ops> (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+}
@@ -0,0 +1,55 @@
+#include <nano/lib/work_kernels.hpp>
+
+#include <immintrin.h>
+
+// Compiled with AVX-512F enabled, only called when the CPU supports it
+namespace
+{
+class avx512_ops final
+{
+public:
+	using vector = __m512i;
+	static unsigned constexpr lanes = 8;
+	static vector set1 (uint64_t value_a)
+	{
+		return _mm512_set1_epi64 (static_cast<long long> (value_a));
+	}
+	static vector sequence (uint64_t first_a)
+	{
+		return _mm512_add_epi64 (set1 (first_a), _mm512_set_epi64 (7, 6, 5, 4, 3, 2, 1, 0));
+	}
+	static void store (uint64_t * target_a, vector value_a)
+	{
+		_mm512_storeu_si512 (target_a, value_a);
+	}
+	static vector add (vector a, vector b)
+	{
+		return _mm512_add_epi64 (a, b);
+	}
+	static vector xor_ (vector a, vector b)
+	{
+		return _mm512_xor_si512 (a, b);
+	}
+	static vector rotr32 (vector a)
+	{
+		return _mm512_ror_epi64 (a, 32);
+	}
+	static vector rotr24 (vector a)
+	{
+		return _mm512_ror_epi64 (a, 24);
+	}
+	static vector rotr16 (vector a)
+	{
+		return _mm512_ror_epi64 (a, 16);
+	}
+	static vector rotr63 (vector a)
+	{
+		return _mm512_ror_epi64 (a, 63);
+	}
+};
+}
+
+bool nano::work_v1::search_avx512 (nano::work_v1::precomputed_state const & state_a, uint64_t difficulty_a, uint64_t & nonce_a, uint64_t count_a, uint64_t & work_a, uint64_t & output_a)
+{
+	return nano::work_v1::kernels::search<avx512_ops> (state_a, difficulty_a, nonce_a, count_a, work_a, output_a);
+}
@@ -5,19 +5,31 @@
 #include <nano/boost/beast/core/flat_buffer.hpp>
 #include <nano/boost/beast/http.hpp>
 #include <nano/boost/process/child.hpp>
+#include <nano/lib/ipc_client.hpp>
+#include <nano/lib/ipc_shm.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/tomlconfig.hpp>
 #include <nano/node/daemonconfig.hpp>
+#include <nano/node/ipc/ipc_server.hpp>
+#include <nano/node/json_handler.hpp>
+#include <nano/node/node_rpc_config.hpp>
+#include <nano/node/testing.hpp>
 #include <nano/secure/utility.hpp>
 #include <nano/test_common/testutil.hpp>
 
 #include <boost/dll/runtime_symbol_info.hpp>
+#include <boost/format.hpp>
 #include <boost/program_options.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <csignal>
+#include <cstdlib>
 #include <future>
 #include <iomanip>
+#include <new>
+#include <numeric>
 #include <random>
 
 /* Boost v1.70 introduced breaking changes; the conditional compilation allows 1.6x to be supported as well. */
@@ -32,6 +44,33 @@ namespace nano
 void force_nano_dev_network ();
 }
 
+namespace
+{
+/** Counts every heap allocation in this process, used by the RPC benchmark */
+std::atomic<uint64_t> allocation_count{ 0 };
+}
+
+void * operator new (std::size_t size_a)
+{
+	allocation_count.fetch_add (1, std::memory_order_relaxed);
+	auto result (std::malloc (size_a == 0 ? 1 : size_a));
+	if (result == nullptr)
+	{
+		throw std::bad_alloc ();
+	}
+	return result;
+}
+
+void operator delete (void * ptr_a) noexcept
+{
+	std::free (ptr_a);
+}
+
+void operator delete (void * ptr_a, std::size_t) noexcept
+{
+	std::free (ptr_a);
+}
+
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace net = boost::asio;
@@ -41,7 +80,7 @@ constexpr auto rpc_port_start = 60000;
 constexpr auto peering_port_start = 61000;
 constexpr auto ipc_port_start = 62000;
 
-void write_config_files (boost::filesystem::path const & data_path, int index)
+void write_config_files (boost::filesystem::path const & data_path, int index, int cpus_per_node)
 {
 	nano::daemon_config daemon_config (data_path);
 	daemon_config.node.peering_port = peering_port_start + index;
@@ -51,6 +90,21 @@ void write_config_files (boost::filesystem::path const & data_path, int index)
 	// Alternate use of memory pool
 	daemon_config.node.use_memory_pools = (index % 2) == 0;
 
+	// Give each node its own CPUs, with block processing isolated on the first of them
+	if (cpus_per_node > 0)
+	{
+		std::vector<unsigned> cpus (cpus_per_node);
+		std::iota (cpus.begin (), cpus.end (), static_cast<unsigned> (index * cpus_per_node));
+		auto & threading (daemon_config.node.threading);
+		auto others (cpus_per_node > 1 ? std::vector<unsigned> (cpus.begin () + 1, cpus.end ()) : cpus);
+		for (auto const & role : nano::threading_config::role_keys ())
+		{
+			threading.cpus[role.first] = others;
+		}
+		threading.cpus[nano::thread_role::name::block_processing] = { cpus.front () };
+		threading.isolate_block_processing = cpus_per_node > 1;
+	}
+
 	// Write daemon config
 	nano::tomlconfig toml;
 	daemon_config.serialize_toml (toml);
@@ -271,6 +325,245 @@ account_info account_info_rpc (boost::asio::io_context & ioc, tcp::resolver::res
 	return account_info;
 }
 
+/**
+ * Runs the hot RPC actions in-process against a single node, reporting latency and heap allocations per call.
+ * The node is idle while measuring, so allocations made by its background threads are negligible.
+ */
+int rpc_benchmark (int block_count, int iterations)
+{
+	nano::system system (1);
+	auto & node (*system.nodes[0]);
+	std::vector<nano::keypair> destinations (10);
+	std::vector<nano::block_hash> hashes;
+	auto previous (node.latest (nano::dev_genesis_key.pub));
+	auto balance (nano::genesis_amount);
+	std::cout << "Generating " << block_count << " blocks..." << std::endl;
+	for (auto i = 0; i < block_count; ++i)
+	{
+		auto const & destination (destinations[i % destinations.size ()]);
+		balance -= nano::Gxrb_ratio;
+		nano::state_block send (nano::dev_genesis_key.pub, previous, nano::dev_genesis_key.pub, balance, destination.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (previous));
+		if (node.process (send).code != nano::process_result::progress)
+		{
+			std::cerr << "Failed to process send block" << std::endl;
+			return 1;
+		}
+		previous = send.hash ();
+		hashes.push_back (previous);
+		if (i < static_cast<int> (destinations.size ()))
+		{
+			// Open each destination with the first send, the rest stay pending
+			nano::state_block open (destination.pub, 0, nano::dev_genesis_key.pub, nano::Gxrb_ratio, previous, destination.prv, destination.pub, *system.work.generate (destination.pub));
+			if (node.process (open).code != nano::process_result::progress)
+			{
+				std::cerr << "Failed to process open block" << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	auto make_list = [](std::string const & name_a, std::vector<std::string> const & values_a) {
+		boost::property_tree::ptree request;
+		boost::property_tree::ptree list;
+		for (auto const & value : values_a)
+		{
+			boost::property_tree::ptree entry;
+			entry.put ("", value);
+			list.push_back (std::make_pair ("", entry));
+		}
+		request.add_child (name_a, list);
+		return request;
+	};
+	std::vector<std::string> hash_strings;
+	for (auto i = 0; i < std::min<int> (hashes.size (), 1000); ++i)
+	{
+		hash_strings.push_back (hashes[i].to_string ());
+	}
+	std::vector<std::string> account_strings{ nano::dev_genesis_key.pub.to_account () };
+	for (auto const & destination : destinations)
+	{
+		account_strings.push_back (destination.pub.to_account ());
+	}
+
+	std::vector<boost::property_tree::ptree> requests;
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "account_history");
+		request.put ("account", nano::dev_genesis_key.pub.to_account ());
+		request.put ("count", std::to_string (block_count));
+		requests.push_back (request);
+	}
+	{
+		auto request (make_list ("hashes", hash_strings));
+		request.put ("action", "blocks_info");
+		request.put ("json_block", "true");
+		requests.push_back (request);
+	}
+	{
+		auto request (make_list ("accounts", account_strings));
+		request.put ("action", "accounts_balances");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "pending");
+		request.put ("account", destinations[0].pub.to_account ());
+		request.put ("count", std::to_string (block_count));
+		request.put ("source", "true");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "ledger");
+		request.put ("count", std::to_string (block_count));
+		request.put ("representative", "true");
+		request.put ("weight", "true");
+		request.put ("pending", "true");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "delegators");
+		request.put ("account", nano::dev_genesis_key.pub.to_account ());
+		requests.push_back (request);
+	}
+
+	nano::node_rpc_config node_rpc_config;
+	for (auto const & request : requests)
+	{
+		std::stringstream ostream;
+		boost::property_tree::write_json (ostream, request);
+		auto body (ostream.str ());
+		size_t response_size (0);
+		auto allocations_before (allocation_count.load ());
+		auto start (std::chrono::steady_clock::now ());
+		for (auto i = 0; i < iterations; ++i)
+		{
+			auto handler (std::make_shared<nano::json_handler> (node, node_rpc_config, body, [&response_size](std::string const & response_a) {
+				response_size = response_a.size ();
+			}));
+			handler->process_request ();
+		}
+		auto elapsed (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start));
+		auto allocations (allocation_count.load () - allocations_before);
+		std::cout << boost::str (boost::format ("%1%: %2% us/call, %3% allocations/call, %4% bytes/response\n") % request.get<std::string> ("action") % (elapsed.count () / iterations) % (allocations / iterations) % response_size);
+	}
+	system.stop ();
+	return 0;
+}
+
+/**
+ * Compares the IPC transports by sending block_count requests to a single node, with an increasing number of
+ * clients each owning a connection. Reports throughput and latency percentiles for every transport.
+ */
+int ipc_benchmark (int requests_per_client)
+{
+	nano::system system (1);
+	auto & node (*system.nodes[0]);
+	auto & ipc_config (node.config.ipc_config);
+	ipc_config.transport_tcp.enabled = true;
+	ipc_config.transport_tcp.port = 24078;
+	ipc_config.transport_domain.enabled = true;
+	ipc_config.transport_domain.path = "/tmp/nano_ipc_benchmark";
+	ipc_config.transport_shared_memory.enabled = true;
+	ipc_config.transport_shared_memory.name = "/nano_ipc_benchmark";
+	std::vector<unsigned> const concurrency_levels{ 1, 2, 4, 8, 16, 32, 64 };
+	ipc_config.transport_shared_memory.connections = concurrency_levels.back ();
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc (node, node_rpc_config);
+	// Requests are handled on the node's io threads
+	nano::thread_runner runner (system.io_ctx, node.config.io_threads);
+
+	// Socket clients are asynchronous underneath, their io_context is run by these threads
+	boost::asio::io_context client_io_ctx;
+	auto work (boost::asio::make_work_guard (client_io_ctx));
+	std::vector<std::thread> io_threads;
+	for (auto i = 0; i < 4; ++i)
+	{
+		io_threads.emplace_back ([&client_io_ctx]() { client_io_ctx.run (); });
+	}
+
+	std::string const request (R"({"action": "block_count"})");
+	std::vector<std::string> const transports{ "tcp", "domain", "shared_memory" };
+	auto error (false);
+	for (auto const & transport : transports)
+	{
+		for (auto concurrency : concurrency_levels)
+		{
+			std::vector<std::vector<std::chrono::nanoseconds>> latencies (concurrency);
+			std::atomic<bool> failed{ false };
+			std::vector<std::thread> clients;
+			auto start (std::chrono::steady_clock::now ());
+			for (auto i = 0u; i < concurrency; ++i)
+			{
+				clients.emplace_back ([&, i]() {
+					auto & latencies_l (latencies[i]);
+					latencies_l.reserve (requests_per_client);
+					std::function<std::string ()> send;
+					nano::ipc::ipc_client socket_client (client_io_ctx);
+					nano::ipc::shm_client shm_client;
+					nano::error connect_error;
+					if (transport == "shared_memory")
+					{
+						connect_error = shm_client.connect (ipc_config.transport_shared_memory.name);
+						send = [&]() { return shm_client.request (nano::ipc::payload_encoding::json_v1, request); };
+					}
+					else
+					{
+						connect_error = transport == "tcp" ? socket_client.connect ("::1", ipc_config.transport_tcp.port) : socket_client.connect (ipc_config.transport_domain.path);
+						send = [&]() { return nano::ipc::request (nano::ipc::payload_encoding::json_v1, socket_client, request); };
+					}
+					for (auto j = 0; !connect_error && j < requests_per_client; ++j)
+					{
+						auto request_start (std::chrono::steady_clock::now ());
+						if (send ().empty ())
+						{
+							failed = true;
+							break;
+						}
+						latencies_l.push_back (std::chrono::steady_clock::now () - request_start);
+					}
+					if (connect_error)
+					{
+						failed = true;
+					}
+				});
+			}
+			for (auto & client : clients)
+			{
+				client.join ();
+			}
+			auto elapsed (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start));
+			if (failed)
+			{
+				std::cerr << boost::str (boost::format ("%1%: requests failed with %2% clients\n") % transport % concurrency);
+				error = true;
+				break;
+			}
+			std::vector<std::chrono::nanoseconds> all;
+			for (auto const & latencies_l : latencies)
+			{
+				all.insert (all.end (), latencies_l.begin (), latencies_l.end ());
+			}
+			std::sort (all.begin (), all.end ());
+			auto percentile = [&all](double fraction_a) {
+				return std::chrono::duration_cast<std::chrono::microseconds> (all[std::min<size_t> (all.size () - 1, static_cast<size_t> (all.size () * fraction_a))]).count ();
+			};
+			std::cout << boost::str (boost::format ("%1%, %2% clients: %3% requests/s, p50 %4% us, p99 %5% us\n") % transport % concurrency % (all.size () * 1000000 / std::max<uint64_t> (elapsed.count (), 1)) % percentile (0.5) % percentile (0.99));
+		}
+	}
+	work.reset ();
+	client_io_ctx.stop ();
+	for (auto & thread : io_threads)
+	{
+		thread.join ();
+	}
+	ipc.stop ();
+	system.stop ();
+	runner.join ();
+	return error ? 1 : 0;
+}
+
 /** This launches a node and fires a lot of send/recieve RPC requests at it (configurable), then other nodes are tested to make sure they observe these blocks as well. */
 int main (int argc, char * const * argv)
 {
@@ -285,8 +578,14 @@ int main (int argc, char * const * argv)
 		("send_count,s", boost::program_options::value<int> ()->default_value (2000), "How many send blocks to generate")
 		("simultaneous_process_calls", boost::program_options::value<int> ()->default_value (20), "Number of simultaneous rpc sends to do")
 		("destination_count", boost::program_options::value<int> ()->default_value (2), "How many destination accounts to choose between")
+		("cpus_per_node", boost::program_options::value<int> ()->default_value (0), "Pin each node to its own range of this many CPUs, with block processing isolated on the first. 0 leaves threads unpinned")
 		("node_path", boost::program_options::value<std::string> (), "The path to the nano_node to test")
-		("rpc_path", boost::program_options::value<std::string> (), "The path to the nano_rpc to test");
+		("rpc_path", boost::program_options::value<std::string> (), "The path to the nano_rpc to test")
+		("rpc_benchmark", "Measure latency and allocations per call of the hot RPC actions in-process, instead of running the load test")
+		("rpc_benchmark_blocks", boost::program_options::value<int> ()->default_value (5000), "How many blocks to generate for the RPC benchmark")
+		("rpc_benchmark_iterations", boost::program_options::value<int> ()->default_value (20), "How many times each RPC action is called by the RPC benchmark")
+		("ipc_benchmark", "Compare throughput and latency of the TCP, domain socket and shared memory IPC transports, instead of running the load test")
+		("ipc_benchmark_requests", boost::program_options::value<int> ()->default_value (2000), "How many requests each client sends in the IPC benchmark");
 	// clang-format on
 
 	boost::program_options::variables_map vm;
@@ -301,10 +600,21 @@ int main (int argc, char * const * argv)
 	}
 	boost::program_options::notify (vm);
 
+	if (vm.count ("rpc_benchmark"))
+	{
+		return rpc_benchmark (vm["rpc_benchmark_blocks"].as<int> (), vm["rpc_benchmark_iterations"].as<int> ());
+	}
+
+	if (vm.count ("ipc_benchmark"))
+	{
+		return ipc_benchmark (vm["ipc_benchmark_requests"].as<int> ());
+	}
+
 	auto node_count = vm.find ("node_count")->second.as<int> ();
 	auto destination_count = vm.find ("destination_count")->second.as<int> ();
 	auto send_count = vm.find ("send_count")->second.as<int> ();
 	auto simultaneous_process_calls = vm.find ("simultaneous_process_calls")->second.as<int> ();
+	auto cpus_per_node = vm.find ("cpus_per_node")->second.as<int> ();
 
 	boost::system::error_code err;
 	auto running_executable_filepath = boost::dll::program_location (err);
@@ -356,7 +666,7 @@ int main (int argc, char * const * argv)
 	{
 		auto data_path = nano::unique_path ();
 		boost::filesystem::create_directory (data_path);
-		write_config_files (data_path, i);
+		write_config_files (data_path, i, cpus_per_node);
 		data_paths.push_back (std::move (data_path));
 	}
 
@@ -421,6 +731,8 @@ int main (int argc, char * const * argv)
 		std::uniform_int_distribution<size_t> dist (0, destination_accounts.size () - 1);
 
 		std::atomic<int> send_calls_remaining{ send_count };
+		nano::timer<std::chrono::milliseconds> process_timer;
+		process_timer.start ();
 
 		for (auto i = 0; i < send_count; ++i)
 		{
@@ -453,7 +765,10 @@ int main (int argc, char * const * argv)
 			}
 		}
 
+		auto process_time (std::max<uint64_t> (process_timer.since_start ().count (), 1));
 		std::cout << "\rPrimary node processed transactions                " << std::endl;
+		// Every send is received, so twice as many blocks are processed
+		std::cout << boost::str (boost::format ("Processed %1% blocks in %2% ms, %3% blocks/s\n") % (send_count * 2) % process_time % (send_count * 2 * 1000 / process_time));
 
 		std::cout << "Waiting for nodes to catch up..." << std::endl;
 
@@ -491,6 +806,7 @@ int main (int argc, char * const * argv)
 
 			stop_rpc (ioc, results);
 		}
+		std::cout << boost::str (boost::format ("Nodes caught up in %1% ms\n") % timer.since_start ().count ());
 
 		// Stop main node
 		stop_rpc (ioc, primary_node_results);
@@ -1,5 +1,6 @@
 #include <nano/boost/process/child.hpp>
 #include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/nano_node/daemon.hpp>
 #include <nano/node/cli.hpp>
@@ -48,7 +49,16 @@ void nano_daemon::daemon::run (boost::filesystem::path const & data_path, nano::
 	if (!error)
 	{
 		config.node.logging.init (data_path);
+		config.node.threading.apply ();
+		nano::tracing::configure (config.node.diagnostics_config.tracing);
 		nano::logger_mt logger{ config.node.logging.min_time_between_log_output };
+#if NANO_IO_URING
+		if (!nano::io_uring_supported ())
+		{
+			std::cerr << "This node was built with NANO_IO_URING, but the kernel does not support io_uring (Linux 5.6 or later is required). Use a build without NANO_IO_URING to run on epoll\n";
+			return;
+		}
+#endif
 		boost::asio::io_context io_ctx;
 		auto opencl (nano::opencl_work::create (config.opencl_enable, config.opencl, logger));
 		nano::work_pool opencl_work (config.node.work_threads, config.node.pow_sleep_interval, opencl ? [&opencl](nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, std::atomic<int> & ticket_a) {
@@ -3,10 +3,13 @@
 #include <nano/lib/utility.hpp>
 #include <nano/nano_node/daemon.hpp>
 #include <nano/node/cli.hpp>
+#include <nano/ipc_flatbuffers_lib/flatbuffer_producer.hpp>
 #include <nano/node/daemonconfig.hpp>
+#include <nano/node/ipc/flatbuffers_util.hpp>
 #include <nano/node/ipc/ipc_server.hpp>
 #include <nano/node/json_handler.hpp>
 #include <nano/node/node.hpp>
+#include <nano/node/websocket.hpp>
 
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -94,6 +97,7 @@ int main (int argc, char * const * argv)
 		("debug_profile_process", "Profile active blocks processing (only for nano_dev_network)")
 		("debug_profile_votes", "Profile votes processing (only for nano_dev_network)")
 		("debug_profile_frontiers_confirmation", "Profile frontiers confirmation speed (only for nano_dev_network)")
+		("debug_profile_websocket", "Profile websocket confirmation message encoding, json versus flatbuffers")
 		("debug_random_feed", "Generates output to RNG test suites")
 		("debug_rpc", "Read an RPC command from stdin and invoke it. Network operations will have no effect.")
 		("debug_peers", "Display peer IPv6:port connections")
@@ -440,18 +444,63 @@ int main (int argc, char * const * argv)
 		}
 		else if (vm.count ("debug_profile_kdf"))
 		{
+			size_t count (1000);
+			auto count_it = vm.find ("count");
+			if (count_it != vm.end ())
+			{
+				try
+				{
+					count = boost::lexical_cast<size_t> (count_it->second.as<std::string> ());
+				}
+				catch (boost::bad_lexical_cast &)
+				{
+					std::cerr << "Invalid count\n";
+					return -1;
+				}
+			}
+			unsigned threads (nano::kdf::default_parallel ());
+			auto threads_it = vm.find ("threads");
+			if (threads_it != vm.end ())
+			{
+				try
+				{
+					threads = boost::lexical_cast<unsigned> (threads_it->second.as<std::string> ());
+				}
+				catch (boost::bad_lexical_cast &)
+				{
+					std::cerr << "Invalid threads count\n";
+					return -1;
+				}
+			}
 			nano::network_params network_params;
 			nano::uint256_union result;
 			nano::uint256_union salt (0);
 			std::string password ("");
-			while (true)
+			std::chrono::microseconds single (0);
+			auto const samples (3);
+			for (auto i (0); i < samples; ++i)
 			{
 				auto begin1 (std::chrono::high_resolution_clock::now ());
 				auto success (argon2_hash (1, network_params.kdf_work, 1, password.data (), password.size (), salt.bytes.data (), salt.bytes.size (), result.bytes.data (), result.bytes.size (), NULL, 0, Argon2_d, 0x10));
 				(void)success;
 				auto end1 (std::chrono::high_resolution_clock::now ());
-				std::cerr << boost::str (boost::format ("Derivation time: %1%us\n") % std::chrono::duration_cast<std::chrono::microseconds> (end1 - begin1).count ());
-			}
+				auto time (std::chrono::duration_cast<std::chrono::microseconds> (end1 - begin1));
+				single = std::min (i == 0 ? time : single, time);
+				std::cerr << boost::str (boost::format ("Derivation time: %1%us\n") % time.count ());
+			}
+			// Unlocking many wallets, each with its own salt
+			std::vector<std::pair<std::string, nano::uint256_union>> inputs;
+			for (size_t i (0); i < count; ++i)
+			{
+				nano::uint256_union salt_l;
+				nano::random_pool::generate_block (salt_l.bytes.data (), salt_l.bytes.size ());
+				inputs.emplace_back (password, salt_l);
+			}
+			nano::kdf kdf (threads);
+			auto begin2 (std::chrono::high_resolution_clock::now ());
+			kdf.phs (inputs);
+			auto end2 (std::chrono::high_resolution_clock::now ());
+			std::cout << boost::str (boost::format ("Unlocking %1% wallets, serial estimate: %2%ms, with %3% threads: %4%ms\n") % count % (single.count () * count / 1000) % kdf.parallel % std::chrono::duration_cast<std::chrono::milliseconds> (end2 - begin2).count ());
 		}
 		else if (vm.count ("debug_profile_generate"))
 		{
@@ -495,6 +544,24 @@ int main (int argc, char * const * argv)
 			nano::change_block block (0, 0, nano::keypair ().prv, 0, 0);
 			if (!result)
 			{
+				// Raw speed of each CPU kernel on a single thread, searching for a solution which is never found
+				nano::work_v1::precomputed_state state (block.root ());
+				for (auto kernel : nano::work_v1::supported_kernels ())
+				{
+					uint64_t nonce (0);
+					uint64_t work_l;
+					uint64_t output_l;
+					auto begin (std::chrono::steady_clock::now ());
+					std::chrono::steady_clock::duration elapsed;
+					do
+					{
+						nano::work_v1::search (kernel, state, std::numeric_limits<uint64_t>::max (), nonce, 1024 * 1024, work_l, output_l);
+						elapsed = std::chrono::steady_clock::now () - begin;
+					} while (elapsed < std::chrono::seconds (1));
+					auto hashes_per_second (static_cast<uint64_t> (nonce / std::chrono::duration<double> (elapsed).count ()));
+					std::cerr << boost::str (boost::format ("Kernel %1%: %2% hashes/s per thread%3%\n") % nano::to_string (kernel) % hashes_per_second % (kernel == work.kernel ? " (used)" : ""));
+				}
+				std::cerr << boost::str (boost::format ("Work pool running %1% threads\n") % work.threads.size ());
 				std::cerr << boost::str (boost::format ("Starting generation profiling. Difficulty: %1$#x (%2%x from base difficulty %3$#x)\n") % difficulty % nano::to_string (nano::difficulty::to_multiplier (difficulty, network_constants.publish_full.base), 4) % network_constants.publish_full.base);
 				while (!result)
 				{
@@ -885,6 +952,63 @@ int main (int argc, char * const * argv)
 				std::cerr << boost::str (boost::format ("%|1$ 12d|\n") % std::chrono::duration_cast<std::chrono::microseconds> (end1 - begin1).count ());
 			}
 		}
+		else if (vm.count ("debug_profile_websocket"))
+		{
+			nano::network_constants::set_active_network (nano::nano_networks::nano_dev_network);
+			nano::node_flags node_flags;
+			nano::update_flags (node_flags, vm);
+			nano::inactive_node inactive_node (nano::unique_path (), data_path, node_flags);
+			auto node = inactive_node.node;
+			size_t count (100000);
+			nano::block_builder builder;
+			std::vector<std::shared_ptr<nano::block>> blocks;
+			blocks.reserve (count);
+			for (size_t i (0); i < count; ++i)
+			{
+				nano::keypair key;
+				blocks.push_back (builder.state ()
+				                  .account (key.pub)
+				                  .previous (nano::block_hash (i))
+				                  .representative (key.pub)
+				                  .balance (i)
+				                  .link (nano::keypair ().pub)
+				                  .sign (key.prv, key.pub)
+				                  .work (0)
+				                  .build ());
+			}
+			nano::websocket::confirmation_options options (node->wallets);
+			std::vector<nano::vote_with_weight_info> votes;
+			auto status = [](std::shared_ptr<nano::block> const & block_a) {
+				return nano::election_status{ block_a, 0, std::chrono::milliseconds (0), std::chrono::milliseconds (0), 0, 1, 0, nano::election_status_type::active_confirmed_quorum };
+			};
+			auto report = [count](std::string const & name_a, std::chrono::steady_clock::time_point const & begin_a, size_t total_bytes_a) {
+				auto time (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - begin_a).count ());
+				std::cout << boost::str (boost::format ("%1%: %2% us total, %3% ns per confirmation, %4% bytes per confirmation\n") % name_a % time % (time * 1000 / count) % (total_bytes_a / count));
+			};
+			std::cout << boost::str (boost::format ("Encoding %1% confirmation messages\n") % count);
+			{
+				nano::websocket::message_builder message_builder;
+				size_t total_bytes (0);
+				auto begin (std::chrono::steady_clock::now ());
+				for (auto const & block : blocks)
+				{
+					auto message (message_builder.block_confirmed (block, block->account (), 1, "send", true, status (block), votes, options));
+					total_bytes += message.to_string ().size ();
+				}
+				report ("json", begin, total_bytes);
+			}
+			{
+				size_t total_bytes (0);
+				auto begin (std::chrono::steady_clock::now ());
+				for (auto const & block : blocks)
+				{
+					auto confirmation (nano::ipc::flatbuffers_builder::from (status (block), votes, block->account (), 1, true, true, false, false));
+					total_bytes += nano::ipc::flatbuffer_producer::make_buffer (*confirmation)->GetSize ();
+				}
+				report ("flatbuffers", begin, total_bytes);
+			}
+			node->stop ();
+		}
 		else if (vm.count ("debug_profile_process"))
 		{
 			nano::network_constants::set_active_network (nano::nano_networks::nano_dev_network);
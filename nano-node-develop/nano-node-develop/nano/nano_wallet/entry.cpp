@@ -5,6 +5,7 @@
 #include <nano/lib/rpcconfig.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/tomlconfig.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/lib/walletconfig.hpp>
 #include <nano/nano_wallet/icon.hpp>
@@ -96,6 +97,8 @@ int run_wallet (QApplication & application, int argc, char * const * argv, boost
 	if (!error)
 	{
 		nano::set_use_memory_pools (config.node.use_memory_pools);
+		config.node.threading.apply ();
+		nano::tracing::configure (config.node.diagnostics_config.tracing);
 
 		config.node.logging.init (data_path);
 		nano::logger_mt logger{ config.node.logging.min_time_between_log_output };
@@ -1,4 +1,5 @@
 #include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/active_transactions.hpp>
 #include <nano/node/confirmation_height_processor.hpp>
 #include <nano/node/confirmation_solicitor.hpp>
@@ -801,6 +802,7 @@ nano::election_insertion_result nano::active_transactions::insert_impl (nano::un
 {
 	debug_assert (lock_a.owns_lock ());
 	debug_assert (block_a->has_sideband ());
+	NANO_TRACE_SPAN (span, active_insert, nano::tracing::id (block_a->hash ()));
 	nano::election_insertion_result result;
 	if (!stopped)
 	{
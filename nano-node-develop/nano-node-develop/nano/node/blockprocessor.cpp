@@ -1,5 +1,6 @@
 #include <nano/lib/threading.hpp>
 #include <nano/lib/timer.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/blockprocessor.hpp>
 #include <nano/node/election.hpp>
 #include <nano/node/node.hpp>
@@ -241,9 +242,11 @@ void nano::block_processor::process_verified_state_blocks (std::deque<std::pair<
 
 void nano::block_processor::process_batch (nano::unique_lock<nano::mutex> & lock_a)
 {
+	auto const wait_start (std::chrono::steady_clock::now ());
 	auto scoped_write_guard = write_database_queue.wait (nano::writer::process_batch);
+	node.stats.observe (nano::stat::latency::write_queue_wait, std::chrono::steady_clock::now () - wait_start);
 	block_post_events post_events ([& store = node.store] { return store.tx_begin_read (); });
-	auto transaction (node.store.tx_begin_write ({ tables::accounts, tables::blocks, tables::frontiers, tables::pending, tables::unchecked }));
+	auto transaction (node.store.tx_begin_write ({ tables::account_heights, tables::accounts, tables::blocks, tables::frontiers, tables::pending, tables::pending_amounts, tables::unchecked }));
 	nano::timer<std::chrono::milliseconds> timer_l;
 	lock_a.lock ();
 	timer_l.start ();
@@ -324,7 +327,9 @@ void nano::block_processor::process_batch (nano::unique_lock<nano::mutex> & lock
 				}
 			}
 			number_of_blocks_processed++;
+			auto const process_start (std::chrono::steady_clock::now ());
 			process_one (transaction, post_events, info, watch_work, force);
+			node.stats.observe (nano::stat::latency::block_processing, std::chrono::steady_clock::now () - process_start);
 		}
 		lock_a.lock ();
 	}
@@ -363,7 +368,10 @@ void nano::block_processor::process_live (nano::transaction const & transaction_
 
 	if (node.websocket_server && node.websocket_server->any_subscriber (nano::websocket::topic::new_unconfirmed_block))
 	{
-		node.websocket_server->broadcast (nano::websocket::message_builder ().new_block_arrived (*block_a));
+		nano::websocket::message_builder builder (node.websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::new_unconfirmed_block));
+		auto balance (block_a->balance ().number ());
+		auto previous_balance (process_return_a.previous_balance.number ());
+		node.websocket_server->broadcast (builder.new_block_arrived (*block_a, balance > previous_balance ? balance - previous_balance : previous_balance - balance));
 	}
 }
 
@@ -372,6 +380,7 @@ nano::process_return nano::block_processor::process_one (nano::write_transaction
 	nano::process_return result;
 	auto block (info_a.block);
 	auto hash (block->hash ());
+	NANO_TRACE_SPAN (span, block_process, nano::tracing::id (hash));
 	result = node.ledger.process (transaction_a, *block, info_a.verified);
 	switch (result.code)
 	{
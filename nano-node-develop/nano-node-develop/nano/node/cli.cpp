@@ -57,6 +57,9 @@ void nano::add_node_options (boost::program_options::options_description & descr
 	("unchecked_clear", "Clear unchecked blocks")
 	("confirmation_height_clear", "Clear confirmation height")
 	("final_vote_clear", "Clear final votes")
+	("account_index_build", "Build the optional account index used by account_history and pending, if it does not exist yet")
+	("account_index_rebuild", "Clear and rebuild the optional account index")
+	("account_index_clear", "Remove the optional account index")
 	("rebuild_database", "Rebuild LMDB database with vacuum for best compaction")
 	("migrate_database_lmdb_to_rocksdb", "Migrates LMDB database to RocksDB")
 	("diagnostics", "Run internal diagnostics")
@@ -110,6 +113,7 @@ void nano::add_node_flag_options (boost::program_options::options_description &
 		("block_processor_verification_size", boost::program_options::value<std::size_t>(), "Increase batch signature verification size in block processor, default 0 (limited by config signature_checker_threads), unlimited for fast_bootstrap")
 		("inactive_votes_cache_size", boost::program_options::value<std::size_t>(), "Increase cached votes without active elections size, default 16384")
 		("vote_processor_capacity", boost::program_options::value<std::size_t>(), "Vote processor queue size before dropping votes, default 144k")
+		("record_message_trace", boost::program_options::value<std::string>(), "Record received publish, confirm_req and confirm_ack messages to this file, for replay by nano_bench")
 		;
 	// clang-format on
 }
@@ -174,6 +178,11 @@ std::error_code nano::update_flags (nano::node_flags & flags_a, boost::program_o
 	{
 		flags_a.vote_processor_capacity = vote_processor_capacity_it->second.as<size_t> ();
 	}
+	auto record_message_trace_it = vm.find ("record_message_trace");
+	if (record_message_trace_it != vm.end ())
+	{
+		flags_a.record_message_trace = record_message_trace_it->second.as<std::string> ();
+	}
 	// Config overriding
 	auto config (vm.find ("config"));
 	if (config != vm.end ())
@@ -650,6 +659,40 @@ std::error_code nano::handle_node_options (boost::program_options::variables_map
 			database_write_lock_error (ec);
 		}
 	}
+	else if (vm.count ("account_index_build") || vm.count ("account_index_rebuild") || vm.count ("account_index_clear"))
+	{
+		boost::filesystem::path data_path = vm.count ("data_path") ? boost::filesystem::path (vm["data_path"].as<std::string> ()) : nano::working_path ();
+		auto node_flags = nano::inactive_node_flag_defaults ();
+		node_flags.read_only = false;
+		nano::update_flags (node_flags, vm);
+		nano::inactive_node node (data_path, node_flags);
+		if (!node.node->init_error ())
+		{
+			auto & ledger (node.node->ledger);
+			auto transaction (node.node->store.tx_begin_write ({ tables::account_heights, tables::meta, tables::pending_amounts }));
+			if (vm.count ("account_index_clear"))
+			{
+				ledger.account_index_clear (transaction);
+				std::cout << "Account index removed" << std::endl;
+			}
+			else if (ledger.account_index && !vm.count ("account_index_rebuild"))
+			{
+				std::cout << "Account index already exists, use --account_index_rebuild to build it again" << std::endl;
+			}
+			else
+			{
+				std::cout << "Building account index, this may take a while..." << std::endl;
+				auto begin (std::chrono::steady_clock::now ());
+				ledger.account_index_build (transaction);
+				auto elapsed (std::chrono::duration_cast<std::chrono::seconds> (std::chrono::steady_clock::now () - begin));
+				std::cout << boost::str (boost::format ("Account index built in %1% seconds") % elapsed.count ()) << std::endl;
+			}
+		}
+		else
+		{
+			database_write_lock_error (ec);
+		}
+	}
 	else if (vm.count ("generate_config"))
 	{
 		auto type = vm["generate_config"].as<std::string> ();
@@ -1,5 +1,6 @@
 #include <nano/lib/blocks.hpp>
 #include <nano/lib/memory.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/lib/work.hpp>
 #include <nano/node/active_transactions.hpp>
 #include <nano/node/common.hpp>
@@ -439,10 +440,13 @@ void nano::message_parser::deserialize_keepalive (nano::stream & stream_a, nano:
 
 void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::message_header const & header_a, nano::uint128_t const & digest_a)
 {
+	NANO_TRACE_SPAN (span, message_parse, 0);
 	auto error (false);
 	nano::publish incoming (error, stream_a, header_a, digest_a, &block_uniquer);
 	if (!error && at_end (stream_a))
 	{
+		NANO_TRACE_IDENTIFY (span, nano::tracing::id (incoming.block->hash ()));
+		NANO_TRACE_END (span);
 		if (!nano::work_validate_entry (*incoming.block))
 		{
 			visitor.publish (incoming);
@@ -454,6 +458,8 @@ void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::m
 	}
 	else
 	{
+		// Without a block there is no id to sample by
+		NANO_TRACE_CANCEL (span);
 		status = parse_status::invalid_publish_message;
 	}
 }
@@ -481,10 +487,13 @@ void nano::message_parser::deserialize_confirm_req (nano::stream & stream_a, nan
 
 void nano::message_parser::deserialize_confirm_ack (nano::stream & stream_a, nano::message_header const & header_a)
 {
+	NANO_TRACE_SPAN (span, message_parse, 0);
 	auto error (false);
 	nano::confirm_ack incoming (error, stream_a, header_a, &vote_uniquer);
 	if (!error && at_end (stream_a))
 	{
+		NANO_TRACE_IDENTIFY (span, nano::tracing::id (incoming.vote->signature));
+		NANO_TRACE_END (span);
 		for (auto & vote_block : incoming.vote->blocks)
 		{
 			if (!vote_block.which ())
@@ -504,6 +513,7 @@ void nano::message_parser::deserialize_confirm_ack (nano::stream & stream_a, nan
 	}
 	else
 	{
+		NANO_TRACE_CANCEL (span);
 		status = parse_status::invalid_confirm_ack_message;
 	}
 }
@@ -1,6 +1,8 @@
 #include <nano/lib/logger_mt.hpp>
 #include <nano/lib/numbers.hpp>
+#include <nano/lib/stats.hpp>
 #include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/node/confirmation_height_processor.hpp>
 #include <nano/node/write_database_queue.hpp>
@@ -61,6 +63,7 @@ void nano::confirmation_height_processor::run (confirmation_height_mode mode_a)
 			}
 
 			set_next_hash ();
+			NANO_TRACE_SPAN (span, cementing, nano::tracing::id (original_block->hash ()));
 
 			const auto num_blocks_to_use_unbounded = confirmation_height::unbounded_cutoff;
 			auto blocks_within_automatic_unbounded_selection = (ledger.cache.block_count < num_blocks_to_use_unbounded || ledger.cache.block_count - num_blocks_to_use_unbounded < ledger.cache.cemented_count);
@@ -101,7 +104,9 @@ void nano::confirmation_height_processor::run (confirmation_height_mode mode_a)
 				{
 					debug_assert (unbounded_processor.pending_empty ());
 					{
+						auto const wait_start (std::chrono::steady_clock::now ());
 						auto scoped_write_guard = write_database_queue.wait (nano::writer::confirmation_height);
+						ledger.stats.observe (nano::stat::latency::write_queue_wait, std::chrono::steady_clock::now () - wait_start);
 						bounded_processor.cement_blocks (scoped_write_guard);
 					}
 					lock_and_cleanup ();
@@ -110,7 +115,9 @@ void nano::confirmation_height_processor::run (confirmation_height_mode mode_a)
 				{
 					debug_assert (bounded_processor.pending_empty ());
 					{
+						auto const wait_start (std::chrono::steady_clock::now ());
 						auto scoped_write_guard = write_database_queue.wait (nano::writer::confirmation_height);
+						ledger.stats.observe (nano::stat::latency::write_queue_wait, std::chrono::steady_clock::now () - wait_start);
 						unbounded_processor.cement_blocks (scoped_write_guard);
 					}
 					lock_and_cleanup ();
@@ -186,6 +193,7 @@ void nano::confirmation_height_processor::notify_observers (std::vector<std::sha
 {
 	for (auto const & block_callback_data : cemented_blocks)
 	{
+		NANO_TRACE_SPAN (span, observers, nano::tracing::id (block_callback_data->hash ()));
 		for (auto const & observer : cemented_observers)
 		{
 			observer (block_callback_data);
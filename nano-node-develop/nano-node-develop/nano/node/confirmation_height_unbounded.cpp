@@ -424,6 +424,7 @@ void nano::confirmation_height_unbounded::cement_blocks (nano::write_guard & sco
 	}
 
 	auto time_spent_cementing = cemented_batch_timer.since_start ().count ();
+	ledger.stats.observe (nano::stat::latency::cementing, cemented_batch_timer.since_start ());
 	if (logging.timing_logging () && time_spent_cementing > 50)
 	{
 		logger.always_log (boost::str (boost::format ("Cemented %1% blocks in %2% %3% (unbounded processor)") % cemented_blocks.size () % time_spent_cementing % cemented_batch_timer.unit ()));
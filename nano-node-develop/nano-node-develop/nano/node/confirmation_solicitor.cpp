@@ -4,6 +4,23 @@
 
 using namespace std::chrono_literals;
 
+namespace
+{
+class root_hashes_hash final
+{
+public:
+	size_t operator() (std::vector<std::pair<nano::block_hash, nano::root>> const & roots_hashes_a) const
+	{
+		size_t result (0);
+		for (auto const & root_hash : roots_hashes_a)
+		{
+			result = result * 31 + std::hash<nano::block_hash> () (root_hash.first);
+		}
+		return result;
+	}
+};
+}
+
 nano::confirmation_solicitor::confirmation_solicitor (nano::network & network_a, nano::node_config const & config_a) :
 max_block_broadcasts (config_a.network_params.network.is_dev_network () ? 4 : 30),
 max_election_requests (50),
@@ -31,7 +48,7 @@ bool nano::confirmation_solicitor::broadcast (nano::election const & election_a)
 	if (rebroadcasted++ < max_block_broadcasts)
 	{
 		auto const & hash (election_a.status.winner->hash ());
-		nano::publish winner (election_a.status.winner);
+		auto winner (nano::publish (election_a.status.winner).to_shared_const_buffer ());
 		unsigned count = 0;
 		// Directed broadcasting to principal representatives
 		for (auto i (representatives_broadcasts.begin ()), n (representatives_broadcasts.end ()); i != n && count < max_election_broadcasts; ++i)
@@ -41,12 +58,12 @@ bool nano::confirmation_solicitor::broadcast (nano::election const & election_a)
 			bool const different (exists && existing->second.hash != hash);
 			if (!exists || different)
 			{
-				i->channel->send (winner);
+				i->channel->send (winner, nano::message_type::publish);
 				count += different ? 0 : 1;
 			}
 		}
 		// Random flood for block propagation
-		network.flood_message (winner, nano::buffer_drop_policy::limiter, 0.5f);
+		network.flood_message (winner, nano::message_type::publish, nano::buffer_drop_policy::limiter, 0.5f);
 		error = false;
 	}
 	return error;
@@ -88,24 +105,32 @@ bool nano::confirmation_solicitor::add (nano::election const & election_a)
 void nano::confirmation_solicitor::flush ()
 {
 	debug_assert (prepared);
+	// Representatives are mostly asked about the same elections, each distinct request is only serialized once
+	std::unordered_map<vector_root_hashes, nano::shared_const_buffer, root_hashes_hash> encoded;
+	auto send = [&encoded](std::shared_ptr<nano::transport::channel> const & channel_a, vector_root_hashes const & roots_hashes_a) {
+		auto existing (encoded.find (roots_hashes_a));
+		if (existing == encoded.end ())
+		{
+			existing = encoded.emplace (roots_hashes_a, nano::confirm_req (roots_hashes_a).to_shared_const_buffer ()).first;
+		}
+		channel_a->send (existing->second, nano::message_type::confirm_req);
+	};
 	for (auto const & request_queue : requests)
 	{
 		auto const & channel (request_queue.first);
-		std::vector<std::pair<nano::block_hash, nano::root>> roots_hashes_l;
+		vector_root_hashes roots_hashes_l;
 		for (auto const & root_hash : request_queue.second)
 		{
 			roots_hashes_l.push_back (root_hash);
 			if (roots_hashes_l.size () == nano::network::confirm_req_hashes_max)
 			{
-				nano::confirm_req req (roots_hashes_l);
-				channel->send (req);
+				send (channel, roots_hashes_l);
 				roots_hashes_l.clear ();
 			}
 		}
 		if (!roots_hashes_l.empty ())
 		{
-			nano::confirm_req req (roots_hashes_l);
-			channel->send (req);
+			send (channel, roots_hashes_l);
 		}
 	}
 	prepared = false;
@@ -26,7 +26,8 @@ node_w (node_a.shared ()),
 request (request_a),
 backoff (backoff_a),
 strand (node_a.io_ctx.get_executor ()),
-need_resolve (request_a.peers),
+hedging (node_a.config.work_peer_hedging && request_a.peers.size () > 1),
+need_resolve (hedging ? node_a.distributed_work.scores.order (request_a.peers) : request_a.peers),
 elapsed (nano::timer_state::started, "distributed work generation timer")
 {
 	debug_assert (!finished);
@@ -71,35 +72,69 @@ void nano::distributed_work::start ()
 		status = work_generation_status::failure_local;
 		request.callback (boost::none);
 	}
-	for (auto const & peer : need_resolve)
+	if (hedging)
 	{
-		boost::system::error_code ec;
-		auto parsed_address (boost::asio::ip::make_address_v6 (peer.first, ec));
-		if (!ec)
+		hedge (0);
+	}
+	else
+	{
+		for (auto const & peer : need_resolve)
 		{
-			do_request (nano::tcp_endpoint (parsed_address, peer.second));
+			resolve (peer);
 		}
-		else
-		{
-			auto this_l (shared_from_this ());
-			node.network.resolver.async_resolve (boost::asio::ip::udp::resolver::query (peer.first, std::to_string (peer.second)), [peer, this_l, &extra = resolved_extra](boost::system::error_code const & ec, boost::asio::ip::udp::resolver::iterator i_a) {
-				if (!ec)
+	}
+}
+
+void nano::distributed_work::resolve (std::pair<std::string, uint16_t> const & peer_a)
+{
+	auto peer_key (nano::work_peer_scores::key (peer_a));
+	boost::system::error_code ec;
+	auto parsed_address (boost::asio::ip::make_address_v6 (peer_a.first, ec));
+	if (!ec)
+	{
+		do_request (nano::tcp_endpoint (parsed_address, peer_a.second), peer_key);
+	}
+	else
+	{
+		auto this_l (shared_from_this ());
+		node.network.resolver.async_resolve (boost::asio::ip::udp::resolver::query (peer_a.first, std::to_string (peer_a.second)), [peer = peer_a, peer_key, this_l, &extra = resolved_extra](boost::system::error_code const & ec, boost::asio::ip::udp::resolver::iterator i_a) {
+			if (!ec)
+			{
+				this_l->do_request (nano::tcp_endpoint (i_a->endpoint ().address (), i_a->endpoint ().port ()), peer_key);
+				++i_a;
+				for (auto & i : boost::make_iterator_range (i_a, {}))
 				{
-					this_l->do_request (nano::tcp_endpoint (i_a->endpoint ().address (), i_a->endpoint ().port ()));
-					++i_a;
-					for (auto & i : boost::make_iterator_range (i_a, {}))
-					{
-						++extra;
-						this_l->do_request (nano::tcp_endpoint (i.endpoint ().address (), i.endpoint ().port ()));
-					}
+					++extra;
+					this_l->do_request (nano::tcp_endpoint (i.endpoint ().address (), i.endpoint ().port ()), peer_key);
 				}
-				else
+			}
+			else
+			{
+				this_l->node.logger.try_log (boost::str (boost::format ("Error resolving work peer: %1%:%2%: %3%") % peer.first % peer.second % ec.message ()));
+				this_l->node.distributed_work.scores.failure (peer_key);
+				this_l->failure ();
+			}
+		});
+	}
+}
+
+void nano::distributed_work::hedge (size_t const index_a)
+{
+	auto expected (index_a);
+	if (index_a < need_resolve.size () && !stopped && next_peer.compare_exchange_strong (expected, index_a + 1))
+	{
+		auto const & peer (need_resolve[index_a]);
+		if (index_a + 1 < need_resolve.size ())
+		{
+			std::weak_ptr<nano::distributed_work> this_w (shared_from_this ());
+			node.workers.add_timed_task (std::chrono::steady_clock::now () + node.distributed_work.scores.hedge_delay (nano::work_peer_scores::key (peer)), [this_w, index_a] {
+				if (auto this_l = this_w.lock ())
 				{
-					this_l->node.logger.try_log (boost::str (boost::format ("Error resolving work peer: %1%:%2%: %3%") % peer.first % peer.second % ec.message ()));
-					this_l->failure ();
+					this_l->hedge (index_a + 1);
 				}
 			});
 		}
+		resolve (peer);
 	}
 }
 
@@ -107,7 +142,14 @@ void nano::distributed_work::start_local ()
 {
 	auto this_l (shared_from_this ());
 	local_generation_started = true;
-	node.work.generate (request.version, request.root, request.difficulty, [this_l](boost::optional<uint64_t> const & work_a) {
+	nano::work_schedule schedule;
+	schedule.priority = request.priority;
+	schedule.client = request.account.value_or (nano::account (0));
+	schedule.deadline = request.deadline;
+	// Requests are cancelled when the node stops, so its stats outlive them
+	schedule.stats = &node.stats;
+	node.work.generate (
+	request.version, request.root, request.difficulty, [this_l](boost::optional<uint64_t> const & work_a) {
 		if (work_a.is_initialized ())
 		{
 			this_l->set_once (*work_a);
@@ -121,13 +163,14 @@ void nano::distributed_work::start_local ()
 			}
 		}
 		this_l->stop_once (false);
-	});
+	},
+	schedule);
 }
 
-void nano::distributed_work::do_request (nano::tcp_endpoint const & endpoint_a)
+void nano::distributed_work::do_request (nano::tcp_endpoint const & endpoint_a, std::string const & peer_a)
 {
 	auto this_l (shared_from_this ());
-	auto connection (std::make_shared<peer_request> (node.io_ctx, endpoint_a));
+	auto connection (std::make_shared<peer_request> (node.io_ctx, endpoint_a, peer_a));
 	{
 		nano::lock_guard<nano::mutex> lock (mutex);
 		connections.emplace_back (connection);
@@ -163,17 +206,21 @@ void nano::distributed_work::do_request (nano::tcp_endpoint const & endpoint_a)
 						{
 							if (connection->response.result () == boost::beast::http::status::ok)
 							{
-								this_l->success (connection->response.body (), connection->endpoint);
+								this_l->success (*connection);
 							}
 							else if (ec)
 							{
 								this_l->node.logger.try_log (boost::str (boost::format ("Work peer responded with an error %1% %2%: %3%") % connection->endpoint.address () % connection->endpoint.port () % connection->response.result ()));
-								this_l->add_bad_peer (connection->endpoint);
+								this_l->add_bad_peer (connection->endpoint, connection->peer);
 								this_l->failure ();
 							}
 						}
 						else if (ec)
 						{
+							if (!this_l->stopped)
+							{
+								this_l->node.distributed_work.scores.failure (connection->peer);
+							}
 							this_l->do_cancel (connection->endpoint);
 							this_l->failure ();
 						}
@@ -182,7 +229,7 @@ void nano::distributed_work::do_request (nano::tcp_endpoint const & endpoint_a)
 				else if (ec && ec != boost::system::errc::operation_canceled)
 				{
 					this_l->node.logger.try_log (boost::str (boost::format ("Unable to write to work_peer %1% %2%: %3% (%4%)") % connection->endpoint.address () % connection->endpoint.port () % ec.message () % ec.value ()));
-					this_l->add_bad_peer (connection->endpoint);
+					this_l->add_bad_peer (connection->endpoint, connection->peer);
 					this_l->failure ();
 				}
 			}));
@@ -190,7 +237,7 @@ void nano::distributed_work::do_request (nano::tcp_endpoint const & endpoint_a)
 		else if (ec && ec != boost::system::errc::operation_canceled)
 		{
 			this_l->node.logger.try_log (boost::str (boost::format ("Unable to connect to work_peer %1% %2%: %3% (%4%)") % connection->endpoint.address () % connection->endpoint.port () % ec.message () % ec.value ()));
-			this_l->add_bad_peer (connection->endpoint);
+			this_l->add_bad_peer (connection->endpoint, connection->peer);
 			this_l->failure ();
 		}
 	}));
@@ -227,8 +274,10 @@ void nano::distributed_work::do_cancel (nano::tcp_endpoint const & endpoint_a)
 	}));
 }
 
-void nano::distributed_work::success (std::string const & body_a, nano::tcp_endpoint const & endpoint_a)
+void nano::distributed_work::success (nano::distributed_work::peer_request const & connection_a)
 {
+	auto const & body_a (connection_a.response.body ());
+	auto const & endpoint_a (connection_a.endpoint);
 	bool error = true;
 	try
 	{
@@ -243,6 +292,7 @@ void nano::distributed_work::success (std::string const & body_a, nano::tcp_endp
 			{
 				error = false;
 				node.unresponsive_work_peers = false;
+				node.distributed_work.scores.success (connection_a.peer, std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - connection_a.start));
 				set_once (work, boost::str (boost::format ("%1%:%2%") % endpoint_a.address () % endpoint_a.port ()));
 				stop_once (true);
 			}
@@ -262,7 +312,7 @@ void nano::distributed_work::success (std::string const & body_a, nano::tcp_endp
 	}
 	if (error)
 	{
-		add_bad_peer (endpoint_a);
+		add_bad_peer (endpoint_a, connection_a.peer);
 		failure ();
 	}
 }
@@ -347,6 +397,11 @@ void nano::distributed_work::cancel ()
 
 void nano::distributed_work::failure ()
 {
+	if (hedging)
+	{
+		// Move on to the next peer without waiting for the hedge delay
+		hedge (next_peer);
+	}
 	if (++failures == need_resolve.size () + resolved_extra.load ())
 	{
 		handle_failure ();
@@ -387,8 +442,9 @@ void nano::distributed_work::handle_failure ()
 	}
 }
 
-void nano::distributed_work::add_bad_peer (nano::tcp_endpoint const & endpoint_a)
+void nano::distributed_work::add_bad_peer (nano::tcp_endpoint const & endpoint_a, std::string const & peer_a)
 {
+	node.distributed_work.scores.failure (peer_a);
 	nano::lock_guard<nano::mutex> guard (mutex);
 	bad_peers.emplace_back (boost::str (boost::format ("%1%:%2%") % endpoint_a.address () % endpoint_a.port ()));
 }
@@ -35,6 +35,9 @@ struct work_request final
 	boost::optional<nano::account> const account;
 	std::function<void(boost::optional<uint64_t>)> callback;
 	std::vector<std::pair<std::string, uint16_t>> const peers;
+	nano::work_priority const priority{ nano::work_priority::normal };
+	/** Local generation fails if not solved by then, see work_schedule::deadline */
+	std::chrono::steady_clock::time_point const deadline{ std::chrono::steady_clock::time_point::max () };
 };
 
 /**
@@ -54,13 +57,17 @@ class distributed_work final : public std::enable_shared_from_this<nano::distrib
 	class peer_request final
 	{
 	public:
-		peer_request (boost::asio::io_context & io_ctx_a, nano::tcp_endpoint const & endpoint_a) :
+		peer_request (boost::asio::io_context & io_ctx_a, nano::tcp_endpoint const & endpoint_a, std::string const & peer_a = "") :
 		endpoint (endpoint_a),
+		peer (peer_a),
 		socket (io_ctx_a)
 		{
 		}
 		std::shared_ptr<request_type> get_prepared_json_request (std::string const &) const;
 		nano::tcp_endpoint const endpoint;
+		/** The configured peer this endpoint was resolved from, see work_peer_scores */
+		std::string const peer;
+		std::chrono::steady_clock::time_point const start{ std::chrono::steady_clock::now () };
 		boost::beast::flat_buffer buffer;
 		boost::beast::http::response<boost::beast::http::string_body> response;
 		boost::asio::ip::tcp::socket socket;
@@ -74,18 +81,22 @@ public:
 
 private:
 	void start_local ();
+	/** Resolve \p peer_a and send a request to each of its endpoints */
+	void resolve (std::pair<std::string, uint16_t> const & peer_a);
+	/** Start on the peer at \p index_a, unless it was started already, and ask the next one if this one is slow to respond */
+	void hedge (size_t const index_a);
 	/** Send a work_generate message to \p endpoint_a and handle a response */
-	void do_request (nano::tcp_endpoint const & endpoint_a);
+	void do_request (nano::tcp_endpoint const & endpoint_a, std::string const & peer_a);
 	/** Send a work_cancel message using a new connection to \p endpoint_a */
 	void do_cancel (nano::tcp_endpoint const & endpoint_a);
 	/** Called on a successful peer response, validates the reply */
-	void success (std::string const &, nano::tcp_endpoint const &);
+	void success (nano::distributed_work::peer_request const &);
 	/** Send a work_cancel message to all remaining connections */
 	void stop_once (bool const);
 	void set_once (uint64_t const, std::string const & source_a = "local");
 	void failure ();
 	void handle_failure ();
-	void add_bad_peer (nano::tcp_endpoint const &);
+	void add_bad_peer (nano::tcp_endpoint const &, std::string const & peer_a);
 
 	nano::node & node;
 	// Only used in destructor, as the node reference can become invalid before distributed_work objects go out of scope
@@ -94,7 +105,11 @@ private:
 
 	std::chrono::seconds backoff;
 	boost::asio::strand<boost::asio::io_context::executor_type> strand;
+	/** Peers are contacted one at a time in need_resolve order, see node_config::work_peer_hedging */
+	bool const hedging;
 	std::vector<std::pair<std::string, uint16_t>> const need_resolve;
+	/** Index in need_resolve of the next peer to contact when hedging */
+	std::atomic<size_t> next_peer{ 0 };
 	std::vector<std::weak_ptr<peer_request>> connections; // protected by the mutex
 
 	work_generation_status status{ work_generation_status::ongoing };
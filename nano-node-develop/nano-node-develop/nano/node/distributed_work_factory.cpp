@@ -2,6 +2,91 @@
 #include <nano/node/distributed_work_factory.hpp>
 #include <nano/node/node.hpp>
 
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+std::chrono::milliseconds constexpr nano::work_peer_scores::hedge_delay_unknown;
+
+void nano::work_peer_scores::success (std::string const & peer_a, std::chrono::milliseconds const & elapsed_a)
+{
+	nano::lock_guard<nano::mutex> guard (mutex);
+	auto & score (scores[peer_a]);
+	auto sample (static_cast<double> (elapsed_a.count ()));
+	if (score.measured)
+	{
+		// Gains of 1/4 and 1/8 as in RFC 6298
+		score.deviation_ms += (std::abs (score.response_ms - sample) - score.deviation_ms) / 4;
+		score.response_ms += (sample - score.response_ms) / 8;
+	}
+	else
+	{
+		score.measured = true;
+		score.response_ms = sample;
+		score.deviation_ms = sample / 2;
+	}
+	score.reliability += (1 - score.reliability) / 8;
+}
+
+void nano::work_peer_scores::failure (std::string const & peer_a)
+{
+	nano::lock_guard<nano::mutex> guard (mutex);
+	auto & score (scores[peer_a]);
+	score.measured = true;
+	score.reliability -= score.reliability / 8;
+}
+
+std::vector<std::pair<std::string, uint16_t>> nano::work_peer_scores::order (std::vector<std::pair<std::string, uint16_t>> const & peers_a) const
+{
+	std::vector<std::pair<double, std::pair<std::string, uint16_t>>> expected;
+	{
+		nano::lock_guard<nano::mutex> guard (mutex);
+		for (auto const & peer : peers_a)
+		{
+			auto existing (scores.find (key (peer)));
+			auto expected_l (0.0);
+			if (existing != scores.end () && existing->second.measured)
+			{
+				// Peers which never returned valid work are expected to take as long as the hedge delay of unknown peers
+				auto response_l (existing->second.response_ms > 0 ? existing->second.response_ms : static_cast<double> (hedge_delay_unknown.count ()));
+				expected_l = response_l / std::max (existing->second.reliability, 1e-3);
+			}
+			expected.emplace_back (expected_l, peer);
+		}
+	}
+	std::stable_sort (expected.begin (), expected.end (), [](auto const & lhs, auto const & rhs) { return lhs.first < rhs.first; });
+	std::vector<std::pair<std::string, uint16_t>> result;
+	for (auto & item : expected)
+	{
+		result.push_back (std::move (item.second));
+	}
+	return result;
+}
+
+std::chrono::milliseconds nano::work_peer_scores::hedge_delay (std::string const & peer_a) const
+{
+	auto result (hedge_delay_unknown);
+	nano::lock_guard<nano::mutex> guard (mutex);
+	auto existing (scores.find (peer_a));
+	if (existing != scores.end () && existing->second.response_ms > 0)
+	{
+		result = std::chrono::milliseconds (static_cast<int64_t> (std::ceil (existing->second.response_ms + 4 * existing->second.deviation_ms)));
+	}
+	return result;
+}
+
+size_t nano::work_peer_scores::size () const
+{
+	nano::lock_guard<nano::mutex> guard (mutex);
+	return scores.size ();
+}
+
+std::string nano::work_peer_scores::key (std::pair<std::string, uint16_t> const & peer_a)
+{
+	return boost::str (boost::format ("%1%:%2%") % peer_a.first % peer_a.second);
+}
+
 nano::distributed_work_factory::distributed_work_factory (nano::node & node_a) :
 node (node_a)
 {
@@ -12,9 +97,9 @@ nano::distributed_work_factory::~distributed_work_factory ()
 	stop ();
 }
 
-bool nano::distributed_work_factory::make (nano::work_version const version_a, nano::root const & root_a, std::vector<std::pair<std::string, uint16_t>> const & peers_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t>)> const & callback_a, boost::optional<nano::account> const & account_a)
+bool nano::distributed_work_factory::make (nano::work_version const version_a, nano::root const & root_a, std::vector<std::pair<std::string, uint16_t>> const & peers_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t>)> const & callback_a, boost::optional<nano::account> const & account_a, nano::work_priority const priority_a, std::chrono::steady_clock::time_point const & deadline_a)
 {
-	return make (std::chrono::seconds (1), nano::work_request{ version_a, root_a, difficulty_a, account_a, callback_a, peers_a });
+	return make (std::chrono::seconds (1), nano::work_request{ version_a, root_a, difficulty_a, account_a, callback_a, peers_a, priority_a, deadline_a });
 }
 
 bool nano::distributed_work_factory::make (std::chrono::seconds const & backoff_a, nano::work_request const & request_a)
@@ -100,5 +185,6 @@ std::unique_ptr<nano::container_info_component> nano::collect_container_info (di
 	auto sizeof_item_element = sizeof (decltype (nano::distributed_work_factory::items)::value_type);
 	auto composite = std::make_unique<container_info_composite> (name);
 	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "items", item_count, sizeof_item_element }));
+	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "peer_scores", distributed_work.scores.size (), sizeof (std::string) + sizeof (double) * 4 }));
 	return composite;
 }
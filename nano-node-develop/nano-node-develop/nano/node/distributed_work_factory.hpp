@@ -1,10 +1,13 @@
 #pragma once
 
 #include <nano/lib/numbers.hpp>
+#include <nano/lib/work.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -16,17 +19,59 @@ class node;
 class root;
 struct work_request;
 
+/**
+ * Response times and reliability of work peers, as measured by distributed_work. Peers are identified by their
+ * configured "address:port", even if the address resolves to several endpoints.
+ */
+class work_peer_scores final
+{
+public:
+	/** Records valid work received \p elapsed_a after sending the request */
+	void success (std::string const & peer_a, std::chrono::milliseconds const & elapsed_a);
+	/** Records a peer which could not be reached, returned an error or returned invalid work */
+	void failure (std::string const & peer_a);
+	/**
+	 * Orders \p peers_a by their expected time to valid work, the response time divided by the rate of valid
+	 * responses. Peers without measurements come first so they get measured, otherwise the configured order is kept.
+	 * Peers which never returned valid work are taken to respond in hedge_delay_unknown.
+	 */
+	std::vector<std::pair<std::string, uint16_t>> order (std::vector<std::pair<std::string, uint16_t>> const & peers_a) const;
+	/**
+	 * Time to wait for a response from \p peer_a before also asking the next peer. This is the smoothed
+	 * response time plus four times its mean deviation, as for TCP retransmission timeouts.
+	 */
+	std::chrono::milliseconds hedge_delay (std::string const & peer_a) const;
+	size_t size () const;
+	static std::string key (std::pair<std::string, uint16_t> const &);
+	/** Hedge delay for peers without measurements */
+	static std::chrono::milliseconds constexpr hedge_delay_unknown{ 500 };
+
+private:
+	class score final
+	{
+	public:
+		bool measured{ false };
+		double response_ms{ 0 };
+		double deviation_ms{ 0 };
+		/** Smoothed rate of valid responses */
+		double reliability{ 1 };
+	};
+	mutable nano::mutex mutex;
+	std::unordered_map<std::string, score> scores;
+};
+
 class distributed_work_factory final
 {
 public:
 	distributed_work_factory (nano::node &);
 	~distributed_work_factory ();
-	bool make (nano::work_version const, nano::root const &, std::vector<std::pair<std::string, uint16_t>> const &, uint64_t, std::function<void(boost::optional<uint64_t>)> const &, boost::optional<nano::account> const & = boost::none);
+	bool make (nano::work_version const, nano::root const &, std::vector<std::pair<std::string, uint16_t>> const &, uint64_t, std::function<void(boost::optional<uint64_t>)> const &, boost::optional<nano::account> const & = boost::none, nano::work_priority const = nano::work_priority::normal, std::chrono::steady_clock::time_point const & = std::chrono::steady_clock::time_point::max ());
 	bool make (std::chrono::seconds const &, nano::work_request const &);
 	void cancel (nano::root const &);
 	void cleanup_finished ();
 	void stop ();
 	size_t size () const;
+	nano::work_peer_scores scores;
 
 private:
 	std::unordered_multimap<nano::root, std::weak_ptr<nano::distributed_work>> items;
@@ -1,3 +1,4 @@
+#include <nano/lib/tracing.hpp>
 #include <nano/node/confirmation_solicitor.hpp>
 #include <nano/node/election.hpp>
 #include <nano/node/network.hpp>
@@ -44,6 +45,7 @@ void nano::election::confirm_once (nano::unique_lock<nano::mutex> & lock_a, nano
 		election_winners_lk.unlock ();
 		status.election_end = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::system_clock::now ().time_since_epoch ());
 		status.election_duration = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - election_start);
+		node.stats.observe (nano::stat::latency::election, status.election_duration);
 		status.confirmation_request_count = confirmation_request_count;
 		status.block_count = nano::narrow_cast<decltype (status.block_count)> (last_blocks.size ());
 		status.voter_count = nano::narrow_cast<decltype (status.voter_count)> (last_votes.size ());
@@ -312,6 +314,7 @@ std::shared_ptr<nano::block> nano::election::find (nano::block_hash const & hash
 
 nano::election_vote_result nano::election::vote (nano::account const & rep, uint64_t timestamp_a, nano::block_hash const & block_hash_a)
 {
+	NANO_TRACE_SPAN (span, election_vote, nano::tracing::id (block_hash_a));
 	auto replay (false);
 	auto online_stake (node.online_reps.trended ());
 	auto weight (node.ledger.weight (rep));
@@ -65,6 +65,7 @@ subscriber (subscriber_a)
 
 void nano::ipc::action_handler::on_topic_confirmation (nanoapi::Envelope const & envelope_a)
 {
+	require_subscriber ();
 	auto confirmationTopic (get_message<nanoapi::TopicConfirmation> (envelope_a));
 	ipc_server.get_broker ()->subscribe (subscriber, std::move (confirmationTopic));
 	nanoapi::EventAckT ack;
@@ -74,6 +75,7 @@ void nano::ipc::action_handler::on_topic_confirmation (nanoapi::Envelope const &
 void nano::ipc::action_handler::on_service_register (nanoapi::Envelope const & envelope_a)
 {
 	require_oneof (envelope_a, { nano::ipc::access_permission::api_service_register, nano::ipc::access_permission::service });
+	require_subscriber ();
 	auto query (get_message<nanoapi::ServiceRegister> (envelope_a));
 	ipc_server.get_broker ()->service_register (query->service_name, this->subscriber);
 	nanoapi::SuccessT success;
@@ -98,6 +100,7 @@ void nano::ipc::action_handler::on_service_stop (nanoapi::Envelope const & envel
 
 void nano::ipc::action_handler::on_topic_service_stop (nanoapi::Envelope const & envelope_a)
 {
+	require_subscriber ();
 	auto topic (get_message<nanoapi::TopicServiceStop> (envelope_a));
 	ipc_server.get_broker ()->subscribe (subscriber, std::move (topic));
 	nanoapi::EventAckT ack;
@@ -181,3 +184,11 @@ void nano::ipc::action_handler::require_oneof (nanoapi::Envelope const & envelop
 		throw nano::error (nano::error_common::access_denied);
 	}
 }
+
+void nano::ipc::action_handler::require_subscriber () const
+{
+	if (subscriber.expired ())
+	{
+		throw nano::error ("Subscriptions and services are not supported on this transport");
+	}
+}
@@ -62,6 +62,8 @@ namespace ipc
 		void require (nanoapi::Envelope const & envelope_a, nano::ipc::access_permission permission_a) const;
 		void require_all (nanoapi::Envelope const & envelope_a, std::initializer_list<nano::ipc::access_permission> permissions_a) const;
 		void require_oneof (nanoapi::Envelope const & envelope_a, std::initializer_list<nano::ipc::access_permission> alternative_permissions_a) const;
+		/** Throws if there is no session to push messages to, such as over the shared memory transport */
+		void require_subscriber () const;
 
 		nano::node & node;
 		nano::ipc::ipc_server & ipc_server;
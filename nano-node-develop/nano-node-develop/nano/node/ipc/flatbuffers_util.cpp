@@ -1,5 +1,7 @@
 #include <nano/lib/blocks.hpp>
 #include <nano/lib/numbers.hpp>
+#include <nano/node/common.hpp>
+#include <nano/node/election.hpp>
 #include <nano/node/ipc/flatbuffers_util.hpp>
 #include <nano/secure/common.hpp>
 
@@ -82,6 +84,118 @@ std::unique_ptr<nanoapi::BlockChangeT> nano::ipc::flatbuffers_builder::from (nan
 	return block;
 }
 
+std::unique_ptr<nanoapi::EventConfirmationT> nano::ipc::flatbuffers_builder::from (nano::election_status const & election_status_a, std::vector<nano::vote_with_weight_info> const & election_votes_a, nano::account const & account_a, nano::amount const & amount_a, bool is_state_send_a, bool include_block_a, bool include_election_info_a, bool include_votes_a)
+{
+	auto confirmation (std::make_unique<nanoapi::EventConfirmationT> ());
+	confirmation->account = account_a.to_account ();
+	confirmation->amount = amount_a.to_string_dec ();
+	confirmation->hash = election_status_a.winner->hash ().to_string ();
+	switch (election_status_a.type)
+	{
+		case nano::election_status_type::active_confirmed_quorum:
+			confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_active_quorum;
+			break;
+		case nano::election_status_type::active_confirmation_height:
+			confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_active_confirmation_height;
+			break;
+		case nano::election_status_type::inactive_confirmation_height:
+			confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_inactive;
+			break;
+		default:
+			debug_assert (false);
+			break;
+	};
+	if (include_block_a)
+	{
+		confirmation->block = block_to_union (*election_status_a.winner, amount_a, is_state_send_a);
+	}
+	if (include_election_info_a)
+	{
+		confirmation->election_info = std::make_unique<nanoapi::ElectionInfoT> ();
+		confirmation->election_info->duration = election_status_a.election_duration.count ();
+		confirmation->election_info->time = election_status_a.election_end.count ();
+		confirmation->election_info->tally = election_status_a.tally.to_string_dec ();
+		confirmation->election_info->block_count = election_status_a.block_count;
+		confirmation->election_info->voter_count = election_status_a.voter_count;
+		confirmation->election_info->request_count = election_status_a.confirmation_request_count;
+		if (include_votes_a)
+		{
+			confirmation->election_info->votes.reserve (election_votes_a.size ());
+			for (auto const & vote_l : election_votes_a)
+			{
+				auto vote (std::make_unique<nanoapi::ElectionVoteT> ());
+				vote->representative = vote_l.representative.to_account ();
+				vote->timestamp = std::to_string (vote_l.timestamp);
+				vote->hash = vote_l.hash.to_string ();
+				vote->weight = vote_l.weight.convert_to<std::string> ();
+				confirmation->election_info->votes.push_back (std::move (vote));
+			}
+		}
+	}
+	return confirmation;
+}
+
+std::unique_ptr<nanoapi::EventVoteT> nano::ipc::flatbuffers_builder::from (nano::vote const & vote_a, nano::vote_code code_a)
+{
+	auto vote (std::make_unique<nanoapi::EventVoteT> ());
+	vote->account = vote_a.account.to_account ();
+	vote_a.signature.encode_hex (vote->signature);
+	vote->timestamp = std::to_string (vote_a.timestamp);
+	for (auto const & hash : vote_a)
+	{
+		vote->blocks.push_back (hash.to_string ());
+	}
+	switch (code_a)
+	{
+		case nano::vote_code::vote:
+			vote->type = nanoapi::VoteType::VoteType_vote;
+			break;
+		case nano::vote_code::replay:
+			vote->type = nanoapi::VoteType::VoteType_replay;
+			break;
+		case nano::vote_code::indeterminate:
+			vote->type = nanoapi::VoteType::VoteType_indeterminate;
+			break;
+		case nano::vote_code::invalid:
+			vote->type = nanoapi::VoteType::VoteType_invalid;
+			break;
+	}
+	return vote;
+}
+
+std::unique_ptr<nanoapi::EventTelemetryT> nano::ipc::flatbuffers_builder::from (nano::telemetry_data const & telemetry_data_a, std::string const & address_a, uint16_t port_a)
+{
+	auto telemetry (std::make_unique<nanoapi::EventTelemetryT> ());
+	telemetry->block_count = telemetry_data_a.block_count;
+	telemetry->cemented_count = telemetry_data_a.cemented_count;
+	telemetry->unchecked_count = telemetry_data_a.unchecked_count;
+	telemetry->account_count = telemetry_data_a.account_count;
+	telemetry->bandwidth_cap = telemetry_data_a.bandwidth_cap;
+	telemetry->peer_count = telemetry_data_a.peer_count;
+	telemetry->protocol_version = telemetry_data_a.protocol_version;
+	telemetry->uptime = telemetry_data_a.uptime;
+	telemetry->genesis_block = telemetry_data_a.genesis_block.to_string ();
+	telemetry->major_version = telemetry_data_a.major_version;
+	telemetry->minor_version = telemetry_data_a.minor_version;
+	telemetry->patch_version = telemetry_data_a.patch_version;
+	telemetry->pre_release_version = telemetry_data_a.pre_release_version;
+	telemetry->maker = telemetry_data_a.maker;
+	telemetry->timestamp = std::chrono::duration_cast<std::chrono::milliseconds> (telemetry_data_a.timestamp.time_since_epoch ()).count ();
+	telemetry->active_difficulty = nano::to_string_hex (telemetry_data_a.active_difficulty);
+	telemetry->node_id = telemetry_data_a.node_id.to_node_id ();
+	telemetry->signature = telemetry_data_a.signature.to_string ();
+	telemetry->address = address_a;
+	telemetry->port = port_a;
+	return telemetry;
+}
+
+std::unique_ptr<nanoapi::EventNewUnconfirmedBlockT> nano::ipc::flatbuffers_builder::from (nano::block const & block_a, nano::amount const & amount_a)
+{
+	auto new_block (std::make_unique<nanoapi::EventNewUnconfirmedBlockT> ());
+	new_block->block = block_to_union (block_a, amount_a, block_a.sideband ().details.is_send);
+	return new_block;
+}
+
 nanoapi::BlockUnion nano::ipc::flatbuffers_builder::block_to_union (nano::block const & block_a, nano::amount const & amount_a, bool is_state_send_a)
 {
 	nanoapi::BlockUnion u;
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <nano/ipc_flatbuffers_lib/generated/flatbuffers/nanoapi_generated.h>
+#include <nano/lib/numbers.hpp>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace nano
 {
-class amount;
 class block;
+class election_status;
+class telemetry_data;
+class vote;
+enum class vote_code;
+class vote_with_weight_info;
 class send_block;
 class receive_block;
 class change_block;
@@ -27,6 +34,12 @@ namespace ipc
 		static std::unique_ptr<nanoapi::BlockReceiveT> from (nano::receive_block const & block_a);
 		static std::unique_ptr<nanoapi::BlockOpenT> from (nano::open_block const & block_a);
 		static std::unique_ptr<nanoapi::BlockChangeT> from (nano::change_block const & block_a);
+		/** Confirmation event shared by the IPC broker and websockets. Votes are only included along with the election info */
+		static std::unique_ptr<nanoapi::EventConfirmationT> from (nano::election_status const & election_status_a, std::vector<nano::vote_with_weight_info> const & election_votes_a, nano::account const & account_a, nano::amount const & amount_a, bool is_state_send_a, bool include_block_a, bool include_election_info_a, bool include_votes_a);
+		static std::unique_ptr<nanoapi::EventVoteT> from (nano::vote const & vote_a, nano::vote_code code_a);
+		static std::unique_ptr<nanoapi::EventTelemetryT> from (nano::telemetry_data const & telemetry_data_a, std::string const & address_a, uint16_t port_a);
+		/** \p amount_a is the balance change of the block, which identifies epoch blocks */
+		static std::unique_ptr<nanoapi::EventNewUnconfirmedBlockT> from (nano::block const & block_a, nano::amount const & amount_a);
 	};
 }
 }
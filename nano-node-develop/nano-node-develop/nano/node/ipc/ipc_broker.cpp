@@ -31,35 +31,8 @@ void nano::ipc::broker::start ()
 			// is that broadcast is called only to not find any live sessions.
 			if (this_l->confirmation_subscriber_count () > 0)
 			{
-				auto confirmation (std::make_shared<nanoapi::EventConfirmationT> ());
-
-				confirmation->account = account_a.to_account ();
-				confirmation->amount = amount_a.to_string_dec ();
-				switch (status_a.type)
-				{
-					case nano::election_status_type::active_confirmed_quorum:
-						confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_active_quorum;
-						break;
-					case nano::election_status_type::active_confirmation_height:
-						confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_active_confirmation_height;
-						break;
-					case nano::election_status_type::inactive_confirmation_height:
-						confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_inactive;
-						break;
-					default:
-						debug_assert (false);
-						break;
-				};
-				confirmation->confirmation_type = nanoapi::TopicConfirmationType::TopicConfirmationType_active_quorum;
-				confirmation->block = nano::ipc::flatbuffers_builder::block_to_union (*status_a.winner, amount_a, is_state_send_a);
-				confirmation->election_info = std::make_unique<nanoapi::ElectionInfoT> ();
-				confirmation->election_info->duration = status_a.election_duration.count ();
-				confirmation->election_info->time = status_a.election_end.count ();
-				confirmation->election_info->tally = status_a.tally.to_string_dec ();
-				confirmation->election_info->block_count = status_a.block_count;
-				confirmation->election_info->voter_count = status_a.voter_count;
-				confirmation->election_info->request_count = status_a.confirmation_request_count;
-
+				// Everything is included, broadcast removes what each subscriber did not ask for
+				std::shared_ptr<nanoapi::EventConfirmationT> confirmation (nano::ipc::flatbuffers_builder::from (status_a, votes_a, account_a, amount_a, is_state_send_a, true, true, true));
 				this_l->broadcast (confirmation);
 			}
 		}
@@ -113,6 +86,7 @@ void nano::ipc::broker::broadcast (std::shared_ptr<nanoapi::EventConfirmationT>
 {
 	using Filter = nanoapi::TopicConfirmationTypeFilter;
 	decltype (confirmation_a->election_info) election_info;
+	decltype (confirmation_a->election_info->votes) votes;
 	nanoapi::BlockUnion block;
 	auto itr (confirmation_subscribers->begin ());
 	while (itr != confirmation_subscribers->end ())
@@ -166,9 +140,14 @@ void nano::ipc::broker::broadcast (std::shared_ptr<nanoapi::EventConfirmationT>
 			};
 			// Apply any filters
 			auto & options (itr->topic->options);
+			if ((!options || !options->include_election_info_with_votes) && confirmation_a->election_info)
+			{
+				votes = std::move (confirmation_a->election_info->votes);
+				confirmation_a->election_info->votes.clear ();
+			}
 			if (options)
 			{
-				if (!options->include_election_info)
+				if (!options->include_election_info && !options->include_election_info_with_votes)
 				{
 					election_info = std::move (confirmation_a->election_info);
 					confirmation_a->election_info = nullptr;
@@ -207,6 +186,11 @@ void nano::ipc::broker::broadcast (std::shared_ptr<nanoapi::EventConfirmationT>
 			{
 				confirmation_a->election_info = std::move (election_info);
 			}
+			if (!votes.empty ())
+			{
+				confirmation_a->election_info->votes = std::move (votes);
+				votes.clear ();
+			}
 			if (block.type != nanoapi::Block::Block_NONE)
 			{
 				confirmation_a->block = block;
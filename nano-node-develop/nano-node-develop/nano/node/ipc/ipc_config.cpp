@@ -26,6 +26,15 @@ nano::error nano::ipc::ipc_config::serialize_toml (nano::tomlconfig & toml) cons
 	domain_l.put ("io_timeout", transport_domain.io_timeout, "Timeout for requests.\ntype:seconds");
 	toml.put_child ("local", domain_l);
 
+	nano::tomlconfig shared_memory_l;
+	shared_memory_l.put ("enable", transport_shared_memory.enabled, "Enable or disable IPC via shared memory, for clients on the same host. Linux only.\ntype:bool");
+	shared_memory_l.put ("allow_unsafe", transport_shared_memory.allow_unsafe, "If enabled, certain unsafe RPCs can be used. Not recommended for production systems.\ntype:bool");
+	shared_memory_l.put ("name", transport_shared_memory.name, "Name of the shared memory segment. Clients must use the same name.\ntype:string");
+	shared_memory_l.put ("connections", transport_shared_memory.connections, "Maximum number of clients connected at the same time.\ntype:uint32");
+	shared_memory_l.put ("ring_size", transport_shared_memory.ring_size, "Size in bytes of the buffer in each direction of a connection. Larger messages are streamed through it. Must be a power of two, at least 4096.\ntype:uint32");
+	shared_memory_l.put ("io_timeout", transport_shared_memory.io_timeout, "Timeout for writing responses to a client which is not reading them.\ntype:seconds");
+	toml.put_child ("shared_memory", shared_memory_l);
+
 	nano::tomlconfig flatbuffers_l;
 	flatbuffers_l.put ("skip_unexpected_fields_in_json", flatbuffers.skip_unexpected_fields_in_json, "Allow client to send unknown fields in json messages. These will be ignored.\ntype:bool");
 	flatbuffers_l.put ("verify_buffers", flatbuffers.verify_buffers, "Verify that the buffer is valid before parsing. This is recommended when receiving data from untrusted sources.\ntype:bool");
@@ -56,6 +65,25 @@ nano::error nano::ipc::ipc_config::deserialize_toml (nano::tomlconfig & toml)
 		domain_l->get<size_t> ("io_timeout", transport_domain.io_timeout);
 	}
 
+	auto shared_memory_l (toml.get_optional_child ("shared_memory"));
+	if (shared_memory_l)
+	{
+		shared_memory_l->get<bool> ("enable", transport_shared_memory.enabled);
+		shared_memory_l->get<bool> ("allow_unsafe", transport_shared_memory.allow_unsafe);
+		shared_memory_l->get<std::string> ("name", transport_shared_memory.name);
+		shared_memory_l->get<unsigned> ("connections", transport_shared_memory.connections);
+		shared_memory_l->get<uint32_t> ("ring_size", transport_shared_memory.ring_size);
+		shared_memory_l->get<size_t> ("io_timeout", transport_shared_memory.io_timeout);
+		if (transport_shared_memory.connections == 0)
+		{
+			toml.get_error ().set ("ipc.shared_memory.connections must be at least 1");
+		}
+		if (transport_shared_memory.ring_size < 4096 || (transport_shared_memory.ring_size & (transport_shared_memory.ring_size - 1)) != 0)
+		{
+			toml.get_error ().set ("ipc.shared_memory.ring_size must be a power of two, at least 4096");
+		}
+	}
+
 	auto flatbuffers_l (toml.get_optional_child ("flatbuffers"));
 	if (flatbuffers_l)
 	{
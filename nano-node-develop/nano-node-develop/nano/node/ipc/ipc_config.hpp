@@ -61,6 +61,18 @@ namespace ipc
 		uint16_t port;
 	};
 
+	/** Shared memory transport config, for clients on the same host. Only supported on Linux. */
+	class ipc_config_shared_memory : public ipc_config_transport
+	{
+	public:
+		/** Name of the POSIX shared memory segment */
+		std::string name{ "/nano" };
+		/** Number of clients which can be connected at the same time */
+		unsigned connections{ 16 };
+		/** Size of the ring in each direction of a connection. Must be a power of two */
+		uint32_t ring_size{ 1024 * 1024 };
+	};
+
 	/** IPC configuration */
 	class ipc_config
 	{
@@ -71,6 +83,7 @@ namespace ipc
 		nano::error serialize_toml (nano::tomlconfig & toml) const;
 		ipc_config_domain_socket transport_domain;
 		ipc_config_tcp_socket transport_tcp;
+		ipc_config_shared_memory transport_shared_memory;
 		ipc_config_flatbuffers flatbuffers;
 	};
 }
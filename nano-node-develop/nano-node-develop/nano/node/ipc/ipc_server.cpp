@@ -4,6 +4,7 @@
 #include <nano/boost/asio/strand.hpp>
 #include <nano/lib/config.hpp>
 #include <nano/lib/ipc.hpp>
+#include <nano/lib/ipc_shm.hpp>
 #include <nano/lib/locks.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/timer.hpp>
@@ -20,9 +21,15 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <deque>
 #include <list>
 
+#if defined(__linux__)
+#include <signal.h>
+#endif
+
 #include <flatbuffers/flatbuffers.h>
 
 using namespace boost::log;
@@ -553,6 +560,385 @@ private:
 	std::unique_ptr<boost::asio::io_context> io_ctx;
 	std::unique_ptr<ACCEPTOR_TYPE> acceptor;
 };
+
+/**
+ * Server side of a shared memory connection slot. A new instance is made every time a client claims the slot,
+ * so responses to a client which has since disconnected can never reach the next one.
+ */
+class shm_connection final
+{
+public:
+	shm_connection (nano::ipc::shm_segment const & segment_a, uint32_t index_a, nano::ipc::ipc_config_transport & config_transport_a) :
+	segment (segment_a), responses (segment_a.responses (index_a)), config_transport (config_transport_a)
+	{
+	}
+
+	/**
+	 * Queues a response for the transport thread to write. This can be called from any thread and never waits for
+	 * the client, so a client which doesn't read its responses can't hold up the node's threads.
+	 */
+	void queue_response (uint32_t request_id_a, std::shared_ptr<void const> const & owner_a, uint8_t const * data_a, size_t size_a)
+	{
+		nano::lock_guard<nano::mutex> guard (mutex);
+		if (closed == 0)
+		{
+			if (queued_bytes + size_a > max_queued_bytes)
+			{
+				// Responses accumulate when the client keeps sending requests but doesn't read their responses
+				close_locked ();
+			}
+			else
+			{
+				if (queue.empty ())
+				{
+					last_progress = std::chrono::steady_clock::now ();
+				}
+				queue.push_back ({ request_id_a, owner_a, data_a, size_a, 0 });
+				queued_bytes += size_a;
+				// Closing waits for the lock, so the segment is still mapped
+				segment.notify_server ();
+			}
+		}
+	}
+
+	/**
+	 * Writes queued responses for as long as the client's ring has space. Only called by the transport thread.
+	 * @return true if anything was written
+	 */
+	bool write_responses ()
+	{
+		auto result (false);
+		nano::lock_guard<nano::mutex> guard (mutex);
+		auto full (false);
+		while (closed == 0 && !full && !queue.empty ())
+		{
+			auto & response (queue.front ());
+			nano::ipc::shm_frame_header header;
+			header.request_id = response.request_id;
+			header.size = static_cast<uint32_t> (std::min<size_t> (response.size - response.written, responses.max_frame_payload ()));
+			header.flags = static_cast<uint8_t> (response.written + header.size == response.size ? nano::ipc::shm_frame_flags::last : nano::ipc::shm_frame_flags::none);
+			full = !responses.try_write_frame (header, response.data + response.written);
+			if (!full)
+			{
+				result = true;
+				last_progress = std::chrono::steady_clock::now ();
+				response.written += header.size;
+				if (response.written == response.size)
+				{
+					queued_bytes -= response.size;
+					queue.pop_front ();
+				}
+			}
+		}
+		if (full && std::chrono::steady_clock::now () - last_progress >= std::chrono::seconds (config_transport.io_timeout))
+		{
+			// A client which does not read its responses is disconnected, as its ring is left with a partial response
+			close_locked ();
+		}
+		return result;
+	}
+
+	/** Stops all writes and drops queued responses. Once this returns the slot can be emptied. */
+	void close ()
+	{
+		closed = 1;
+		nano::lock_guard<nano::mutex> guard (mutex);
+		close_locked ();
+	}
+
+	/** Set once writing a response failed or too much was buffered for the connection, or when the slot is emptied */
+	std::atomic<uint32_t> closed{ 0 };
+
+	/** Requests which were not completely received yet, by request id. Only used by the transport thread. */
+	std::unordered_map<uint32_t, std::pair<uint8_t, std::vector<uint8_t>>> partial_requests;
+	/** Bytes held by partial_requests */
+	size_t partial_bytes{ 0 };
+
+	/** Flatbuffers requests are handled one at a time, as the handler is not thread safe */
+	nano::mutex flatbuffers_mutex;
+	std::shared_ptr<nano::ipc::flatbuffers_handler> flatbuffers_handler;
+
+	/** Responses queued and not yet written to the client */
+	static size_t constexpr max_queued_bytes{ 64 * 1024 * 1024 };
+
+private:
+	class queued_response final
+	{
+	public:
+		uint32_t request_id;
+		/** Keeps data alive */
+		std::shared_ptr<void const> owner;
+		uint8_t const * data;
+		size_t size;
+		size_t written;
+	};
+
+	void close_locked ()
+	{
+		closed = 1;
+		queue.clear ();
+		queued_bytes = 0;
+	}
+
+	nano::ipc::shm_segment const & segment;
+	nano::ipc::shm_ring responses;
+	nano::ipc::ipc_config_transport & config_transport;
+	nano::mutex mutex;
+	std::deque<queued_response> queue;
+	size_t queued_bytes{ 0 };
+	/** When the client last made room for a queued response, or when the queue was last empty */
+	std::chrono::steady_clock::time_point last_progress;
+};
+
+size_t constexpr shm_connection::max_queued_bytes;
+
+/**
+ * Shared memory transport. A single thread reads the requests of all connections, which are then processed on the
+ * node's io context. Requests of a connection are not serialized, so a client can have many in progress at once.
+ * The same thread writes the responses queued by the io threads.
+ */
+class shm_transport : public nano::ipc::transport, public std::enable_shared_from_this<shm_transport>
+{
+public:
+	shm_transport (nano::ipc::ipc_server & server_a, nano::ipc::ipc_config_shared_memory & config_a) :
+	server (server_a), node (server_a.node), config (config_a), connections (config_a.connections)
+	{
+	}
+
+	/** Creates the segment and starts the transport thread, once the transport is owned by a shared_ptr */
+	void start ()
+	{
+		auto error (segment.create (config.name, config.connections, config.ring_size));
+		if (!error)
+		{
+			thread = std::thread ([this]() {
+				nano::thread_role::set (nano::thread_role::name::ipc_shared_memory);
+				run ();
+			});
+		}
+		else
+		{
+			node.logger.always_log ("IPC: ", error.get_message ());
+		}
+	}
+
+	~shm_transport ()
+	{
+		stop ();
+	}
+
+	void stop () override
+	{
+		if (thread.joinable ())
+		{
+			segment.header ().server_running = 0;
+			stopped = true;
+			segment.notify_server ();
+			thread.join ();
+			for (auto & connection : connections)
+			{
+				if (connection)
+				{
+					connection->close ();
+				}
+			}
+		}
+	}
+
+private:
+	void run ()
+	{
+		auto & header (segment.header ());
+		nano::ipc::shm_frame_header frame;
+		std::vector<uint8_t> payload;
+		auto next_liveness_check (std::chrono::steady_clock::now ());
+		while (!stopped)
+		{
+			auto observed (header.doorbell.load ());
+			auto received (false);
+			for (auto i (0u); i < connections.size (); ++i)
+			{
+				auto & slot (segment.slot (i));
+				auto state (static_cast<nano::ipc::shm_slot_state> (slot.state.load ()));
+				if (state == nano::ipc::shm_slot_state::connected)
+				{
+					if (!connections[i])
+					{
+						connections[i] = std::make_shared<shm_connection> (segment, i, config);
+					}
+					auto & connection (connections[i]);
+					auto requests (segment.requests (i));
+					while (connection->closed == 0 && requests.try_read_frame (frame, payload))
+					{
+						received = true;
+						receive (connection, frame, payload);
+					}
+					received |= connection->write_responses ();
+					if (connection->closed != 0)
+					{
+						// The client fails its outstanding requests, the slot is released once it closes or exits
+						auto expected (static_cast<uint32_t> (nano::ipc::shm_slot_state::connected));
+						slot.state.compare_exchange_strong (expected, static_cast<uint32_t> (nano::ipc::shm_slot_state::disconnected));
+					}
+				}
+				else if (state == nano::ipc::shm_slot_state::closed)
+				{
+					release (i);
+				}
+			}
+			if (std::chrono::steady_clock::now () >= next_liveness_check)
+			{
+				reclaim_abandoned ();
+				next_liveness_check = std::chrono::steady_clock::now () + std::chrono::seconds (1);
+			}
+			if (!received)
+			{
+				segment.wait_server (observed, std::chrono::milliseconds (100));
+			}
+		}
+	}
+
+	void receive (std::shared_ptr<shm_connection> const & connection_a, nano::ipc::shm_frame_header const & frame_a, std::vector<uint8_t> const & payload_a)
+	{
+		auto & partial_requests (connection_a->partial_requests);
+		if (partial_requests.size () >= max_partial_requests && partial_requests.find (frame_a.request_id) == partial_requests.end ())
+		{
+			node.logger.always_log ("IPC: shared memory connection has too many incomplete requests, closing connection");
+			close (connection_a);
+			return;
+		}
+		auto & request (partial_requests[frame_a.request_id]);
+		request.first = frame_a.encoding;
+		request.second.insert (request.second.end (), payload_a.begin (), payload_a.end ());
+		connection_a->partial_bytes += payload_a.size ();
+		if (connection_a->partial_bytes > max_request_size)
+		{
+			node.logger.always_log ("IPC: shared memory requests exceed the maximum size, closing connection");
+			close (connection_a);
+		}
+		else if ((frame_a.flags & static_cast<uint8_t> (nano::ipc::shm_frame_flags::last)) != 0)
+		{
+			auto body (std::make_shared<std::vector<uint8_t>> (std::move (request.second)));
+			auto encoding (static_cast<nano::ipc::payload_encoding> (request.first));
+			connection_a->partial_bytes -= body->size ();
+			partial_requests.erase (frame_a.request_id);
+			process (connection_a, frame_a.request_id, encoding, body);
+		}
+	}
+
+	/** Closes a connection from the transport thread, dropping its incomplete requests */
+	void close (std::shared_ptr<shm_connection> const & connection_a)
+	{
+		connection_a->close ();
+		connection_a->partial_requests.clear ();
+		connection_a->partial_bytes = 0;
+	}
+
+	void process (std::shared_ptr<shm_connection> const & connection_a, uint32_t request_id_a, nano::ipc::payload_encoding encoding_a, std::shared_ptr<std::vector<uint8_t>> const & body_a)
+	{
+		node.stats.inc (nano::stat::type::ipc, nano::stat::detail::invocations);
+		if (encoding_a == nano::ipc::payload_encoding::json_v1 || encoding_a == nano::ipc::payload_encoding::json_v1_unsafe)
+		{
+			auto allow_unsafe (encoding_a == nano::ipc::payload_encoding::json_v1_unsafe && config.allow_unsafe);
+			// Handlers may still be queued when the transport is stopped
+			auto this_l (shared_from_this ());
+			boost::asio::post (node.io_ctx, [this_l, connection_a, request_id_a, body_a, allow_unsafe]() {
+				auto response_handler_l ([connection_a, request_id_a](std::string const & response_a) {
+					auto response_l (std::make_shared<std::string> (response_a));
+					connection_a->queue_response (request_id_a, response_l, reinterpret_cast<uint8_t const *> (response_l->data ()), response_l->size ());
+				});
+				auto handler (std::make_shared<nano::json_handler> (this_l->node, this_l->server.node_rpc_config, std::string (body_a->begin (), body_a->end ()), response_handler_l, [& server = this_l->server]() {
+					server.stop ();
+					server.node.workers.add_timed_task (std::chrono::steady_clock::now () + std::chrono::seconds (3), [& io_ctx = server.node.io_ctx]() {
+						io_ctx.stop ();
+					});
+				}));
+				handler->process_request (allow_unsafe);
+			});
+		}
+		else if (encoding_a == nano::ipc::payload_encoding::flatbuffers || encoding_a == nano::ipc::payload_encoding::flatbuffers_json)
+		{
+			auto this_l (shared_from_this ());
+			boost::asio::post (node.io_ctx, [this_l, connection_a, request_id_a, body_a, encoding_a]() {
+				nano::lock_guard<nano::mutex> guard (connection_a->flatbuffers_mutex);
+				if (!connection_a->flatbuffers_handler)
+				{
+					// Subscriptions need a session to push messages to, without a subscriber they are answered with an error
+					connection_a->flatbuffers_handler = std::make_shared<nano::ipc::flatbuffers_handler> (this_l->node, this_l->server, nullptr, this_l->node.config.ipc_config);
+				}
+				if (encoding_a == nano::ipc::payload_encoding::flatbuffers_json)
+				{
+					connection_a->flatbuffers_handler->process_json (body_a->data (), body_a->size (), [connection_a, request_id_a](std::shared_ptr<std::string> const & response_a) {
+						connection_a->queue_response (request_id_a, response_a, reinterpret_cast<uint8_t const *> (response_a->data ()), response_a->size ());
+					});
+				}
+				else
+				{
+					connection_a->flatbuffers_handler->process (body_a->data (), body_a->size (), [connection_a, request_id_a](std::shared_ptr<flatbuffers::FlatBufferBuilder> const & fbb) {
+						connection_a->queue_response (request_id_a, fbb, fbb->GetBufferPointer (), fbb->GetSize ());
+					});
+				}
+			});
+		}
+		else
+		{
+			if (node.config.logging.log_ipc ())
+			{
+				node.logger.always_log ("IPC: Unsupported payload encoding");
+			}
+			close (connection_a);
+		}
+	}
+
+	/** Empties slot \p index_a, making it available to the next client */
+	void release (uint32_t index_a)
+	{
+		if (connections[index_a])
+		{
+			connections[index_a]->close ();
+			connections[index_a] = nullptr;
+		}
+		segment.requests (index_a).reset ();
+		segment.responses (index_a).reset ();
+		auto & slot (segment.slot (index_a));
+		slot.client_pid = 0;
+		slot.state = static_cast<uint32_t> (nano::ipc::shm_slot_state::free);
+	}
+
+	/** Releases slots of clients which exited without disconnecting */
+	void reclaim_abandoned ()
+	{
+#if defined(__linux__)
+		for (auto i (0u); i < connections.size (); ++i)
+		{
+			auto & slot (segment.slot (i));
+			auto pid (slot.client_pid.load ());
+			auto state (static_cast<nano::ipc::shm_slot_state> (slot.state.load ()));
+			if ((state == nano::ipc::shm_slot_state::connected || state == nano::ipc::shm_slot_state::disconnected) && pid != 0 && kill (pid, 0) == -1 && errno == ESRCH)
+			{
+				if (node.config.logging.log_ipc ())
+				{
+					node.logger.always_log (boost::str (boost::format ("IPC: releasing shared memory connection of exited process %1%") % pid));
+				}
+				release (i);
+			}
+		}
+#endif
+	}
+
+	/** Requests are assembled in memory before processing. This bounds the bytes of all incomplete requests of a connection, which bounds what a client can make the node allocate */
+	static size_t constexpr max_request_size{ 32 * 1024 * 1024 };
+	/** Incomplete requests a connection may have at once */
+	static size_t constexpr max_partial_requests{ 256 };
+	nano::ipc::ipc_server & server;
+	nano::node & node;
+	nano::ipc::ipc_config_shared_memory & config;
+	nano::ipc::shm_segment segment;
+	/** Only used by the transport thread, apart from closing them when stopping */
+	std::vector<std::shared_ptr<shm_connection>> connections;
+	std::atomic<bool> stopped{ false };
+	std::thread thread;
+};
 }
 
 /**
@@ -610,6 +996,13 @@ broker (std::make_shared<nano::ipc::broker> (node_a))
 			transports.push_back (std::make_shared<socket_transport<boost::asio::ip::tcp::acceptor, boost::asio::ip::tcp::socket, boost::asio::ip::tcp::endpoint>> (*this, boost::asio::ip::tcp::endpoint (boost::asio::ip::tcp::v6 (), node_a.config.ipc_config.transport_tcp.port), node_a.config.ipc_config.transport_tcp, threads));
 		}
 
+		if (node_a.config.ipc_config.transport_shared_memory.enabled)
+		{
+			auto transport (std::make_shared<shm_transport> (*this, node_a.config.ipc_config.transport_shared_memory));
+			transport->start ();
+			transports.push_back (transport);
+		}
+
 		node.logger.always_log ("IPC: server started");
 
 		if (!transports.empty ())
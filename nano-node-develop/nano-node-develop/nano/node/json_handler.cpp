@@ -1,6 +1,7 @@
 #include <nano/lib/config.hpp>
 #include <nano/lib/json_error_response.hpp>
 #include <nano/lib/timer.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/bootstrap/bootstrap_lazy.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/election.hpp>
@@ -14,6 +15,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <numeric>
 
 namespace
 {
@@ -23,6 +25,8 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ();
 auto ipc_json_handler_no_arg_funcs = create_ipc_json_handler_no_arg_func_map ();
 bool block_confirmed (nano::node & node, nano::transaction & transaction, nano::block_hash const & hash, bool include_active, bool include_only_confirmed);
 const char * epoch_as_string (nano::epoch);
+std::string history_cursor_encode (nano::account const &, uint64_t);
+bool history_cursor_decode (std::string const &, nano::account &, uint64_t &);
 }
 
 nano::json_handler::json_handler (nano::node & node_a, nano::node_rpc_config const & node_rpc_config_a, std::string const & body_a, std::function<void(std::string const &)> const & response_a, std::function<void()> stop_callback_a) :
@@ -52,6 +56,68 @@ std::function<void()> nano::json_handler::create_worker_task (std::function<void
 	};
 }
 
+void nano::json_handler::for_each_account_parallel (std::vector<nano::account> const & accounts_a, std::function<void(nano::transaction &, size_t)> const & action_a, std::function<void(std::shared_ptr<nano::json_handler> const &)> const & done_a)
+{
+	// Visiting accounts in key order keeps the lookups of each shard close together in the store
+	auto order (std::make_shared<std::vector<size_t>> (accounts_a.size ()));
+	std::iota (order->begin (), order->end (), 0);
+	std::sort (order->begin (), order->end (), [&accounts_a](size_t lhs_a, size_t rhs_a) {
+		return accounts_a[lhs_a] < accounts_a[rhs_a];
+	});
+	// Not worth the hand-off to the worker threads below this many accounts per shard
+	size_t const min_shard_size (64);
+	auto max_shards (std::max<size_t> (1, std::min<size_t> (node_rpc_config.max_request_parallelism, node.workers.get_num_threads ())));
+	auto shard_count (std::min (max_shards, (order->size () + min_shard_size - 1) / min_shard_size));
+	if (shard_count <= 1)
+	{
+		auto transaction (node.store.tx_begin_read ());
+		for (auto index : *order)
+		{
+			action_a (transaction, index);
+		}
+		done_a (shared_from_this ());
+	}
+	else
+	{
+		auto shard_size ((order->size () + shard_count - 1) / shard_count);
+		auto remaining (std::make_shared<std::atomic<size_t>> (shard_count));
+		auto failed (std::make_shared<std::atomic<bool>> (false));
+		for (size_t shard (0); shard < shard_count; ++shard)
+		{
+			auto begin (shard * shard_size);
+			auto end (std::min (order->size (), begin + shard_size));
+			debug_assert (begin < end);
+			node.workers.push_task ([rpc_l = shared_from_this (), order, begin, end, action_a, done_a, remaining, failed]() {
+				try
+				{
+					auto transaction (rpc_l->node.store.tx_begin_read ());
+					for (auto i (begin); i != end; ++i)
+					{
+						action_a (transaction, (*order)[i]);
+					}
+					rpc_l->node.stats.inc (nano::stat::type::rpc, nano::stat::detail::request_shard);
+				}
+				catch (...)
+				{
+					*failed = true;
+				}
+				// The last shard to finish writes the response
+				if (--*remaining == 0)
+				{
+					if (!*failed)
+					{
+						rpc_l->create_worker_task (done_a) ();
+					}
+					else
+					{
+						json_error_response (rpc_l->response, "Internal server error in RPC");
+					}
+				}
+			});
+		}
+	}
+}
+
 void nano::json_handler::process_request (bool unsafe_a)
 {
 	try
@@ -168,6 +234,33 @@ void nano::json_handler::response_errors ()
 	}
 }
 
+void nano::json_handler::response_errors (nano::json_writer & writer_a)
+{
+	if (!ec && writer_a.empty ())
+	{
+		// Return an error code if no response data was given
+		ec = nano::error_rpc::empty_response;
+	}
+	if (ec)
+	{
+		// Anything streamed so far is discarded
+		response_errors ();
+	}
+	else
+	{
+		writer_a.finish ();
+		response (response_text);
+	}
+}
+
+nano::json_writer nano::json_handler::response_writer ()
+{
+	response_text.clear ();
+	nano::json_writer writer (response_text);
+	writer.put_children (response_l);
+	return writer;
+}
+
 std::shared_ptr<nano::wallet> nano::json_handler::wallet_impl ()
 {
 	if (!ec)
@@ -877,21 +970,41 @@ void nano::json_handler::account_weight ()
 
 void nano::json_handler::accounts_balances ()
 {
-	boost::property_tree::ptree balances;
-	for (auto & accounts : request.get_child ("accounts"))
+	auto accounts (std::make_shared<std::vector<nano::account>> ());
+	for (auto & account_text : request.get_child ("accounts"))
 	{
-		auto account (account_impl (accounts.second.data ()));
+		auto account (account_impl (account_text.second.data ()));
 		if (!ec)
 		{
-			boost::property_tree::ptree entry;
-			auto balance (node.balance_pending (account, false));
-			entry.put ("balance", balance.first.convert_to<std::string> ());
-			entry.put ("pending", balance.second.convert_to<std::string> ());
-			balances.push_back (std::make_pair (account.to_account (), entry));
+			accounts->push_back (account);
 		}
 	}
-	response_l.add_child ("balances", balances);
-	response_errors ();
+	if (!ec)
+	{
+		auto balances (std::make_shared<std::vector<std::pair<nano::uint128_t, nano::uint128_t>>> (accounts->size ()));
+		for_each_account_parallel (
+		*accounts, [this, accounts, balances](nano::transaction & transaction_a, size_t index_a) {
+			auto const & account ((*accounts)[index_a]);
+			(*balances)[index_a] = std::make_pair (node.ledger.account_balance (transaction_a, account), node.ledger.account_pending (transaction_a, account));
+		},
+		[accounts, balances](std::shared_ptr<nano::json_handler> const & rpc_l) {
+			auto writer (rpc_l->response_writer ());
+			writer.start_object ("balances");
+			for (size_t i (0); i < accounts->size (); ++i)
+			{
+				writer.start_object ((*accounts)[i].to_account ());
+				writer.put ("balance", (*balances)[i].first.convert_to<std::string> ());
+				writer.put ("pending", (*balances)[i].second.convert_to<std::string> ());
+				writer.end ();
+			}
+			writer.end ();
+			rpc_l->response_errors (writer);
+		});
+	}
+	else
+	{
+		response_errors ();
+	}
 }
 
 void nano::json_handler::accounts_create ()
@@ -921,22 +1034,39 @@ void nano::json_handler::accounts_create ()
 
 void nano::json_handler::accounts_frontiers ()
 {
-	boost::property_tree::ptree frontiers;
-	auto transaction (node.store.tx_begin_read ());
-	for (auto & accounts : request.get_child ("accounts"))
+	auto accounts (std::make_shared<std::vector<nano::account>> ());
+	for (auto & account_text : request.get_child ("accounts"))
 	{
-		auto account (account_impl (accounts.second.data ()));
+		auto account (account_impl (account_text.second.data ()));
 		if (!ec)
 		{
-			auto latest (node.ledger.latest (transaction, account));
-			if (!latest.is_zero ())
+			accounts->push_back (account);
+		}
+	}
+	if (!ec)
+	{
+		auto frontiers (std::make_shared<std::vector<nano::block_hash>> (accounts->size ()));
+		for_each_account_parallel (
+		*accounts, [this, accounts, frontiers](nano::transaction & transaction_a, size_t index_a) {
+			(*frontiers)[index_a] = node.ledger.latest (transaction_a, (*accounts)[index_a]);
+		},
+		[accounts, frontiers](std::shared_ptr<nano::json_handler> const & rpc_l) {
+			boost::property_tree::ptree frontiers_l;
+			for (size_t i (0); i < accounts->size (); ++i)
 			{
-				frontiers.put (account.to_account (), latest.to_string ());
+				if (!(*frontiers)[i].is_zero ())
+				{
+					frontiers_l.put ((*accounts)[i].to_account (), (*frontiers)[i].to_string ());
+				}
 			}
-		}
+			rpc_l->response_l.add_child ("frontiers", frontiers_l);
+			rpc_l->response_errors ();
+		});
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_l.add_child ("frontiers", frontiers);
-	response_errors ();
 }
 
 void nano::json_handler::accounts_pending ()
@@ -948,18 +1078,26 @@ void nano::json_handler::accounts_pending ()
 	const bool include_only_confirmed = request.get<bool> ("include_only_confirmed", false);
 	const bool sorting = request.get<bool> ("sorting", false);
 	auto simple (threshold.is_zero () && !source && !sorting); // if simple, response is a list of hashes for each account
-	boost::property_tree::ptree pending;
-	auto transaction (node.store.tx_begin_read ());
-	for (auto & accounts : request.get_child ("accounts"))
+	auto accounts (std::make_shared<std::vector<nano::account>> ());
+	for (auto & account_text : request.get_child ("accounts"))
 	{
-		auto account (account_impl (accounts.second.data ()));
+		auto account (account_impl (account_text.second.data ()));
 		if (!ec)
 		{
-			boost::property_tree::ptree peers_l;
-			for (auto i (node.store.pending_begin (transaction, nano::pending_key (account, 0))), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
+			accounts->push_back (account);
+		}
+	}
+	if (!ec)
+	{
+		auto pending (std::make_shared<std::vector<boost::property_tree::ptree>> (accounts->size ()));
+		for_each_account_parallel (
+		*accounts, [this, accounts, pending, count, threshold, source, include_active, include_only_confirmed, sorting, simple](nano::transaction & transaction_a, size_t index_a) {
+			auto const & account ((*accounts)[index_a]);
+			auto & peers_l ((*pending)[index_a]);
+			for (auto i (node.store.pending_begin (transaction_a, nano::pending_key (account, 0))), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
 			{
 				nano::pending_key const & key (i->first);
-				if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
+				if (block_confirmed (node, transaction_a, key.hash, include_active, include_only_confirmed))
 				{
 					if (simple)
 					{
@@ -1002,11 +1140,21 @@ void nano::json_handler::accounts_pending ()
 					});
 				}
 			}
-			pending.add_child (account.to_account (), peers_l);
-		}
+		},
+		[accounts, pending](std::shared_ptr<nano::json_handler> const & rpc_l) {
+			boost::property_tree::ptree pending_l;
+			for (size_t i (0); i < accounts->size (); ++i)
+			{
+				pending_l.add_child ((*accounts)[i].to_account (), (*pending)[i]);
+			}
+			rpc_l->response_l.add_child ("blocks", pending_l);
+			rpc_l->response_errors ();
+		});
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_l.add_child ("blocks", pending);
-	response_errors ();
 }
 
 void nano::json_handler::active_difficulty ()
@@ -1196,8 +1344,9 @@ void nano::json_handler::blocks_info ()
 	const bool json_block_l = request.get<bool> ("json_block", false);
 	const bool include_not_found = request.get<bool> ("include_not_found", false);
 
-	boost::property_tree::ptree blocks;
-	boost::property_tree::ptree blocks_not_found;
+	auto writer (response_writer ());
+	writer.start_object ("blocks");
+	std::vector<std::string> blocks_not_found;
 	auto transaction (node.store.tx_begin_read ());
 	for (boost::property_tree::ptree::value_type & hashes : request.get_child ("hashes"))
 	{
@@ -1210,38 +1359,38 @@ void nano::json_handler::blocks_info ()
 				auto block (node.store.block_get (transaction, hash));
 				if (block != nullptr)
 				{
-					boost::property_tree::ptree entry;
+					writer.start_object (hash_text);
 					nano::account account (block->account ().is_zero () ? block->sideband ().account : block->account ());
-					entry.put ("block_account", account.to_account ());
+					writer.put ("block_account", account.to_account ());
 					bool error_or_pruned (false);
 					auto amount (node.ledger.amount_safe (transaction, hash, error_or_pruned));
 					if (!error_or_pruned)
 					{
-						entry.put ("amount", amount.convert_to<std::string> ());
+						writer.put ("amount", amount.convert_to<std::string> ());
 					}
 					auto balance (node.ledger.balance (transaction, hash));
-					entry.put ("balance", balance.convert_to<std::string> ());
-					entry.put ("height", std::to_string (block->sideband ().height));
-					entry.put ("local_timestamp", std::to_string (block->sideband ().timestamp));
+					writer.put ("balance", balance.convert_to<std::string> ());
+					writer.put ("height", std::to_string (block->sideband ().height));
+					writer.put ("local_timestamp", std::to_string (block->sideband ().timestamp));
 					auto confirmed (node.ledger.block_confirmed (transaction, hash));
-					entry.put ("confirmed", confirmed);
+					writer.put ("confirmed", confirmed);
 
 					if (json_block_l)
 					{
 						boost::property_tree::ptree block_node_l;
 						block->serialize_json (block_node_l);
-						entry.add_child ("contents", block_node_l);
+						writer.put_tree ("contents", block_node_l);
 					}
 					else
 					{
 						std::string contents;
 						block->serialize_json (contents);
-						entry.put ("contents", contents);
+						writer.put ("contents", contents);
 					}
 					if (block->type () == nano::block_type::state)
 					{
 						auto subtype (nano::state_subtype (block->sideband ().details));
-						entry.put ("subtype", subtype);
+						writer.put ("subtype", subtype);
 					}
 					if (pending)
 					{
@@ -1251,7 +1400,7 @@ void nano::json_handler::blocks_info ()
 						{
 							exists = node.store.pending_exists (transaction, nano::pending_key (destination, hash));
 						}
-						entry.put ("pending", exists ? "1" : "0");
+						writer.put ("pending", exists ? "1" : "0");
 					}
 					if (source)
 					{
@@ -1260,20 +1409,18 @@ void nano::json_handler::blocks_info ()
 						if (block_a != nullptr)
 						{
 							auto source_account (node.ledger.account (transaction, source_hash));
-							entry.put ("source_account", source_account.to_account ());
+							writer.put ("source_account", source_account.to_account ());
 						}
 						else
 						{
-							entry.put ("source_account", "0");
+							writer.put ("source_account", "0");
 						}
 					}
-					blocks.push_back (std::make_pair (hash_text, entry));
+					writer.end ();
 				}
 				else if (include_not_found)
 				{
-					boost::property_tree::ptree entry;
-					entry.put ("", hash_text);
-					blocks_not_found.push_back (std::make_pair ("", entry));
+					blocks_not_found.push_back (hash_text);
 				}
 				else
 				{
@@ -1286,15 +1433,17 @@ void nano::json_handler::blocks_info ()
 			}
 		}
 	}
-	if (!ec)
+	writer.end ();
+	if (!ec && include_not_found)
 	{
-		response_l.add_child ("blocks", blocks);
-		if (include_not_found)
+		writer.start_array ("blocks_not_found");
+		for (auto const & hash_text : blocks_not_found)
 		{
-			response_l.add_child ("blocks_not_found", blocks_not_found);
+			writer.push_back (hash_text);
 		}
+		writer.end ();
 	}
-	response_errors ();
+	response_errors (writer);
 }
 
 void nano::json_handler::block_account ()
@@ -2066,7 +2215,8 @@ void nano::json_handler::delegators ()
 	auto account (account_impl ());
 	if (!ec)
 	{
-		boost::property_tree::ptree delegators;
+		auto writer (response_writer ());
+		writer.start_object ("delegators");
 		auto transaction (node.store.tx_begin_read ());
 		for (auto i (node.store.accounts_begin (transaction)), n (node.store.accounts_end ()); i != n; ++i)
 		{
@@ -2076,12 +2226,16 @@ void nano::json_handler::delegators ()
 				std::string balance;
 				nano::uint128_union (info.balance).encode_dec (balance);
 				nano::account const & account (i->first);
-				delegators.put (account.to_account (), balance);
+				writer.put (account.to_account (), balance);
 			}
 		}
-		response_l.add_child ("delegators", delegators);
+		writer.end ();
+		response_errors (writer);
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_errors ();
 }
 
 void nano::json_handler::delegators_count ()
@@ -2446,10 +2600,31 @@ void nano::json_handler::account_history ()
 	nano::block_hash hash;
 	bool reverse (request.get_optional<bool> ("reverse") == true);
 	auto head_str (request.get_optional<std::string> ("head"));
+	auto cursor_str (request.get_optional<std::string> ("cursor"));
 	auto transaction (node.store.tx_begin_read ());
 	auto count (count_impl ());
 	auto offset (offset_optional_impl (0));
-	if (head_str)
+	if (cursor_str)
+	{
+		uint64_t height (0);
+		if (!history_cursor_decode (*cursor_str, account, height))
+		{
+			if (node.ledger.account_index)
+			{
+				// Zero if the chain was rolled back below the cursor since, which gives an empty history
+				hash = node.store.account_height_get (transaction, nano::account_height_key (account, reverse ? height + 1 : height));
+			}
+			else
+			{
+				ec = nano::error_rpc::account_index_disabled;
+			}
+		}
+		else
+		{
+			ec = nano::error_rpc::bad_cursor;
+		}
+	}
+	else if (head_str)
 	{
 		if (!hash.decode_hex (*head_str))
 		{
@@ -2486,11 +2661,32 @@ void nano::json_handler::account_history ()
 			}
 		}
 	}
+	if (!ec && offset > 0 && node.ledger.account_index && !hash.is_zero ())
+	{
+		// The offset counts every block, including filtered ones, so the index can skip straight past them
+		auto start (node.store.block_get (transaction, hash));
+		if (start != nullptr)
+		{
+			auto height (start->sideband ().height);
+			uint64_t target (0);
+			if (reverse)
+			{
+				target = offset < std::numeric_limits<uint64_t>::max () - height ? height + offset : 0;
+			}
+			else
+			{
+				target = height > offset ? height - offset : 0;
+			}
+			hash = target != 0 ? node.store.account_height_get (transaction, nano::account_height_key (account, target)) : nano::block_hash (0);
+			offset = 0;
+		}
+	}
 	if (!ec)
 	{
-		boost::property_tree::ptree history;
 		bool output_raw (request.get_optional<bool> ("raw") == true);
-		response_l.put ("account", account.to_account ());
+		auto writer (response_writer ());
+		writer.put ("account", account.to_account ());
+		writer.start_array ("history");
 		auto block (node.store.block_get (transaction, hash));
 		while (block != nullptr && count > 0)
 		{
@@ -2513,20 +2709,30 @@ void nano::json_handler::account_history ()
 						entry.put ("work", nano::to_string_hex (block->block_work ()));
 						entry.put ("signature", block->block_signature ().to_string ());
 					}
-					history.push_back (std::make_pair ("", entry));
+					// Entries are small and short lived, the response itself is streamed
+					writer.push_back_tree (entry);
 					--count;
 				}
 			}
 			hash = reverse ? node.store.block_successor (transaction, hash) : block->previous ();
 			block = node.store.block_get (transaction, hash);
 		}
-		response_l.add_child ("history", history);
+		writer.end ();
 		if (!hash.is_zero ())
 		{
-			response_l.put (reverse ? "next" : "previous", hash.to_string ());
+			writer.put (reverse ? "next" : "previous", hash.to_string ());
+			if (node.ledger.account_index && block != nullptr)
+			{
+				auto next_height (block->sideband ().height);
+				writer.put ("cursor", history_cursor_encode (account, reverse ? next_height - 1 : next_height));
+			}
 		}
+		response_errors (writer);
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_errors ();
 }
 
 void nano::json_handler::keepalive ()
@@ -2601,44 +2807,54 @@ void nano::json_handler::ledger ()
 		const bool representative = request.get<bool> ("representative", false);
 		const bool weight = request.get<bool> ("weight", false);
 		const bool pending = request.get<bool> ("pending", false);
-		boost::property_tree::ptree accounts;
 		auto transaction (node.store.tx_begin_read ());
+		auto writer (response_writer ());
+		writer.start_object ("accounts");
+		uint64_t accounts_count (0);
+		// Writes the entry for an account, unless it's below the threshold once pending balance is included
+		auto write_entry = [&](nano::account const & account, nano::account_info const & info) {
+			nano::uint128_t account_pending (0);
+			if (pending)
+			{
+				account_pending = node.ledger.account_pending (transaction, account);
+				if (info.balance.number () + account_pending < threshold.number ())
+				{
+					return;
+				}
+			}
+			writer.start_object (account.to_account ());
+			if (pending)
+			{
+				writer.put ("pending", account_pending.convert_to<std::string> ());
+			}
+			writer.put ("frontier", info.head.to_string ());
+			writer.put ("open_block", info.open_block.to_string ());
+			writer.put ("representative_block", node.ledger.representative (transaction, info.head).to_string ());
+			std::string balance;
+			nano::uint128_union (info.balance).encode_dec (balance);
+			writer.put ("balance", balance);
+			writer.put ("modified_timestamp", std::to_string (info.modified));
+			writer.put ("block_count", std::to_string (info.block_count));
+			if (representative)
+			{
+				writer.put ("representative", info.representative.to_account ());
+			}
+			if (weight)
+			{
+				auto account_weight (node.ledger.weight (account));
+				writer.put ("weight", account_weight.convert_to<std::string> ());
+			}
+			writer.end ();
+			++accounts_count;
+		};
 		if (!ec && !sorting) // Simple
 		{
-			for (auto i (node.store.accounts_begin (transaction, start)), n (node.store.accounts_end ()); i != n && accounts.size () < count; ++i)
+			for (auto i (node.store.accounts_begin (transaction, start)), n (node.store.accounts_end ()); i != n && accounts_count < count; ++i)
 			{
 				nano::account_info const & info (i->second);
 				if (info.modified >= modified_since && (pending || info.balance.number () >= threshold.number ()))
 				{
-					nano::account const & account (i->first);
-					boost::property_tree::ptree response_a;
-					if (pending)
-					{
-						auto account_pending (node.ledger.account_pending (transaction, account));
-						if (info.balance.number () + account_pending < threshold.number ())
-						{
-							continue;
-						}
-						response_a.put ("pending", account_pending.convert_to<std::string> ());
-					}
-					response_a.put ("frontier", info.head.to_string ());
-					response_a.put ("open_block", info.open_block.to_string ());
-					response_a.put ("representative_block", node.ledger.representative (transaction, info.head).to_string ());
-					std::string balance;
-					nano::uint128_union (info.balance).encode_dec (balance);
-					response_a.put ("balance", balance);
-					response_a.put ("modified_timestamp", std::to_string (info.modified));
-					response_a.put ("block_count", std::to_string (info.block_count));
-					if (representative)
-					{
-						response_a.put ("representative", info.representative.to_account ());
-					}
-					if (weight)
-					{
-						auto account_weight (node.ledger.weight (account));
-						response_a.put ("weight", account_weight.convert_to<std::string> ());
-					}
-					accounts.push_back (std::make_pair (account.to_account (), response_a));
+					write_entry (i->first, info);
 				}
 			}
 		}
@@ -2657,46 +2873,22 @@ void nano::json_handler::ledger ()
 			std::sort (ledger_l.begin (), ledger_l.end ());
 			std::reverse (ledger_l.begin (), ledger_l.end ());
 			nano::account_info info;
-			for (auto i (ledger_l.begin ()), n (ledger_l.end ()); i != n && accounts.size () < count; ++i)
+			for (auto i (ledger_l.begin ()), n (ledger_l.end ()); i != n && accounts_count < count; ++i)
 			{
 				node.store.account_get (transaction, i->second, info);
 				if (pending || info.balance.number () >= threshold.number ())
 				{
-					nano::account const & account (i->second);
-					boost::property_tree::ptree response_a;
-					if (pending)
-					{
-						auto account_pending (node.ledger.account_pending (transaction, account));
-						if (info.balance.number () + account_pending < threshold.number ())
-						{
-							continue;
-						}
-						response_a.put ("pending", account_pending.convert_to<std::string> ());
-					}
-					response_a.put ("frontier", info.head.to_string ());
-					response_a.put ("open_block", info.open_block.to_string ());
-					response_a.put ("representative_block", node.ledger.representative (transaction, info.head).to_string ());
-					std::string balance;
-					(i->first).encode_dec (balance);
-					response_a.put ("balance", balance);
-					response_a.put ("modified_timestamp", std::to_string (info.modified));
-					response_a.put ("block_count", std::to_string (info.block_count));
-					if (representative)
-					{
-						response_a.put ("representative", info.representative.to_account ());
-					}
-					if (weight)
-					{
-						auto account_weight (node.ledger.weight (account));
-						response_a.put ("weight", account_weight.convert_to<std::string> ());
-					}
-					accounts.push_back (std::make_pair (account.to_account (), response_a));
+					write_entry (i->second, info);
 				}
 			}
 		}
-		response_l.add_child ("accounts", accounts);
+		writer.end ();
+		response_errors (writer);
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_errors ();
 }
 
 void nano::json_handler::mnano_from_raw (nano::uint128_t ratio)
@@ -2861,59 +3053,83 @@ void nano::json_handler::pending ()
 	const bool should_sort = sorting && !simple;
 	if (!ec)
 	{
-		boost::property_tree::ptree peers_l;
+		auto writer (response_writer ());
+		if (simple)
+		{
+			writer.start_array ("blocks");
+		}
+		else
+		{
+			writer.start_object ("blocks");
+		}
+		uint64_t blocks_count (0);
+		auto write_entry = [&writer, source, min_version](std::string const & hash_a, nano::pending_info const & info_a) {
+			if (source || min_version)
+			{
+				writer.start_object (hash_a);
+				writer.put ("amount", info_a.amount.number ().convert_to<std::string> ());
+				if (source)
+				{
+					writer.put ("source", info_a.source.to_account ());
+				}
+				if (min_version)
+				{
+					writer.put ("min_version", epoch_as_string (info_a.epoch));
+				}
+				writer.end ();
+			}
+			else
+			{
+				writer.put (hash_a, info_a.amount.number ().convert_to<std::string> ());
+			}
+		};
 		auto transaction (node.store.tx_begin_read ());
-		// The ptree container is used if there are any children nodes (e.g source/min_version) otherwise the amount container is used.
-		std::vector<std::pair<std::string, boost::property_tree::ptree>> hash_ptree_pairs;
-		std::vector<std::pair<std::string, nano::uint128_t>> hash_amount_pairs;
-		for (auto i (node.store.pending_begin (transaction, nano::pending_key (account, 0))), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && (should_sort || peers_l.size () < count); ++i)
+		if (should_sort && node.ledger.account_index)
+		{
+			// Entries are ordered by decreasing amount, so the scan stops after count entries or at the first one below the threshold.
+			// Unsorted queries return entries in pending table order, the scan below stops after count entries of it as well
+			for (auto i (node.store.pending_amounts_begin (transaction, nano::pending_amount_key (account, std::numeric_limits<nano::uint128_t>::max (), 0))), n (node.store.pending_amounts_end ()); i != n && nano::pending_amount_key (i->first).account == account && blocks_count < count; ++i)
+			{
+				nano::pending_amount_key const & key (i->first);
+				if (key.amount ().number () < threshold.number ())
+				{
+					break;
+				}
+				nano::pending_info info;
+				if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed) && !node.store.pending_get (transaction, nano::pending_key (account, key.hash), info))
+				{
+					write_entry (key.hash.to_string (), info);
+					++blocks_count;
+				}
+			}
+			writer.end ();
+			response_errors (writer);
+			return;
+		}
+		std::vector<std::pair<std::string, nano::pending_info>> hash_info_pairs;
+		for (auto i (node.store.pending_begin (transaction, nano::pending_key (account, 0))), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && (should_sort || blocks_count < count); ++i)
 		{
 			nano::pending_key const & key (i->first);
 			if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
 			{
 				if (simple)
 				{
-					boost::property_tree::ptree entry;
-					entry.put ("", key.hash.to_string ());
-					peers_l.push_back (std::make_pair ("", entry));
+					writer.push_back (key.hash.to_string ());
+					++blocks_count;
 				}
 				else
 				{
 					nano::pending_info const & info (i->second);
 					if (info.amount.number () >= threshold.number ())
 					{
-						if (source || min_version)
+						if (should_sort)
 						{
-							boost::property_tree::ptree pending_tree;
-							pending_tree.put ("amount", info.amount.number ().convert_to<std::string> ());
-							if (source)
-							{
-								pending_tree.put ("source", info.source.to_account ());
-							}
-							if (min_version)
-							{
-								pending_tree.put ("min_version", epoch_as_string (info.epoch));
-							}
-
-							if (should_sort)
-							{
-								hash_ptree_pairs.emplace_back (key.hash.to_string (), pending_tree);
-							}
-							else
-							{
-								peers_l.add_child (key.hash.to_string (), pending_tree);
-							}
+							hash_info_pairs.emplace_back (key.hash.to_string (), info);
 						}
 						else
 						{
-							if (should_sort)
-							{
-								hash_amount_pairs.emplace_back (key.hash.to_string (), info.amount.number ());
-							}
-							else
-							{
-								peers_l.put (key.hash.to_string (), info.amount.number ().convert_to<std::string> ());
-							}
+							write_entry (key.hash.to_string (), info);
+							++blocks_count;
 						}
 					}
 				}
@@ -2921,33 +3137,22 @@ void nano::json_handler::pending ()
 		}
 		if (should_sort)
 		{
-			if (source || min_version)
+			auto mid = hash_info_pairs.size () <= count ? hash_info_pairs.end () : hash_info_pairs.begin () + count;
+			std::partial_sort (hash_info_pairs.begin (), mid, hash_info_pairs.end (), [](const auto & lhs, const auto & rhs) {
+				return lhs.second.amount.number () > rhs.second.amount.number ();
+			});
+			for (auto i = 0; i < hash_info_pairs.size () && i < count; ++i)
 			{
-				auto mid = hash_ptree_pairs.size () <= count ? hash_ptree_pairs.end () : hash_ptree_pairs.begin () + count;
-				std::partial_sort (hash_ptree_pairs.begin (), mid, hash_ptree_pairs.end (), [](const auto & lhs, const auto & rhs) {
-					return lhs.second.template get<nano::uint128_t> ("amount") > rhs.second.template get<nano::uint128_t> ("amount");
-				});
-				for (auto i = 0; i < hash_ptree_pairs.size () && i < count; ++i)
-				{
-					peers_l.add_child (hash_ptree_pairs[i].first, hash_ptree_pairs[i].second);
-				}
-			}
-			else
-			{
-				auto mid = hash_amount_pairs.size () <= count ? hash_amount_pairs.end () : hash_amount_pairs.begin () + count;
-				std::partial_sort (hash_amount_pairs.begin (), mid, hash_amount_pairs.end (), [](const auto & lhs, const auto & rhs) {
-					return lhs.second > rhs.second;
-				});
-
-				for (auto i = 0; i < hash_amount_pairs.size () && i < count; ++i)
-				{
-					peers_l.put (hash_amount_pairs[i].first, hash_amount_pairs[i].second.convert_to<std::string> ());
-				}
+				write_entry (hash_info_pairs[i].first, hash_info_pairs[i].second);
 			}
 		}
-		response_l.add_child ("blocks", peers_l);
+		writer.end ();
+		response_errors (writer);
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_errors ();
 }
 
 void nano::json_handler::pending_exists ()
@@ -3603,6 +3808,72 @@ void nano::json_handler::send ()
 	}
 }
 
+void nano::json_handler::send_batch ()
+{
+	auto wallet (wallet_impl ());
+	std::vector<nano::send_batch_item> items;
+	if (!ec && !node.work_generation_enabled ())
+	{
+		ec = nano::error_common::disabled_work_generation;
+	}
+	if (!ec)
+	{
+		auto transaction (node.wallets.tx_begin_read ());
+		wallet_locked_impl (transaction, wallet);
+	}
+	if (!ec)
+	{
+		for (auto const & send : request.get_child ("sends"))
+		{
+			nano::send_batch_item item;
+			item.source = account_impl (send.second.get<std::string> ("source"), nano::error_rpc::bad_source);
+			item.destination = account_impl (send.second.get<std::string> ("destination"), nano::error_rpc::bad_destination);
+			nano::amount amount (0);
+			if (!ec && (amount.decode_dec (send.second.get<std::string> ("amount")) || amount.is_zero ()))
+			{
+				ec = nano::error_common::invalid_amount;
+			}
+			if (ec)
+			{
+				break;
+			}
+			item.amount = amount.number ();
+			item.id = send.second.get_optional<std::string> ("id");
+			items.push_back (item);
+		}
+	}
+	if (!ec)
+	{
+		// Results arrive on the wallet actions thread, each is written to the response as it completes
+		auto rpc_l (shared_from_this ());
+		auto writer (std::make_shared<nano::json_writer> (response_writer ()));
+		writer->start_array ("blocks");
+		wallet->send_batch_async (
+		items, [writer](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+			writer->start_object ();
+			writer->put ("index", std::to_string (index_a));
+			if (block_a != nullptr)
+			{
+				writer->put ("block", block_a->hash ().to_string ());
+			}
+			else
+			{
+				writer->put ("error", ec_a.message ());
+			}
+			writer->end ();
+		},
+		[rpc_l, writer]() {
+			writer->end ();
+			rpc_l->response_errors (*writer);
+		});
+	}
+	// Because of send_batch_async
+	if (ec)
+	{
+		response_errors ();
+	}
+}
+
 void nano::json_handler::sign ()
 {
 	const bool json_block_l = request.get<bool> ("json_block", false);
@@ -3750,6 +4021,22 @@ void nano::json_handler::stats_clear ()
 	response (ostream.str ());
 }
 
+void nano::json_handler::trace_dump ()
+{
+#if NANO_TRACING
+	auto trace_l (nano::tracing::dump_chrome_json ());
+	if (request.get<bool> ("clear", false))
+	{
+		nano::tracing::clear ();
+	}
+	// Returned as is, trace viewers need numeric timestamps which property trees can't write
+	response (trace_l);
+#else
+	ec = nano::error_rpc::tracing_unavailable;
+	response_errors ();
+#endif
+}
+
 void nano::json_handler::stop ()
 {
 	response_l.put ("success", "");
@@ -4241,25 +4528,46 @@ void nano::json_handler::wallet_balances ()
 	auto threshold (threshold_optional_impl ());
 	if (!ec)
 	{
-		boost::property_tree::ptree balances;
-		auto transaction (node.wallets.tx_begin_read ());
-		auto block_transaction (node.store.tx_begin_read ());
-		for (auto i (wallet->store.begin (transaction)), n (wallet->store.end ()); i != n; ++i)
+		auto accounts (std::make_shared<std::vector<nano::account>> ());
 		{
-			nano::account const & account (i->first);
-			nano::uint128_t balance = node.ledger.account_balance (block_transaction, account);
-			if (balance >= threshold.number ())
+			auto transaction (node.wallets.tx_begin_read ());
+			for (auto i (wallet->store.begin (transaction)), n (wallet->store.end ()); i != n; ++i)
 			{
-				boost::property_tree::ptree entry;
-				nano::uint128_t pending = node.ledger.account_pending (block_transaction, account);
-				entry.put ("balance", balance.convert_to<std::string> ());
-				entry.put ("pending", pending.convert_to<std::string> ());
-				balances.push_back (std::make_pair (account.to_account (), entry));
+				accounts->push_back (i->first);
 			}
 		}
-		response_l.add_child ("balances", balances);
+		auto balances (std::make_shared<std::vector<std::pair<nano::uint128_t, nano::uint128_t>>> (accounts->size ()));
+		for_each_account_parallel (
+		*accounts, [this, accounts, balances, threshold](nano::transaction & transaction_a, size_t index_a) {
+			auto const & account ((*accounts)[index_a]);
+			auto & balance ((*balances)[index_a]);
+			balance.first = node.ledger.account_balance (transaction_a, account);
+			if (balance.first >= threshold.number ())
+			{
+				balance.second = node.ledger.account_pending (transaction_a, account);
+			}
+		},
+		[accounts, balances, threshold](std::shared_ptr<nano::json_handler> const & rpc_l) {
+			boost::property_tree::ptree balances_l;
+			for (size_t i (0); i < accounts->size (); ++i)
+			{
+				auto const & balance ((*balances)[i]);
+				if (balance.first >= threshold.number ())
+				{
+					boost::property_tree::ptree entry;
+					entry.put ("balance", balance.first.convert_to<std::string> ());
+					entry.put ("pending", balance.second.convert_to<std::string> ());
+					balances_l.push_back (std::make_pair ((*accounts)[i].to_account (), entry));
+				}
+			}
+			rpc_l->response_l.add_child ("balances", balances_l);
+			rpc_l->response_errors ();
+		});
+	}
+	else
+	{
+		response_errors ();
 	}
-	response_errors ();
 }
 
 void nano::json_handler::wallet_change_seed ()
@@ -5121,11 +5429,13 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ()
 	no_arg_funcs.emplace ("search_pending", &nano::json_handler::search_pending);
 	no_arg_funcs.emplace ("search_pending_all", &nano::json_handler::search_pending_all);
 	no_arg_funcs.emplace ("send", &nano::json_handler::send);
+	no_arg_funcs.emplace ("send_batch", &nano::json_handler::send_batch);
 	no_arg_funcs.emplace ("sign", &nano::json_handler::sign);
 	no_arg_funcs.emplace ("stats", &nano::json_handler::stats);
 	no_arg_funcs.emplace ("stats_clear", &nano::json_handler::stats_clear);
 	no_arg_funcs.emplace ("stop", &nano::json_handler::stop);
 	no_arg_funcs.emplace ("telemetry", &nano::json_handler::telemetry);
+	no_arg_funcs.emplace ("trace_dump", &nano::json_handler::trace_dump);
 	no_arg_funcs.emplace ("unchecked", &nano::json_handler::unchecked);
 	no_arg_funcs.emplace ("unchecked_clear", &nano::json_handler::unchecked_clear);
 	no_arg_funcs.emplace ("unchecked_get", &nano::json_handler::unchecked_get);
@@ -5200,4 +5510,23 @@ const char * epoch_as_string (nano::epoch epoch)
 			return "0";
 	}
 }
+
+/**
+ * account_history cursors are opaque to clients, they encode the account and a position between two blocks of its chain.
+ * The height is the last block below the position, a forward query resumes from it and a reverse query from the block above
+ */
+std::string history_cursor_encode (nano::account const & account, uint64_t height)
+{
+	return account.to_string () + nano::to_string_hex (height);
+}
+
+bool history_cursor_decode (std::string const & cursor, nano::account & account, uint64_t & height)
+{
+	auto error (cursor.size () != 80);
+	if (!error)
+	{
+		error = account.decode_hex (cursor.substr (0, 64)) || nano::from_string_hex (cursor.substr (64), height) || height == 0;
+	}
+	return error;
+}
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <nano/lib/json_writer.hpp>
 #include <nano/lib/numbers.hpp>
 #include <nano/node/ipc/flatbuffers_handler.hpp>
 #include <nano/node/wallet.hpp>
@@ -94,11 +95,13 @@ public:
 	void search_pending ();
 	void search_pending_all ();
 	void send ();
+	void send_batch ();
 	void sign ();
 	void stats ();
 	void stats_clear ();
 	void stop ();
 	void telemetry ();
+	void trace_dump ();
 	void unchecked ();
 	void unchecked_clear ();
 	void unchecked_get ();
@@ -140,9 +143,14 @@ public:
 	boost::property_tree::ptree request;
 	std::function<void(std::string const &)> response;
 	void response_errors ();
+	/** Sends the streamed response of \p writer_a, or an error response if \p ec is set */
+	void response_errors (nano::json_writer & writer_a);
 	std::error_code ec;
 	std::string action;
 	boost::property_tree::ptree response_l;
+	/** Starts a streamed response in response_text, beginning with any fields already in response_l */
+	nano::json_writer response_writer ();
+	std::string response_text;
 	std::shared_ptr<nano::wallet> wallet_impl ();
 	bool wallet_locked_impl (nano::transaction const &, std::shared_ptr<nano::wallet> const &);
 	bool wallet_account_impl (nano::transaction const &, std::shared_ptr<nano::wallet> const &, nano::account const &);
@@ -164,6 +172,13 @@ public:
 	std::function<void()> stop_callback;
 	nano::node_rpc_config const & node_rpc_config;
 	std::function<void()> create_worker_task (std::function<void(std::shared_ptr<nano::json_handler> const &)> const &);
+	/**
+	 * Calls \p action_a with the index of each account in \p accounts_a, split into shards which run on the worker threads.
+	 * Each shard has its own read transaction and visits its accounts in key order. At most node_rpc_config.max_request_parallelism
+	 * shards are used, and small requests run inline. \p done_a is called once every account was visited, so it can write the
+	 * results in input order.
+	 */
+	void for_each_account_parallel (std::vector<nano::account> const & accounts_a, std::function<void(nano::transaction &, size_t)> const & action_a, std::function<void(std::shared_ptr<nano::json_handler> const &)> const & done_a);
 };
 
 class inprocess_rpc_handler final : public nano::rpc_handler_interface
@@ -200,6 +200,12 @@ void nano::mdb_store::open_databases (bool & error_a, nano::transaction const &
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "pending", flags, &pending_v0) != 0;
 	pending = pending_v0;
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "final_votes", flags, &final_votes) != 0;
+	// The account index tables are created by the first writable open after they were introduced. A database opened as read only
+	// before that doesn't have them, nor the meta marker of a built index, so they are never used.
+	auto account_heights_status (mdb_dbi_open (env.tx (transaction_a), "account_heights", flags, &account_heights));
+	error_a |= account_heights_status != 0 && !(account_heights_status == MDB_NOTFOUND && (flags & MDB_CREATE) == 0);
+	auto pending_amounts_status (mdb_dbi_open (env.tx (transaction_a), "pending_amounts", flags, &pending_amounts));
+	error_a |= pending_amounts_status != 0 && !(pending_amounts_status == MDB_NOTFOUND && (flags & MDB_CREATE) == 0);
 
 	auto version_l = version_get (transaction_a);
 	if (version_l < 19)
@@ -879,6 +885,10 @@ MDB_dbi nano::mdb_store::table_to_dbi (tables table_a) const
 			return confirmation_height;
 		case tables::final_votes:
 			return final_votes;
+		case tables::account_heights:
+			return account_heights;
+		case tables::pending_amounts:
+			return pending_amounts;
 		default:
 			release_assert (false);
 			return peers;
@@ -198,6 +198,18 @@ public:
 	 */
 	MDB_dbi final_votes{ 0 };
 
+	/**
+	 * Optional account index, maps the height of each block in an account chain to its hash.
+	 * nano::account_height_key -> nano::block_hash
+	 */
+	MDB_dbi account_heights{ 0 };
+
+	/**
+	 * Optional account index, orders the pending entries of each account by descending amount.
+	 * nano::pending_amount_key -> no_value
+	 */
+	MDB_dbi pending_amounts{ 0 };
+
 	bool exists (nano::transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a) const;
 	std::vector<nano::unchecked_info> unchecked_get (nano::transaction const & transaction_a, nano::block_hash const & hash_a) override;
 
@@ -92,7 +92,7 @@ void nano::logging::init (boost::filesystem::path const & application_path_a)
 			boost::log::keywords::open_mode = std::ios_base::out | std::ios_base::app, // append to node.log if it exists
 			boost::log::keywords::enable_final_rotation = false, // for stable log filenames, don't rotate on destruction
 			boost::log::keywords::rotation_size = rotation_size, // max file size in bytes before rotation
-			boost::log::keywords::auto_flush = flush,
+			boost::log::keywords::auto_flush = flush && !async, // the log queue flushes after each batch
 			boost::log::keywords::scan_method = boost::log::sinks::file::scan_method::scan_matching,
 			boost::log::keywords::max_size = max_size, // max total size in bytes of all log files
 			boost::log::keywords::format = format_with_timestamp);
@@ -115,7 +115,7 @@ void nano::logging::init (boost::filesystem::path const & application_path_a)
 			file_sink = boost::log::add_file_log (boost::log::keywords::target = path,
 			boost::log::keywords::file_name = path / "log_%Y-%m-%d_%H-%M-%S.%N.log",
 			boost::log::keywords::rotation_size = rotation_size,
-			boost::log::keywords::auto_flush = flush,
+			boost::log::keywords::auto_flush = flush && !async, // the log queue flushes after each batch
 			boost::log::keywords::scan_method = boost::log::sinks::file::scan_method::scan_matching,
 			boost::log::keywords::max_size = max_size,
 			boost::log::keywords::format = format_with_timestamp);
@@ -134,6 +134,11 @@ void nano::logging::init (boost::filesystem::path const & application_path_a)
 	//clang-format on
 }
 
+std::shared_ptr<nano::log_queue> nano::logging::make_log_queue () const
+{
+	return async ? std::make_shared<nano::log_queue> (flush, async_buffer_size) : nullptr;
+}
+
 void nano::logging::release_file_sink ()
 {
 	if (logging_already_added.test_and_set ())
@@ -176,6 +181,8 @@ nano::error nano::logging::serialize_toml (nano::tomlconfig & toml) const
 	toml.put ("min_time_between_output", min_time_between_log_output.count (), "Minimum time that must pass for low priority entries to be logged.\nWarning: decreasing this value may result in a very large amount of logs.\ntype:milliseconds");
 	toml.put ("single_line_record", single_line_record_value, "Keep log entries on single lines.\ntype:bool");
 	toml.put ("stable_log_filename", stable_log_filename, "Append to log/node.log without a timestamp in the filename.\nThe file is not emptied on startup if it exists, but appended to.\ntype:bool");
+	toml.put ("async", async, "Format and write log entries on a background thread, so logging threads don't wait for the log file.\ntype:bool");
+	toml.put ("async_buffer_size", async_buffer_size, "Log entries buffered per logging thread when async is enabled. Entries logged while the buffer is full are dropped and counted.\ntype:uint64");
 
 	return toml.get_error ();
 }
@@ -214,6 +221,8 @@ nano::error nano::logging::deserialize_toml (nano::tomlconfig & toml)
 	toml.get ("min_time_between_output", min_time_between_log_output_l);
 	min_time_between_log_output = std::chrono::milliseconds (min_time_between_log_output_l);
 	toml.get ("stable_log_filename", stable_log_filename);
+	toml.get<bool> ("async", async);
+	toml.get<size_t> ("async_buffer_size", async_buffer_size);
 
 	return toml.get_error ();
 }
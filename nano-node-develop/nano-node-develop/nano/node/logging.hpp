@@ -1,5 +1,6 @@
 #pragma once
 
+#include <nano/lib/config.hpp>
 #include <nano/lib/errors.hpp>
 
 #include <boost/log/detail/config.hpp>
@@ -8,6 +9,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
 
 #define FATAL_LOG_PREFIX "FATAL ERROR: "
 
@@ -32,6 +34,7 @@ namespace filesystem
 
 namespace nano
 {
+class log_queue;
 class tomlconfig;
 class jsonconfig;
 class logging final
@@ -69,6 +72,8 @@ public:
 	bool log_to_cerr () const;
 	bool single_line_record () const;
 	void init (boost::filesystem::path const &);
+	/** The queue for a node's logger, or nullptr if logging is synchronous */
+	std::shared_ptr<nano::log_queue> make_log_queue () const;
 
 	bool ledger_logging_value{ false };
 	bool ledger_duplicate_logging_value{ false };
@@ -100,6 +105,10 @@ public:
 	bool stable_log_filename{ false };
 	std::chrono::milliseconds min_time_between_log_output{ 5 };
 	bool single_line_record_value{ false };
+	/** Write log messages on a background thread. Synchronous in tests, which check the output at once */
+	bool async{ !nano::network_constants ().is_dev_network () };
+	/** Messages buffered per logging thread when asynchronous, further messages are dropped */
+	size_t async_buffer_size{ 1024 };
 	static void release_file_sink ();
 	unsigned json_version () const
 	{
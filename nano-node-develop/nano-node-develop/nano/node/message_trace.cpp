@@ -0,0 +1,77 @@
+#include <nano/node/message_trace.hpp>
+
+#include <boost/endian/conversion.hpp>
+
+bool nano::message_trace_recorded (nano::message_type type_a)
+{
+	return type_a == nano::message_type::publish || type_a == nano::message_type::confirm_req || type_a == nano::message_type::confirm_ack;
+}
+
+nano::message_trace_writer::message_trace_writer (boost::filesystem::path const & path_a) :
+stream (path_a.string (), std::ios::binary | std::ios::trunc),
+start (std::chrono::steady_clock::now ())
+{
+	stream.write (nano::message_trace_magic.data (), nano::message_trace_magic.size ());
+}
+
+bool nano::message_trace_writer::error () const
+{
+	return !stream.good ();
+}
+
+void nano::message_trace_writer::write (nano::message const & message_a)
+{
+	write (message_a, std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start));
+}
+
+void nano::message_trace_writer::write (nano::message const & message_a, std::chrono::microseconds time_a)
+{
+	auto bytes (message_a.to_bytes ());
+	auto time (boost::endian::native_to_little (static_cast<uint64_t> (time_a.count ())));
+	auto size (boost::endian::native_to_little (static_cast<uint32_t> (bytes->size ())));
+	nano::lock_guard<nano::mutex> lock (mutex);
+	stream.write (reinterpret_cast<char const *> (&time), sizeof (time));
+	stream.write (reinterpret_cast<char const *> (&size), sizeof (size));
+	stream.write (reinterpret_cast<char const *> (bytes->data ()), bytes->size ());
+}
+
+void nano::message_trace_writer::flush ()
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	stream.flush ();
+}
+
+nano::message_trace_reader::message_trace_reader (boost::filesystem::path const & path_a) :
+stream (path_a.string (), std::ios::binary)
+{
+	std::array<char, 8> magic{};
+	stream.read (magic.data (), magic.size ());
+	error_m = !stream.good () || magic != nano::message_trace_magic;
+}
+
+bool nano::message_trace_reader::error () const
+{
+	return error_m;
+}
+
+bool nano::message_trace_reader::next (entry & entry_a)
+{
+	uint64_t time (0);
+	uint32_t size (0);
+	auto result (!error_m);
+	if (result)
+	{
+		stream.read (reinterpret_cast<char *> (&time), sizeof (time));
+		stream.read (reinterpret_cast<char *> (&size), sizeof (size));
+		// A message is never larger than a block buffer, a larger size means a truncated or corrupt trace
+		result = stream.good () && boost::endian::little_to_native (size) <= 64 * 1024;
+	}
+	if (result)
+	{
+		entry_a.time = std::chrono::microseconds (boost::endian::little_to_native (time));
+		entry_a.message.resize (boost::endian::little_to_native (size));
+		stream.read (reinterpret_cast<char *> (entry_a.message.data ()), entry_a.message.size ());
+		result = !stream.fail ();
+	}
+	return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <nano/lib/locks.hpp>
+#include <nano/node/common.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+namespace nano
+{
+/** Whether messages of \p type_a are recorded in message traces, those which drive block and vote processing */
+bool message_trace_recorded (nano::message_type type_a);
+
+/**
+ * Message traces hold realtime messages as they arrived at a node, to be replayed by nano_bench.
+ * The file starts with message_trace_magic, followed for each message by the microseconds since the recording
+ * started as uint64, the message size as uint32, both little endian, and the serialized message.
+ */
+std::array<char, 8> constexpr message_trace_magic{ { 'N', 'A', 'N', 'O', 'T', 'R', 'C', '1' } };
+
+class message_trace_writer final
+{
+public:
+	explicit message_trace_writer (boost::filesystem::path const & path_a);
+	/** @return true if the file could not be created */
+	bool error () const;
+	/** Records \p message_a as arriving now */
+	void write (nano::message const & message_a);
+	/** Records \p message_a as arriving \p time_a after the start of the recording, used to generate traces */
+	void write (nano::message const & message_a, std::chrono::microseconds time_a);
+	void flush ();
+
+private:
+	nano::mutex mutex;
+	std::ofstream stream;
+	std::chrono::steady_clock::time_point const start;
+};
+
+class message_trace_reader final
+{
+public:
+	class entry final
+	{
+	public:
+		std::chrono::microseconds time{ 0 };
+		std::vector<uint8_t> message;
+	};
+	explicit message_trace_reader (boost::filesystem::path const & path_a);
+	/** @return true if the file is missing or isn't a message trace */
+	bool error () const;
+	/** Reads the next message into \p entry_a. @return false at the end of the trace */
+	bool next (entry & entry_a);
+
+private:
+	std::ifstream stream;
+	bool error_m{ false };
+};
+}
@@ -0,0 +1,275 @@
+#include <nano/boost/beast/core/flat_buffer.hpp>
+#include <nano/boost/beast/http.hpp>
+#include <nano/lib/threading.hpp>
+#include <nano/node/metrics.hpp>
+#include <nano/node/node.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <sstream>
+
+std::string const nano::metrics_server::content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+namespace
+{
+/** Escapes a label value as required by the exposition format */
+std::string escape (std::string const & value_a)
+{
+	std::string result;
+	result.reserve (value_a.size ());
+	for (auto character : value_a)
+	{
+		switch (character)
+		{
+			case '\\':
+				result += "\\\\";
+				break;
+			case '"':
+				result += "\\\"";
+				break;
+			case '\n':
+				result += "\\n";
+				break;
+			default:
+				result += character;
+		}
+	}
+	return result;
+}
+
+/** Exact decimal seconds, avoiding floating point rounding of bucket bounds */
+std::string seconds (std::chrono::nanoseconds const & duration_a)
+{
+	auto count (std::max<int64_t> (duration_a.count (), 0));
+	auto fraction (std::to_string (count % 1000000000));
+	return std::to_string (count / 1000000000) + "." + std::string (9 - fraction.size (), '0') + fraction;
+}
+
+void render_containers (std::ostream & items_a, std::ostream & bytes_a, nano::container_info_component const & component_a, std::string const & path_a)
+{
+	if (component_a.is_composite ())
+	{
+		auto const & composite (static_cast<nano::container_info_composite const &> (component_a));
+		auto path_l (path_a.empty () ? composite.get_name () : path_a + "/" + composite.get_name ());
+		for (auto const & child : composite.get_children ())
+		{
+			render_containers (items_a, bytes_a, *child, path_l);
+		}
+	}
+	else
+	{
+		auto const & info (static_cast<nano::container_info_leaf const &> (component_a).get_info ());
+		auto labels (std::string ("{path=\"") + escape (path_a + "/" + info.name) + "\"}");
+		items_a << "nano_container_items" << labels << ' ' << info.count << '\n';
+		bytes_a << "nano_container_bytes" << labels << ' ' << info.count * info.sizeof_element << '\n';
+	}
+}
+
+/** Answers the requests of one connection */
+class metrics_session final : public std::enable_shared_from_this<metrics_session>
+{
+public:
+	explicit metrics_session (std::shared_ptr<nano::metrics_server> const & server_a) :
+	server (server_a),
+	socket (server_a->node.io_ctx)
+	{
+	}
+	void read ()
+	{
+		request = {};
+		auto this_l (shared_from_this ());
+		boost::beast::http::async_read (socket, buffer, request, [this_l](boost::system::error_code const & ec, size_t) {
+			if (!ec)
+			{
+				this_l->respond ();
+			}
+		});
+	}
+	std::shared_ptr<nano::metrics_server> server;
+	boost::asio::ip::tcp::socket socket;
+
+private:
+	void respond ()
+	{
+		response = {};
+		response.version (request.version ());
+		response.keep_alive (request.keep_alive ());
+		response.set (boost::beast::http::field::server, "nano");
+		if (request.method () != boost::beast::http::verb::get)
+		{
+			response.result (boost::beast::http::status::method_not_allowed);
+			response.set (boost::beast::http::field::allow, "GET");
+		}
+		else if (request.target () != "/metrics")
+		{
+			response.result (boost::beast::http::status::not_found);
+		}
+		else
+		{
+			response.result (boost::beast::http::status::ok);
+			response.set (boost::beast::http::field::content_type, nano::metrics_server::content_type);
+			response.body () = server->render ();
+		}
+		response.prepare_payload ();
+		auto this_l (shared_from_this ());
+		boost::beast::http::async_write (socket, response, [this_l](boost::system::error_code const & ec, size_t) {
+			if (!ec && this_l->response.keep_alive ())
+			{
+				this_l->read ();
+			}
+			else
+			{
+				boost::system::error_code ignored;
+				this_l->socket.shutdown (boost::asio::ip::tcp::socket::shutdown_both, ignored);
+			}
+		});
+	}
+	boost::beast::flat_buffer buffer;
+	boost::beast::http::request<boost::beast::http::string_body> request;
+	boost::beast::http::response<boost::beast::http::string_body> response;
+};
+}
+
+nano::metrics_server::metrics_server (nano::node & node_a, boost::asio::ip::tcp::endpoint const & endpoint_a) :
+node (node_a),
+acceptor (node_a.io_ctx)
+{
+	try
+	{
+		acceptor.open (endpoint_a.protocol ());
+		acceptor.set_option (boost::asio::socket_base::reuse_address (true));
+		acceptor.bind (endpoint_a);
+		acceptor.listen (boost::asio::socket_base::max_listen_connections);
+	}
+	catch (std::exception const & ex)
+	{
+		node.logger.always_log ("Metrics: listen failed: ", ex.what ());
+	}
+}
+
+void nano::metrics_server::start ()
+{
+	if (acceptor.is_open ())
+	{
+		collect ();
+		ongoing_collect ();
+		accept ();
+	}
+}
+
+void nano::metrics_server::stop ()
+{
+	stopped = true;
+	boost::asio::post (node.io_ctx, [this_l = shared_from_this ()]() {
+		boost::system::error_code ignored;
+		this_l->acceptor.close (ignored);
+	});
+}
+
+uint16_t nano::metrics_server::listening_port () const
+{
+	boost::system::error_code ec;
+	return acceptor.local_endpoint (ec).port ();
+}
+
+void nano::metrics_server::accept ()
+{
+	auto session (std::make_shared<metrics_session> (shared_from_this ()));
+	acceptor.async_accept (session->socket, [session](boost::system::error_code const & ec) {
+		auto & server (*session->server);
+		if (!ec)
+		{
+			session->read ();
+		}
+		else if (ec != boost::asio::error::operation_aborted)
+		{
+			server.node.logger.try_log ("Metrics: accept failed: ", ec.message ());
+		}
+		if (!server.stopped && server.acceptor.is_open ())
+		{
+			server.accept ();
+		}
+	});
+}
+
+void nano::metrics_server::ongoing_collect ()
+{
+	std::weak_ptr<nano::metrics_server> this_w (shared_from_this ());
+	node.workers.add_timed_task (std::chrono::steady_clock::now () + node.config.metrics_config.collect_interval, [this_w]() {
+		if (auto this_l = this_w.lock ())
+		{
+			if (!this_l->stopped)
+			{
+				this_l->collect ();
+				this_l->ongoing_collect ();
+			}
+		}
+	});
+}
+
+void nano::metrics_server::collect ()
+{
+	std::ostringstream items;
+	std::ostringstream bytes;
+	items << "# TYPE nano_container_items gauge\n# HELP nano_container_items Number of items in node containers, as of the last collection\n";
+	bytes << "# TYPE nano_container_bytes gauge\n# UNIT nano_container_bytes bytes\n# HELP nano_container_bytes Approximate memory of the items in node containers, as of the last collection\n";
+	auto containers (nano::collect_container_info (node, "node"));
+	render_containers (items, bytes, *containers, "");
+
+	std::ostringstream store;
+	store << "# TYPE nano_store gauge\n# HELP nano_store Database statistics, as of the last collection\n";
+	boost::property_tree::ptree store_stats;
+	node.store.serialize_memory_stats (store_stats);
+	auto vendor (escape (node.store.vendor_get ()));
+	for (auto const & item : store_stats)
+	{
+		auto value (item.second.get_value_optional<double> ());
+		if (value)
+		{
+			store << "nano_store{vendor=\"" << vendor << "\",name=\"" << escape (item.first) << "\"} " << *value << '\n';
+		}
+	}
+
+	auto collected_l (items.str () + bytes.str () + store.str ());
+	nano::lock_guard<nano::mutex> guard (mutex);
+	collected.swap (collected_l);
+}
+
+std::string nano::metrics_server::render ()
+{
+	std::ostringstream result;
+	result << "# TYPE nano_stat counter\n# HELP nano_stat Node statistics counters\n";
+	node.stats.visit_counters ([&result](std::string const & type_a, std::string const & detail_a, std::string const & dir_a, uint64_t value_a) {
+		result << "nano_stat_total{type=\"" << escape (type_a) << "\",detail=\"" << escape (detail_a.empty () ? "all" : detail_a) << "\",dir=\"" << escape (dir_a) << "\"} " << value_a << '\n';
+	});
+
+	result << "# TYPE nano_latency_seconds histogram\n# UNIT nano_latency_seconds seconds\n# HELP nano_latency_seconds Durations of node operations\n";
+	for (auto i (0u); i < static_cast<unsigned> (nano::stat::latency::_last); ++i)
+	{
+		auto latency (static_cast<nano::stat::latency> (i));
+		auto kind (nano::stat::latency_to_string (latency));
+		auto snapshot (node.stats.latency_snapshot (latency));
+		uint64_t cumulative (0);
+		for (size_t bucket (0); bucket < nano::stat_latency_histogram::bounds.size (); ++bucket)
+		{
+			cumulative += snapshot.buckets[bucket];
+			result << "nano_latency_seconds_bucket{kind=\"" << kind << "\",le=\"" << seconds (nano::stat_latency_histogram::bounds[bucket]) << "\"} " << cumulative << '\n';
+		}
+		result << "nano_latency_seconds_bucket{kind=\"" << kind << "\",le=\"+Inf\"} " << snapshot.count << '\n';
+		result << "nano_latency_seconds_count{kind=\"" << kind << "\"} " << snapshot.count << '\n';
+		result << "nano_latency_seconds_sum{kind=\"" << kind << "\"} " << seconds (snapshot.sum) << '\n';
+	}
+
+	result << "# TYPE nano_thread_cpu_seconds counter\n# UNIT nano_thread_cpu_seconds seconds\n# HELP nano_thread_cpu_seconds CPU time of the node's threads by role\n";
+	for (auto const & item : nano::thread_role::cpu_time ())
+	{
+		result << "nano_thread_cpu_seconds_total{role=\"" << escape (nano::thread_role::get_string (item.first)) << "\"} " << seconds (item.second) << '\n';
+	}
+
+	{
+		nano::lock_guard<nano::mutex> guard (mutex);
+		result << collected;
+	}
+	result << "# EOF\n";
+	return result.str ();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nano/boost/asio/ip/tcp.hpp>
+#include <nano/lib/locks.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace nano
+{
+class node;
+/**
+ * Serves the node's metrics over HTTP at /metrics in the OpenMetrics text format: stat counters, latency histograms,
+ * CPU time per thread role, container sizes and database statistics.
+ * Counters and histograms are read without locks when scraped. Container sizes and database statistics need node
+ * locks, so they are collected periodically on a worker thread and scrapes return the last collection.
+ */
+class metrics_server final : public std::enable_shared_from_this<nano::metrics_server>
+{
+public:
+	metrics_server (nano::node &, boost::asio::ip::tcp::endpoint const &);
+	void start ();
+	void stop ();
+	/** The full exposition, as returned to a scrape */
+	std::string render ();
+	/** Collects container sizes and database statistics for the following scrapes */
+	void collect ();
+	/** Port being listened on, useful when started on an ephemeral port */
+	uint16_t listening_port () const;
+
+	static std::string const content_type;
+	nano::node & node;
+
+private:
+	void accept ();
+	void ongoing_collect ();
+	boost::asio::ip::tcp::acceptor acceptor;
+	nano::mutex mutex;
+	/** Exposition of the last collection */
+	std::string collected;
+	std::atomic<bool> stopped{ false };
+};
+}
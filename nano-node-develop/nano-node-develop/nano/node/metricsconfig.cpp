@@ -0,0 +1,35 @@
+#include <nano/boost/asio/ip/address_v6.hpp>
+#include <nano/lib/tomlconfig.hpp>
+#include <nano/node/metricsconfig.hpp>
+
+nano::metrics_config::metrics_config () :
+address (boost::asio::ip::address_v6::loopback ().to_string ()),
+port (network_constants.default_metrics_port)
+{
+}
+
+nano::error nano::metrics_config::serialize_toml (nano::tomlconfig & toml_a) const
+{
+	toml_a.put ("enable", enabled, "Enable or disable the OpenMetrics exporter, served over HTTP at /metrics.\ntype:bool");
+	toml_a.put ("address", address, "Metrics server bind address.\ntype:string,ip");
+	toml_a.put ("port", port, "Metrics server listening port.\ntype:uint16");
+	toml_a.put ("collect_interval", collect_interval.count (), "Interval in seconds between collections of container sizes and database statistics.\ntype:seconds");
+	return toml_a.get_error ();
+}
+
+nano::error nano::metrics_config::deserialize_toml (nano::tomlconfig & toml_a)
+{
+	toml_a.get<bool> ("enable", enabled);
+	boost::asio::ip::address_v6 address_l;
+	toml_a.get_optional<boost::asio::ip::address_v6> ("address", address_l, boost::asio::ip::address_v6::loopback ());
+	address = address_l.to_string ();
+	toml_a.get<uint16_t> ("port", port);
+	auto collect_interval_l (collect_interval.count ());
+	toml_a.get ("collect_interval", collect_interval_l);
+	collect_interval = std::chrono::seconds (collect_interval_l);
+	if (collect_interval.count () < 1)
+	{
+		toml_a.get_error ().set ("collect_interval must be at least 1 second");
+	}
+	return toml_a.get_error ();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <nano/lib/config.hpp>
+#include <nano/lib/errors.hpp>
+
+#include <chrono>
+
+namespace nano
+{
+class tomlconfig;
+
+/** Configuration of the OpenMetrics exporter */
+class metrics_config final
+{
+public:
+	metrics_config ();
+	nano::error serialize_toml (nano::tomlconfig & toml_a) const;
+	nano::error deserialize_toml (nano::tomlconfig & toml_a);
+
+	nano::network_constants network_constants;
+	bool enabled{ false };
+	std::string address;
+	uint16_t port;
+	/** How often container sizes and store statistics are collected. Scrapes return the last collection */
+	std::chrono::seconds collect_interval{ 10 };
+};
+}
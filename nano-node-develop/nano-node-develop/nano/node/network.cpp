@@ -1,5 +1,6 @@
 #include <nano/crypto_lib/random_pool_shuffle.hpp>
 #include <nano/lib/threading.hpp>
+#include <nano/node/message_trace.hpp>
 #include <nano/node/network.hpp>
 #include <nano/node/node.hpp>
 #include <nano/node/telemetry.hpp>
@@ -15,8 +16,8 @@ nano::network::network (nano::node & node_a, uint16_t port_a) :
 syn_cookies (node_a.network_params.node.max_peers_per_ip),
 buffer_container (node_a.stats, nano::network::buffer_size, 4096), // 2Mb receive buffer
 resolver (node_a.io_ctx),
-limiter (node_a.config.bandwidth_limit_burst_ratio, node_a.config.bandwidth_limit),
-tcp_message_manager (node_a.config.tcp_incoming_connections_max),
+shaper (node_a),
+tcp_message_manager (node_a.stats, node_a.config.tcp_incoming_connections_max),
 node (node_a),
 publish_filter (256 * 1024),
 udp_channels (node_a, port_a),
@@ -61,40 +62,44 @@ disconnect_observer ([]() {})
 			}
 		});
 	}
-	// TCP
-	for (size_t i = 0; i < node.config.network_threads && !node.flags.disable_tcp_realtime; ++i)
+	// TCP, each lane has its own threads
+	for (auto lane (0u); lane < static_cast<unsigned> (nano::tcp_message_lane::_last) && !node.flags.disable_tcp_realtime; ++lane)
 	{
-		packet_processing_threads.emplace_back (attrs, [this]() {
-			nano::thread_role::set (nano::thread_role::name::packet_processing);
-			try
-			{
-				tcp_channels.process_messages ();
-			}
-			catch (boost::system::error_code & ec)
-			{
-				this->node.logger.always_log (FATAL_LOG_PREFIX, ec.message ());
-				release_assert (false);
-			}
-			catch (std::error_code & ec)
-			{
-				this->node.logger.always_log (FATAL_LOG_PREFIX, ec.message ());
-				release_assert (false);
-			}
-			catch (std::runtime_error & err)
-			{
-				this->node.logger.always_log (FATAL_LOG_PREFIX, err.what ());
-				release_assert (false);
-			}
-			catch (...)
-			{
-				this->node.logger.always_log (FATAL_LOG_PREFIX, "Unknown exception");
-				release_assert (false);
-			}
-			if (this->node.config.logging.network_packet_logging ())
-			{
-				this->node.logger.try_log ("Exiting TCP packet processing thread");
-			}
-		});
+		auto lane_l (static_cast<nano::tcp_message_lane> (lane));
+		for (auto i (0u); i < nano::tcp_message_manager::consumers (lane_l, node.config.network_threads); ++i)
+		{
+			packet_processing_threads.emplace_back (attrs, [this, lane_l]() {
+				nano::thread_role::set (nano::thread_role::name::packet_processing);
+				try
+				{
+					tcp_channels.process_messages (lane_l);
+				}
+				catch (boost::system::error_code & ec)
+				{
+					this->node.logger.always_log (FATAL_LOG_PREFIX, ec.message ());
+					release_assert (false);
+				}
+				catch (std::error_code & ec)
+				{
+					this->node.logger.always_log (FATAL_LOG_PREFIX, ec.message ());
+					release_assert (false);
+				}
+				catch (std::runtime_error & err)
+				{
+					this->node.logger.always_log (FATAL_LOG_PREFIX, err.what ());
+					release_assert (false);
+				}
+				catch (...)
+				{
+					this->node.logger.always_log (FATAL_LOG_PREFIX, "Unknown exception");
+					release_assert (false);
+				}
+				if (this->node.config.logging.network_packet_logging ())
+				{
+					this->node.logger.try_log ("Exiting TCP packet processing thread");
+				}
+			});
+		}
 	}
 }
 
@@ -105,6 +110,15 @@ nano::network::~network ()
 
 void nano::network::start ()
 {
+	if (!node.flags.record_message_trace.empty ())
+	{
+		message_trace = std::make_unique<nano::message_trace_writer> (node.flags.record_message_trace);
+		if (message_trace->error ())
+		{
+			node.logger.always_log ("Unable to create message trace ", node.flags.record_message_trace);
+			message_trace.reset ();
+		}
+	}
 	ongoing_cleanup ();
 	ongoing_syn_cookie_cleanup ();
 	if (!node.flags.disable_udp)
@@ -128,6 +142,12 @@ void nano::network::stop ()
 		resolver.cancel ();
 		buffer_container.stop ();
 		tcp_message_manager.stop ();
+		shaper.stop ();
+		simulated_channels.clear ();
+		if (message_trace)
+		{
+			message_trace->flush ();
+		}
 		port = 0;
 		for (auto & thread : packet_processing_threads)
 		{
@@ -167,10 +187,15 @@ void nano::network::send_node_id_handshake (std::shared_ptr<nano::transport::cha
 }
 
 void nano::network::flood_message (nano::message const & message_a, nano::buffer_drop_policy const drop_policy_a, float const scale_a)
+{
+	flood_message (message_a.to_shared_const_buffer (), message_a.header.type, drop_policy_a, scale_a);
+}
+
+void nano::network::flood_message (nano::shared_const_buffer const & buffer_a, nano::message_type type_a, nano::buffer_drop_policy const drop_policy_a, float const scale_a)
 {
 	for (auto & i : list (fanout (scale_a)))
 	{
-		i->send (message_a, nullptr, drop_policy_a);
+		i->send (buffer_a, type_a, nullptr, drop_policy_a);
 	}
 }
 
@@ -182,32 +207,29 @@ void nano::network::flood_block (std::shared_ptr<nano::block> const & block_a, n
 
 void nano::network::flood_block_initial (std::shared_ptr<nano::block> const & block_a)
 {
-	nano::publish message (block_a);
+	auto buffer (nano::publish (block_a).to_shared_const_buffer ());
 	for (auto const & i : node.rep_crawler.principal_representatives ())
 	{
-		i.channel->send (message, nullptr, nano::buffer_drop_policy::no_limiter_drop);
+		i.channel->send (buffer, nano::message_type::publish, nullptr, nano::buffer_drop_policy::no_limiter_drop);
 	}
 	for (auto & i : list_non_pr (fanout (1.0)))
 	{
-		i->send (message, nullptr, nano::buffer_drop_policy::no_limiter_drop);
+		i->send (buffer, nano::message_type::publish, nullptr, nano::buffer_drop_policy::no_limiter_drop);
 	}
 }
 
 void nano::network::flood_vote (std::shared_ptr<nano::vote> const & vote_a, float scale)
 {
 	nano::confirm_ack message (vote_a);
-	for (auto & i : list (fanout (scale)))
-	{
-		i->send (message, nullptr);
-	}
+	flood_message (message, nano::buffer_drop_policy::limiter, scale);
 }
 
 void nano::network::flood_vote_pr (std::shared_ptr<nano::vote> const & vote_a)
 {
-	nano::confirm_ack message (vote_a);
+	auto buffer (nano::confirm_ack (vote_a).to_shared_const_buffer ());
 	for (auto const & i : node.rep_crawler.principal_representatives ())
 	{
-		i.channel->send (message, nullptr, nano::buffer_drop_policy::no_limiter_drop);
+		i.channel->send (buffer, nano::message_type::confirm_ack, nullptr, nano::buffer_drop_policy::no_limiter_drop);
 	}
 }
 
@@ -235,13 +257,6 @@ void nano::network::flood_block_many (std::deque<std::shared_ptr<nano::block>> b
 	}
 }
 
-void nano::network::send_confirm_req (std::shared_ptr<nano::transport::channel> const & channel_a, std::pair<nano::block_hash, nano::block_hash> const & hash_root_a)
-{
-	// Confirmation request with hash + root
-	nano::confirm_req req (hash_root_a.first, hash_root_a.second);
-	channel_a->send (req);
-}
-
 void nano::network::broadcast_confirm_req (std::shared_ptr<nano::block> const & block_a)
 {
 	auto list (std::make_shared<std::vector<std::shared_ptr<nano::transport::channel>>> (node.rep_crawler.representative_endpoints (std::numeric_limits<size_t>::max ())));
@@ -277,11 +292,11 @@ void nano::network::broadcast_confirm_req_base (std::shared_ptr<nano::block> con
 	{
 		node.logger.try_log (boost::str (boost::format ("Broadcasting confirm req for block %1% to %2% representatives") % block_a->hash ().to_string () % endpoints_a->size ()));
 	}
+	auto buffer (nano::confirm_req (block_a->hash (), block_a->root ()).to_shared_const_buffer ());
 	auto count (0);
 	while (!endpoints_a->empty () && count < max_reps)
 	{
-		auto channel (endpoints_a->back ());
-		send_confirm_req (channel, std::make_pair (block_a->hash (), block_a->root ().as_block_hash ()));
+		endpoints_a->back ()->send (buffer, nano::message_type::confirm_req);
 		endpoints_a->pop_back ();
 		count++;
 	}
@@ -529,6 +544,10 @@ public:
 
 void nano::network::process_message (nano::message const & message_a, std::shared_ptr<nano::transport::channel> const & channel_a)
 {
+	if (message_trace && nano::message_trace_recorded (message_a.header.type))
+	{
+		message_trace->write (message_a);
+	}
 	network_message_visitor visitor (node, channel_a);
 	message_a.visit (visitor);
 }
@@ -591,6 +610,7 @@ std::deque<std::shared_ptr<nano::transport::channel>> nano::network::list (size_
 	std::deque<std::shared_ptr<nano::transport::channel>> result;
 	tcp_channels.list (result, minimum_version_a, include_tcp_temporary_channels_a);
 	udp_channels.list (result, minimum_version_a);
+	simulated_channels.list (result, minimum_version_a);
 	nano::random_pool_shuffle (result.begin (), result.end ());
 	if (result.size () > count_a)
 	{
@@ -604,6 +624,7 @@ std::deque<std::shared_ptr<nano::transport::channel>> nano::network::list_non_pr
 	std::deque<std::shared_ptr<nano::transport::channel>> result;
 	tcp_channels.list (result);
 	udp_channels.list (result);
+	simulated_channels.list (result);
 	nano::random_pool_shuffle (result.begin (), result.end ());
 	result.erase (std::remove_if (result.begin (), result.end (), [this](std::shared_ptr<nano::transport::channel> const & channel) {
 		return this->node.rep_crawler.is_pr (*channel);
@@ -630,6 +651,11 @@ std::unordered_set<std::shared_ptr<nano::transport::channel>> nano::network::ran
 	{
 		result.insert (*i);
 	}
+	if (simulated_channels.size () != 0)
+	{
+		auto simulated_random (simulated_channels.random_set (count_a, min_version_a));
+		result.insert (simulated_random.begin (), simulated_random.end ());
+	}
 	while (result.size () > count_a)
 	{
 		result.erase (result.begin ());
@@ -701,6 +727,10 @@ std::shared_ptr<nano::transport::channel> nano::network::find_channel (nano::end
 	{
 		result = udp_channels.channel (endpoint_a);
 	}
+	if (!result)
+	{
+		result = simulated_channels.find_channel (endpoint_a);
+	}
 	return result;
 }
 
@@ -711,6 +741,10 @@ std::shared_ptr<nano::transport::channel> nano::network::find_node_id (nano::acc
 	{
 		result = udp_channels.find_node_id (node_id_a);
 	}
+	if (!result)
+	{
+		result = simulated_channels.find_node_id (node_id_a);
+	}
 	return result;
 }
 
@@ -768,7 +802,7 @@ void nano::network::ongoing_keepalive ()
 
 size_t nano::network::size () const
 {
-	return tcp_channels.size () + udp_channels.size ();
+	return tcp_channels.size () + udp_channels.size () + simulated_channels.size ();
 }
 
 float nano::network::size_sqrt () const
@@ -788,6 +822,10 @@ void nano::network::erase (nano::transport::channel const & channel_a)
 	{
 		tcp_channels.erase (channel_a.get_tcp_endpoint ());
 	}
+	else if (channel_type == nano::transport::transport_type::simulated)
+	{
+		simulated_channels.erase (channel_a.get_endpoint ());
+	}
 	else if (channel_type != nano::transport::transport_type::loopback)
 	{
 		udp_channels.erase (channel_a.get_endpoint ());
@@ -883,55 +921,218 @@ void nano::message_buffer_manager::stop ()
 	condition.notify_all ();
 }
 
-nano::tcp_message_manager::tcp_message_manager (unsigned incoming_connections_max_a) :
+nano::tcp_message_lane nano::to_tcp_message_lane (nano::message_type type_a)
+{
+	nano::tcp_message_lane result (nano::tcp_message_lane::generic);
+	switch (type_a)
+	{
+		case nano::message_type::confirm_ack:
+			result = nano::tcp_message_lane::vote;
+			break;
+		case nano::message_type::publish:
+			result = nano::tcp_message_lane::publish;
+			break;
+		case nano::message_type::confirm_req:
+			result = nano::tcp_message_lane::confirm_req;
+			break;
+		case nano::message_type::telemetry_req:
+		case nano::message_type::telemetry_ack:
+			result = nano::tcp_message_lane::telemetry;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+std::string nano::to_string (nano::tcp_message_lane lane_a)
+{
+	std::string result;
+	switch (lane_a)
+	{
+		case nano::tcp_message_lane::generic:
+			result = "generic";
+			break;
+		case nano::tcp_message_lane::vote:
+			result = "vote";
+			break;
+		case nano::tcp_message_lane::publish:
+			result = "publish";
+			break;
+		case nano::tcp_message_lane::confirm_req:
+			result = "confirm_req";
+			break;
+		case nano::tcp_message_lane::telemetry:
+			result = "telemetry";
+			break;
+		case nano::tcp_message_lane::_last:
+			debug_assert (false);
+			break;
+	}
+	return result;
+}
+
+nano::stat::detail nano::to_stat_detail (nano::tcp_message_lane lane_a)
+{
+	nano::stat::detail result (nano::stat::detail::all);
+	switch (lane_a)
+	{
+		case nano::tcp_message_lane::generic:
+			result = nano::stat::detail::generic;
+			break;
+		case nano::tcp_message_lane::vote:
+			result = nano::stat::detail::vote;
+			break;
+		case nano::tcp_message_lane::publish:
+			result = nano::stat::detail::publish;
+			break;
+		case nano::tcp_message_lane::confirm_req:
+			result = nano::stat::detail::confirm_req;
+			break;
+		case nano::tcp_message_lane::telemetry:
+			result = nano::stat::detail::telemetry;
+			break;
+		case nano::tcp_message_lane::_last:
+			debug_assert (false);
+			break;
+	}
+	return result;
+}
+
+unsigned constexpr nano::tcp_message_manager::max_entries_per_connection;
+
+nano::tcp_message_manager::tcp_message_manager (nano::stat & stats_a, unsigned incoming_connections_max_a) :
+stats (stats_a),
 max_entries (incoming_connections_max_a * nano::tcp_message_manager::max_entries_per_connection + 1)
 {
 	debug_assert (max_entries > 0);
 }
 
+bool nano::tcp_message_manager::droppable (nano::tcp_message_lane lane_a)
+{
+	// Handshakes and keepalives are cheap and needed to keep connections, losing votes delays confirmations
+	return lane_a != nano::tcp_message_lane::generic && lane_a != nano::tcp_message_lane::vote;
+}
+
+unsigned nano::tcp_message_manager::consumers (nano::tcp_message_lane lane_a, unsigned network_threads_a)
+{
+	unsigned result (1);
+	switch (lane_a)
+	{
+		case nano::tcp_message_lane::vote:
+			result = network_threads_a;
+			break;
+		case nano::tcp_message_lane::publish:
+			result = network_threads_a / 2;
+			break;
+		case nano::tcp_message_lane::confirm_req:
+			result = network_threads_a / 4;
+			break;
+		default:
+			break;
+	}
+	return std::max (result, 1u);
+}
+
 void nano::tcp_message_manager::put_message (nano::tcp_message_item const & item_a)
 {
+	auto lane_type (item_a.message != nullptr ? nano::to_tcp_message_lane (item_a.message->header.type) : nano::tcp_message_lane::generic);
+	auto & lane_l (lanes[static_cast<size_t> (lane_type)]);
+	auto drop (false);
 	{
-		nano::unique_lock<nano::mutex> lock (mutex);
-		while (entries.size () >= max_entries && !stopped)
+		nano::unique_lock<nano::mutex> lock (lane_l.mutex);
+		if (droppable (lane_type))
+		{
+			auto existing (lane_l.peers.find (item_a.endpoint));
+			drop = lane_l.size >= max_entries || (existing != lane_l.peers.end () && existing->second.size () >= max_entries_per_connection);
+		}
+		else
+		{
+			// Producers run on io threads, waiting on a single peer's queue would let a few peers park all of them
+			while (lane_l.size >= max_entries && !stopped)
+			{
+				lane_l.producer_condition.wait (lock);
+			}
+		}
+		if (!drop)
 		{
-			producer_condition.wait (lock);
+			auto & queue (lane_l.peers[item_a.endpoint]);
+			if (queue.empty ())
+			{
+				lane_l.ready.push_back (item_a.endpoint);
+			}
+			queue.push_back ({ item_a, std::chrono::steady_clock::now () });
+			++lane_l.size;
 		}
-		entries.push_back (item_a);
 	}
-	consumer_condition.notify_one ();
+	if (!drop)
+	{
+		lane_l.consumer_condition.notify_one ();
+	}
+	else
+	{
+		stats.inc (nano::stat::type::tcp_lane_drop, nano::to_stat_detail (lane_type), nano::stat::dir::in);
+	}
 }
 
-nano::tcp_message_item nano::tcp_message_manager::get_message ()
+nano::tcp_message_item nano::tcp_message_manager::get_message (nano::tcp_message_lane lane_a)
 {
 	nano::tcp_message_item result;
-	nano::unique_lock<nano::mutex> lock (mutex);
-	while (entries.empty () && !stopped)
-	{
-		consumer_condition.wait (lock);
-	}
-	if (!entries.empty ())
-	{
-		result = std::move (entries.front ());
-		entries.pop_front ();
+	auto & lane_l (lanes[static_cast<size_t> (lane_a)]);
+	nano::unique_lock<nano::mutex> lock (lane_l.mutex);
+	while (lane_l.size == 0 && !stopped)
+	{
+		lane_l.consumer_condition.wait (lock);
+	}
+	if (lane_l.size != 0)
+	{
+		// Take the oldest message of the next peer, which goes to the back of the line if it has more
+		auto endpoint (lane_l.ready.front ());
+		lane_l.ready.pop_front ();
+		auto existing (lane_l.peers.find (endpoint));
+		debug_assert (existing != lane_l.peers.end () && !existing->second.empty ());
+		auto entry_l (std::move (existing->second.front ()));
+		existing->second.pop_front ();
+		if (existing->second.empty ())
+		{
+			lane_l.peers.erase (existing);
+		}
+		else
+		{
+			lane_l.ready.push_back (endpoint);
+		}
+		--lane_l.size;
+		lock.unlock ();
+		lane_l.producer_condition.notify_all ();
+		stats.observe (static_cast<nano::stat::latency> (static_cast<size_t> (nano::stat::latency::tcp_lane_generic) + static_cast<size_t> (lane_a)), std::chrono::steady_clock::now () - entry_l.queued);
+		result = std::move (entry_l.item);
 	}
 	else
 	{
 		result = nano::tcp_message_item{ std::make_shared<nano::keepalive> (), nano::tcp_endpoint (boost::asio::ip::address_v6::any (), 0), 0, nullptr, nano::bootstrap_server_type::undefined };
 	}
-	lock.unlock ();
-	producer_condition.notify_one ();
 	return result;
 }
 
+size_t nano::tcp_message_manager::size (nano::tcp_message_lane lane_a) const
+{
+	auto & lane_l (lanes[static_cast<size_t> (lane_a)]);
+	nano::lock_guard<nano::mutex> lock (lane_l.mutex);
+	return lane_l.size;
+}
+
 void nano::tcp_message_manager::stop ()
 {
+	stopped = true;
+	for (auto & lane_l : lanes)
 	{
-		nano::lock_guard<nano::mutex> lock (mutex);
-		stopped = true;
+		{
+			// Waiters check stopped under the lock, so none misses the notification
+			nano::lock_guard<nano::mutex> lock (lane_l.mutex);
+		}
+		lane_l.consumer_condition.notify_all ();
+		lane_l.producer_condition.notify_all ();
 	}
-	consumer_condition.notify_all ();
-	producer_condition.notify_all ();
 }
 
 nano::syn_cookies::syn_cookies (size_t max_cookies_per_ip_a) :
@@ -1025,6 +1226,19 @@ std::unique_ptr<nano::container_info_component> nano::collect_container_info (ne
 	composite->add_component (network.udp_channels.collect_container_info ("udp_channels"));
 	composite->add_component (network.syn_cookies.collect_container_info ("syn_cookies"));
 	composite->add_component (collect_container_info (network.excluded_peers, "excluded_peers"));
+	composite->add_component (nano::transport::collect_container_info (network.shaper, "traffic_shaper"));
+	composite->add_component (network.tcp_message_manager.collect_container_info ("tcp_message_manager"));
+	return composite;
+}
+
+std::unique_ptr<nano::container_info_component> nano::tcp_message_manager::collect_container_info (std::string const & name)
+{
+	auto composite = std::make_unique<container_info_composite> (name);
+	for (auto i (0u); i < lanes.size (); ++i)
+	{
+		auto lane_l (static_cast<nano::tcp_message_lane> (i));
+		composite->add_component (std::make_unique<container_info_leaf> (container_info{ nano::to_string (lane_l), size (lane_l), sizeof (entry) }));
+	}
 	return composite;
 }
 
@@ -2,18 +2,22 @@
 
 #include <nano/node/common.hpp>
 #include <nano/node/peer_exclusion.hpp>
+#include <nano/node/transport/simulated.hpp>
 #include <nano/node/transport/tcp.hpp>
 #include <nano/node/transport/udp.hpp>
 #include <nano/secure/network_filter.hpp>
 
 #include <boost/thread/thread.hpp>
 
+#include <array>
 #include <memory>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 namespace nano
 {
 class channel;
+class message_trace_writer;
 class node;
 class stats;
 class transaction;
@@ -66,25 +70,70 @@ private:
 	std::vector<nano::message_buffer> entries;
 	bool stopped;
 };
+/** Lanes of realtime messages received over TCP. Each has its own queue and threads, so cheap messages don't wait behind expensive ones */
+enum class tcp_message_lane : uint8_t
+{
+	/** keepalive and node_id_handshake */
+	generic,
+	/** confirm_ack */
+	vote,
+	publish,
+	confirm_req,
+	telemetry,
+	_last
+};
+nano::tcp_message_lane to_tcp_message_lane (nano::message_type);
+std::string to_string (nano::tcp_message_lane);
+nano::stat::detail to_stat_detail (nano::tcp_message_lane);
+
+/**
+ * Bounded queues of realtime messages received over TCP, one per nano::tcp_message_lane.
+ * Within a lane each peer has its own queue and peers are served round robin with equal weight, so a noisy peer only
+ * delays its own messages. Droppable lanes drop a message once the lane or the peer's queue of
+ * max_entries_per_connection is full, other lanes make the producer wait only while the whole lane is full
+ */
 class tcp_message_manager final
 {
 public:
-	tcp_message_manager (unsigned incoming_connections_max_a);
+	tcp_message_manager (nano::stat &, unsigned incoming_connections_max_a);
 	void put_message (nano::tcp_message_item const & item_a);
-	nano::tcp_message_item get_message ();
+	/** Waits for a message in \p lane_a. Once stopped, returns a keepalive without a socket */
+	nano::tcp_message_item get_message (nano::tcp_message_lane lane_a);
 	// Stop container and notify waiting threads
 	void stop ();
+	size_t size (nano::tcp_message_lane) const;
+	/** Whether messages are dropped rather than waiting for room in a full lane */
+	static bool droppable (nano::tcp_message_lane);
+	/** Number of threads processing \p lane_a, votes get the most */
+	static unsigned consumers (nano::tcp_message_lane lane_a, unsigned network_threads_a);
+	std::unique_ptr<nano::container_info_component> collect_container_info (std::string const &);
 
 private:
-	nano::mutex mutex;
-	nano::condition_variable producer_condition;
-	nano::condition_variable consumer_condition;
-	std::deque<nano::tcp_message_item> entries;
+	class entry final
+	{
+	public:
+		nano::tcp_message_item item;
+		std::chrono::steady_clock::time_point queued;
+	};
+	class lane final
+	{
+	public:
+		mutable nano::mutex mutex;
+		nano::condition_variable producer_condition;
+		nano::condition_variable consumer_condition;
+		std::unordered_map<nano::tcp_endpoint, std::deque<entry>> peers;
+		/** Peers with queued messages in the order they are served */
+		std::deque<nano::tcp_endpoint> ready;
+		size_t size{ 0 };
+	};
+	nano::stat & stats;
+	std::array<lane, static_cast<size_t> (nano::tcp_message_lane::_last)> lanes;
 	unsigned max_entries;
-	static unsigned const max_entries_per_connection = 16;
-	bool stopped{ false };
+	static unsigned constexpr max_entries_per_connection = 16;
+	std::atomic<bool> stopped{ false };
 
 	friend class network_tcp_message_manager_Test;
+	friend class network_tcp_message_manager_fairness_Test;
 };
 /**
   * Node ID cookies for node ID handshakes
@@ -123,6 +172,8 @@ public:
 	void start ();
 	void stop ();
 	void flood_message (nano::message const &, nano::buffer_drop_policy const = nano::buffer_drop_policy::limiter, float const = 1.0f);
+	/** Floods a message already serialized by nano::message::to_shared_const_buffer */
+	void flood_message (nano::shared_const_buffer const &, nano::message_type, nano::buffer_drop_policy const = nano::buffer_drop_policy::limiter, float const = 1.0f);
 	void flood_keepalive (float const scale_a = 1.0f)
 	{
 		nano::keepalive message;
@@ -147,7 +198,6 @@ public:
 	void send_keepalive (std::shared_ptr<nano::transport::channel> const &);
 	void send_keepalive_self (std::shared_ptr<nano::transport::channel> const &);
 	void send_node_id_handshake (std::shared_ptr<nano::transport::channel> const &, boost::optional<nano::uint256_union> const & query, boost::optional<nano::uint256_union> const & respond_to);
-	void send_confirm_req (std::shared_ptr<nano::transport::channel> const & channel_a, std::pair<nano::block_hash, nano::block_hash> const & hash_root_a);
 	void broadcast_confirm_req (std::shared_ptr<nano::block> const &);
 	void broadcast_confirm_req_base (std::shared_ptr<nano::block> const &, std::shared_ptr<std::vector<std::shared_ptr<nano::transport::channel>>> const &, unsigned, bool = false);
 	void broadcast_confirm_req_batched_many (std::unordered_map<std::shared_ptr<nano::transport::channel>, std::deque<std::pair<nano::block_hash, nano::root>>>, std::function<void()> = nullptr, unsigned = broadcast_interval_ms, bool = false);
@@ -182,13 +232,17 @@ public:
 	nano::message_buffer_manager buffer_container;
 	boost::asio::ip::udp::resolver resolver;
 	std::vector<boost::thread> packet_processing_threads;
-	nano::bandwidth_limiter limiter;
+	nano::transport::traffic_shaper shaper;
 	nano::peer_exclusion excluded_peers;
 	nano::tcp_message_manager tcp_message_manager;
 	nano::node & node;
 	nano::network_filter publish_filter;
 	nano::transport::udp_channels udp_channels;
 	nano::transport::tcp_channels tcp_channels;
+	/** Links to other nodes of a nano::transport::simulated::simulator, only used by network simulations */
+	nano::transport::simulated::channels simulated_channels;
+	/** Set when node_flags::record_message_trace is */
+	std::unique_ptr<nano::message_trace_writer> message_trace;
 	std::atomic<uint16_t> port{ 0 };
 	std::function<void()> disconnect_observer;
 	// Called when a new channel is observed
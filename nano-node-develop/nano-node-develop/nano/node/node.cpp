@@ -3,6 +3,7 @@
 #include <nano/lib/utility.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/daemonconfig.hpp>
+#include <nano/node/metrics.hpp>
 #include <nano/node/node.hpp>
 #include <nano/node/rocksdb/rocksdb.hpp>
 #include <nano/node/telemetry.hpp>
@@ -18,6 +19,7 @@
 #include <cstdlib>
 #include <future>
 #include <sstream>
+#include <unordered_set>
 
 double constexpr nano::node::price_max;
 double constexpr nano::node::free_cutoff;
@@ -94,7 +96,7 @@ workers (std::max (3u, config.io_threads / 4), nano::thread_role::name::worker),
 flags (flags_a),
 work (work_a),
 distributed_work (*this),
-logger (config_a.logging.min_time_between_log_output),
+logger (config_a.logging.min_time_between_log_output, config_a.logging.make_log_queue ()),
 store_impl (nano::make_store (logger, application_path_a, flags.read_only, true, config_a.rocksdb_config, config_a.diagnostics_config.txn_tracking, config_a.block_processor_batch_max_time, config_a.lmdb_config, config_a.backup_before_upgrade)),
 store (*store_impl),
 wallets_store_impl (std::make_unique<nano::mdb_wallets_store> (application_path_a / "wallets.ldb", config_a.lmdb_config)),
@@ -128,6 +130,7 @@ wallets (wallets_store.init_error (), *this),
 startup_time (std::chrono::steady_clock::now ()),
 node_seq (seq)
 {
+	nano::work_pool::define_histograms (stats);
 	if (!init_error ())
 	{
 		telemetry->start ();
@@ -139,6 +142,13 @@ node_seq (seq)
 			this->websocket_server->run ();
 		}
 
+		if (config.metrics_config.enabled)
+		{
+			auto endpoint_l (nano::tcp_endpoint (boost::asio::ip::make_address_v6 (config.metrics_config.address), config.metrics_config.port));
+			metrics = std::make_shared<nano::metrics_server> (*this, endpoint_l);
+			metrics->start ();
+		}
+
 		wallets.observer = [this](bool active) {
 			observers.wallet.notify (active);
 		};
@@ -264,7 +274,7 @@ node_seq (seq)
 			observers.telemetry.add ([this](nano::telemetry_data const & telemetry_data, nano::endpoint const & endpoint) {
 				if (this->websocket_server->any_subscriber (nano::websocket::topic::telemetry))
 				{
-					nano::websocket::message_builder builder;
+					nano::websocket::message_builder builder (this->websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::telemetry));
 					this->websocket_server->broadcast (builder.telemetry_received (telemetry_data, endpoint));
 				}
 			});
@@ -316,7 +326,7 @@ node_seq (seq)
 			observers.vote.add ([this](std::shared_ptr<nano::vote> vote_a, std::shared_ptr<nano::transport::channel> const & channel_a, nano::vote_code code_a) {
 				if (this->websocket_server->any_subscriber (nano::websocket::topic::vote))
 				{
-					nano::websocket::message_builder builder;
+					nano::websocket::message_builder builder (this->websocket_server->any_flatbuffers_subscriber (nano::websocket::topic::vote));
 					auto msg (builder.vote_received (vote_a, code_a));
 					this->websocket_server->broadcast (msg);
 				}
@@ -335,7 +345,7 @@ node_seq (seq)
 		auto network_label = network_params.network.get_current_network_as_string ();
 		logger.always_log ("Active network: ", network_label);
 
-		logger.always_log (boost::str (boost::format ("Work pool running %1% threads %2%") % work.threads.size () % (work.opencl ? "(1 for OpenCL)" : "")));
+		logger.always_log (boost::str (boost::format ("Work pool running %1% threads %2%, CPU kernel %3%") % work.threads.size () % (work.opencl ? "(1 for OpenCL)" : "") % nano::to_string (work.kernel)));
 		logger.always_log (boost::str (boost::format ("%1% work peers configured") % config.work_peers.size ()));
 		if (!work_generation_enabled ())
 		{
@@ -348,6 +358,7 @@ node_seq (seq)
 		}
 
 		logger.always_log (boost::str (boost::format ("Outbound Voting Bandwidth limited to %1% bytes per second, burst ratio %2%") % config.bandwidth_limit % config.bandwidth_limit_burst_ratio));
+		logger.always_log ("Network IO backend: ", nano::io_backend ());
 
 		// First do a pass with a read to see if any writing needs doing, this saves needing to open a write lock (and potentially blocking)
 		auto is_initialized (false);
@@ -557,6 +568,7 @@ std::unique_ptr<nano::container_info_component> nano::collect_container_info (no
 	composite->add_component (collect_container_info (node.history, "history"));
 	composite->add_component (collect_container_info (node.block_uniquer, "block_uniquer"));
 	composite->add_component (collect_container_info (node.vote_uniquer, "vote_uniquer"));
+	composite->add_component (collect_memory_pool_info ("memory_pools"));
 	composite->add_component (collect_container_info (node.confirmation_height_processor, "confirmation_height_processor"));
 	composite->add_component (collect_container_info (node.distributed_work, "distributed_work"));
 	composite->add_component (collect_container_info (node.aggregator, "request_aggregator"));
@@ -571,7 +583,7 @@ void nano::node::process_active (std::shared_ptr<nano::block> const & incoming)
 
 nano::process_return nano::node::process (nano::block & block_a)
 {
-	auto transaction (store.tx_begin_write ({ tables::accounts, tables::blocks, tables::frontiers, tables::pending }));
+	auto transaction (store.tx_begin_write ({ tables::account_heights, tables::accounts, tables::blocks, tables::frontiers, tables::pending, tables::pending_amounts }));
 	auto result (ledger.process (transaction, block_a));
 	return result;
 }
@@ -586,10 +598,39 @@ nano::process_return nano::node::process_local (std::shared_ptr<nano::block> con
 	block_processor.wait_write ();
 	// Process block
 	block_post_events post_events ([& store = store] { return store.tx_begin_read (); });
-	auto transaction (store.tx_begin_write ({ tables::accounts, tables::blocks, tables::frontiers, tables::pending }));
+	auto transaction (store.tx_begin_write ({ tables::account_heights, tables::accounts, tables::blocks, tables::frontiers, tables::pending, tables::pending_amounts }));
 	return block_processor.process_one (transaction, post_events, info, work_watcher_a, false, nano::block_origin::local);
 }
 
+std::vector<nano::process_return> nano::node::process_local (std::vector<std::shared_ptr<nano::block>> const & blocks_a, bool const work_watcher_a)
+{
+	std::vector<nano::process_return> result;
+	result.reserve (blocks_a.size ());
+	// Blocks of a chain after one which failed can never be processed, they aren't stored as unchecked either
+	std::unordered_set<nano::block_hash> failed;
+	block_processor.wait_write ();
+	block_post_events post_events ([& store = store] { return store.tx_begin_read (); });
+	auto transaction (store.tx_begin_write ({ tables::account_heights, tables::accounts, tables::blocks, tables::frontiers, tables::pending, tables::pending_amounts, tables::unchecked }));
+	for (auto const & block : blocks_a)
+	{
+		if (failed.count (block->previous ()) == 0)
+		{
+			block_arrival.add (block->hash ());
+			nano::unchecked_info info (block, block->account (), nano::seconds_since_epoch (), nano::signature_verification::unknown);
+			result.push_back (block_processor.process_one (transaction, post_events, info, work_watcher_a, false, nano::block_origin::local));
+		}
+		else
+		{
+			result.push_back ({ nano::process_result::gap_previous, nano::signature_verification::unknown, 0 });
+		}
+		if (result.back ().code != nano::process_result::progress)
+		{
+			failed.insert (block->hash ());
+		}
+	}
+	return result;
+}
+
 void nano::node::process_local_async (std::shared_ptr<nano::block> const & block_a, bool const work_watcher_a)
 {
 	// Add block hash as recently arrived to trigger automatic rebroadcast and election
@@ -681,6 +722,10 @@ void nano::node::stop ()
 		{
 			websocket_server->stop ();
 		}
+		if (metrics)
+		{
+			metrics->stop ();
+		}
 		bootstrap_initiator.stop ();
 		bootstrap.stop ();
 		port_mapping.stop ();
@@ -1157,7 +1202,8 @@ bool nano::node::work_generation_enabled (std::vector<std::pair<std::string, uin
 
 boost::optional<uint64_t> nano::node::work_generate_blocking (nano::block & block_a, uint64_t difficulty_a)
 {
-	auto opt_work_l (work_generate_blocking (block_a.work_version (), block_a.root (), difficulty_a, block_a.account ()));
+	// Blocks are completed by wallets and the user is waiting for them
+	auto opt_work_l (work_generate_blocking (block_a.work_version (), block_a.root (), difficulty_a, block_a.account (), nano::work_priority::high));
 	if (opt_work_l.is_initialized ())
 	{
 		block_a.block_work_set (*opt_work_l);
@@ -1165,24 +1211,24 @@ boost::optional<uint64_t> nano::node::work_generate_blocking (nano::block & bloc
 	return opt_work_l;
 }
 
-void nano::node::work_generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t>)> callback_a, boost::optional<nano::account> const & account_a, bool secondary_work_peers_a)
+void nano::node::work_generate (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, std::function<void(boost::optional<uint64_t>)> callback_a, boost::optional<nano::account> const & account_a, bool secondary_work_peers_a, nano::work_priority const priority_a, std::chrono::steady_clock::time_point const & deadline_a)
 {
 	auto const & peers_l (secondary_work_peers_a ? config.secondary_work_peers : config.work_peers);
-	if (distributed_work.make (version_a, root_a, peers_l, difficulty_a, callback_a, account_a))
+	if (distributed_work.make (version_a, root_a, peers_l, difficulty_a, callback_a, account_a, priority_a, deadline_a))
 	{
 		// Error in creating the job (either stopped or work generation is not possible)
 		callback_a (boost::none);
 	}
 }
 
-boost::optional<uint64_t> nano::node::work_generate_blocking (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, boost::optional<nano::account> const & account_a)
+boost::optional<uint64_t> nano::node::work_generate_blocking (nano::work_version const version_a, nano::root const & root_a, uint64_t difficulty_a, boost::optional<nano::account> const & account_a, nano::work_priority const priority_a)
 {
 	std::promise<boost::optional<uint64_t>> promise;
 	work_generate (
 	version_a, root_a, difficulty_a, [&promise](boost::optional<uint64_t> opt_work_a) {
 		promise.set_value (opt_work_a);
 	},
-	account_a);
+	account_a, false, priority_a);
 	return promise.get_future ().get ();
 }
 
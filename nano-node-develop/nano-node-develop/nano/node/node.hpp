@@ -46,6 +46,7 @@ namespace websocket
 {
 	class listener;
 }
+class metrics_server;
 class node;
 class telemetry;
 class work_pool;
@@ -105,6 +106,11 @@ public:
 	void process_active (std::shared_ptr<nano::block> const &);
 	nano::process_return process (nano::block &);
 	nano::process_return process_local (std::shared_ptr<nano::block> const &, bool const = false);
+	/**
+	 * Processes the blocks in order in a single write transaction, returning the result of each. Once a block fails, the later
+	 * blocks building on it are not processed and their result is gap_previous.
+	 */
+	std::vector<nano::process_return> process_local (std::vector<std::shared_ptr<nano::block>> const &, bool const = false);
 	void process_local_async (std::shared_ptr<nano::block> const &, bool const = false);
 	void keepalive_preconfigured (std::vector<std::string> const &);
 	nano::block_hash latest (nano::account const &);
@@ -135,8 +141,8 @@ public:
 	bool work_generation_enabled () const;
 	bool work_generation_enabled (std::vector<std::pair<std::string, uint16_t>> const &) const;
 	boost::optional<uint64_t> work_generate_blocking (nano::block &, uint64_t);
-	boost::optional<uint64_t> work_generate_blocking (nano::work_version const, nano::root const &, uint64_t, boost::optional<nano::account> const & = boost::none);
-	void work_generate (nano::work_version const, nano::root const &, uint64_t, std::function<void(boost::optional<uint64_t>)>, boost::optional<nano::account> const & = boost::none, bool const = false);
+	boost::optional<uint64_t> work_generate_blocking (nano::work_version const, nano::root const &, uint64_t, boost::optional<nano::account> const & = boost::none, nano::work_priority const = nano::work_priority::normal);
+	void work_generate (nano::work_version const, nano::root const &, uint64_t, std::function<void(boost::optional<uint64_t>)>, boost::optional<nano::account> const & = boost::none, bool const = false, nano::work_priority const = nano::work_priority::normal, std::chrono::steady_clock::time_point const & = std::chrono::steady_clock::time_point::max ());
 	void add_initial_peers ();
 	void block_confirm (std::shared_ptr<nano::block> const &);
 	bool block_confirmed (nano::block_hash const &);
@@ -156,6 +162,7 @@ public:
 	nano::stat stats;
 	nano::thread_pool workers;
 	std::shared_ptr<nano::websocket::listener> websocket_server;
+	std::shared_ptr<nano::metrics_server> metrics;
 	nano::node_flags flags;
 	nano::work_pool & work;
 	nano::distributed_work_factory distributed_work;
@@ -9,6 +9,7 @@ nano::error nano::node_rpc_config::serialize_json (nano::jsonconfig & json) cons
 {
 	json.put ("version", json_version ());
 	json.put ("enable_sign_hash", enable_sign_hash);
+	json.put ("max_request_parallelism", max_request_parallelism);
 
 	nano::jsonconfig child_process_l;
 	child_process_l.put ("enable", child_process.enable);
@@ -20,6 +21,7 @@ nano::error nano::node_rpc_config::serialize_json (nano::jsonconfig & json) cons
 nano::error nano::node_rpc_config::serialize_toml (nano::tomlconfig & toml) const
 {
 	toml.put ("enable_sign_hash", enable_sign_hash, "Allow or disallow signing of hashes.\ntype:bool");
+	toml.put ("max_request_parallelism", max_request_parallelism, "Maximum number of worker threads used by a single request which looks up many accounts, such as accounts_balances. 1 processes such requests serially.\ntype:uint32,[1..]");
 
 	nano::tomlconfig child_process_l;
 	child_process_l.put ("enable", child_process.enable, "Enable or disable RPC child process. If false, an in-process RPC server is used.\ntype:bool");
@@ -32,6 +34,11 @@ nano::error nano::node_rpc_config::deserialize_toml (nano::tomlconfig & toml)
 {
 	toml.get_optional ("enable_sign_hash", enable_sign_hash);
 	toml.get_optional<bool> ("enable_sign_hash", enable_sign_hash);
+	toml.get_optional<unsigned> ("max_request_parallelism", max_request_parallelism);
+	if (max_request_parallelism == 0)
+	{
+		toml.get_error ().set ("max_request_parallelism must be greater than 0");
+	}
 
 	auto child_process_l (toml.get_optional_child ("child_process"));
 	if (child_process_l)
@@ -46,6 +53,11 @@ nano::error nano::node_rpc_config::deserialize_toml (nano::tomlconfig & toml)
 nano::error nano::node_rpc_config::deserialize_json (bool & upgraded_a, nano::jsonconfig & json, boost::filesystem::path const & data_path)
 {
 	json.get_optional<bool> ("enable_sign_hash", enable_sign_hash);
+	json.get_optional<unsigned> ("max_request_parallelism", max_request_parallelism);
+	if (max_request_parallelism == 0)
+	{
+		json.get_error ().set ("max_request_parallelism must be greater than 0");
+	}
 
 	auto child_process_l (json.get_optional_child ("child_process"));
 	if (child_process_l)
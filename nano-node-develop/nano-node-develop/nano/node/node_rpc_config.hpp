@@ -33,6 +33,8 @@ public:
 	nano::error deserialize_toml (nano::tomlconfig & toml);
 
 	bool enable_sign_hash{ false };
+	/** Maximum number of worker threads a single multi-account request (such as accounts_balances) may use */
+	unsigned max_request_parallelism{ 4 };
 	nano::rpc_child_process_config child_process;
 	static unsigned json_version ()
 	{
@@ -80,7 +80,7 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	toml.put ("election_hint_weight_percent", election_hint_weight_percent, "Percentage of online weight to hint at starting an election. Defaults to 10.\ntype:uint32,[5,50]");
 	toml.put ("password_fanout", password_fanout, "Password fanout factor.\ntype:uint64");
 	toml.put ("io_threads", io_threads, "Number of threads dedicated to I/O operations. Defaults to the number of CPU threads, and at least 4.\ntype:uint64");
-	toml.put ("network_threads", network_threads, "Number of threads dedicated to processing network messages. Defaults to the number of CPU threads, and at least 4.\ntype:uint64");
+	toml.put ("network_threads", network_threads, "Number of threads dedicated to processing network messages. Defaults to the number of CPU threads, and at least 4.\nMessages received over TCP are processed in lanes per message type. Votes get this many threads, publish and confirm_req fewer.\ntype:uint64");
 	toml.put ("work_threads", work_threads, "Number of threads dedicated to CPU generated work. Defaults to all available CPU threads.\ntype:uint64");
 	toml.put ("signature_checker_threads", signature_checker_threads, "Number of additional threads dedicated to signature verification. Defaults to number of CPU threads / 2.\ntype:uint64");
 	toml.put ("enable_voting", enable_voting, "Enable or disable voting. Enabling this option requires additional system resources, namely increased CPU, bandwidth and disk usage.\ntype:bool");
@@ -99,15 +99,18 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	toml.put ("external_address", external_address, "The external address of this node (NAT). If not set, the node will request this information via UPnP.\ntype:string,ip");
 	toml.put ("external_port", external_port, "The external port number of this node (NAT). Only used if external_address is set.\ntype:uint16");
 	toml.put ("tcp_incoming_connections_max", tcp_incoming_connections_max, "Maximum number of incoming TCP connections.\ntype:uint64");
-	toml.put ("use_memory_pools", use_memory_pools, "If true, allocate memory from memory pools. Enabling this may improve performance. Memory is never released to the OS.\ntype:bool");
+	toml.put ("use_memory_pools", use_memory_pools, "If true, allocate memory from memory pools. Enabling this may improve performance. Each pool keeps a bounded number of freed objects for reuse and releases the rest.\ntype:bool");
 	toml.put ("confirmation_history_size", confirmation_history_size, "Maximum confirmation history size. If tracking the rate of block confirmations, the websocket feature is recommended instead.\ntype:uint64");
 	toml.put ("active_elections_size", active_elections_size, "Number of active elections. Elections beyond this limit have limited survival time.\nWarning: modifying this value may result in a lower confirmation rate.\ntype:uint64,[250..]");
 	toml.put ("bandwidth_limit", bandwidth_limit, "Outbound traffic limit in bytes/sec after which messages will be dropped.\nNote: changing to unlimited bandwidth (0) is not recommended for limited connections.\ntype:uint64");
 	toml.put ("bandwidth_limit_burst_ratio", bandwidth_limit_burst_ratio, "Burst ratio for outbound traffic shaping.\ntype:double");
+	toml.put ("bandwidth_limit_per_peer", bandwidth_limit_per_peer, "Outbound traffic limit to a single peer in bytes/sec, with the same burst ratio. Messages over it are dropped, rather than queued for the overall limit.\nThe overall limit is shared by votes, confirmation requests, publishes, bootstrap and telemetry in decreasing priority.\n0 for no per peer limit.\ntype:uint64");
 	toml.put ("conf_height_processor_batch_min_time", conf_height_processor_batch_min_time.count (), "Minimum write batching time when there are blocks pending confirmation height.\ntype:milliseconds");
 	toml.put ("backup_before_upgrade", backup_before_upgrade, "Backup the ledger database before performing upgrades.\nWarning: uses more disk storage and increases startup time when upgrading.\ntype:bool");
 	toml.put ("work_watcher_period", work_watcher_period.count (), "Time between checks for confirmation and re-generating higher difficulty work if unconfirmed, for blocks in the work watcher.\ntype:seconds");
 	toml.put ("max_work_generate_multiplier", max_work_generate_multiplier, "Maximum allowed difficulty multiplier for work generation.\ntype:double,[1..]");
+	toml.put ("work_precache_cpu_share", work_precache_cpu_share, "Maximum share of work generation time spent precomputing work for the next block of wallet accounts, in bursts of up to a minute. Measured as wall time per request, including time queued behind higher priority work. 0 disables precomputation.\ntype:double,[0..1]");
+	toml.put ("work_precache_delay", work_precache_delay.count (), "Time before precomputing work for wallet accounts which did not create other blocks recently. Recently active accounts start at once.\ntype:seconds");
 	toml.put ("frontiers_confirmation", serialize_frontiers_confirmation (frontiers_confirmation), "Mode controlling frontier confirmation rate.\ntype:string,{auto,always,disabled}");
 	toml.put ("max_queued_requests", max_queued_requests, "Limit for number of queued confirmation requests for one channel, after which new requests are dropped until the queue drops below this value.\ntype:uint32");
 	toml.put ("confirm_req_batches_max", confirm_req_batches_max, "Limit for the number of confirmation requests for one channel per request attempt\ntype:uint32");
@@ -117,6 +120,7 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	{
 		work_peers_l->push_back (boost::str (boost::format ("%1%:%2%") % i->first % i->second));
 	}
+	toml.put ("work_peer_hedging", work_peer_hedging, "Send work requests to one work peer at a time, those which responded fastest and most reliably first. The next peer is added when the previous one fails, or takes longer than it usually does to respond.\ntype:bool");
 
 	auto preconfigured_peers_l (toml.create_array ("preconfigured_peers", "A list of \"address\" (hostname or ip address) entries to identify preconfigured peers."));
 	for (auto i (preconfigured_peers.begin ()), n (preconfigured_peers.end ()); i != n; ++i)
@@ -155,6 +159,14 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	websocket_config.serialize_toml (websocket_l);
 	toml.put_child ("websocket", websocket_l);
 
+	nano::tomlconfig metrics_l;
+	metrics_config.serialize_toml (metrics_l);
+	toml.put_child ("metrics", metrics_l);
+
+	nano::tomlconfig threading_l;
+	threading.serialize_toml (threading_l);
+	toml.put_child ("threading", threading_l);
+
 	nano::tomlconfig ipc_l;
 	ipc_config.serialize_toml (ipc_l);
 	toml.put_child ("ipc", ipc_l);
@@ -202,6 +214,18 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 			websocket_config.deserialize_toml (websocket_config_l);
 		}
 
+		if (toml.has_key ("metrics"))
+		{
+			auto metrics_config_l (toml.get_required_child ("metrics"));
+			metrics_config.deserialize_toml (metrics_config_l);
+		}
+
+		if (toml.has_key ("threading"))
+		{
+			auto threading_l (toml.get_required_child ("threading"));
+			threading.deserialize_toml (threading_l);
+		}
+
 		if (toml.has_key ("ipc"))
 		{
 			auto ipc_config_l (toml.get_required_child ("ipc"));
@@ -233,6 +257,7 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 				this->deserialize_address (entry_a, this->work_peers);
 			});
 		}
+		toml.get<bool> ("work_peer_hedging", work_peer_hedging);
 
 		if (toml.has_key (preconfigured_peers_key))
 		{
@@ -359,6 +384,7 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 		toml.get<size_t> ("active_elections_size", active_elections_size);
 		toml.get<size_t> ("bandwidth_limit", bandwidth_limit);
 		toml.get<double> ("bandwidth_limit_burst_ratio", bandwidth_limit_burst_ratio);
+		toml.get<size_t> ("bandwidth_limit_per_peer", bandwidth_limit_per_peer);
 		toml.get<bool> ("backup_before_upgrade", backup_before_upgrade);
 
 		auto work_watcher_period_l = work_watcher_period.count ();
@@ -371,6 +397,11 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 
 		nano::network_constants network;
 		toml.get<double> ("max_work_generate_multiplier", max_work_generate_multiplier);
+		toml.get<double> ("work_precache_cpu_share", work_precache_cpu_share);
+
+		auto work_precache_delay_l (work_precache_delay.count ());
+		toml.get ("work_precache_delay", work_precache_delay_l);
+		work_precache_delay = std::chrono::seconds (work_precache_delay_l);
 
 		toml.get<uint32_t> ("max_queued_requests", max_queued_requests);
 		toml.get<uint32_t> ("confirm_req_batches_max", confirm_req_batches_max);
@@ -431,6 +462,10 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 		{
 			toml.get_error ().set ("max_work_generate_multiplier must be greater than or equal to 1");
 		}
+		if (work_precache_cpu_share < 0 || work_precache_cpu_share > 1)
+		{
+			toml.get_error ().set ("work_precache_cpu_share must be a number between 0 and 1");
+		}
 		if (frontiers_confirmation == nano::frontiers_confirmation_mode::invalid)
 		{
 			toml.get_error ().set ("frontiers_confirmation value is invalid (available: always, auto, disabled)");
@@ -10,6 +10,8 @@
 #include <nano/lib/stats.hpp>
 #include <nano/node/ipc/ipc_config.hpp>
 #include <nano/node/logging.hpp>
+#include <nano/node/metricsconfig.hpp>
+#include <nano/node/threadingconfig.hpp>
 #include <nano/node/websocketconfig.hpp>
 #include <nano/secure/common.hpp>
 
@@ -46,6 +48,8 @@ public:
 	uint16_t peering_port{ 0 };
 	nano::logging logging;
 	std::vector<std::pair<std::string, uint16_t>> work_peers;
+	/** Contact work peers one at a time, best scoring first, instead of all at once */
+	bool work_peer_hedging{ false };
 	std::vector<std::pair<std::string, uint16_t>> secondary_work_peers{ { "127.0.0.1", 8076 } }; /* Default of nano-pow-server */
 	std::vector<std::string> preconfigured_peers;
 	std::vector<nano::account> preconfigured_representatives;
@@ -67,6 +71,8 @@ public:
 	unsigned bootstrap_connections_max{ 64 };
 	unsigned bootstrap_initiator_threads{ 1 };
 	nano::websocket::config websocket_config;
+	nano::metrics_config metrics_config;
+	nano::threading_config threading;
 	nano::diagnostics_config diagnostics_config;
 	size_t confirmation_history_size{ 2048 };
 	std::string callback_address;
@@ -94,10 +100,16 @@ public:
 	size_t bandwidth_limit{ 10 * 1024 * 1024 };
 	/** By default, allow bursts of 15MB/s (not sustainable) */
 	double bandwidth_limit_burst_ratio{ 3. };
+	/** Outbound traffic to a single peer, 0 is only limited by bandwidth_limit */
+	size_t bandwidth_limit_per_peer{ 0 };
 	std::chrono::milliseconds conf_height_processor_batch_min_time{ 50 };
 	bool backup_before_upgrade{ false };
 	std::chrono::seconds work_watcher_period{ std::chrono::seconds (5) };
 	double max_work_generate_multiplier{ 64. };
+	/** Maximum share of the work pool spent precomputing work for wallet accounts, 0 disables precomputation */
+	double work_precache_cpu_share{ 0.5 };
+	/** Time before precomputing work for accounts without recent activity */
+	std::chrono::seconds work_precache_delay{ network_params.network.is_dev_network () ? std::chrono::seconds (1) : std::chrono::seconds (10) };
 	uint32_t max_queued_requests{ 512 };
 	/** Maximum amount of confirmation requests (batches) to be sent to each channel */
 	uint32_t confirm_req_batches_max{ network_params.network.is_dev_network () ? 1u : 2u };
@@ -157,5 +169,7 @@ public:
 	size_t inactive_votes_cache_size{ 16 * 1024 };
 	size_t vote_processor_capacity{ 144 * 1024 };
 	size_t bootstrap_interval{ 0 }; // For testing only
+	/** Path to record realtime messages to, for replay by nano_bench. Empty disables recording */
+	std::string record_message_trace;
 };
 }
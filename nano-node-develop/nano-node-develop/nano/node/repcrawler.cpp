@@ -143,11 +143,12 @@ void nano::rep_crawler::query (std::vector<std::shared_ptr<nano::transport::chan
 	{
 		node.active.erase_recently_confirmed (hash_root.first);
 	}
+	auto buffer (nano::confirm_req (hash_root.first, hash_root.second).to_shared_const_buffer ());
 	for (auto i (channels_a.begin ()), n (channels_a.end ()); i != n; ++i)
 	{
 		debug_assert (*i != nullptr);
 		on_rep_request (*i);
-		node.network.send_confirm_req (*i, hash_root);
+		(*i)->send (buffer, nano::message_type::confirm_req);
 	}
 
 	// A representative must respond with a vote within the deadline
@@ -76,21 +76,16 @@ void nano::socket::async_write (nano::shared_const_buffer const & buffer_a, std:
 		boost::asio::post (strand, boost::asio::bind_executor (strand, [buffer_a, callback_a, this_l = shared_from_this ()]() {
 			if (!this_l->closed)
 			{
-				this_l->start_timer ();
-				nano::async_write (this_l->tcp_socket, buffer_a,
-				boost::asio::bind_executor (this_l->strand,
-				[buffer_a, callback_a, this_l](boost::system::error_code ec, std::size_t size_a) {
-					--this_l->queue_size;
-					this_l->node.stats.add (nano::stat::type::traffic_tcp, nano::stat::dir::out, size_a);
-					this_l->stop_timer ();
-					if (callback_a)
-					{
-						callback_a (ec, size_a);
-					}
-				}));
+				this_l->send_queue.push_back ({ buffer_a, callback_a });
+				// Buffers queued while a write is in progress go out together with the next one
+				if (!this_l->writing)
+				{
+					this_l->write_queued ();
+				}
 			}
 			else
 			{
+				--this_l->queue_size;
 				if (callback_a)
 				{
 					callback_a (boost::system::errc::make_error_code (boost::system::errc::not_supported), 0);
@@ -106,6 +101,66 @@ void nano::socket::async_write (nano::shared_const_buffer const & buffer_a, std:
 	}
 }
 
+void nano::socket::write_queued ()
+{
+	debug_assert (!writing && !send_queue.empty ());
+	auto batch (std::make_shared<std::vector<queue_item>> ());
+	std::vector<boost::asio::const_buffer> buffers;
+	size_t bytes (0);
+	while (!send_queue.empty () && batch->size () < write_batch_size_max && (batch->empty () || bytes + send_queue.front ().buffer.size () <= write_batch_bytes_max))
+	{
+		auto & item (send_queue.front ());
+		bytes += item.buffer.size ();
+		buffers.push_back (*item.buffer.begin ());
+		batch->push_back (std::move (item));
+		send_queue.pop_front ();
+	}
+	writing = true;
+	start_timer ();
+	node.stats.inc (nano::stat::type::tcp, nano::stat::detail::tcp_write_batch, nano::stat::dir::out);
+	// The batch keeps the buffers alive until the write completes
+	nano::unsafe_async_write (tcp_socket, buffers,
+	boost::asio::bind_executor (strand,
+	[batch, this_l = shared_from_this ()](boost::system::error_code const & ec, size_t size_a) {
+		this_l->queue_size -= batch->size ();
+		this_l->node.stats.add (nano::stat::type::traffic_tcp, nano::stat::dir::out, size_a);
+		this_l->stop_timer ();
+		this_l->writing = false;
+		if (!this_l->send_queue.empty ())
+		{
+			if (!this_l->closed)
+			{
+				this_l->write_queued ();
+			}
+			else
+			{
+				this_l->fail_queued ();
+			}
+		}
+		for (auto & item : *batch)
+		{
+			if (item.callback)
+			{
+				item.callback (ec, ec ? 0 : item.buffer.size ());
+			}
+		}
+	}));
+}
+
+void nano::socket::fail_queued ()
+{
+	std::deque<queue_item> queue_l;
+	queue_l.swap (send_queue);
+	queue_size -= queue_l.size ();
+	for (auto & item : queue_l)
+	{
+		if (item.callback)
+		{
+			item.callback (boost::system::errc::make_error_code (boost::system::errc::not_supported), 0);
+		}
+	}
+}
+
 void nano::socket::start_timer ()
 {
 	start_timer (io_timeout.get ());
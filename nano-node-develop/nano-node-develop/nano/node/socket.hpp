@@ -69,6 +69,9 @@ protected:
 		nano::shared_const_buffer buffer;
 		std::function<void(boost::system::error_code const &, size_t)> callback;
 	};
+	/** Writes waiting for the one in progress, only accessed from the strand */
+	std::deque<queue_item> send_queue;
+	bool writing{ false };
 
 	boost::asio::strand<boost::asio::io_context::executor_type> strand;
 	boost::asio::ip::tcp::socket tcp_socket;
@@ -87,12 +90,19 @@ protected:
 	 error codes as the OS may have already completed the async operation. */
 	std::atomic<bool> closed{ false };
 	void close_internal ();
+	/** Writes queued buffers with a single gathering write, must be called from the strand */
+	void write_queued ();
+	/** Fails the callbacks of writes still queued once the socket is closed */
+	void fail_queued ();
 	void start_timer ();
 	void stop_timer ();
 	void checkup ();
 
 public:
 	static size_t constexpr queue_size_max = 128;
+	/** Limits of a gathering write. Asio passes at most 64 buffers to a single writev */
+	static size_t constexpr write_batch_size_max = 64;
+	static size_t constexpr write_batch_bytes_max = 64 * 1024;
 };
 
 /** Socket class for TCP servers */
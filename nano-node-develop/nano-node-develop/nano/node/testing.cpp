@@ -36,7 +36,8 @@ std::shared_ptr<nano::node> nano::system::add_node (nano::node_config const & no
 	node->wallets.create (nano::random_wallet_id ());
 	nodes.reserve (nodes.size () + 1);
 	nodes.push_back (node);
-	if (nodes.size () > 1)
+	// Simulated nodes are linked by their nano::transport::simulated::simulator instead
+	if (nodes.size () > 1 && type_a != nano::transport::transport_type::simulated)
 	{
 		debug_assert (nodes.size () - 1 <= node->network_params.node.max_peers_per_ip || node->flags.disable_max_peers_per_ip); // Check that we don't start more nodes than limit for single IP address
 		auto begin = nodes.end () - 2;
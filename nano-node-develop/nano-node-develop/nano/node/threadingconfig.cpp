@@ -0,0 +1,170 @@
+#include <nano/lib/tomlconfig.hpp>
+#include <nano/node/threadingconfig.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include <algorithm>
+
+nano::error nano::threading_config::serialize_toml (nano::tomlconfig & toml_a) const
+{
+	for (auto const & role : role_keys ())
+	{
+		auto existing (cpus.find (role.first));
+		auto cpus_l (existing != cpus.end () ? to_cpu_list (existing->second) : std::string ());
+		auto documentation_l (boost::str (boost::format ("CPUs the %1% threads run on, as ids and ranges such as \"0-3,8\". Empty to run on any CPU.\ntype:string") % nano::thread_role::get_string (role.first)));
+		toml_a.put (role.second, cpus_l, documentation_l.c_str ());
+	}
+	toml_a.put ("isolate_block_processing", isolate_block_processing, "Reserve the block_processing CPUs, which must be set, to the block processor and its database writes. No other thread runs on them.\ntype:bool");
+	return toml_a.get_error ();
+}
+
+nano::error nano::threading_config::deserialize_toml (nano::tomlconfig & toml_a)
+{
+	for (auto const & role : role_keys ())
+	{
+		auto existing (cpus.find (role.first));
+		auto cpus_l (existing != cpus.end () ? to_cpu_list (existing->second) : std::string ());
+		toml_a.get<std::string> (role.second, cpus_l);
+		std::vector<unsigned> parsed_l;
+		if (parse_cpu_list (cpus_l, parsed_l))
+		{
+			toml_a.get_error ().set (boost::str (boost::format ("%1% is not a valid CPU list") % role.second));
+		}
+		else if (parsed_l.empty ())
+		{
+			cpus.erase (role.first);
+		}
+		else
+		{
+			cpus[role.first] = parsed_l;
+		}
+	}
+	toml_a.get<bool> ("isolate_block_processing", isolate_block_processing);
+	if (isolate_block_processing && !toml_a.get_error ())
+	{
+		auto block_processing (cpus.find (nano::thread_role::name::block_processing));
+		if (block_processing == cpus.end ())
+		{
+			toml_a.get_error ().set ("isolate_block_processing requires block_processing CPUs");
+		}
+		else
+		{
+			for (auto const & role : cpus)
+			{
+				if (role.first != nano::thread_role::name::block_processing && std::find_first_of (role.second.begin (), role.second.end (), block_processing->second.begin (), block_processing->second.end ()) != role.second.end ())
+				{
+					toml_a.get_error ().set (boost::str (boost::format ("%1% CPUs overlap the isolated block_processing CPUs") % role_keys ().at (role.first)));
+				}
+			}
+		}
+	}
+	return toml_a.get_error ();
+}
+
+void nano::threading_config::apply () const
+{
+	std::vector<unsigned> isolated;
+	auto block_processing (cpus.find (nano::thread_role::name::block_processing));
+	if (isolate_block_processing && block_processing != cpus.end ())
+	{
+		isolated = block_processing->second;
+	}
+	nano::thread_role::set_cpus (cpus, isolated);
+}
+
+bool nano::threading_config::parse_cpu_list (std::string const & list_a, std::vector<unsigned> & cpus_a)
+{
+	auto error (false);
+	cpus_a.clear ();
+	auto parse_cpu = [&error](std::string const & cpu_a) {
+		unsigned long result (0);
+		if (cpu_a.empty () || cpu_a.size () > 4 || !std::all_of (cpu_a.begin (), cpu_a.end (), [](char c) { return c >= '0' && c <= '9'; }))
+		{
+			error = true;
+		}
+		else
+		{
+			result = std::stoul (cpu_a);
+		}
+		return static_cast<unsigned> (result);
+	};
+	auto list_l (boost::algorithm::erase_all_copy (list_a, " "));
+	if (!list_l.empty ())
+	{
+		std::vector<std::string> items;
+		boost::algorithm::split (items, list_l, boost::algorithm::is_any_of (","));
+		for (auto i (items.begin ()), n (items.end ()); i != n && !error; ++i)
+		{
+			auto dash (i->find ('-'));
+			if (dash == std::string::npos)
+			{
+				cpus_a.push_back (parse_cpu (*i));
+			}
+			else
+			{
+				auto first (parse_cpu (i->substr (0, dash)));
+				auto last (parse_cpu (i->substr (dash + 1)));
+				error = error || first > last;
+				for (auto cpu (first); !error && cpu <= last; ++cpu)
+				{
+					cpus_a.push_back (cpu);
+				}
+			}
+		}
+	}
+	std::sort (cpus_a.begin (), cpus_a.end ());
+	cpus_a.erase (std::unique (cpus_a.begin (), cpus_a.end ()), cpus_a.end ());
+	return error;
+}
+
+std::string nano::threading_config::to_cpu_list (std::vector<unsigned> const & cpus_a)
+{
+	std::string result;
+	for (auto i (cpus_a.begin ()), n (cpus_a.end ()); i != n;)
+	{
+		auto last (i);
+		while (std::next (last) != n && *std::next (last) == *last + 1)
+		{
+			++last;
+		}
+		result += (result.empty () ? "" : ",") + std::to_string (*i);
+		if (last != i)
+		{
+			result += "-" + std::to_string (*last);
+		}
+		i = std::next (last);
+	}
+	return result;
+}
+
+std::map<nano::thread_role::name, std::string> const & nano::threading_config::role_keys ()
+{
+	static std::map<nano::thread_role::name, std::string> const keys{
+		{ nano::thread_role::name::io, "io" },
+		{ nano::thread_role::name::work, "work" },
+		{ nano::thread_role::name::packet_processing, "packet_processing" },
+		{ nano::thread_role::name::vote_processing, "vote_processing" },
+		{ nano::thread_role::name::block_processing, "block_processing" },
+		{ nano::thread_role::name::request_loop, "request_loop" },
+		{ nano::thread_role::name::wallet_actions, "wallet_actions" },
+		{ nano::thread_role::name::bootstrap_initiator, "bootstrap_initiator" },
+		{ nano::thread_role::name::bootstrap_connections, "bootstrap_connections" },
+		{ nano::thread_role::name::voting, "voting" },
+		{ nano::thread_role::name::signature_checking, "signature_checking" },
+		{ nano::thread_role::name::rpc_request_processor, "rpc_request_processor" },
+		{ nano::thread_role::name::rpc_process_container, "rpc_process_container" },
+		{ nano::thread_role::name::work_watcher, "work_watcher" },
+		{ nano::thread_role::name::confirmation_height_processing, "confirmation_height_processing" },
+		{ nano::thread_role::name::worker, "worker" },
+		{ nano::thread_role::name::request_aggregator, "request_aggregator" },
+		{ nano::thread_role::name::state_block_signature_verification, "state_block_signature_verification" },
+		{ nano::thread_role::name::epoch_upgrader, "epoch_upgrader" },
+		{ nano::thread_role::name::db_parallel_traversal, "db_parallel_traversal" },
+		{ nano::thread_role::name::ipc_shared_memory, "ipc_shared_memory" },
+		{ nano::thread_role::name::work_precache, "work_precache" },
+		{ nano::thread_role::name::log_writer, "log_writer" },
+		{ nano::thread_role::name::traffic_shaping, "traffic_shaping" }
+	};
+	return keys;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <nano/lib/errors.hpp>
+#include <nano/lib/threading.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace nano
+{
+class tomlconfig;
+
+/** Placement of the node's threads on CPUs, by thread role */
+class threading_config final
+{
+public:
+	nano::error serialize_toml (nano::tomlconfig &) const;
+	nano::error deserialize_toml (nano::tomlconfig &);
+	/**
+	 * Pins the threads of the process as configured, resetting them to all CPUs if none are configured.
+	 * Affinity is process wide, so this is called once by the entry point rather than by each node
+	 */
+	void apply () const;
+
+	/** CPUs of the roles which are pinned, other roles may use any CPU */
+	std::map<nano::thread_role::name, std::vector<unsigned>> cpus;
+	/** Keeps all other threads off the CPUs of block processing, which also holds the database write transaction */
+	bool isolate_block_processing{ false };
+
+	/** Parses a list of CPU ids and ranges such as "0-3,8", \p cpus_a is sorted. @return true on error */
+	static bool parse_cpu_list (std::string const &, std::vector<unsigned> & cpus_a);
+	/** Formats \p cpus_a as parsed by parse_cpu_list, consecutive CPUs are joined into ranges */
+	static std::string to_cpu_list (std::vector<unsigned> const & cpus_a);
+	/** Key of each configurable role in the [node.threading] section */
+	static std::map<nano::thread_role::name, std::string> const & role_keys ();
+};
+}
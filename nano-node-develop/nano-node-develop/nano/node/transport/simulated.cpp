@@ -0,0 +1,365 @@
+#include <nano/crypto_lib/random_pool.hpp>
+#include <nano/node/node.hpp>
+#include <nano/node/transport/simulated.hpp>
+
+#include <boost/format.hpp>
+
+namespace
+{
+uint8_t const * buffer_data (nano::shared_const_buffer const & buffer_a)
+{
+	return static_cast<uint8_t const *> (buffer_a.begin ()->data ());
+}
+
+nano::message_type buffer_type (nano::shared_const_buffer const & buffer_a)
+{
+	nano::bufferstream stream (buffer_data (buffer_a), buffer_a.size ());
+	auto error (false);
+	nano::message_header header (error, stream);
+	return error ? nano::message_type::invalid : header.type;
+}
+}
+
+nano::transport::simulated::channel::channel (nano::node & node_a, nano::transport::simulated::simulator & simulator_a, size_t source_a, size_t destination_a, nano::endpoint const & endpoint_a) :
+nano::transport::channel (node_a),
+simulator (simulator_a),
+source (source_a),
+destination (destination_a),
+endpoint (endpoint_a)
+{
+	set_node_id (simulator_a.node (destination_a).node_id.pub);
+	set_network_version (node_a.network_params.protocol.protocol_version);
+}
+
+size_t nano::transport::simulated::channel::hash_code () const
+{
+	std::hash<::nano::endpoint> hash;
+	return hash (endpoint);
+}
+
+bool nano::transport::simulated::channel::operator== (nano::transport::channel const & other_a) const
+{
+	return other_a.get_type () == nano::transport::transport_type::simulated && endpoint == other_a.get_endpoint ();
+}
+
+void nano::transport::simulated::channel::send_buffer (nano::shared_const_buffer const & buffer_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::buffer_drop_policy)
+{
+	set_last_packet_sent (std::chrono::steady_clock::now ());
+	simulator.send (source, destination, buffer_a);
+	if (callback_a)
+	{
+		auto size (buffer_a.size ());
+		node.background ([callback_a, size]() {
+			callback_a (boost::system::errc::make_error_code (boost::system::errc::success), size);
+		});
+	}
+}
+
+std::string nano::transport::simulated::channel::to_string () const
+{
+	return boost::str (boost::format ("%1%") % endpoint);
+}
+
+void nano::transport::simulated::channels::insert (std::shared_ptr<nano::transport::simulated::channel> const & channel_a)
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	entries.push_back (channel_a);
+}
+
+void nano::transport::simulated::channels::erase (nano::endpoint const & endpoint_a)
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	entries.erase (std::remove_if (entries.begin (), entries.end (), [&endpoint_a](auto const & channel_a) { return channel_a->get_endpoint () == endpoint_a; }), entries.end ());
+}
+
+void nano::transport::simulated::channels::clear ()
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	entries.clear ();
+}
+
+size_t nano::transport::simulated::channels::size () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return entries.size ();
+}
+
+void nano::transport::simulated::channels::list (std::deque<std::shared_ptr<nano::transport::channel>> & deque_a, uint8_t minimum_version_a) const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	for (auto const & channel : entries)
+	{
+		if (channel->get_network_version () >= minimum_version_a)
+		{
+			deque_a.push_back (channel);
+		}
+	}
+}
+
+std::unordered_set<std::shared_ptr<nano::transport::channel>> nano::transport::simulated::channels::random_set (size_t count_a, uint8_t minimum_version_a) const
+{
+	std::unordered_set<std::shared_ptr<nano::transport::channel>> result;
+	nano::lock_guard<nano::mutex> lock (mutex);
+	// Stop trying to fill result with random samples after this many attempts
+	auto random_cutoff (count_a * 2);
+	for (auto i (0u); i < random_cutoff && result.size () < count_a && !entries.empty (); ++i)
+	{
+		auto const & channel (entries[nano::random_pool::generate_word32 (0, static_cast<uint32_t> (entries.size () - 1))]);
+		if (channel->get_network_version () >= minimum_version_a)
+		{
+			result.insert (channel);
+		}
+	}
+	return result;
+}
+
+std::shared_ptr<nano::transport::channel> nano::transport::simulated::channels::find_channel (nano::endpoint const & endpoint_a) const
+{
+	std::shared_ptr<nano::transport::channel> result;
+	nano::lock_guard<nano::mutex> lock (mutex);
+	auto existing (std::find_if (entries.begin (), entries.end (), [&endpoint_a](auto const & channel_a) { return channel_a->get_endpoint () == endpoint_a; }));
+	if (existing != entries.end ())
+	{
+		result = *existing;
+	}
+	return result;
+}
+
+std::shared_ptr<nano::transport::channel> nano::transport::simulated::channels::find_node_id (nano::account const & node_id_a) const
+{
+	std::shared_ptr<nano::transport::channel> result;
+	nano::lock_guard<nano::mutex> lock (mutex);
+	auto existing (std::find_if (entries.begin (), entries.end (), [&node_id_a](auto const & channel_a) { return channel_a->get_node_id () == node_id_a; }));
+	if (existing != entries.end ())
+	{
+		result = *existing;
+	}
+	return result;
+}
+
+nano::transport::simulated::simulator::simulator (uint64_t seed_a) :
+seed (seed_a)
+{
+}
+
+size_t nano::transport::simulated::simulator::add (nano::node & node_a)
+{
+	debug_assert (node_a.flags.disable_tcp_realtime && node_a.flags.disable_udp);
+	nano::lock_guard<nano::mutex> lock (mutex);
+	nodes.push_back (node_a);
+	links.emplace_back ();
+	return nodes.size () - 1;
+}
+
+void nano::transport::simulated::simulator::connect (size_t first_a, size_t second_a, nano::transport::simulated::link const & link_a)
+{
+	debug_assert (first_a != second_a);
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		links[first_a][second_a] = make_link (first_a, second_a, link_a);
+		links[second_a][first_a] = make_link (second_a, first_a, link_a);
+	}
+	node (first_a).network.simulated_channels.insert (std::make_shared<nano::transport::simulated::channel> (node (first_a), *this, first_a, second_a, endpoint (second_a)));
+	node (second_a).network.simulated_channels.insert (std::make_shared<nano::transport::simulated::channel> (node (second_a), *this, second_a, first_a, endpoint (first_a)));
+}
+
+nano::transport::simulated::simulator::link_state nano::transport::simulated::simulator::make_link (size_t source_a, size_t destination_a, nano::transport::simulated::link const & link_a) const
+{
+	link_state result;
+	result.properties = link_a;
+	// seed_seq mixes its inputs the same way on every platform
+	std::seed_seq seed_l{ static_cast<uint32_t> (seed), static_cast<uint32_t> (seed >> 32), static_cast<uint32_t> (source_a), static_cast<uint32_t> (destination_a) };
+	result.random.seed (seed_l);
+	return result;
+}
+
+void nano::transport::simulated::simulator::send (size_t source_a, size_t destination_a, nano::shared_const_buffer const & buffer_a)
+{
+	auto type (buffer_type (buffer_a));
+	nano::lock_guard<nano::mutex> lock (mutex);
+	auto & counters (traffic[static_cast<size_t> (type)]);
+	++counters.sent;
+	counters.bytes += buffer_a.size ();
+	++sequence;
+	auto existing (links[source_a].find (destination_a));
+	debug_assert (existing != links[source_a].end ());
+	if (existing != links[source_a].end ())
+	{
+		auto & link_l (existing->second);
+		// Messages queue up behind those still being transmitted
+		auto departure (std::max (clock, link_l.busy_until));
+		std::chrono::microseconds transmission (0);
+		if (link_l.properties.bandwidth != 0)
+		{
+			transmission = std::chrono::microseconds (buffer_a.size () * 1000000 / link_l.properties.bandwidth);
+		}
+		link_l.busy_until = departure + transmission;
+		std::chrono::microseconds jitter (0);
+		if (link_l.properties.jitter.count () > 0)
+		{
+			jitter = std::chrono::microseconds (std::uniform_int_distribution<int64_t> (0, link_l.properties.jitter.count ()) (link_l.random));
+		}
+		if (std::uniform_real_distribution<double> (0.0, 1.0) (link_l.random) < link_l.properties.loss)
+		{
+			++counters.lost;
+		}
+		else
+		{
+			arrivals.push ({ link_l.busy_until + link_l.properties.latency + jitter, sequence, source_a, destination_a, buffer_a });
+		}
+	}
+}
+
+bool nano::transport::simulated::simulator::step (std::chrono::microseconds until_a, std::chrono::microseconds resolution_a)
+{
+	std::vector<arrival> due;
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		if (!arrivals.empty () && arrivals.top ().time <= until_a)
+		{
+			auto end (std::max (clock, arrivals.top ().time) + resolution_a);
+			while (!arrivals.empty () && arrivals.top ().time <= end)
+			{
+				due.push_back (arrivals.top ());
+				arrivals.pop ();
+			}
+			clock = std::max (clock, due.back ().time);
+		}
+		else
+		{
+			clock = std::max (clock, until_a);
+		}
+	}
+	for (auto const & arrival_l : due)
+	{
+		deliver (arrival_l);
+	}
+	return !due.empty ();
+}
+
+namespace
+{
+class simulated_message_visitor final : public nano::message_visitor
+{
+public:
+	simulated_message_visitor (nano::node & node_a, std::shared_ptr<nano::transport::channel> const & channel_a) :
+	node (node_a),
+	channel (channel_a)
+	{
+	}
+	void keepalive (nano::keepalive const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void publish (nano::publish const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void confirm_req (nano::confirm_req const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void confirm_ack (nano::confirm_ack const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void bulk_pull (nano::bulk_pull const &) override
+	{
+		debug_assert (false);
+	}
+	void bulk_pull_account (nano::bulk_pull_account const &) override
+	{
+		debug_assert (false);
+	}
+	void bulk_push (nano::bulk_push const &) override
+	{
+		debug_assert (false);
+	}
+	void frontier_req (nano::frontier_req const &) override
+	{
+		debug_assert (false);
+	}
+	void node_id_handshake (nano::node_id_handshake const &) override
+	{
+		// Simulated channels know the node id of their peer from the start
+	}
+	void telemetry_req (nano::telemetry_req const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	void telemetry_ack (nano::telemetry_ack const & message_a) override
+	{
+		node.network.process_message (message_a, channel);
+	}
+	nano::node & node;
+	std::shared_ptr<nano::transport::channel> channel;
+};
+}
+
+void nano::transport::simulated::simulator::deliver (arrival const & arrival_a)
+{
+	auto & destination (node (arrival_a.destination));
+	auto channel_l (destination.network.simulated_channels.find_channel (endpoint (arrival_a.source)));
+	if (channel_l != nullptr && !destination.stopped)
+	{
+		channel_l->set_last_packet_received (std::chrono::steady_clock::now ());
+		simulated_message_visitor visitor (destination, channel_l);
+		nano::message_parser parser (destination.network.publish_filter, destination.block_uniquer, destination.vote_uniquer, visitor, destination.work);
+		parser.deserialize_buffer (buffer_data (arrival_a.buffer), arrival_a.buffer.size ());
+		if (parser.status == nano::message_parser::parse_status::duplicate_publish_message)
+		{
+			destination.stats.inc (nano::stat::type::filter, nano::stat::detail::duplicate_publish);
+		}
+	}
+	auto type (buffer_type (arrival_a.buffer));
+	nano::lock_guard<nano::mutex> lock (mutex);
+	++traffic[static_cast<size_t> (type)].delivered;
+}
+
+std::chrono::microseconds nano::transport::simulated::simulator::now () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return clock;
+}
+
+size_t nano::transport::simulated::simulator::in_flight () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return arrivals.size ();
+}
+
+uint64_t nano::transport::simulated::simulator::sends () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return sequence;
+}
+
+std::array<nano::transport::simulated::traffic, static_cast<size_t> (nano::message_type::telemetry_ack) + 1> nano::transport::simulated::simulator::traffic_by_type () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return traffic;
+}
+
+nano::endpoint nano::transport::simulated::simulator::endpoint (size_t index_a) const
+{
+	// Unique local addresses, which no real peer has
+	boost::asio::ip::address_v6::bytes_type bytes{};
+	bytes[0] = 0xfd;
+	bytes[12] = static_cast<uint8_t> (index_a >> 24);
+	bytes[13] = static_cast<uint8_t> (index_a >> 16);
+	bytes[14] = static_cast<uint8_t> (index_a >> 8);
+	bytes[15] = static_cast<uint8_t> (index_a);
+	return nano::endpoint (boost::asio::ip::address_v6 (bytes), 7075);
+}
+
+nano::node & nano::transport::simulated::simulator::node (size_t index_a) const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return nodes[index_a];
+}
+
+size_t nano::transport::simulated::simulator::size () const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return nodes.size ();
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <nano/node/common.hpp>
+#include <nano/node/transport/transport.hpp>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace nano
+{
+class node;
+namespace transport
+{
+	/**
+	 * In-process links between nodes, for network simulations. Messages are delivered by a discrete-event scheduler on
+	 * a virtual clock, after the latency, transmission time and loss of their link.
+	 */
+	namespace simulated
+	{
+		class simulator;
+
+		/** Properties of one direction of a link */
+		class link final
+		{
+		public:
+			std::chrono::microseconds latency{ 0 };
+			/** Up to this much latency is added to each message, uniformly distributed */
+			std::chrono::microseconds jitter{ 0 };
+			/** Bytes per second, 0 is unlimited */
+			uint64_t bandwidth{ 0 };
+			/** Probability of a message being lost */
+			double loss{ 0.0 };
+		};
+
+		class channel final : public nano::transport::channel
+		{
+		public:
+			/** Channel of \p node_a to the node \p destination_a of \p simulator_a, which has \p endpoint_a */
+			channel (nano::node & node_a, nano::transport::simulated::simulator & simulator_a, size_t source_a, size_t destination_a, nano::endpoint const & endpoint_a);
+			size_t hash_code () const override;
+			bool operator== (nano::transport::channel const &) const override;
+			void send_buffer (nano::shared_const_buffer const &, std::function<void(boost::system::error_code const &, size_t)> const & = nullptr, nano::buffer_drop_policy = nano::buffer_drop_policy::limiter) override;
+			std::string to_string () const override;
+
+			nano::endpoint get_endpoint () const override
+			{
+				return endpoint;
+			}
+
+			nano::tcp_endpoint get_tcp_endpoint () const override
+			{
+				return nano::transport::map_endpoint_to_tcp (endpoint);
+			}
+
+			nano::transport::transport_type get_type () const override
+			{
+				return nano::transport::transport_type::simulated;
+			}
+
+		private:
+			nano::transport::simulated::simulator & simulator;
+			size_t const source;
+			size_t const destination;
+			nano::endpoint const endpoint;
+		};
+
+		/** Simulated channels of a node, consulted by nano::network along with its TCP and UDP channels */
+		class channels final
+		{
+		public:
+			void insert (std::shared_ptr<nano::transport::simulated::channel> const &);
+			void erase (nano::endpoint const &);
+			void clear ();
+			size_t size () const;
+			void list (std::deque<std::shared_ptr<nano::transport::channel>> &, uint8_t = 0) const;
+			std::unordered_set<std::shared_ptr<nano::transport::channel>> random_set (size_t, uint8_t = 0) const;
+			std::shared_ptr<nano::transport::channel> find_channel (nano::endpoint const &) const;
+			std::shared_ptr<nano::transport::channel> find_node_id (nano::account const &) const;
+
+		private:
+			mutable nano::mutex mutex;
+			std::vector<std::shared_ptr<nano::transport::simulated::channel>> entries;
+		};
+
+		/** Counters of the messages of one type sent over all links */
+		class traffic final
+		{
+		public:
+			uint64_t sent{ 0 };
+			uint64_t bytes{ 0 };
+			uint64_t lost{ 0 };
+			uint64_t delivered{ 0 };
+		};
+
+		/**
+		 * Links nodes and delivers their messages in order of virtual arrival time. The virtual clock only moves when
+		 * step is called, so the time nodes take to process messages doesn't count, only the modelled network does.
+		 * Each direction of a link draws loss and jitter from its own generator, seeded from the scenario seed and the
+		 * indices of its nodes, so the n-th message on a link meets the same fate whatever happens on other links.
+		 * Runs are only repeatable as far as nodes send the same messages in the same order though: node timers, such as
+		 * those of elections and request aggregation, still run on the real clock and node threads are scheduled by the
+		 * operating system.
+		 */
+		class simulator final
+		{
+		public:
+			explicit simulator (uint64_t seed_a);
+			/** Adds \p node_a, which must have been started with TCP and UDP disabled. @return its index */
+			size_t add (nano::node & node_a);
+			/** Links two nodes in both directions, each node gets a channel to the other */
+			void connect (size_t, size_t, nano::transport::simulated::link const &);
+			/** Queues \p buffer_a from \p source_a to \p destination_a, it arrives once the link has carried it or is lost */
+			void send (size_t source_a, size_t destination_a, nano::shared_const_buffer const & buffer_a);
+			/**
+			 * Moves the clock to the next arrival, if it is before \p until_a, and delivers all messages arriving up to
+			 * \p resolution_a later. Otherwise the clock moves to \p until_a. @return true if messages were delivered
+			 */
+			bool step (std::chrono::microseconds until_a, std::chrono::microseconds resolution_a = std::chrono::microseconds (1000));
+			std::chrono::microseconds now () const;
+			/** Messages sent and not yet delivered or lost */
+			size_t in_flight () const;
+			/** Number of messages sent so far, to tell when nodes have stopped sending */
+			uint64_t sends () const;
+			std::array<nano::transport::simulated::traffic, static_cast<size_t> (nano::message_type::telemetry_ack) + 1> traffic_by_type () const;
+			nano::endpoint endpoint (size_t) const;
+			nano::node & node (size_t) const;
+			size_t size () const;
+
+		private:
+			class arrival final
+			{
+			public:
+				std::chrono::microseconds time;
+				/** Order of sending, breaks ties between messages arriving at the same time */
+				uint64_t sequence;
+				size_t source;
+				size_t destination;
+				nano::shared_const_buffer buffer;
+				bool operator> (arrival const & other_a) const
+				{
+					return time > other_a.time || (time == other_a.time && sequence > other_a.sequence);
+				}
+			};
+			class link_state final
+			{
+			public:
+				nano::transport::simulated::link properties;
+				/** When the link finishes transmitting the messages queued on it */
+				std::chrono::microseconds busy_until{ 0 };
+				/** Draws the loss and jitter of each message in the order they are sent on this link */
+				std::mt19937_64 random;
+			};
+			void deliver (arrival const &);
+			/** The state of a new link from \p source_a to \p destination_a, with its generator seeded for that direction */
+			link_state make_link (size_t source_a, size_t destination_a, nano::transport::simulated::link const &) const;
+			uint64_t const seed;
+			mutable nano::mutex mutex;
+			std::chrono::microseconds clock{ 0 };
+			uint64_t sequence{ 0 };
+			std::priority_queue<arrival, std::vector<arrival>, std::greater<arrival>> arrivals;
+			std::vector<std::reference_wrapper<nano::node>> nodes;
+			/** Links by source and destination index */
+			std::vector<std::unordered_map<size_t, link_state>> links;
+			std::array<nano::transport::simulated::traffic, static_cast<size_t> (nano::message_type::telemetry_ack) + 1> traffic;
+		};
+	}
+}
+}
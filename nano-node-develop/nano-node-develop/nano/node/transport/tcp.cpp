@@ -276,11 +276,11 @@ nano::tcp_endpoint nano::transport::tcp_channels::bootstrap_peer (uint8_t connec
 	return result;
 }
 
-void nano::transport::tcp_channels::process_messages ()
+void nano::transport::tcp_channels::process_messages (nano::tcp_message_lane lane_a)
 {
 	while (!stopped)
 	{
-		auto item (node.network.tcp_message_manager.get_message ());
+		auto item (node.network.tcp_message_manager.get_message (lane_a));
 		if (item.message != nullptr)
 		{
 			process_message (*item.message, item.endpoint, item.node_id, item.socket, item.type);
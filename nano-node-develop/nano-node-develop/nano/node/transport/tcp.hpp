@@ -18,6 +18,7 @@ namespace nano
 {
 class bootstrap_server;
 enum class bootstrap_server_type;
+enum class tcp_message_lane : uint8_t;
 class tcp_message_item final
 {
 public:
@@ -92,7 +93,7 @@ namespace transport
 		void receive ();
 		void start ();
 		void stop ();
-		void process_messages ();
+		void process_messages (nano::tcp_message_lane);
 		void process_message (nano::message const &, nano::tcp_endpoint const &, nano::account const &, std::shared_ptr<nano::socket> const &, nano::bootstrap_server_type);
 		bool max_ip_connections (nano::tcp_endpoint const &);
 		// Should we reach out to this endpoint with a keepalive message
@@ -0,0 +1,295 @@
+#include <nano/lib/threading.hpp>
+#include <nano/node/node.hpp>
+#include <nano/node/transport/traffic_shaper.hpp>
+
+#include <boost/format.hpp>
+
+nano::transport::traffic_type nano::transport::to_traffic_type (nano::message_type type_a)
+{
+	nano::transport::traffic_type result (nano::transport::traffic_type::generic);
+	switch (type_a)
+	{
+		case nano::message_type::confirm_ack:
+			result = nano::transport::traffic_type::vote;
+			break;
+		case nano::message_type::confirm_req:
+			result = nano::transport::traffic_type::confirm_req;
+			break;
+		case nano::message_type::publish:
+			result = nano::transport::traffic_type::publish;
+			break;
+		case nano::message_type::bulk_pull:
+		case nano::message_type::bulk_pull_account:
+		case nano::message_type::bulk_push:
+		case nano::message_type::frontier_req:
+			result = nano::transport::traffic_type::bootstrap;
+			break;
+		case nano::message_type::telemetry_req:
+		case nano::message_type::telemetry_ack:
+			result = nano::transport::traffic_type::telemetry;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+std::string nano::transport::to_string (nano::transport::traffic_type type_a)
+{
+	std::string result;
+	switch (type_a)
+	{
+		case nano::transport::traffic_type::vote:
+			result = "vote";
+			break;
+		case nano::transport::traffic_type::confirm_req:
+			result = "confirm_req";
+			break;
+		case nano::transport::traffic_type::publish:
+			result = "publish";
+			break;
+		case nano::transport::traffic_type::bootstrap:
+			result = "bootstrap";
+			break;
+		case nano::transport::traffic_type::telemetry:
+			result = "telemetry";
+			break;
+		case nano::transport::traffic_type::generic:
+			result = "generic";
+			break;
+		case nano::transport::traffic_type::_last:
+			debug_assert (false);
+			break;
+	}
+	return result;
+}
+
+nano::stat::detail nano::transport::to_stat_detail (nano::transport::traffic_type type_a)
+{
+	nano::stat::detail result (nano::stat::detail::all);
+	switch (type_a)
+	{
+		case nano::transport::traffic_type::vote:
+			result = nano::stat::detail::vote;
+			break;
+		case nano::transport::traffic_type::confirm_req:
+			result = nano::stat::detail::confirm_req;
+			break;
+		case nano::transport::traffic_type::publish:
+			result = nano::stat::detail::publish;
+			break;
+		case nano::transport::traffic_type::bootstrap:
+			result = nano::stat::detail::bootstrap;
+			break;
+		case nano::transport::traffic_type::telemetry:
+			result = nano::stat::detail::telemetry;
+			break;
+		case nano::transport::traffic_type::generic:
+			result = nano::stat::detail::generic;
+			break;
+		case nano::transport::traffic_type::_last:
+			debug_assert (false);
+			break;
+	}
+	return result;
+}
+
+unsigned nano::transport::traffic_shaper::weight (nano::transport::traffic_type type_a)
+{
+	unsigned result (1);
+	switch (type_a)
+	{
+		case nano::transport::traffic_type::vote:
+			result = 8;
+			break;
+		case nano::transport::traffic_type::confirm_req:
+			result = 4;
+			break;
+		case nano::transport::traffic_type::telemetry:
+		case nano::transport::traffic_type::generic:
+			result = 2;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+size_t constexpr nano::transport::traffic_shaper::quantum;
+
+nano::transport::traffic_shaper::traffic_shaper (nano::node & node_a) :
+node (node_a),
+bucket (static_cast<size_t> (node_a.config.bandwidth_limit * node_a.config.bandwidth_limit_burst_ratio), node_a.config.bandwidth_limit),
+max_queue_bytes (node_a.config.bandwidth_limit),
+thread ([this]() {
+	nano::thread_role::set (nano::thread_role::name::traffic_shaping);
+	run ();
+})
+{
+}
+
+nano::transport::traffic_shaper::~traffic_shaper ()
+{
+	stop ();
+}
+
+void nano::transport::traffic_shaper::stop ()
+{
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		stopped = true;
+	}
+	condition.notify_all ();
+	if (thread.joinable ())
+	{
+		thread.join ();
+	}
+}
+
+bool nano::transport::traffic_shaper::send (nano::transport::channel & channel_a, nano::transport::traffic_type type_a, nano::shared_const_buffer const & buffer_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::stat::detail detail_a)
+{
+	auto size (buffer_a.size ());
+	auto drop (!channel_a.limiter.try_consume (nano::narrow_cast<unsigned> (size)));
+	auto send_now (false);
+	if (!drop)
+	{
+		nano::unique_lock<nano::mutex> lock (mutex);
+		if (queued == 0 && bucket.try_consume (nano::narrow_cast<unsigned> (size)))
+		{
+			send_now = true;
+		}
+		else
+		{
+			auto & class_l (classes[static_cast<size_t> (type_a)]);
+			// A channel not owned by a shared_ptr can't wait, as it may be gone when its turn comes
+			auto channel_l (channel_a.weak_from_this ());
+			if (!stopped && !channel_l.expired () && class_l.bytes + size <= max_queue_bytes)
+			{
+				class_l.queue.push_back ({ channel_l, buffer_a, callback_a, detail_a });
+				class_l.bytes += size;
+				++queued;
+				lock.unlock ();
+				condition.notify_all ();
+				node.stats.inc (nano::stat::type::traffic_shaper_queue, nano::transport::to_stat_detail (type_a), nano::stat::dir::out);
+			}
+			else
+			{
+				drop = true;
+			}
+		}
+	}
+	if (send_now)
+	{
+		channel_a.send_buffer (buffer_a, callback_a, nano::buffer_drop_policy::limiter);
+		node.stats.inc (nano::stat::type::message, detail_a, nano::stat::dir::out);
+	}
+	else if (drop)
+	{
+		dropped (type_a, size, callback_a, detail_a);
+	}
+	return drop;
+}
+
+void nano::transport::traffic_shaper::dropped (nano::transport::traffic_type type_a, size_t size_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::stat::detail detail_a)
+{
+	if (callback_a)
+	{
+		node.background ([callback_a]() {
+			callback_a (boost::system::errc::make_error_code (boost::system::errc::not_supported), 0);
+		});
+	}
+	node.stats.inc (nano::stat::type::drop, detail_a, nano::stat::dir::out);
+	node.stats.inc (nano::stat::type::traffic_shaper_drop, nano::transport::to_stat_detail (type_a), nano::stat::dir::out);
+	if (node.config.logging.network_packet_logging ())
+	{
+		auto key = static_cast<uint8_t> (detail_a) << 8;
+		node.logger.always_log (boost::str (boost::format ("%1% of size %2% dropped") % node.stats.detail_to_string (key) % size_a));
+	}
+}
+
+size_t nano::transport::traffic_shaper::size (nano::transport::traffic_type type_a) const
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return classes[static_cast<size_t> (type_a)].queue.size ();
+}
+
+void nano::transport::traffic_shaper::run ()
+{
+	nano::unique_lock<nano::mutex> lock (mutex);
+	while (!stopped)
+	{
+		if (queued == 0)
+		{
+			condition.wait (lock);
+			continue;
+		}
+		auto & class_l (classes[current]);
+		if (class_l.queue.empty ())
+		{
+			// An idle class doesn't accumulate credit
+			class_l.deficit = 0;
+		}
+		else
+		{
+			if (!quantum_added)
+			{
+				class_l.deficit += quantum * weight (static_cast<nano::transport::traffic_type> (current));
+				quantum_added = true;
+			}
+			auto size (class_l.queue.front ().buffer.size ());
+			if (size <= class_l.deficit)
+			{
+				if (bucket.try_consume (nano::narrow_cast<unsigned> (size)))
+				{
+					auto entry_l (std::move (class_l.queue.front ()));
+					class_l.queue.pop_front ();
+					class_l.bytes -= size;
+					class_l.deficit -= size;
+					--queued;
+					lock.unlock ();
+					if (auto channel_l = entry_l.channel.lock ())
+					{
+						channel_l->send_buffer (entry_l.buffer, entry_l.callback, nano::buffer_drop_policy::limiter);
+						node.stats.inc (nano::stat::type::message, entry_l.detail, nano::stat::dir::out);
+					}
+					lock.lock ();
+				}
+				else
+				{
+					// Wait for the bucket to refill, this class keeps its turn
+					condition.wait_for (lock, std::chrono::milliseconds (5));
+				}
+				continue;
+			}
+		}
+		current = (current + 1) % classes.size ();
+		quantum_added = false;
+	}
+	// Messages still waiting are dropped, the channels are closing down
+	decltype (classes) discarded;
+	for (auto i (0u); i < classes.size (); ++i)
+	{
+		discarded[i].queue.swap (classes[i].queue);
+		classes[i].bytes = 0;
+	}
+	queued = 0;
+	lock.unlock ();
+	for (auto i (0u); i < discarded.size (); ++i)
+	{
+		for (auto const & entry_l : discarded[i].queue)
+		{
+			dropped (static_cast<nano::transport::traffic_type> (i), entry_l.buffer.size (), entry_l.callback, entry_l.detail);
+		}
+	}
+}
+
+std::unique_ptr<nano::container_info_component> nano::transport::collect_container_info (traffic_shaper & traffic_shaper, std::string const & name)
+{
+	auto composite = std::make_unique<container_info_composite> (name);
+	nano::lock_guard<nano::mutex> guard (traffic_shaper.mutex);
+	for (auto i (0u); i < traffic_shaper.classes.size (); ++i)
+	{
+		composite->add_component (std::make_unique<container_info_leaf> (container_info{ nano::transport::to_string (static_cast<nano::transport::traffic_type> (i)), traffic_shaper.classes[i].queue.size (), sizeof (nano::transport::traffic_shaper::entry) }));
+	}
+	return composite;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <nano/lib/asio.hpp>
+#include <nano/lib/locks.hpp>
+#include <nano/lib/rate_limiting.hpp>
+#include <nano/lib/stats.hpp>
+#include <nano/node/common.hpp>
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace nano
+{
+class container_info_component;
+class node;
+namespace transport
+{
+	class channel;
+
+	/** Classes of outbound traffic, which are shaped separately */
+	enum class traffic_type : uint8_t
+	{
+		/** confirm_ack */
+		vote,
+		confirm_req,
+		/** publish, including republished blocks */
+		publish,
+		/** Bootstrap requests sent over realtime channels */
+		bootstrap,
+		telemetry,
+		/** keepalive and node_id_handshake */
+		generic,
+		_last
+	};
+	nano::transport::traffic_type to_traffic_type (nano::message_type);
+	std::string to_string (nano::transport::traffic_type);
+	nano::stat::detail to_stat_detail (nano::transport::traffic_type);
+
+	/**
+	 * Shapes droppable outbound traffic (buffer_drop_policy::limiter) to node_config::bandwidth_limit.
+	 *
+	 * Messages are first policed by the token bucket of their channel, which limits the traffic to a single peer to
+	 * node_config::bandwidth_limit_per_peer. Messages are sent at once while there is global bandwidth to spare.
+	 * Once it is exhausted, messages wait in a queue per traffic_type, which are served by deficit round robin in
+	 * proportion to their weight. Votes keep flowing while a flood of publishes is shed.
+	 * Each queue holds up to one second of traffic at the global limit, further messages of that class are dropped.
+	 */
+	class traffic_shaper final
+	{
+	public:
+		explicit traffic_shaper (nano::node &);
+		~traffic_shaper ();
+		/** Stops sending, messages still queued are dropped and their callbacks are called with an error */
+		void stop ();
+		/**
+		 * Sends \p buffer_a to \p channel_a now or once there is bandwidth for its class, or drops it.
+		 * @return true if the message was dropped, in which case \p callback_a is called with an error
+		 */
+		bool send (nano::transport::channel & channel_a, nano::transport::traffic_type type_a, nano::shared_const_buffer const & buffer_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::stat::detail detail_a);
+		/** Number of messages waiting in the queue of \p type_a */
+		size_t size (nano::transport::traffic_type type_a) const;
+		/** Relative share of the bandwidth of each class while the limit is reached */
+		static unsigned weight (nano::transport::traffic_type);
+		/** Bytes a class may send per round, per unit of weight. At least the largest realtime message */
+		static size_t constexpr quantum = 1024;
+
+	private:
+		class entry final
+		{
+		public:
+			std::weak_ptr<nano::transport::channel> channel;
+			nano::shared_const_buffer buffer;
+			std::function<void(boost::system::error_code const &, size_t)> callback;
+			nano::stat::detail detail;
+		};
+		class traffic_class final
+		{
+		public:
+			std::deque<entry> queue;
+			/** Sum of the buffer sizes in queue */
+			size_t bytes{ 0 };
+			/** Bytes this class may still send in the current round */
+			size_t deficit{ 0 };
+		};
+		void run ();
+		void dropped (nano::transport::traffic_type, size_t, std::function<void(boost::system::error_code const &, size_t)> const &, nano::stat::detail);
+		nano::node & node;
+		nano::rate::token_bucket bucket;
+		size_t const max_queue_bytes;
+		std::array<traffic_class, static_cast<size_t> (nano::transport::traffic_type::_last)> classes;
+		/** Messages in all queues. While non zero, all messages are queued, so none overtakes those of its class */
+		size_t queued{ 0 };
+		/** The class being served and whether it was given its quantum for this round yet */
+		size_t current{ 0 };
+		bool quantum_added{ false };
+		bool stopped{ false };
+		mutable nano::mutex mutex;
+		nano::condition_variable condition;
+		std::thread thread;
+
+		friend std::unique_ptr<nano::container_info_component> collect_container_info (traffic_shaper &, std::string const &);
+	};
+
+	std::unique_ptr<nano::container_info_component> collect_container_info (traffic_shaper &, std::string const &);
+}
+}
@@ -8,55 +8,50 @@
 
 namespace
 {
-class callback_visitor : public nano::message_visitor
-{
-public:
-	void keepalive (nano::keepalive const & message_a) override
-	{
-		result = nano::stat::detail::keepalive;
-	}
-	void publish (nano::publish const & message_a) override
-	{
-		result = nano::stat::detail::publish;
-	}
-	void confirm_req (nano::confirm_req const & message_a) override
-	{
-		result = nano::stat::detail::confirm_req;
+nano::stat::detail message_stat_detail (nano::message_type type_a)
+{
+	nano::stat::detail result (nano::stat::detail::all);
+	switch (type_a)
+	{
+		case nano::message_type::keepalive:
+			result = nano::stat::detail::keepalive;
+			break;
+		case nano::message_type::publish:
+			result = nano::stat::detail::publish;
+			break;
+		case nano::message_type::confirm_req:
+			result = nano::stat::detail::confirm_req;
+			break;
+		case nano::message_type::confirm_ack:
+			result = nano::stat::detail::confirm_ack;
+			break;
+		case nano::message_type::bulk_pull:
+			result = nano::stat::detail::bulk_pull;
+			break;
+		case nano::message_type::bulk_pull_account:
+			result = nano::stat::detail::bulk_pull_account;
+			break;
+		case nano::message_type::bulk_push:
+			result = nano::stat::detail::bulk_push;
+			break;
+		case nano::message_type::frontier_req:
+			result = nano::stat::detail::frontier_req;
+			break;
+		case nano::message_type::node_id_handshake:
+			result = nano::stat::detail::node_id_handshake;
+			break;
+		case nano::message_type::telemetry_req:
+			result = nano::stat::detail::telemetry_req;
+			break;
+		case nano::message_type::telemetry_ack:
+			result = nano::stat::detail::telemetry_ack;
+			break;
+		default:
+			debug_assert (false);
+			break;
 	}
-	void confirm_ack (nano::confirm_ack const & message_a) override
-	{
-		result = nano::stat::detail::confirm_ack;
-	}
-	void bulk_pull (nano::bulk_pull const & message_a) override
-	{
-		result = nano::stat::detail::bulk_pull;
-	}
-	void bulk_pull_account (nano::bulk_pull_account const & message_a) override
-	{
-		result = nano::stat::detail::bulk_pull_account;
-	}
-	void bulk_push (nano::bulk_push const & message_a) override
-	{
-		result = nano::stat::detail::bulk_push;
-	}
-	void frontier_req (nano::frontier_req const & message_a) override
-	{
-		result = nano::stat::detail::frontier_req;
-	}
-	void node_id_handshake (nano::node_id_handshake const & message_a) override
-	{
-		result = nano::stat::detail::node_id_handshake;
-	}
-	void telemetry_req (nano::telemetry_req const & message_a) override
-	{
-		result = nano::stat::detail::telemetry_req;
-	}
-	void telemetry_ack (nano::telemetry_ack const & message_a) override
-	{
-		result = nano::stat::detail::telemetry_ack;
-	}
-	nano::stat::detail result;
-};
+	return result;
+}
 }
 
 nano::endpoint nano::transport::map_endpoint_to_v6 (nano::endpoint const & endpoint_a)
@@ -80,6 +75,7 @@ nano::tcp_endpoint nano::transport::map_endpoint_to_tcp (nano::endpoint const &
 }
 
 nano::transport::channel::channel (nano::node & node_a) :
+limiter (static_cast<size_t> (node_a.config.bandwidth_limit_per_peer * node_a.config.bandwidth_limit_burst_ratio), node_a.config.bandwidth_limit_per_peer),
 node (node_a)
 {
 	set_network_version (node_a.network_params.protocol.protocol_version);
@@ -87,32 +83,20 @@ node (node_a)
 
 void nano::transport::channel::send (nano::message const & message_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::buffer_drop_policy drop_policy_a)
 {
-	callback_visitor visitor;
-	message_a.visit (visitor);
-	auto buffer (message_a.to_shared_const_buffer ());
-	auto detail (visitor.result);
-	auto is_droppable_by_limiter = drop_policy_a == nano::buffer_drop_policy::limiter;
-	auto should_drop (node.network.limiter.should_drop (buffer.size ()));
-	if (!is_droppable_by_limiter || !should_drop)
+	send (message_a.to_shared_const_buffer (), message_a.header.type, callback_a, drop_policy_a);
+}
+
+void nano::transport::channel::send (nano::shared_const_buffer const & buffer_a, nano::message_type type_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::buffer_drop_policy drop_policy_a)
+{
+	auto detail (message_stat_detail (type_a));
+	if (drop_policy_a == nano::buffer_drop_policy::limiter)
 	{
-		send_buffer (buffer, callback_a, drop_policy_a);
-		node.stats.inc (nano::stat::type::message, detail, nano::stat::dir::out);
+		node.network.shaper.send (*this, nano::transport::to_traffic_type (type_a), buffer_a, callback_a, detail);
 	}
 	else
 	{
-		if (callback_a)
-		{
-			node.background ([callback_a]() {
-				callback_a (boost::system::errc::make_error_code (boost::system::errc::not_supported), 0);
-			});
-		}
-
-		node.stats.inc (nano::stat::type::drop, detail, nano::stat::dir::out);
-		if (node.config.logging.network_packet_logging ())
-		{
-			auto key = static_cast<uint8_t> (detail) << 8;
-			node.logger.always_log (boost::str (boost::format ("%1% of size %2% dropped") % node.stats.detail_to_string (key) % buffer.size ()));
-		}
+		send_buffer (buffer_a, callback_a, drop_policy_a);
+		node.stats.inc (nano::stat::type::message, detail, nano::stat::dir::out);
 	}
 }
 
@@ -250,15 +234,3 @@ bool nano::transport::reserved_address (nano::endpoint const & endpoint_a, bool
 	}
 	return result;
 }
-
-using namespace std::chrono_literals;
-
-nano::bandwidth_limiter::bandwidth_limiter (const double limit_burst_ratio_a, const size_t limit_a) :
-bucket (static_cast<size_t> (limit_a * limit_burst_ratio_a), limit_a)
-{
-}
-
-bool nano::bandwidth_limiter::should_drop (const size_t & message_size_a)
-{
-	return !bucket.try_consume (nano::narrow_cast<unsigned int> (message_size_a));
-}
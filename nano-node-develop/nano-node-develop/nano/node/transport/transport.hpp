@@ -5,20 +5,10 @@
 #include <nano/lib/stats.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/socket.hpp>
+#include <nano/node/transport/traffic_shaper.hpp>
 
 namespace nano
 {
-class bandwidth_limiter final
-{
-public:
-	// initialize with limit 0 = unbounded
-	bandwidth_limiter (const double, const size_t);
-	bool should_drop (const size_t &);
-
-private:
-	nano::rate::token_bucket bucket;
-};
-
 namespace transport
 {
 	class message;
@@ -33,9 +23,10 @@ namespace transport
 		undefined = 0,
 		udp = 1,
 		tcp = 2,
-		loopback = 3
+		loopback = 3,
+		simulated = 4
 	};
-	class channel
+	class channel : public std::enable_shared_from_this<nano::transport::channel>
 	{
 	public:
 		channel (nano::node &);
@@ -43,6 +34,8 @@ namespace transport
 		virtual size_t hash_code () const = 0;
 		virtual bool operator== (nano::transport::channel const &) const = 0;
 		void send (nano::message const & message_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a = nullptr, nano::buffer_drop_policy policy_a = nano::buffer_drop_policy::limiter);
+		/** Sends a message of type \p type_a serialized by nano::message::to_shared_const_buffer, so a message for many channels is only serialized once */
+		void send (nano::shared_const_buffer const & buffer_a, nano::message_type type_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a = nullptr, nano::buffer_drop_policy policy_a = nano::buffer_drop_policy::limiter);
 		virtual void send_buffer (nano::shared_const_buffer const &, std::function<void(boost::system::error_code const &, size_t)> const & = nullptr, nano::buffer_drop_policy = nano::buffer_drop_policy::limiter) = 0;
 		virtual std::string to_string () const = 0;
 		virtual nano::endpoint get_endpoint () const = 0;
@@ -121,6 +114,8 @@ namespace transport
 		}
 
 		mutable nano::mutex channel_mutex;
+		/** Limits droppable traffic to this peer to node_config::bandwidth_limit_per_peer */
+		nano::rate::token_bucket limiter;
 
 	private:
 		std::chrono::steady_clock::time_point last_bootstrap_attempt{ std::chrono::steady_clock::time_point () };
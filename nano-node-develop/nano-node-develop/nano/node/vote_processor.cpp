@@ -2,6 +2,7 @@
 #include <nano/lib/stats.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/timer.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/active_transactions.hpp>
 #include <nano/node/node_observers.hpp>
 #include <nano/node/nodeconfig.hpp>
@@ -155,7 +156,9 @@ void nano::vote_processor::verify_votes (decltype (votes) const & votes_a)
 		signatures.push_back (vote.first->signature.bytes.data ());
 	}
 	nano::signature_check_set check = { size, messages.data (), lengths.data (), pub_keys.data (), signatures.data (), verifications.data () };
+	auto const verify_start (std::chrono::steady_clock::now ());
 	checker.verify (check);
+	stats.observe (nano::stat::latency::vote_verification, std::chrono::steady_clock::now () - verify_start);
 	auto i (0);
 	for (auto const & vote : votes_a)
 	{
@@ -170,6 +173,7 @@ void nano::vote_processor::verify_votes (decltype (votes) const & votes_a)
 
 nano::vote_code nano::vote_processor::vote_blocking (std::shared_ptr<nano::vote> const & vote_a, std::shared_ptr<nano::transport::channel> const & channel_a, bool validated)
 {
+	NANO_TRACE_SPAN (span, vote_process, nano::tracing::id (vote_a->signature));
 	auto result (nano::vote_code::invalid);
 	if (validated || !vote_a->validate ())
 	{
@@ -1,4 +1,5 @@
 #include <nano/crypto_lib/random_pool.hpp>
+#include <nano/lib/errors.hpp>
 #include <nano/lib/threading.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/node/election.hpp>
@@ -11,6 +12,7 @@
 #include <boost/polymorphic_cast.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include <cmath>
 #include <future>
 
 #include <argon2.h>
@@ -649,13 +651,112 @@ void nano::wallet_store::version_put (nano::transaction const & transaction_a, u
 	entry_put_raw (transaction_a, nano::wallet_store::version_special, nano::wallet_value (entry, 0));
 }
 
+nano::kdf::kdf (unsigned parallel_a) :
+parallel (std::max (parallel_a, 1u))
+{
+	nano::random_pool::generate_block (secret.bytes.data (), secret.bytes.size ());
+}
+
+unsigned nano::kdf::default_parallel ()
+{
+	return std::min (std::max (std::thread::hardware_concurrency (), 1u), 4u);
+}
+
 void nano::kdf::phs (nano::raw_key & result_a, std::string const & password_a, nano::uint256_union const & salt_a)
+{
+	auto found (false);
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		if (!ahead.empty ())
+		{
+			auto existing (ahead.find (ahead_key (password_a, salt_a)));
+			if (existing != ahead.end ())
+			{
+				result_a = existing->second;
+				ahead.erase (existing);
+				found = true;
+			}
+		}
+	}
+	if (!found)
+	{
+		derive (result_a, password_a, salt_a);
+	}
+}
+
+void nano::kdf::derive (nano::raw_key & result_a, std::string const & password_a, nano::uint256_union const & salt_a)
 {
 	static nano::network_params network_params;
-	nano::lock_guard<nano::mutex> lock (mutex);
+	{
+		nano::unique_lock<nano::mutex> lock (mutex);
+		condition.wait (lock, [this] { return running < parallel; });
+		++running;
+	}
 	auto success (argon2_hash (1, network_params.kdf_work, 1, password_a.data (), password_a.size (), salt_a.bytes.data (), salt_a.bytes.size (), result_a.bytes.data (), result_a.bytes.size (), NULL, 0, Argon2_d, 0x10));
 	debug_assert (success == 0);
 	(void)success;
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		--running;
+	}
+	condition.notify_one ();
+}
+
+std::vector<nano::raw_key> nano::kdf::phs (std::vector<std::pair<std::string, nano::uint256_union>> const & inputs_a)
+{
+	std::vector<nano::raw_key> result (inputs_a.size ());
+	std::atomic<size_t> next (0);
+	auto derive_l = [&inputs_a, &result, &next, this]() {
+		for (auto i (next++); i < inputs_a.size (); i = next++)
+		{
+			derive (result[i], inputs_a[i].first, inputs_a[i].second);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (auto i (1u); i < std::min<size_t> (parallel, inputs_a.size ()); ++i)
+	{
+		threads.emplace_back (derive_l);
+	}
+	derive_l ();
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	return result;
+}
+
+void nano::kdf::derive_ahead (std::vector<std::pair<std::string, nano::uint256_union>> const & inputs_a)
+{
+	auto keys (phs (inputs_a));
+	nano::lock_guard<nano::mutex> lock (mutex);
+	for (auto i (0u); i < inputs_a.size (); ++i)
+	{
+		ahead[ahead_key (inputs_a[i].first, inputs_a[i].second)] = keys[i];
+	}
+}
+
+void nano::kdf::clear ()
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	ahead.clear ();
+}
+
+size_t nano::kdf::ahead_size ()
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return ahead.size ();
+}
+
+nano::uint256_union nano::kdf::ahead_key (std::string const & password_a, nano::uint256_union const & salt_a) const
+{
+	// Only a keyed hash of the password is kept
+	nano::uint256_union result;
+	blake2b_state state;
+	blake2b_init_key (&state, sizeof (result.bytes), secret.bytes.data (), secret.bytes.size ());
+	blake2b_update (&state, salt_a.bytes.data (), salt_a.bytes.size ());
+	blake2b_update (&state, password_a.data (), password_a.size ());
+	blake2b_final (&state, result.bytes.data (), sizeof (result.bytes));
+	return result;
 }
 
 nano::wallet::wallet (bool & init_a, nano::transaction & transaction_a, nano::wallets & wallets_a, std::string const & wallet_a) :
@@ -831,6 +932,7 @@ void nano::wallet_store::destroy (nano::transaction const & transaction_a)
 
 std::shared_ptr<nano::block> nano::wallet::receive_action (nano::block_hash const & send_hash_a, nano::account const & representative_a, nano::uint128_union const & amount_a, nano::account const & account_a, uint64_t work_a, bool generate_work_a)
 {
+	auto const cached_work (work_a == 0);
 	std::shared_ptr<nano::block> block;
 	nano::block_details details;
 	details.is_receive = true;
@@ -885,7 +987,7 @@ std::shared_ptr<nano::block> nano::wallet::receive_action (nano::block_hash cons
 	}
 	if (block != nullptr)
 	{
-		if (action_complete (block, account_a, generate_work_a, details))
+		if (action_complete (block, account_a, generate_work_a, details, cached_work))
 		{
 			// Return null block after work generation or ledger process error
 			block = nullptr;
@@ -896,6 +998,7 @@ std::shared_ptr<nano::block> nano::wallet::receive_action (nano::block_hash cons
 
 std::shared_ptr<nano::block> nano::wallet::change_action (nano::account const & source_a, nano::account const & representative_a, uint64_t work_a, bool generate_work_a)
 {
+	auto const cached_work (work_a == 0);
 	std::shared_ptr<nano::block> block;
 	nano::block_details details;
 	{
@@ -925,7 +1028,7 @@ std::shared_ptr<nano::block> nano::wallet::change_action (nano::account const &
 	}
 	if (block != nullptr)
 	{
-		if (action_complete (block, source_a, generate_work_a, details))
+		if (action_complete (block, source_a, generate_work_a, details, cached_work))
 		{
 			// Return null block after work generation or ledger process error
 			block = nullptr;
@@ -936,6 +1039,7 @@ std::shared_ptr<nano::block> nano::wallet::change_action (nano::account const &
 
 std::shared_ptr<nano::block> nano::wallet::send_action (nano::account const & source_a, nano::account const & account_a, nano::uint128_t const & amount_a, uint64_t work_a, bool generate_work_a, boost::optional<std::string> id_a)
 {
+	auto const cached_work (work_a == 0);
 	boost::optional<nano::mdb_val> id_mdb_val;
 	if (id_a)
 	{
@@ -1028,7 +1132,7 @@ std::shared_ptr<nano::block> nano::wallet::send_action (nano::account const & so
 
 	if (!error && block != nullptr && !cached_block)
 	{
-		if (action_complete (block, source_a, generate_work_a, details))
+		if (action_complete (block, source_a, generate_work_a, details, cached_work))
 		{
 			// Return null block after work generation or ledger process error
 			block = nullptr;
@@ -1037,15 +1141,17 @@ std::shared_ptr<nano::block> nano::wallet::send_action (nano::account const & so
 	return block;
 }
 
-bool nano::wallet::action_complete (std::shared_ptr<nano::block> const & block_a, nano::account const & account_a, bool const generate_work_a, nano::block_details const & details_a)
+bool nano::wallet::action_complete (std::shared_ptr<nano::block> const & block_a, nano::account const & account_a, bool const generate_work_a, nano::block_details const & details_a, bool const cached_work_a)
 {
 	bool error{ false };
 	// Unschedule any work caching for this account
-	wallets.delayed_work->erase (account_a);
+	wallets.precache.erase (account_a);
 	if (block_a != nullptr)
 	{
+		auto start (std::chrono::steady_clock::now ());
 		auto required_difficulty{ nano::work_threshold (block_a->work_version (), details_a) };
-		if (block_a->difficulty () < required_difficulty)
+		auto cache_hit (block_a->difficulty () >= required_difficulty);
+		if (!cache_hit)
 		{
 			wallets.node.logger.try_log (boost::str (boost::format ("Cached or provided work for block %1% account %2% is invalid, regenerating") % block_a->hash ().to_string () % account_a.to_account ()));
 			debug_assert (required_difficulty <= wallets.node.max_work_generate_difficulty (block_a->work_version ()));
@@ -1057,6 +1163,17 @@ bool nano::wallet::action_complete (std::shared_ptr<nano::block> const & block_a
 			error = wallets.node.process_local (block_a, true).code != nano::process_result::progress;
 			debug_assert (error || block_a->sideband ().details == details_a);
 		}
+		if (!error && cached_work_a)
+		{
+			auto detail (cache_hit ? nano::stat::detail::precache_hit : nano::stat::detail::precache_miss);
+			auto elapsed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start));
+			wallets.node.stats.inc (nano::stat::type::work, detail);
+			wallets.node.stats.update_histogram (nano::stat::type::work, detail, nano::stat::dir::in, static_cast<uint64_t> (elapsed.count ()));
+		}
+		if (!error)
+		{
+			wallets.precache.activity (account_a);
+		}
 		if (!error && generate_work_a)
 		{
 			work_ensure (account_a, block_a->hash ());
@@ -1129,6 +1246,279 @@ void nano::wallet::send_async (nano::account const & source_a, nano::account con
 	});
 }
 
+void nano::wallet::send_batch_action (std::vector<nano::send_batch_item> const & items_a, std::function<void(size_t, std::shared_ptr<nano::block> const &, std::error_code const &)> const & callback_a)
+{
+	class planned_send final
+	{
+	public:
+		size_t index;
+		std::shared_ptr<nano::state_block> block;
+		uint64_t difficulty;
+		/** Set once work generation ended, work is then set unless it failed */
+		bool work_done{ false };
+		boost::optional<uint64_t> work;
+	};
+	class chain final
+	{
+	public:
+		std::error_code error;
+		nano::account_info info;
+		nano::raw_key prv;
+		nano::uint128_t balance{ 0 };
+		nano::block_hash head{ 0 };
+	};
+	std::vector<planned_send> plan;
+	std::unordered_map<nano::account, chain> chains;
+	// Items repeating the idempotency id of an earlier item, by the index of that item. They get its result rather than sending again
+	std::unordered_map<std::string, size_t> first_by_id;
+	std::unordered_map<size_t, std::vector<size_t>> duplicates;
+	// Results known while planning, reported once every duplicate is known
+	std::vector<std::tuple<size_t, std::shared_ptr<nano::block>, std::error_code>> planned_results;
+	auto callback_l = [&callback_a, &duplicates](size_t index_a, std::shared_ptr<nano::block> const & block_a, std::error_code const & ec_a) {
+		callback_a (index_a, block_a, ec_a);
+		auto existing (duplicates.find (index_a));
+		if (existing != duplicates.end ())
+		{
+			for (auto duplicate : existing->second)
+			{
+				callback_a (duplicate, block_a, ec_a);
+			}
+		}
+	};
+	{
+		auto transaction (wallets.tx_begin_write ());
+		auto block_transaction (wallets.node.store.tx_begin_read ());
+		auto valid_password (store.valid_password (transaction));
+		for (size_t i (0); i < items_a.size (); ++i)
+		{
+			auto const & item (items_a[i]);
+			boost::optional<nano::mdb_val> id_mdb_val;
+			if (item.id)
+			{
+				auto first (first_by_id.emplace (*item.id, i));
+				if (!first.second)
+				{
+					duplicates[first.first->second].push_back (i);
+					continue;
+				}
+				id_mdb_val = nano::mdb_val (item.id->size (), const_cast<char *> (item.id->data ()));
+				nano::mdb_val existing_id;
+				if (mdb_get (wallets.env.tx (transaction), wallets.send_action_ids, *id_mdb_val, existing_id) == 0)
+				{
+					if (auto block = wallets.node.store.block_get (block_transaction, nano::block_hash (existing_id)))
+					{
+						// Already sent
+						planned_results.emplace_back (i, block, std::error_code ());
+						continue;
+					}
+				}
+			}
+			auto existing (chains.find (item.source));
+			if (existing == chains.end ())
+			{
+				existing = chains.emplace (item.source, chain ()).first;
+				auto & chain_l (existing->second);
+				wallets.precache.erase (item.source);
+				if (!valid_password)
+				{
+					chain_l.error = nano::error_common::wallet_locked;
+				}
+				else if (store.fetch (transaction, item.source, chain_l.prv))
+				{
+					chain_l.error = nano::error_common::account_not_found_wallet;
+				}
+				else if (wallets.node.store.account_get (block_transaction, item.source, chain_l.info))
+				{
+					chain_l.error = nano::error_common::insufficient_balance;
+				}
+				else
+				{
+					chain_l.balance = chain_l.info.balance.number ();
+					chain_l.head = chain_l.info.head;
+				}
+			}
+			auto & chain_l (existing->second);
+			std::error_code ec (chain_l.error);
+			if (!ec && item.amount.is_zero ())
+			{
+				ec = nano::error_common::invalid_amount;
+			}
+			if (!ec && chain_l.balance < item.amount)
+			{
+				ec = nano::error_common::insufficient_balance;
+			}
+			if (!ec)
+			{
+				auto block (std::make_shared<nano::state_block> (item.source, chain_l.head, chain_l.info.representative, chain_l.balance - item.amount, item.destination, chain_l.prv, item.source, 0));
+				if (id_mdb_val && mdb_put (wallets.env.tx (transaction), wallets.send_action_ids, *id_mdb_val, nano::mdb_val (block->hash ()), 0) != 0)
+				{
+					ec = nano::error_common::generic;
+				}
+				else
+				{
+					nano::block_details details (chain_l.info.epoch (), true, false, false);
+					auto required_difficulty (nano::work_threshold (block->work_version (), details));
+					planned_send send{ i, block, std::max (required_difficulty, wallets.node.active.limited_active_difficulty (block->work_version (), required_difficulty)) };
+					if (chain_l.head == chain_l.info.head)
+					{
+						// The first block of a chain may have precomputed work
+						uint64_t cached_work (0);
+						if (!store.work_get (transaction, item.source, cached_work) && nano::work_difficulty (block->work_version (), block->root (), cached_work) >= send.difficulty)
+						{
+							send.work_done = true;
+							send.work = cached_work;
+						}
+					}
+					plan.push_back (send);
+					chain_l.balance -= item.amount;
+					chain_l.head = block->hash ();
+				}
+			}
+			if (ec)
+			{
+				planned_results.emplace_back (i, nullptr, ec);
+			}
+		}
+	}
+	for (auto const & [index, block, ec] : planned_results)
+	{
+		callback_l (index, block, ec);
+	}
+
+	// Protects the work results and outstanding, which are set from work generation callbacks
+	nano::mutex mutex;
+	nano::condition_variable condition;
+	// Chains with a failed block, whose later blocks can't be processed
+	std::unordered_set<nano::account> broken;
+	size_t outstanding (0);
+	size_t next_work (0);
+	for (size_t next_process (0); next_process < plan.size ();)
+	{
+		// Generate work for the next blocks, up to the window
+		std::vector<size_t> start;
+		{
+			nano::lock_guard<nano::mutex> lock (mutex);
+			for (; next_work < plan.size () && outstanding + start.size () < send_batch_work_window; ++next_work)
+			{
+				auto & send (plan[next_work]);
+				if (broken.count (send.block->account ()) > 0)
+				{
+					send.work_done = true;
+				}
+				else if (!send.work_done)
+				{
+					start.push_back (next_work);
+				}
+			}
+			outstanding += start.size ();
+		}
+		for (auto position : start)
+		{
+			auto & send (plan[position]);
+			wallets.node.work_generate (
+			send.block->work_version (), send.block->root (), send.difficulty, [&mutex, &condition, &outstanding, &send](boost::optional<uint64_t> work_a) {
+				nano::lock_guard<nano::mutex> lock (mutex);
+				send.work = work_a;
+				send.work_done = true;
+				--outstanding;
+				// While locked, as the batch may return as soon as it is released
+				condition.notify_all ();
+			},
+			send.block->account (), false, nano::work_priority::high);
+		}
+		// Process the blocks with work, in order
+		std::vector<size_t> ready;
+		{
+			nano::unique_lock<nano::mutex> lock (mutex);
+			condition.wait (lock, [&plan, next_process] { return plan[next_process].work_done; });
+			for (auto i (next_process); i < next_work && plan[i].work_done; ++i)
+			{
+				ready.push_back (i);
+			}
+		}
+		next_process += ready.size ();
+		std::vector<std::shared_ptr<nano::block>> blocks;
+		std::vector<size_t> positions;
+		std::vector<nano::root> cancel;
+		for (auto position : ready)
+		{
+			auto & send (plan[position]);
+			auto account (send.block->account ());
+			if (broken.count (account) > 0)
+			{
+				callback_l (send.index, nullptr, nano::error_process::gap_previous);
+			}
+			else if (!send.work.is_initialized ())
+			{
+				callback_l (send.index, nullptr, nano::error_common::failure_work_generation);
+				broken.insert (account);
+			}
+			else
+			{
+				send.block->block_work_set (*send.work);
+				blocks.push_back (send.block);
+				positions.push_back (position);
+			}
+		}
+		if (!blocks.empty ())
+		{
+			auto results (wallets.node.process_local (blocks, true));
+			for (size_t i (0); i < results.size (); ++i)
+			{
+				auto const & send (plan[positions[i]]);
+				auto account (send.block->account ());
+				if (broken.count (account) > 0)
+				{
+					// Processed after a failed block of its chain
+					callback_l (send.index, nullptr, nano::error_process::gap_previous);
+				}
+				else if (results[i].code == nano::process_result::progress)
+				{
+					wallets.precache.activity (account);
+					callback_l (send.index, send.block, std::error_code ());
+				}
+				else
+				{
+					callback_l (send.index, nullptr, results[i].code == nano::process_result::fork ? nano::error_process::fork : nano::error_process::other);
+					broken.insert (account);
+				}
+			}
+		}
+		// Stop generating work for the rest of broken chains
+		{
+			nano::lock_guard<nano::mutex> lock (mutex);
+			for (auto i (next_process); i < next_work; ++i)
+			{
+				if (!plan[i].work_done && broken.count (plan[i].block->account ()) > 0)
+				{
+					cancel.push_back (plan[i].block->root ());
+				}
+			}
+		}
+		for (auto const & root : cancel)
+		{
+			wallets.node.distributed_work.cancel (root);
+		}
+	}
+	// Precompute work for the next block of each chain
+	for (auto const & [account, chain_l] : chains)
+	{
+		if (!chain_l.error && broken.count (account) == 0 && chain_l.head != chain_l.info.head)
+		{
+			work_ensure (account, chain_l.head);
+		}
+	}
+}
+
+void nano::wallet::send_batch_async (std::vector<nano::send_batch_item> const & items_a, std::function<void(size_t, std::shared_ptr<nano::block> const &, std::error_code const &)> const & callback_a, std::function<void()> const & done_a)
+{
+	auto this_l (shared_from_this ());
+	wallets.queue_wallet_action (nano::wallets::high_priority, this_l, [items_a, callback_a, done_a](nano::wallet & wallet_a) {
+		wallet_a.send_batch_action (items_a, callback_a);
+		done_a ();
+	});
+}
+
 // Update work for account if latest root is root_a
 void nano::wallet::work_update (nano::transaction const & transaction_a, nano::account const & account_a, nano::root const & root_a, uint64_t work_a)
 {
@@ -1148,22 +1538,7 @@ void nano::wallet::work_update (nano::transaction const & transaction_a, nano::a
 
 void nano::wallet::work_ensure (nano::account const & account_a, nano::root const & root_a)
 {
-	using namespace std::chrono_literals;
-	std::chrono::seconds const precache_delay = wallets.node.network_params.network.is_dev_network () ? 1s : 10s;
-
-	wallets.delayed_work->operator[] (account_a) = root_a;
-
-	wallets.node.workers.add_timed_task (std::chrono::steady_clock::now () + precache_delay, [this_l = shared_from_this (), account_a, root_a] {
-		auto delayed_work = this_l->wallets.delayed_work.lock ();
-		auto existing (delayed_work->find (account_a));
-		if (existing != delayed_work->end () && existing->second == root_a)
-		{
-			delayed_work->erase (existing);
-			this_l->wallets.queue_wallet_action (nano::wallets::generate_priority, this_l, [account_a, root_a](nano::wallet & wallet_a) {
-				wallet_a.work_cache_blocking (account_a, root_a);
-			});
-		}
-	});
+	wallets.precache.queue (shared_from_this (), account_a, root_a);
 }
 
 bool nano::wallet::search_pending (nano::transaction const & wallet_transaction_a)
@@ -1303,7 +1678,7 @@ void nano::wallet::work_cache_blocking (nano::account const & account_a, nano::r
 	if (wallets.node.work_generation_enabled ())
 	{
 		auto difficulty (wallets.node.default_difficulty (nano::work_version::work_1));
-		auto opt_work_l (wallets.node.work_generate_blocking (nano::work_version::work_1, root_a, difficulty, account_a));
+		auto opt_work_l (wallets.node.work_generate_blocking (nano::work_version::work_1, root_a, difficulty, account_a, nano::work_priority::low));
 		if (opt_work_l.is_initialized ())
 		{
 			auto transaction_l (wallets.tx_begin_write ());
@@ -1373,6 +1748,8 @@ void nano::work_watcher::watching (nano::qualified_root const & root_a, std::sha
 			 */
 			if (active_difficulty > block_a->difficulty () && watcher_l->node.work_generation_enabled ())
 			{
+				// Work taking longer than the period is for an outdated active difficulty, the next check requests it again
+				auto deadline (std::chrono::steady_clock::now () + watcher_l->node.config.work_watcher_period);
 				watcher_l->node.work_generate (
 				block_a->work_version (), block_a->root (), active_difficulty, [watcher_l, block_a, root_a](boost::optional<uint64_t> work_a) {
 					if (watcher_l->is_watched (root_a))
@@ -1393,7 +1770,7 @@ void nano::work_watcher::watching (nano::qualified_root const & root_a, std::sha
 						watcher_l->watching (root_a, block_a);
 					}
 				},
-				block_a->account ());
+				block_a->account (), false, nano::work_priority::low, deadline);
 			}
 			else
 			{
@@ -1461,12 +1838,194 @@ void nano::wallets::do_wallet_actions ()
 	}
 }
 
+std::chrono::seconds constexpr nano::work_precache::activity_half_life;
+std::chrono::seconds constexpr nano::work_precache::budget_window;
+
+nano::work_precache::work_precache (nano::node & node_a) :
+node (node_a),
+budget (node_a.config.work_precache_cpu_share * budget_window.count ()),
+budget_updated (std::chrono::steady_clock::now ()),
+thread ([this]() {
+	nano::thread_role::set (nano::thread_role::name::work_precache);
+	run ();
+})
+{
+	// Time to complete wallet blocks, in milliseconds, depending on whether precomputed work was used
+	for (auto detail : { nano::stat::detail::precache_hit, nano::stat::detail::precache_miss })
+	{
+		node.stats.define_histogram (nano::stat::type::work, detail, nano::stat::dir::in, { 0, 1, 10, 100, 1000, 10000, std::numeric_limits<uint64_t>::max () });
+	}
+}
+
+nano::work_precache::~work_precache ()
+{
+	stop ();
+}
+
+void nano::work_precache::stop ()
+{
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		stopped = true;
+	}
+	condition.notify_all ();
+	if (thread.joinable ())
+	{
+		thread.join ();
+	}
+}
+
+void nano::work_precache::queue (std::shared_ptr<nano::wallet> const & wallet_a, nano::account const & account_a, nano::root const & root_a)
+{
+	if (node.config.work_precache_cpu_share > 0)
+	{
+		{
+			nano::lock_guard<nano::mutex> lock (mutex);
+			auto now (std::chrono::steady_clock::now ());
+			auto & entry (entries[account_a]);
+			entry.wallet = wallet_a;
+			entry.root = root_a;
+			entry.queued = true;
+			// The block just created counts, anything above it means another one recently
+			entry.ready = decayed (entry, now) > 1.5 ? now : now + node.config.work_precache_delay;
+		}
+		condition.notify_all ();
+	}
+}
+
+void nano::work_precache::erase (nano::account const & account_a)
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	auto existing (entries.find (account_a));
+	if (existing != entries.end ())
+	{
+		existing->second.queued = false;
+	}
+}
+
+void nano::work_precache::activity (nano::account const & account_a)
+{
+	if (node.config.work_precache_cpu_share > 0)
+	{
+		nano::lock_guard<nano::mutex> lock (mutex);
+		auto now (std::chrono::steady_clock::now ());
+		auto & entry (entries[account_a]);
+		entry.activity = decayed (entry, now) + 1;
+		entry.activity_updated = now;
+	}
+}
+
+boost::optional<nano::root> nano::work_precache::root (nano::account const & account_a)
+{
+	boost::optional<nano::root> result;
+	nano::lock_guard<nano::mutex> lock (mutex);
+	auto existing (entries.find (account_a));
+	if (existing != entries.end () && !existing->second.root.is_zero ())
+	{
+		result = existing->second.root;
+	}
+	return result;
+}
+
+size_t nano::work_precache::size ()
+{
+	nano::lock_guard<nano::mutex> lock (mutex);
+	return entries.size ();
+}
+
+double nano::work_precache::decayed (nano::work_precache::entry const & entry_a, std::chrono::steady_clock::time_point const & now_a) const
+{
+	std::chrono::duration<double> elapsed (now_a - entry_a.activity_updated);
+	return entry_a.activity * std::exp2 (-elapsed.count () / activity_half_life.count ());
+}
+
+void nano::work_precache::run ()
+{
+	nano::unique_lock<nano::mutex> lock (mutex);
+	while (!stopped)
+	{
+		auto now (std::chrono::steady_clock::now ());
+		auto share (node.config.work_precache_cpu_share);
+		std::chrono::duration<double> refill (now - budget_updated);
+		budget = std::min (budget + refill.count () * share, share * budget_window.count ());
+		budget_updated = now;
+		// Most active ready account, forgetting inactive ones
+		auto next (entries.end ());
+		auto wakeup (std::chrono::steady_clock::time_point::max ());
+		for (auto i (entries.begin ()), n (entries.end ()); i != n;)
+		{
+			auto & entry (i->second);
+			auto activity_l (decayed (entry, now));
+			if (!entry.queued && !entry.generating && activity_l < 0.01)
+			{
+				i = entries.erase (i);
+				continue;
+			}
+			if (entry.queued)
+			{
+				if (entry.ready <= now)
+				{
+					if (next == entries.end () || activity_l > decayed (next->second, now))
+					{
+						next = i;
+					}
+				}
+				else
+				{
+					wakeup = std::min (wakeup, entry.ready);
+				}
+			}
+			++i;
+		}
+		if (next != entries.end () && budget > 0)
+		{
+			auto account (next->first);
+			auto & entry (next->second);
+			auto wallet (entry.wallet.lock ());
+			auto root_l (entry.root);
+			entry.queued = false;
+			entry.generating = true;
+			lock.unlock ();
+			if (wallet != nullptr)
+			{
+				wallet->work_cache_blocking (account, root_l);
+				node.stats.inc (nano::stat::type::work, nano::stat::detail::precache_generated);
+			}
+			lock.lock ();
+			// Wall time, which approximates the work pool time from above
+			std::chrono::duration<double> spent (std::chrono::steady_clock::now () - now);
+			budget -= spent.count ();
+			auto existing (entries.find (account));
+			if (existing != entries.end ())
+			{
+				existing->second.generating = false;
+			}
+		}
+		else if (next != entries.end ())
+		{
+			// Over budget, wait until it is positive again
+			node.stats.inc (nano::stat::type::work, nano::stat::detail::precache_throttled);
+			std::chrono::duration<double> refill_time (-budget / share + 0.001);
+			condition.wait_for (lock, std::chrono::duration_cast<std::chrono::milliseconds> (refill_time));
+		}
+		else if (wakeup != std::chrono::steady_clock::time_point::max ())
+		{
+			condition.wait_until (lock, wakeup);
+		}
+		else
+		{
+			condition.wait (lock);
+		}
+	}
+}
+
 nano::wallets::wallets (bool error_a, nano::node & node_a) :
 observer ([](bool) {}),
 node (node_a),
 env (boost::polymorphic_downcast<nano::mdb_wallets_store *> (node_a.wallets_store_impl.get ())->environment),
 stopped (false),
 watcher (std::make_shared<nano::work_watcher> (node_a)),
+precache (node_a),
 thread ([this]() {
 	nano::thread_role::set (nano::thread_role::name::wallet_actions);
 	do_wallet_actions ();
@@ -1523,10 +2082,27 @@ thread ([this]() {
 		const boost::filesystem::path path (store_path);
 		nano::mdb_store::create_backup_file (env, path, node_a.logger);
 	}
+	{
+		// Derive the keys for the empty password of all locked wallets in parallel, entering them below takes them
+		std::vector<std::pair<std::string, nano::uint256_union>> initial_l;
+		auto transaction (tx_begin_read ());
+		for (auto & item : items)
+		{
+			nano::raw_key password_l;
+			item.second->store.password.value (password_l);
+			if (password_l.is_zero ())
+			{
+				initial_l.emplace_back ("", item.second->store.salt (transaction));
+			}
+		}
+		kdf.derive_ahead (initial_l);
+	}
 	for (auto & item : items)
 	{
 		item.second->enter_initial_password ();
 	}
+	// Keys derived ahead are only kept for the initial unlock
+	kdf.clear ();
 	if (node_a.config.enable_voting)
 	{
 		lock.unlock ();
@@ -1732,6 +2308,7 @@ void nano::wallets::stop ()
 		thread.join ();
 	}
 	watcher->stop ();
+	precache.stop ();
 }
 
 nano::write_transaction nano::wallets::tx_begin_write ()
@@ -1893,7 +2470,6 @@ std::unordered_map<nano::wallet_id, std::shared_ptr<nano::wallet>> nano::wallets
 	return items;
 }
 
-nano::uint128_t const nano::wallets::generate_priority = std::numeric_limits<nano::uint128_t>::max ();
 nano::uint128_t const nano::wallets::high_priority = std::numeric_limits<nano::uint128_t>::max () - 1;
 
 nano::store_iterator<nano::account, nano::wallet_value> nano::wallet_store::begin (nano::transaction const & transaction_a)
@@ -1958,13 +2534,16 @@ std::unique_ptr<nano::container_info_component> nano::collect_container_info (wa
 		items_count = wallets.items.size ();
 		actions_count = wallets.actions.size ();
 	}
+	auto precache_count (wallets.precache.size ());
 
 	auto sizeof_item_element = sizeof (decltype (wallets.items)::value_type);
 	auto sizeof_actions_element = sizeof (decltype (wallets.actions)::value_type);
 	auto sizeof_watcher_element = sizeof (decltype (wallets.watcher->list_watched ())::value_type);
+	auto sizeof_precache_element = sizeof (decltype (wallets.precache.entries)::value_type);
 	auto composite = std::make_unique<container_info_composite> (name);
 	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "items", items_count, sizeof_item_element }));
 	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "actions", actions_count, sizeof_actions_element }));
 	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "work_watcher", wallets.watcher->size (), sizeof_watcher_element }));
+	composite->add_component (std::make_unique<container_info_leaf> (container_info{ "work_precache", precache_count, sizeof_precache_element }));
 	return composite;
 }
@@ -10,8 +10,11 @@
 #include <nano/secure/common.hpp>
 
 #include <atomic>
+#include <deque>
 #include <mutex>
+#include <system_error>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 namespace nano
 {
@@ -31,11 +34,37 @@ private:
 	nano::mutex mutex;
 	void value_get (nano::raw_key &);
 };
+/**
+ * Derives wallet keys from passwords. Up to `parallel` derivations run at a time, as each one needs kdf_work KiB
+ * of memory. Keys can be derived ahead in parallel, such as for unlocking all wallets at startup. Each of those is
+ * kept until it is used once or cleared, keyed by a hash of (password, salt) under a secret of this kdf.
+ */
 class kdf final
 {
 public:
+	explicit kdf (unsigned parallel_a = default_parallel ());
+	/** Derives a key, or takes it if it was derived ahead */
 	void phs (nano::raw_key &, std::string const &, nano::uint256_union const &);
+	/** Derives the keys of several (password, salt) pairs, in parallel, returning them in the same order */
+	std::vector<nano::raw_key> phs (std::vector<std::pair<std::string, nano::uint256_union>> const &);
+	/** Derives the keys of several (password, salt) pairs in parallel, for later calls of phs with each pair to take */
+	void derive_ahead (std::vector<std::pair<std::string, nano::uint256_union>> const &);
+	/** Drops the keys derived ahead and not taken */
+	void clear ();
+	size_t ahead_size ();
+	/** Hardware threads, up to 4 to bound memory use */
+	static unsigned default_parallel ();
+	unsigned const parallel;
+
+private:
+	void derive (nano::raw_key &, std::string const &, nano::uint256_union const &);
+	nano::uint256_union ahead_key (std::string const &, nano::uint256_union const &) const;
 	nano::mutex mutex;
+	nano::condition_variable condition;
+	unsigned running{ 0 };
+	/** Random, so a key of ahead can't be used to check passwords without knowing it */
+	nano::raw_key secret;
+	std::unordered_map<nano::uint256_union, nano::raw_key> ahead;
 };
 enum class key_type
 {
@@ -115,6 +144,16 @@ public:
 private:
 	MDB_txn * tx (nano::transaction const &) const;
 };
+/** A send of wallet::send_batch_action */
+class send_batch_item final
+{
+public:
+	nano::account source;
+	nano::account destination;
+	nano::uint128_t amount;
+	/** Optional idempotency id, as for send_action */
+	boost::optional<std::string> id;
+};
 // A wallet is a set of account keys encrypted by a common encryption key
 class wallet final : public std::enable_shared_from_this<nano::wallet>
 {
@@ -122,7 +161,8 @@ public:
 	std::shared_ptr<nano::block> change_action (nano::account const &, nano::account const &, uint64_t = 0, bool = true);
 	std::shared_ptr<nano::block> receive_action (nano::block_hash const &, nano::account const &, nano::uint128_union const &, nano::account const &, uint64_t = 0, bool = true);
 	std::shared_ptr<nano::block> send_action (nano::account const &, nano::account const &, nano::uint128_t const &, uint64_t = 0, bool = true, boost::optional<std::string> = {});
-	bool action_complete (std::shared_ptr<nano::block> const &, nano::account const &, bool const, nano::block_details const &);
+	/** \p cached_work_a is set when the block's work was taken from the wallet store, for the precache statistics */
+	bool action_complete (std::shared_ptr<nano::block> const &, nano::account const &, bool const, nano::block_details const &, bool const cached_work_a = false);
 	wallet (bool &, nano::transaction &, nano::wallets &, std::string const &);
 	wallet (bool &, nano::transaction &, nano::wallets &, std::string const &, std::string const &);
 	void enter_initial_password ();
@@ -141,9 +181,19 @@ public:
 	void receive_async (nano::block_hash const &, nano::account const &, nano::uint128_t const &, nano::account const &, std::function<void(std::shared_ptr<nano::block> const &)> const &, uint64_t = 0, bool = true);
 	nano::block_hash send_sync (nano::account const &, nano::account const &, nano::uint128_t const &);
 	void send_async (nano::account const &, nano::account const &, nano::uint128_t const &, std::function<void(std::shared_ptr<nano::block> const &)> const &, uint64_t = 0, bool = true, boost::optional<std::string> = {});
+	/**
+	 * Creates the sends of \p items_a, chained per source account in item order.
+	 * Block hashes don't depend on work, so every block is built and signed up front. Work is then generated for up to
+	 * send_batch_work_window blocks at a time, while the blocks with work are processed in chain order, in batches.
+	 * \p callback_a is called once per item as it completes, with the item index and its block or an error. Items of a
+	 * chain following a failed one fail as well. An item repeating the idempotency id of an earlier item gets the result
+	 * of that item instead of sending again.
+	 */
+	void send_batch_action (std::vector<nano::send_batch_item> const &, std::function<void(size_t, std::shared_ptr<nano::block> const &, std::error_code const &)> const &);
+	void send_batch_async (std::vector<nano::send_batch_item> const &, std::function<void(size_t, std::shared_ptr<nano::block> const &, std::error_code const &)> const &, std::function<void()> const &);
 	void work_cache_blocking (nano::account const &, nano::root const &);
 	void work_update (nano::transaction const &, nano::account const &, nano::root const &, uint64_t);
-	// Schedule work generation after a few seconds
+	// Schedule work generation in the background, see work_precache
 	void work_ensure (nano::account const &, nano::root const &);
 	bool search_pending (nano::transaction const &);
 	void init_free_accounts (nano::transaction const &);
@@ -159,6 +209,7 @@ public:
 	nano::wallets & wallets;
 	nano::mutex representatives_mutex;
 	std::unordered_set<nano::account> representatives;
+	static size_t constexpr send_batch_work_window = 64;
 };
 
 class work_watcher final : public std::enable_shared_from_this<nano::work_watcher>
@@ -183,6 +234,63 @@ private:
 	std::atomic<bool> stopped;
 };
 
+/**
+ * Precomputes work on the latest root of wallet accounts in the background, so the next block they create has
+ * work ready. Generation uses the low priority class of the work pool, and the time spent is limited to
+ * node_config::work_precache_cpu_share of it, with bursts of up to a minute of budget.
+ * The time spent is the wall time from queuing a request on the work pool to its completion, an approximation of the CPU
+ * time: work is generated by the pool threads, an OpenCL device or work peers, none of which this thread can measure.
+ * Time spent waiting behind higher priority requests is counted too, so precaching errs on the side of doing less.
+ * Accounts are served by recent activity, most active first. Accounts which created another block recently
+ * start at once, others after node_config::work_precache_delay in case another block is created meanwhile.
+ * Results are persisted in the wallet store, see wallet::work_update.
+ */
+class work_precache final
+{
+public:
+	work_precache (nano::node &);
+	~work_precache ();
+	void stop ();
+	/** Queues work on \p root_a for \p account_a, replacing anything queued for the account */
+	void queue (std::shared_ptr<nano::wallet> const &, nano::account const &, nano::root const &);
+	/** Unqueues the account, which is creating a block. Work already being generated is left to finish */
+	void erase (nano::account const &);
+	/** Records a block created by the account */
+	void activity (nano::account const &);
+	/** Root last queued for the account, whether or not its work was generated since, if the account is still tracked */
+	boost::optional<nano::root> root (nano::account const &);
+	size_t size ();
+	static std::chrono::seconds constexpr activity_half_life{ 60 };
+	static std::chrono::seconds constexpr budget_window{ 60 };
+
+private:
+	class entry final
+	{
+	public:
+		std::weak_ptr<nano::wallet> wallet;
+		nano::root root{ 0 };
+		bool queued{ false };
+		bool generating{ false };
+		std::chrono::steady_clock::time_point ready;
+		/** Blocks created, decaying by half every activity_half_life */
+		double activity{ 0 };
+		std::chrono::steady_clock::time_point activity_updated;
+	};
+	void run ();
+	double decayed (nano::work_precache::entry const &, std::chrono::steady_clock::time_point const &) const;
+	nano::node & node;
+	nano::mutex mutex;
+	nano::condition_variable condition;
+	std::unordered_map<nano::account, nano::work_precache::entry> entries;
+	/** Seconds of work pool time available, refilled at the configured share */
+	double budget;
+	std::chrono::steady_clock::time_point budget_updated;
+	bool stopped{ false };
+	std::thread thread;
+
+	friend std::unique_ptr<container_info_component> collect_container_info (wallets &, std::string const &);
+};
+
 class wallet_representatives
 {
 public:
@@ -237,7 +345,6 @@ public:
 	std::function<void(bool)> observer;
 	std::unordered_map<nano::wallet_id, std::shared_ptr<nano::wallet>> items;
 	std::multimap<nano::uint128_t, std::pair<std::shared_ptr<nano::wallet>, std::function<void(nano::wallet &)>>, std::greater<nano::uint128_t>> actions;
-	nano::locked<std::unordered_map<nano::account, nano::root>> delayed_work;
 	nano::mutex mutex;
 	nano::mutex action_mutex;
 	nano::condition_variable condition;
@@ -248,8 +355,8 @@ public:
 	nano::mdb_env & env;
 	std::atomic<bool> stopped;
 	std::shared_ptr<nano::work_watcher> watcher;
+	nano::work_precache precache;
 	std::thread thread;
-	static nano::uint128_t const generate_priority;
 	static nano::uint128_t const high_priority;
 	/** Start read-write transaction */
 	nano::write_transaction tx_begin_write ();
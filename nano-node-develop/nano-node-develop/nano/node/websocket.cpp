@@ -1,7 +1,9 @@
 #include <nano/boost/asio/bind_executor.hpp>
 #include <nano/boost/asio/dispatch.hpp>
 #include <nano/boost/asio/strand.hpp>
+#include <nano/ipc_flatbuffers_lib/flatbuffer_producer.hpp>
 #include <nano/lib/work.hpp>
+#include <nano/node/ipc/flatbuffers_util.hpp>
 #include <nano/node/transport/transport.hpp>
 #include <nano/node/wallet.hpp>
 #include <nano/node/websocket.hpp>
@@ -244,7 +246,7 @@ nano::websocket::session::~session ()
 		nano::unique_lock<nano::mutex> lk (subscriptions_mutex);
 		for (auto & subscription : subscriptions)
 		{
-			ws_listener.decrease_subscriber_count (subscription.first);
+			ws_listener.decrease_subscriber_count (subscription.first, subscription.second->encoding);
 		}
 	}
 }
@@ -286,12 +288,17 @@ void nano::websocket::session::write (nano::websocket::message message_a)
 	auto subscription (subscriptions.find (message_a.topic));
 	if (message_a.topic == nano::websocket::topic::ack || (subscription != subscriptions.end () && !subscription->second->should_filter (message_a)))
 	{
+		auto encoding_l (nano::websocket::encoding::json);
+		if (subscription != subscriptions.end () && subscription->second->encoding == nano::websocket::encoding::flatbuffers && message_a.flatbuffer != nullptr)
+		{
+			encoding_l = nano::websocket::encoding::flatbuffers;
+		}
 		lk.unlock ();
 		auto this_l (shared_from_this ());
 		boost::asio::post (strand,
-		[message_a, this_l]() {
+		[message_a, encoding_l, this_l]() {
 			bool write_in_progress = !this_l->send_queue.empty ();
-			this_l->send_queue.emplace_back (message_a);
+			this_l->send_queue.emplace_back (message_a, encoding_l);
 			if (!write_in_progress)
 			{
 				this_l->write_queued_messages ();
@@ -302,11 +309,9 @@ void nano::websocket::session::write (nano::websocket::message message_a)
 
 void nano::websocket::session::write_queued_messages ()
 {
-	auto msg (send_queue.front ().to_string ());
+	auto const & front (send_queue.front ());
 	auto this_l (shared_from_this ());
-
-	ws.async_write (nano::shared_const_buffer (msg),
-	boost::asio::bind_executor (strand,
+	auto handler (boost::asio::bind_executor (strand,
 	[this_l](boost::system::error_code ec, std::size_t bytes_transferred) {
 		this_l->send_queue.pop_front ();
 		if (!ec)
@@ -317,6 +322,19 @@ void nano::websocket::session::write_queued_messages ()
 			}
 		}
 	}));
+
+	if (front.second == nano::websocket::encoding::flatbuffers)
+	{
+		// The buffer is owned by the message, which stays in the queue until the write completes
+		auto const & flatbuffer (*front.first.flatbuffer);
+		ws.binary (true);
+		ws.async_write (boost::asio::buffer (flatbuffer.GetBufferPointer (), flatbuffer.GetSize ()), handler);
+	}
+	else
+	{
+		ws.text (true);
+		ws.async_write (nano::shared_const_buffer (front.first.to_string ()), handler);
+	}
 }
 
 void nano::websocket::session::read ()
@@ -443,6 +461,25 @@ std::string from_topic (nano::websocket::topic topic_a)
 
 	return topic;
 }
+
+nano::websocket::encoding to_encoding (std::string const & encoding_a, bool & error_a)
+{
+	auto encoding (nano::websocket::encoding::json);
+	if (encoding_a == "flatbuffers")
+	{
+		encoding = nano::websocket::encoding::flatbuffers;
+	}
+	else if (encoding_a != "json")
+	{
+		error_a = true;
+	}
+	return encoding;
+}
+}
+
+bool nano::websocket::supports_flatbuffers (nano::websocket::topic topic_a)
+{
+	return topic_a == nano::websocket::topic::confirmation || topic_a == nano::websocket::topic::vote || topic_a == nano::websocket::topic::telemetry || topic_a == nano::websocket::topic::new_unconfirmed_block;
 }
 
 void nano::websocket::session::send_ack (std::string action_a, std::string id_a)
@@ -465,8 +502,15 @@ void nano::websocket::session::handle_message (boost::property_tree::ptree const
 	auto ack_l (message_a.get<bool> ("ack", false));
 	auto id_l (message_a.get<std::string> ("id", ""));
 	auto action_succeeded (false);
-	if (action == "subscribe" && topic_l != nano::websocket::topic::invalid)
+	auto encoding_error_l (false);
+	auto encoding_l (to_encoding (message_a.get<std::string> ("encoding", "json"), encoding_error_l));
+	if (action == "subscribe" && topic_l != nano::websocket::topic::invalid && !encoding_error_l)
 	{
+		if (encoding_l == nano::websocket::encoding::flatbuffers && !nano::websocket::supports_flatbuffers (topic_l))
+		{
+			ws_listener.get_logger ().always_log ("Websocket: flatbuffers encoding is not supported for topic: ", from_topic (topic_l), ", using json");
+			encoding_l = nano::websocket::encoding::json;
+		}
 		auto options_text_l (message_a.get_child_optional ("options"));
 		nano::lock_guard<nano::mutex> lk (subscriptions_mutex);
 		std::unique_ptr<nano::websocket::options> options_l{ nullptr };
@@ -482,9 +526,12 @@ void nano::websocket::session::handle_message (boost::property_tree::ptree const
 		{
 			options_l = std::make_unique<nano::websocket::options> ();
 		}
+		options_l->encoding = encoding_l;
 		auto existing (subscriptions.find (topic_l));
 		if (existing != subscriptions.end ())
 		{
+			ws_listener.decrease_subscriber_count (topic_l, existing->second->encoding);
+			ws_listener.increase_subscriber_count (topic_l, encoding_l);
 			existing->second = std::move (options_l);
 			ws_listener.get_logger ().always_log ("Websocket: updated subscription to topic: ", from_topic (topic_l));
 		}
@@ -492,7 +539,7 @@ void nano::websocket::session::handle_message (boost::property_tree::ptree const
 		{
 			subscriptions.emplace (topic_l, std::move (options_l));
 			ws_listener.get_logger ().always_log ("Websocket: new subscription to topic: ", from_topic (topic_l));
-			ws_listener.increase_subscriber_count (topic_l);
+			ws_listener.increase_subscriber_count (topic_l, encoding_l);
 		}
 		action_succeeded = true;
 	}
@@ -512,10 +559,12 @@ void nano::websocket::session::handle_message (boost::property_tree::ptree const
 	else if (action == "unsubscribe" && topic_l != nano::websocket::topic::invalid)
 	{
 		nano::lock_guard<nano::mutex> lk (subscriptions_mutex);
-		if (subscriptions.erase (topic_l))
+		auto existing (subscriptions.find (topic_l));
+		if (existing != subscriptions.end ())
 		{
+			ws_listener.decrease_subscriber_count (topic_l, existing->second->encoding);
+			subscriptions.erase (existing);
 			ws_listener.get_logger ().always_log ("Websocket: removed subscription to topic: ", from_topic (topic_l));
-			ws_listener.decrease_subscriber_count (topic_l);
 		}
 		action_succeeded = true;
 	}
@@ -560,6 +609,10 @@ socket (io_ctx_a)
 		{
 			item = std::size_t (0);
 		}
+		for (std::atomic<std::size_t> & item : topic_flatbuffers_subscriber_count)
+		{
+			item = std::size_t (0);
+		}
 		acceptor.open (endpoint_a.protocol ());
 		acceptor.set_option (boost::asio::socket_base::reuse_address (true));
 		acceptor.bind (endpoint_a);
@@ -614,7 +667,7 @@ void nano::websocket::listener::on_accept (boost::system::error_code ec)
 
 void nano::websocket::listener::broadcast_confirmation (std::shared_ptr<nano::block> const & block_a, nano::account const & account_a, nano::amount const & amount_a, std::string const & subtype, nano::election_status const & election_status_a, std::vector<nano::vote_with_weight_info> const & election_votes_a)
 {
-	nano::websocket::message_builder builder;
+	nano::websocket::message_builder builder (any_flatbuffers_subscriber (nano::websocket::topic::confirmation));
 
 	nano::lock_guard<nano::mutex> lk (sessions_mutex);
 	boost::optional<nano::websocket::message> msg_with_block;
@@ -667,16 +720,31 @@ void nano::websocket::listener::broadcast (nano::websocket::message message_a)
 	}
 }
 
-void nano::websocket::listener::increase_subscriber_count (nano::websocket::topic const & topic_a)
+void nano::websocket::listener::increase_subscriber_count (nano::websocket::topic const & topic_a, nano::websocket::encoding encoding_a)
 {
 	topic_subscriber_count[static_cast<std::size_t> (topic_a)] += 1;
+	if (encoding_a == nano::websocket::encoding::flatbuffers)
+	{
+		topic_flatbuffers_subscriber_count[static_cast<std::size_t> (topic_a)] += 1;
+	}
 }
 
-void nano::websocket::listener::decrease_subscriber_count (nano::websocket::topic const & topic_a)
+void nano::websocket::listener::decrease_subscriber_count (nano::websocket::topic const & topic_a, nano::websocket::encoding encoding_a)
 {
 	auto & count (topic_subscriber_count[static_cast<std::size_t> (topic_a)]);
 	release_assert (count > 0);
 	count -= 1;
+	if (encoding_a == nano::websocket::encoding::flatbuffers)
+	{
+		auto & flatbuffers_count (topic_flatbuffers_subscriber_count[static_cast<std::size_t> (topic_a)]);
+		release_assert (flatbuffers_count > 0);
+		flatbuffers_count -= 1;
+	}
+}
+
+nano::websocket::message_builder::message_builder (bool flatbuffers_a) :
+include_flatbuffers (flatbuffers_a)
+{
 }
 
 nano::websocket::message nano::websocket::message_builder::stopped_election (nano::block_hash const & hash_a)
@@ -758,6 +826,13 @@ nano::websocket::message nano::websocket::message_builder::block_confirmed (std:
 
 	message_l.contents.add_child ("message", message_node_l);
 
+	if (include_flatbuffers)
+	{
+		auto is_state_send (block_a->type () == nano::block_type::state && subtype == "send");
+		auto confirmation_l (nano::ipc::flatbuffers_builder::from (election_status_a, election_votes_a, account_a, amount_a, is_state_send, include_block_a, options_a.get_include_election_info () || options_a.get_include_election_info_with_votes (), options_a.get_include_election_info_with_votes ()));
+		message_l.flatbuffer = nano::ipc::flatbuffer_producer::make_buffer (*confirmation_l);
+	}
+
 	return message_l;
 }
 
@@ -789,6 +864,11 @@ nano::websocket::message nano::websocket::message_builder::vote_received (std::s
 	}
 	vote_node_l.put ("type", vote_type);
 	message_l.contents.add_child ("message", vote_node_l);
+
+	if (include_flatbuffers)
+	{
+		message_l.flatbuffer = nano::ipc::flatbuffer_producer::make_buffer (*nano::ipc::flatbuffers_builder::from (*vote_a, code_a));
+	}
 	return message_l;
 }
 
@@ -909,10 +989,15 @@ nano::websocket::message nano::websocket::message_builder::telemetry_received (n
 	telemetry_l.put ("port", endpoint_a.port ());
 
 	message_l.contents.add_child ("message", telemetry_l.get_tree ());
+
+	if (include_flatbuffers)
+	{
+		message_l.flatbuffer = nano::ipc::flatbuffer_producer::make_buffer (*nano::ipc::flatbuffers_builder::from (telemetry_data_a, endpoint_a.address ().to_string (), endpoint_a.port ()));
+	}
 	return message_l;
 }
 
-nano::websocket::message nano::websocket::message_builder::new_block_arrived (nano::block const & block_a)
+nano::websocket::message nano::websocket::message_builder::new_block_arrived (nano::block const & block_a, nano::amount const & amount_a)
 {
 	nano::websocket::message message_l (nano::websocket::topic::new_unconfirmed_block);
 	set_common_fields (message_l);
@@ -923,6 +1008,11 @@ nano::websocket::message nano::websocket::message_builder::new_block_arrived (na
 	block_l.put ("subtype", subtype);
 
 	message_l.contents.add_child ("message", block_l);
+
+	if (include_flatbuffers)
+	{
+		message_l.flatbuffer = nano::ipc::flatbuffer_producer::make_buffer (*nano::ipc::flatbuffers_builder::from (block_a, amount_a));
+	}
 	return message_l;
 }
 
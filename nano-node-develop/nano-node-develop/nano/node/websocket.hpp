@@ -29,6 +29,11 @@ using socket_type = boost::asio::basic_stream_socket<boost::asio::ip::tcp, boost
 #define beast_buffers boost::beast::make_printable
 #endif
 
+namespace flatbuffers
+{
+class FlatBufferBuilder;
+}
+
 namespace nano
 {
 class wallets;
@@ -70,6 +75,18 @@ namespace websocket
 	};
 	constexpr size_t number_topics{ static_cast<size_t> (topic::_length) - static_cast<size_t> (topic::invalid) };
 
+	/** Encoding of outgoing messages, chosen per subscription */
+	enum class encoding
+	{
+		/** Text frames containing JSON */
+		json,
+		/** Binary frames containing a nanoapi::Envelope, as defined in api/flatbuffers/nanoapi.fbs */
+		flatbuffers
+	};
+
+	/** Returns true if messages of \p topic_a can be sent with the flatbuffers encoding */
+	bool supports_flatbuffers (nano::websocket::topic topic_a);
+
 	/** A message queued for broadcasting */
 	class message final
 	{
@@ -86,12 +103,16 @@ namespace websocket
 		std::string to_string () const;
 		nano::websocket::topic topic;
 		boost::property_tree::ptree contents;
+		/** Flatbuffers encoding of the message, only set if requested from the builder. Shared between all sessions. */
+		std::shared_ptr<flatbuffers::FlatBufferBuilder> flatbuffer;
 	};
 
 	/** Message builder. This is expanded with new builder functions are necessary. */
 	class message_builder final
 	{
 	public:
+		/** If \p flatbuffers_a is true, messages of topics supporting it are also encoded as flatbuffers */
+		explicit message_builder (bool flatbuffers_a = false);
 		message block_confirmed (std::shared_ptr<nano::block> const & block_a, nano::account const & account_a, nano::amount const & amount_a, std::string subtype, bool include_block, nano::election_status const & election_status_a, std::vector<nano::vote_with_weight_info> const & election_votes_a, nano::websocket::confirmation_options const & options_a);
 		message stopped_election (nano::block_hash const & hash_a);
 		message vote_received (std::shared_ptr<nano::vote> const & vote_a, nano::vote_code code_a);
@@ -102,11 +123,12 @@ namespace websocket
 		message bootstrap_started (std::string const & id_a, std::string const & mode_a);
 		message bootstrap_exited (std::string const & id_a, std::string const & mode_a, std::chrono::steady_clock::time_point const start_time_a, uint64_t const total_blocks_a);
 		message telemetry_received (nano::telemetry_data const &, nano::endpoint const &);
-		message new_block_arrived (nano::block const & block_a);
+		message new_block_arrived (nano::block const & block_a, nano::amount const & amount_a);
 
 	private:
 		/** Set the common fields for messages: timestamp and topic. */
 		void set_common_fields (message & message_a);
+		bool const include_flatbuffers;
 	};
 
 	/** Options for subscriptions */
@@ -134,6 +156,9 @@ namespace websocket
 			return true;
 		}
 
+		/** Encoding requested by the subscriber, only honored for topics which support it */
+		nano::websocket::encoding encoding{ nano::websocket::encoding::json };
+
 		friend class session;
 	};
 
@@ -261,8 +286,8 @@ namespace websocket
 		boost::beast::multi_buffer read_buffer;
 		/** All websocket operations that are thread unsafe must go through a strand. */
 		boost::asio::strand<boost::asio::io_context::executor_type> strand;
-		/** Outgoing messages. The send queue is protected by accessing it only through the strand */
-		std::deque<message> send_queue;
+		/** Outgoing messages and their encoding. The send queue is protected by accessing it only through the strand */
+		std::deque<std::pair<message, nano::websocket::encoding>> send_queue;
 
 		/** Hash functor for topic enums */
 		struct topic_hash
@@ -328,15 +353,20 @@ namespace websocket
 		{
 			return topic_subscriber_count[static_cast<std::size_t> (topic_a)];
 		}
+		/** Per-topic check for subscribers using the flatbuffers encoding, used to avoid encoding messages nobody will read */
+		bool any_flatbuffers_subscriber (nano::websocket::topic const & topic_a) const
+		{
+			return topic_flatbuffers_subscriber_count[static_cast<std::size_t> (topic_a)] > 0;
+		}
 
 	private:
 		/** A websocket session can increase and decrease subscription counts. */
 		friend nano::websocket::session;
 
 		/** Adds to subscription count of a specific topic*/
-		void increase_subscriber_count (nano::websocket::topic const & topic_a);
+		void increase_subscriber_count (nano::websocket::topic const & topic_a, nano::websocket::encoding encoding_a);
 		/** Removes from subscription count of a specific topic*/
-		void decrease_subscriber_count (nano::websocket::topic const & topic_a);
+		void decrease_subscriber_count (nano::websocket::topic const & topic_a, nano::websocket::encoding encoding_a);
 
 		nano::logger_mt & logger;
 		nano::wallets & wallets;
@@ -345,6 +375,7 @@ namespace websocket
 		nano::mutex sessions_mutex;
 		std::vector<std::weak_ptr<session>> sessions;
 		std::array<std::atomic<std::size_t>, number_topics> topic_subscriber_count;
+		std::array<std::atomic<std::size_t>, number_topics> topic_flatbuffers_subscriber_count;
 		std::atomic<bool> stopped{ false };
 	};
 }
@@ -169,7 +169,9 @@ std::unordered_set<std::string> create_rpc_control_impls ()
 	set.emplace ("search_pending");
 	set.emplace ("search_pending_all");
 	set.emplace ("send");
+	set.emplace ("send_batch");
 	set.emplace ("stop");
+	set.emplace ("trace_dump");
 	set.emplace ("unchecked_clear");
 	set.emplace ("unopened");
 	set.emplace ("wallet_add");
@@ -8,14 +8,18 @@
 nano::rpc_request_processor::rpc_request_processor (boost::asio::io_context & io_ctx, nano::rpc_config & rpc_config) :
 ipc_address (rpc_config.rpc_process.ipc_address),
 ipc_port (rpc_config.rpc_process.ipc_port),
+ipc_shared_memory (rpc_config.rpc_process.ipc_shared_memory),
+io_ctx (io_ctx),
 thread ([this]() {
 	nano::thread_role::set (nano::thread_role::name::rpc_request_processor);
 	this->run ();
 })
 {
 	nano::lock_guard<nano::mutex> lk (this->request_mutex);
-	this->connections.reserve (rpc_config.rpc_process.num_ipc_connections);
-	for (auto i = 0u; i < rpc_config.rpc_process.num_ipc_connections; ++i)
+	// With shared memory, requests do not need a pool of connections
+	auto num_ipc_connections (ipc_shared_memory.empty () ? rpc_config.rpc_process.num_ipc_connections : 0);
+	this->connections.reserve (num_ipc_connections);
+	for (auto i = 0u; i < num_ipc_connections; ++i)
 	{
 		connections.push_back (std::make_shared<nano::ipc_connection> (nano::ipc::ipc_client (io_ctx), false));
 		auto connection = this->connections.back ();
@@ -121,13 +125,60 @@ void nano::rpc_request_processor::try_reconnect_and_execute_request (std::shared
 	});
 }
 
+void nano::rpc_request_processor::execute_shared_memory (std::shared_ptr<nano::rpc_request> const & rpc_request)
+{
+	// A new client is needed once the node restarts or drops the connection
+	if (!shm_client || !shm_client->connected ())
+	{
+		shm_client = nullptr;
+		auto client (std::make_unique<nano::ipc::shm_client> ());
+		if (!client->connect (ipc_shared_memory))
+		{
+			shm_client = std::move (client);
+		}
+	}
+	if (shm_client)
+	{
+		auto encoding (rpc_request->rpc_api_version == 1 ? nano::ipc::payload_encoding::json_v1 : nano::ipc::payload_encoding::flatbuffers_json);
+		// Callbacks run on the client's receiving thread, which must not block, so responses are written from the io threads
+		shm_client->async_request (encoding, rpc_request->body, [this, rpc_request](nano::error const & error_a, std::string const & response_a) {
+			io_ctx.post ([this, rpc_request, error = static_cast<bool> (error_a), response_a]() {
+				if (!error)
+				{
+					rpc_request->response (response_a);
+					if (rpc_request->action == "stop")
+					{
+						this->stop_callback ();
+					}
+				}
+				else
+				{
+					json_error_response (rpc_request->response, "Connection to node has failed");
+				}
+			});
+		});
+	}
+	else
+	{
+		json_error_response (rpc_request->response, "There is a problem connecting to the node. Make sure ipc->shared_memory is enabled in the node config and its name matches ipc_shared_memory");
+	}
+}
+
 void nano::rpc_request_processor::run ()
 {
 	// This should be a conditioned wait
 	nano::unique_lock<nano::mutex> lk (request_mutex);
 	while (!stopped)
 	{
-		if (!requests.empty ())
+		if (!requests.empty () && !ipc_shared_memory.empty ())
+		{
+			auto rpc_request = requests.front ();
+			requests.pop_front ();
+			lk.unlock ();
+			execute_shared_memory (rpc_request);
+			lk.lock ();
+		}
+		else if (!requests.empty ())
 		{
 			lk.unlock ();
 			nano::unique_lock<nano::mutex> conditions_lk (connections_mutex);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <nano/lib/ipc_client.hpp>
+#include <nano/lib/ipc_shm.hpp>
 #include <nano/lib/rpc_handler_interface.hpp>
 #include <nano/lib/rpcconfig.hpp>
 #include <nano/rpc/rpc.hpp>
@@ -57,6 +58,7 @@ private:
 	void read_payload (std::shared_ptr<nano::ipc_connection> const & connection, std::shared_ptr<std::vector<uint8_t>> const & res, std::shared_ptr<nano::rpc_request> const & rpc_request);
 	void try_reconnect_and_execute_request (std::shared_ptr<nano::ipc_connection> const & connection, nano::shared_const_buffer const & req, std::shared_ptr<std::vector<uint8_t>> const & res, std::shared_ptr<nano::rpc_request> const & rpc_request);
 	void make_available (nano::ipc_connection & connection);
+	void execute_shared_memory (std::shared_ptr<nano::rpc_request> const & rpc_request);
 
 	std::vector<std::shared_ptr<nano::ipc_connection>> connections;
 	nano::mutex request_mutex;
@@ -66,6 +68,10 @@ private:
 	nano::condition_variable condition;
 	const std::string ipc_address;
 	const uint16_t ipc_port;
+	const std::string ipc_shared_memory;
+	boost::asio::io_context & io_ctx;
+	/** Used instead of the connections when ipc_shared_memory is set. Many requests can be outstanding on it. Only replaced by the request thread. */
+	std::unique_ptr<nano::ipc::shm_client> shm_client;
 	std::thread thread;
 };
 
@@ -2,6 +2,7 @@
 #include <nano/boost/beast/http.hpp>
 #include <nano/lib/rpcconfig.hpp>
 #include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/ipc/ipc_server.hpp>
 #include <nano/node/json_handler.hpp>
 #include <nano/node/node_rpc_config.hpp>
@@ -452,6 +453,67 @@ TEST (rpc, send)
 	ASSERT_NE (node->balance (nano::dev_genesis_key.pub), nano::genesis_amount);
 }
 
+TEST (rpc, send_batch)
+{
+	nano::system system;
+	auto node = add_ipc_enabled_node (system);
+	system.wallet (0)->insert_adhoc (nano::dev_genesis_key.prv);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	nano::rpc_config rpc_config (nano::get_available_port (), true);
+	rpc_config.rpc_process.ipc_port = node->config.ipc_config.transport_tcp.port;
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	nano::keypair key;
+	boost::property_tree::ptree request;
+	std::string wallet;
+	node->wallets.items.begin ()->first.encode_hex (wallet);
+	request.put ("wallet", wallet);
+	request.put ("action", "send_batch");
+	boost::property_tree::ptree sends;
+	for (auto amount : { "1", "2", "3" })
+	{
+		boost::property_tree::ptree send;
+		send.put ("source", nano::dev_genesis_key.pub.to_account ());
+		send.put ("destination", key.pub.to_account ());
+		send.put ("amount", amount);
+		sends.push_back (std::make_pair ("", send));
+	}
+	boost::property_tree::ptree unknown;
+	unknown.put ("source", key.pub.to_account ());
+	unknown.put ("destination", key.pub.to_account ());
+	unknown.put ("amount", "1");
+	sends.push_back (std::make_pair ("", unknown));
+	request.add_child ("sends", sends);
+	test_response response (request, rpc.config.port, system.io_ctx);
+	ASSERT_TIMELY (10s, response.status != 0);
+	ASSERT_EQ (200, response.status);
+	// Items are reported in the order they complete, with their index
+	std::vector<boost::property_tree::ptree> blocks (4);
+	size_t count (0);
+	for (auto const & block : response.json.get_child ("blocks"))
+	{
+		blocks[block.second.get<size_t> ("index")] = block.second;
+		++count;
+	}
+	ASSERT_EQ (4, count);
+	nano::block_hash previous (nano::genesis_hash);
+	for (auto i (0); i < 3; ++i)
+	{
+		nano::block_hash hash;
+		ASSERT_FALSE (hash.decode_hex (blocks[i].get<std::string> ("block")));
+		auto block (node->store.block_get (node->store.tx_begin_read (), hash));
+		ASSERT_NE (nullptr, block);
+		ASSERT_EQ (previous, block->previous ());
+		previous = hash;
+	}
+	ASSERT_EQ (std::error_code (nano::error_common::account_not_found_wallet).message (), blocks[3].get<std::string> ("error"));
+	ASSERT_EQ (previous, node->latest (nano::dev_genesis_key.pub));
+	ASSERT_EQ (nano::genesis_amount - 6, node->balance (nano::dev_genesis_key.pub));
+}
+
 TEST (rpc, send_fail)
 {
 	nano::system system;
@@ -2548,6 +2610,132 @@ TEST (rpc, pending)
 	}
 }
 
+TEST (rpc, account_index)
+{
+	nano::system system;
+	auto node = add_ipc_enabled_node (system);
+	nano::keypair key1;
+	system.wallet (0)->insert_adhoc (nano::dev_genesis_key.prv);
+	std::vector<std::shared_ptr<nano::block>> sends;
+	for (auto amount : { 100, 300, 200, 400 })
+	{
+		sends.push_back (system.wallet (0)->send_action (nano::dev_genesis_key.pub, key1.pub, amount));
+		ASSERT_NE (nullptr, sends.back ());
+	}
+	scoped_io_thread_name_change scoped_thread_name_io;
+	ASSERT_TIMELY (5s, !node->active.active (*sends.back ()));
+	{
+		auto transaction (node->store.tx_begin_write ({ nano::tables::account_heights, nano::tables::meta, nano::tables::pending_amounts }));
+		node->ledger.account_index_build (transaction);
+	}
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	nano::rpc_config rpc_config (nano::get_available_port (), true);
+	rpc_config.rpc_process.ipc_port = node->config.ipc_config.transport_tcp.port;
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	boost::property_tree::ptree request;
+	request.put ("action", "pending");
+	request.put ("account", key1.pub.to_account ());
+	request.put ("threshold", "200");
+	request.put ("sorting", "true");
+	{
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		std::vector<std::pair<nano::block_hash, std::string>> blocks;
+		for (auto & entry : response.json.get_child ("blocks"))
+		{
+			blocks.emplace_back (nano::block_hash (entry.first), entry.second.get<std::string> (""));
+		}
+		std::vector<std::pair<nano::block_hash, std::string>> expected{ { sends[3]->hash (), "400" }, { sends[1]->hash (), "300" }, { sends[2]->hash (), "200" } };
+		ASSERT_EQ (expected, blocks);
+	}
+	// Without sorting the selection and order match a scan of the pending table
+	request.erase ("sorting");
+	request.put ("count", "2");
+	{
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		std::vector<nano::block_hash> blocks;
+		for (auto & entry : response.json.get_child ("blocks"))
+		{
+			blocks.emplace_back (entry.first);
+		}
+		std::vector<nano::block_hash> expected{ sends[1]->hash (), sends[2]->hash (), sends[3]->hash () };
+		std::sort (expected.begin (), expected.end ());
+		expected.pop_back ();
+		ASSERT_EQ (expected, blocks);
+	}
+	std::vector<std::string> heights;
+	std::string cursor;
+	auto history = [&system, &rpc, &heights, &cursor](boost::property_tree::ptree const & request_a) {
+		test_response response (request_a, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		heights.clear ();
+		for (auto & entry : response.json.get_child ("history"))
+		{
+			heights.push_back (entry.second.get<std::string> ("height"));
+		}
+		cursor = response.json.get<std::string> ("cursor", "");
+	};
+	boost::property_tree::ptree history_request;
+	history_request.put ("action", "account_history");
+	history_request.put ("account", nano::dev_genesis_key.pub.to_account ());
+	history_request.put ("count", "2");
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "5", "4" }), heights);
+	ASSERT_FALSE (cursor.empty ());
+	history_request.erase ("account");
+	auto first_page (cursor);
+	// A reverse query resumes from the same cursor in the other direction
+	history_request.put ("cursor", first_page);
+	history_request.put ("reverse", "true");
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "4", "5" }), heights);
+	ASSERT_TRUE (cursor.empty ());
+	history_request.erase ("reverse");
+	history_request.put ("cursor", first_page);
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "3", "2" }), heights);
+	auto second_page (cursor);
+	history_request.put ("cursor", second_page);
+	history_request.put ("reverse", "true");
+	history_request.put ("count", "1");
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "2" }), heights);
+	history_request.put ("cursor", cursor);
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "3" }), heights);
+	history_request.erase ("reverse");
+	history_request.put ("count", "2");
+	cursor = second_page;
+	history_request.put ("cursor", cursor);
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "1" }), heights);
+	ASSERT_TRUE (cursor.empty ());
+	// Offsets are resolved with a single index lookup
+	history_request.erase ("cursor");
+	history_request.put ("account", nano::dev_genesis_key.pub.to_account ());
+	history_request.put ("offset", "3");
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "2", "1" }), heights);
+	history_request.put ("reverse", "true");
+	history_request.put ("offset", "1");
+	history (history_request);
+	ASSERT_EQ ((std::vector<std::string>{ "2", "3" }), heights);
+	history_request.erase ("account");
+	history_request.put ("cursor", "00");
+	{
+		test_response response (history_request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (std::error_code (nano::error_rpc::bad_cursor).message (), response.json.get<std::string> ("error"));
+	}
+}
+
 TEST (rpc, pending_burn)
 {
 	nano::system system;
@@ -4161,6 +4349,90 @@ TEST (rpc, accounts_frontiers)
 	}
 }
 
+// Enough accounts to be split across the worker threads, the response must still be in request order
+TEST (rpc, accounts_balances_parallel)
+{
+	nano::system system;
+	auto node = add_ipc_enabled_node (system);
+	nano::keypair key;
+	nano::genesis genesis;
+	nano::send_block send (genesis.hash (), key.pub, nano::genesis_amount - 100, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis.hash ()));
+	ASSERT_EQ (nano::process_result::progress, node->process (send).code);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	nano::node_rpc_config node_rpc_config;
+	node_rpc_config.max_request_parallelism = 4;
+	ASSERT_GT (node->workers.get_num_threads (), 1u);
+	nano::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	nano::rpc_config rpc_config (nano::get_available_port (), true);
+	rpc_config.rpc_process.ipc_port = node->config.ipc_config.transport_tcp.port;
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	std::vector<nano::account> accounts;
+	for (auto i (0); i < 500; ++i)
+	{
+		accounts.push_back (nano::keypair ().pub);
+	}
+	accounts[100] = key.pub;
+	accounts[400] = nano::dev_genesis_key.pub;
+	boost::property_tree::ptree accounts_l;
+	for (auto const & account : accounts)
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("", account.to_account ());
+		accounts_l.push_back (std::make_pair ("", entry));
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "accounts_balances");
+		request.add_child ("accounts", accounts_l);
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		// Each shard is counted once it has visited its accounts
+		ASSERT_EQ (std::min<uint64_t> (node_rpc_config.max_request_parallelism, node->workers.get_num_threads ()), node->stats.count (nano::stat::type::rpc, nano::stat::detail::request_shard));
+		auto & balances (response.json.get_child ("balances"));
+		ASSERT_EQ (accounts.size (), balances.size ());
+		auto i (accounts.begin ());
+		for (auto & balance : balances)
+		{
+			ASSERT_EQ (i->to_account (), balance.first);
+			nano::uint128_t expected (*i == nano::dev_genesis_key.pub ? nano::genesis_amount - 100 : 0);
+			ASSERT_EQ (expected.convert_to<std::string> (), balance.second.get<std::string> ("balance"));
+			ASSERT_EQ (*i == key.pub ? "100" : "0", balance.second.get<std::string> ("pending"));
+			++i;
+		}
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "accounts_frontiers");
+		request.add_child ("accounts", accounts_l);
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		auto & frontiers (response.json.get_child ("frontiers"));
+		ASSERT_EQ (1, frontiers.size ());
+		ASSERT_EQ (send.hash ().to_string (), frontiers.get<std::string> (nano::dev_genesis_key.pub.to_account ()));
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "accounts_pending");
+		request.add_child ("accounts", accounts_l);
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		auto & blocks (response.json.get_child ("blocks"));
+		ASSERT_EQ (accounts.size (), blocks.size ());
+		auto i (accounts.begin ());
+		for (auto & pending : blocks)
+		{
+			ASSERT_EQ (i->to_account (), pending.first);
+			ASSERT_EQ (*i == key.pub ? 1 : 0, pending.second.size ());
+			++i;
+		}
+	}
+}
+
 TEST (rpc, accounts_pending)
 {
 	nano::system system;
@@ -6498,6 +6770,51 @@ TEST (rpc, stats_clear)
 	ASSERT_LE (node->stats.last_reset ().count (), 5);
 }
 
+TEST (rpc, trace_dump)
+{
+	nano::system system;
+	nano::node_config node_config (nano::get_available_port (), system.logging);
+	node_config.diagnostics_config.tracing.enable = true;
+	node_config.diagnostics_config.tracing.sample_rate = 1;
+	// Tracing is process wide, the daemon configures it from the node config
+	nano::tracing::configure (node_config.diagnostics_config.tracing);
+	auto node = add_ipc_enabled_node (system, node_config);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	nano::rpc_config rpc_config (nano::get_available_port (), true);
+	rpc_config.rpc_process.ipc_port = node->config.ipc_config.transport_tcp.port;
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	nano::genesis genesis;
+	auto send (std::make_shared<nano::send_block> (genesis.hash (), nano::dev_genesis_key.pub, nano::genesis_amount - 100, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	node->process_active (send);
+	ASSERT_TIMELY (5s, node->block (send->hash ()) != nullptr);
+	boost::property_tree::ptree request;
+	request.put ("action", "trace_dump");
+	request.put ("clear", "true");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	ASSERT_TIMELY (5s, response.status != 0);
+	ASSERT_EQ (200, response.status);
+#if NANO_TRACING
+	auto hash_id (nano::to_string_hex (nano::tracing::id (send->hash ())));
+	auto processed (false);
+	for (auto const & event : response.json.get_child ("traceEvents"))
+	{
+		if (event.second.get<std::string> ("name") == "block_process")
+		{
+			processed = processed || event.second.get<std::string> ("args.id") == hash_id;
+			ASSERT_EQ ("X", event.second.get<std::string> ("ph"));
+		}
+	}
+	ASSERT_TRUE (processed);
+#else
+	ASSERT_EQ (std::error_code (nano::error_rpc::tracing_unavailable).message (), response.json.get<std::string> ("error"));
+#endif
+	nano::tracing::configure (nano::tracing_config{});
+}
+
 TEST (rpc, unchecked)
 {
 	nano::system system;
@@ -8105,3 +8422,112 @@ TEST (rpc, confirmation_info)
 		ASSERT_EQ (0, response.json.get<unsigned> ("total_tally"));
 	}
 }
+
+// The hot actions stream their responses with nano::json_writer, which must stay byte-compatible with write_json
+TEST (rpc, streamed_responses_byte_compatible)
+{
+	nano::system system;
+	auto & node1 = *add_ipc_enabled_node (system);
+	nano::keypair key;
+	nano::genesis genesis;
+	nano::send_block send (genesis.hash (), key.pub, nano::genesis_amount - 100, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis.hash ()));
+	ASSERT_EQ (nano::process_result::progress, node1.process (send).code);
+	nano::open_block open (send.hash (), nano::dev_genesis_key.pub, key.pub, key.prv, key.pub, *system.work.generate (key.pub));
+	ASSERT_EQ (nano::process_result::progress, node1.process (open).code);
+	nano::state_block send2 (nano::dev_genesis_key.pub, send.hash (), nano::dev_genesis_key.pub, nano::genesis_amount - 200, key.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (send.hash ()));
+	ASSERT_EQ (nano::process_result::progress, node1.process (send2).code);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc_server (node1, node_rpc_config);
+	nano::rpc_config rpc_config (nano::get_available_port (), true);
+	rpc_config.rpc_process.ipc_port = node1.config.ipc_config.transport_tcp.port;
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+
+	std::vector<boost::property_tree::ptree> requests;
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "account_history");
+		request.put ("account", nano::dev_genesis_key.pub.to_account ());
+		request.put ("count", "10");
+		requests.push_back (request);
+		request.put ("raw", "true");
+		request.put ("reverse", "true");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "blocks_info");
+		boost::property_tree::ptree hashes;
+		for (auto const & hash : { send.hash (), open.hash (), send2.hash (), nano::block_hash (1) })
+		{
+			boost::property_tree::ptree entry;
+			entry.put ("", hash.to_string ());
+			hashes.push_back (std::make_pair ("", entry));
+		}
+		request.add_child ("hashes", hashes);
+		request.put ("include_not_found", "true");
+		request.put ("source", "true");
+		request.put ("pending", "true");
+		requests.push_back (request);
+		request.put ("json_block", "true");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "accounts_balances");
+		boost::property_tree::ptree accounts;
+		for (auto const & account : { nano::dev_genesis_key.pub, key.pub })
+		{
+			boost::property_tree::ptree entry;
+			entry.put ("", account.to_account ());
+			accounts.push_back (std::make_pair ("", entry));
+		}
+		request.add_child ("accounts", accounts);
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "pending");
+		request.put ("account", key.pub.to_account ());
+		request.put ("count", "10");
+		requests.push_back (request);
+		request.put ("source", "true");
+		request.put ("min_version", "true");
+		requests.push_back (request);
+		request.put ("sorting", "true");
+		request.put ("threshold", "1");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "ledger");
+		request.put ("count", "10");
+		request.put ("representative", "true");
+		request.put ("weight", "true");
+		request.put ("pending", "true");
+		requests.push_back (request);
+		request.put ("sorting", "true");
+		requests.push_back (request);
+	}
+	{
+		boost::property_tree::ptree request;
+		request.put ("action", "delegators");
+		request.put ("account", nano::dev_genesis_key.pub.to_account ());
+		requests.push_back (request);
+		// Empty responses are written as "" just like write_json does
+		request.put ("account", nano::keypair ().pub.to_account ());
+		requests.push_back (request);
+	}
+	for (auto const & request : requests)
+	{
+		test_response response (request, rpc.config.port, system.io_ctx);
+		ASSERT_TIMELY (5s, response.status != 0);
+		ASSERT_EQ (200, response.status);
+		ASSERT_EQ (0, response.json.count ("error")) << request.get<std::string> ("action");
+		std::stringstream ostream;
+		boost::property_tree::write_json (ostream, response.json);
+		ASSERT_EQ (ostream.str (), response.resp.body ()) << request.get<std::string> ("action");
+	}
+}
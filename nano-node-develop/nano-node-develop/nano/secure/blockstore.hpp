@@ -103,6 +103,18 @@ public:
 		static_assert (std::is_standard_layout<nano::pending_key>::value, "Standard layout is required");
 	}
 
+	db_val (nano::account_height_key const & val_a) :
+	db_val (sizeof (val_a), const_cast<nano::account_height_key *> (&val_a))
+	{
+		static_assert (std::is_standard_layout<nano::account_height_key>::value, "Standard layout is required");
+	}
+
+	db_val (nano::pending_amount_key const & val_a) :
+	db_val (sizeof (val_a), const_cast<nano::pending_amount_key *> (&val_a))
+	{
+		static_assert (std::is_standard_layout<nano::pending_amount_key>::value, "Standard layout is required");
+	}
+
 	db_val (nano::unchecked_info const & val_a) :
 	buffer (std::make_shared<std::vector<uint8_t>> ())
 	{
@@ -212,6 +224,24 @@ public:
 		return result;
 	}
 
+	explicit operator nano::account_height_key () const
+	{
+		nano::account_height_key result;
+		debug_assert (size () == sizeof (result));
+		static_assert (sizeof (nano::account_height_key::account) + sizeof (nano::account_height_key::height_big_endian) == sizeof (result), "Packed class");
+		std::copy (reinterpret_cast<uint8_t const *> (data ()), reinterpret_cast<uint8_t const *> (data ()) + sizeof (result), reinterpret_cast<uint8_t *> (&result));
+		return result;
+	}
+
+	explicit operator nano::pending_amount_key () const
+	{
+		nano::pending_amount_key result;
+		debug_assert (size () == sizeof (result));
+		static_assert (sizeof (nano::pending_amount_key::account) + sizeof (nano::pending_amount_key::amount_inverted) + sizeof (nano::pending_amount_key::hash) == sizeof (result), "Packed class");
+		std::copy (reinterpret_cast<uint8_t const *> (data ()), reinterpret_cast<uint8_t const *> (data ()) + sizeof (result), reinterpret_cast<uint8_t *> (&result));
+		return result;
+	}
+
 	explicit operator nano::confirmation_height_info () const
 	{
 		nano::bufferstream stream (reinterpret_cast<uint8_t const *> (data ()), size ());
@@ -539,6 +569,7 @@ private:
 // Keep this in alphabetical order
 enum class tables
 {
+	account_heights,
 	accounts,
 	blocks,
 	confirmation_height,
@@ -549,6 +580,7 @@ enum class tables
 	online_weight,
 	peers,
 	pending,
+	pending_amounts,
 	pruned,
 	unchecked,
 	vote
@@ -738,6 +770,18 @@ public:
 
 	virtual uint64_t block_account_height (nano::transaction const & transaction_a, nano::block_hash const & hash_a) const = 0;
 
+	/** The account index is optional, it only exists after being built with --account_index_build */
+	virtual bool account_index_exists (nano::transaction const & transaction_a) const = 0;
+	virtual void account_index_exists_set (nano::write_transaction const & transaction_a) = 0;
+	virtual void account_index_clear (nano::write_transaction const & transaction_a) = 0;
+	virtual void account_height_put (nano::write_transaction const & transaction_a, nano::account_height_key const & key_a, nano::block_hash const & hash_a) = 0;
+	virtual nano::block_hash account_height_get (nano::transaction const & transaction_a, nano::account_height_key const & key_a) const = 0;
+	virtual void account_height_del (nano::write_transaction const & transaction_a, nano::account_height_key const & key_a) = 0;
+	virtual void pending_amount_put (nano::write_transaction const & transaction_a, nano::pending_amount_key const & key_a) = 0;
+	virtual void pending_amount_del (nano::write_transaction const & transaction_a, nano::pending_amount_key const & key_a) = 0;
+	virtual nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const & transaction_a, nano::pending_amount_key const & key_a) const = 0;
+	virtual nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_end () const = 0;
+
 	virtual bool final_vote_put (nano::write_transaction const & transaction_a, nano::qualified_root const & root_a, nano::block_hash const & hash_a) = 0;
 	virtual std::vector<nano::block_hash> final_vote_get (nano::transaction const & transaction_a, nano::root const & root_a) = 0;
 	virtual void final_vote_del (nano::write_transaction const & transaction_a, nano::root const & root_a) = 0;
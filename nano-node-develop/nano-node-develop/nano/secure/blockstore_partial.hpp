@@ -253,6 +253,11 @@ public:
 		return nano::store_iterator<nano::block_hash, nano::account> (nullptr);
 	}
 
+	nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_end () const override
+	{
+		return nano::store_iterator<nano::pending_amount_key, nano::no_value> (nullptr);
+	}
+
 	int version_get (nano::transaction const & transaction_a) const override
 	{
 		nano::uint256_union version_key (1);
@@ -451,6 +456,68 @@ public:
 		release_assert_success (status);
 	}
 
+	bool account_index_exists (nano::transaction const & transaction_a) const override
+	{
+		return exists (transaction_a, tables::meta, nano::db_val<Val> (account_index_meta_key));
+	}
+
+	void account_index_exists_set (nano::write_transaction const & transaction_a) override
+	{
+		nano::uint256_union value (1);
+		auto status = put (transaction_a, tables::meta, nano::db_val<Val> (account_index_meta_key), nano::db_val<Val> (value));
+		release_assert_success (status);
+	}
+
+	void account_index_clear (nano::write_transaction const & transaction_a) override
+	{
+		if (account_index_exists (transaction_a))
+		{
+			auto status = del (transaction_a, tables::meta, nano::db_val<Val> (account_index_meta_key));
+			release_assert_success (status);
+		}
+		auto status = drop (transaction_a, tables::account_heights);
+		release_assert_success (status);
+		status = drop (transaction_a, tables::pending_amounts);
+		release_assert_success (status);
+	}
+
+	void account_height_put (nano::write_transaction const & transaction_a, nano::account_height_key const & key_a, nano::block_hash const & hash_a) override
+	{
+		auto status = put (transaction_a, tables::account_heights, key_a, hash_a);
+		release_assert_success (status);
+	}
+
+	nano::block_hash account_height_get (nano::transaction const & transaction_a, nano::account_height_key const & key_a) const override
+	{
+		nano::db_val<Val> value;
+		auto status = get (transaction_a, tables::account_heights, nano::db_val<Val> (key_a), value);
+		release_assert (success (status) || not_found (status));
+		nano::block_hash result (0);
+		if (success (status))
+		{
+			result = static_cast<nano::block_hash> (value);
+		}
+		return result;
+	}
+
+	void account_height_del (nano::write_transaction const & transaction_a, nano::account_height_key const & key_a) override
+	{
+		auto status = del (transaction_a, tables::account_heights, key_a);
+		release_assert_success (status);
+	}
+
+	void pending_amount_put (nano::write_transaction const & transaction_a, nano::pending_amount_key const & key_a) override
+	{
+		auto status = put_key (transaction_a, tables::pending_amounts, key_a);
+		release_assert_success (status);
+	}
+
+	void pending_amount_del (nano::write_transaction const & transaction_a, nano::pending_amount_key const & key_a) override
+	{
+		auto status = del (transaction_a, tables::pending_amounts, key_a);
+		release_assert_success (status);
+	}
+
 	void pruned_put (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a) override
 	{
 		auto status = put_key (transaction_a, tables::pruned, hash_a);
@@ -706,6 +773,11 @@ public:
 		return make_iterator<nano::pending_key, nano::pending_info> (transaction_a, tables::pending);
 	}
 
+	nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const & transaction_a, nano::pending_amount_key const & key_a) const override
+	{
+		return make_iterator<nano::pending_amount_key, nano::no_value> (transaction_a, tables::pending_amounts, nano::db_val<Val> (key_a));
+	}
+
 	nano::store_iterator<nano::unchecked_key, nano::unchecked_info> unchecked_begin (nano::transaction const & transaction_a) const override
 	{
 		return make_iterator<nano::unchecked_key, nano::unchecked_info> (transaction_a, tables::unchecked);
@@ -854,6 +926,8 @@ public:
 protected:
 	nano::network_params network_params;
 	int const version{ 21 };
+	/** Meta table key marking that the account index was built and is being maintained, the version uses key 1 */
+	nano::uint256_union const account_index_meta_key{ 2 };
 
 	template <typename Key, typename Value>
 	nano::store_iterator<Key, Value> make_iterator (nano::transaction const & transaction_a, tables table_a, bool const direction_asc = true) const
@@ -332,6 +332,39 @@ nano::account const & nano::pending_key::key () const
 	return account;
 }
 
+nano::account_height_key::account_height_key (nano::account const & account_a, uint64_t height_a) :
+account (account_a),
+height_big_endian (boost::endian::native_to_big (height_a))
+{
+}
+
+uint64_t nano::account_height_key::height () const
+{
+	return boost::endian::big_to_native (height_big_endian);
+}
+
+bool nano::account_height_key::operator== (nano::account_height_key const & other_a) const
+{
+	return account == other_a.account && height_big_endian == other_a.height_big_endian;
+}
+
+nano::pending_amount_key::pending_amount_key (nano::account const & account_a, nano::amount const & amount_a, nano::block_hash const & hash_a) :
+account (account_a),
+amount_inverted (std::numeric_limits<nano::uint128_t>::max () - amount_a.number ()),
+hash (hash_a)
+{
+}
+
+nano::amount nano::pending_amount_key::amount () const
+{
+	return std::numeric_limits<nano::uint128_t>::max () - amount_inverted.number ();
+}
+
+bool nano::pending_amount_key::operator== (nano::pending_amount_key const & other_a) const
+{
+	return account == other_a.account && amount_inverted == other_a.amount_inverted && hash == other_a.hash;
+}
+
 nano::unchecked_info::unchecked_info (std::shared_ptr<nano::block> const & block_a, nano::account const & account_a, uint64_t modified_a, nano::signature_verification verified_a, bool confirmed_a) :
 block (block_a),
 account (account_a),
@@ -748,47 +781,13 @@ std::shared_ptr<nano::vote> nano::vote_uniquer::unique (std::shared_ptr<nano::vo
 		{
 			result->blocks.front () = uniquer.unique (boost::get<std::shared_ptr<nano::block>> (result->blocks.front ()));
 		}
-		nano::block_hash key (vote_a->full_hash ());
-		nano::lock_guard<nano::mutex> lock (mutex);
-		auto & existing (votes[key]);
-		if (auto block_l = existing.lock ())
-		{
-			result = block_l;
-		}
-		else
-		{
-			existing = vote_a;
-		}
-
-		release_assert (std::numeric_limits<CryptoPP::word32>::max () > votes.size ());
-		for (auto i (0); i < cleanup_count && !votes.empty (); ++i)
-		{
-			auto random_offset = nano::random_pool::generate_word32 (0, static_cast<CryptoPP::word32> (votes.size () - 1));
-
-			auto existing (std::next (votes.begin (), random_offset));
-			if (existing == votes.end ())
-			{
-				existing = votes.begin ();
-			}
-			if (existing != votes.end ())
-			{
-				if (auto block_l = existing->second.lock ())
-				{
-					// Still live
-				}
-				else
-				{
-					votes.erase (existing);
-				}
-			}
-		}
+		result = votes.unique (vote_a->full_hash (), vote_a);
 	}
 	return result;
 }
 
 size_t nano::vote_uniquer::size ()
 {
-	nano::lock_guard<nano::mutex> lock (mutex);
 	return votes.size ();
 }
 
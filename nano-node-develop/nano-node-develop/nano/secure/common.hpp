@@ -135,6 +135,37 @@ public:
 	nano::block_hash hash{ 0 };
 };
 
+/**
+ * Key of the optional account index mapping (account, height) to a block hash.
+ * The height is stored big endian so that keys of an account sort by height.
+ */
+class account_height_key final
+{
+public:
+	account_height_key () = default;
+	account_height_key (nano::account const &, uint64_t);
+	uint64_t height () const;
+	bool operator== (nano::account_height_key const &) const;
+	nano::account account{ 0 };
+	uint64_t height_big_endian{ 0 };
+};
+
+/**
+ * Key of the optional index of pending entries ordered by destination account, then by descending amount.
+ * The amount is stored inverted so that larger amounts sort first.
+ */
+class pending_amount_key final
+{
+public:
+	pending_amount_key () = default;
+	pending_amount_key (nano::account const &, nano::amount const &, nano::block_hash const &);
+	nano::amount amount () const;
+	bool operator== (nano::pending_amount_key const &) const;
+	nano::account account{ 0 };
+	nano::amount amount_inverted{ 0 };
+	nano::block_hash hash{ 0 };
+};
+
 class endpoint_key final
 {
 public:
@@ -288,9 +319,7 @@ public:
 
 private:
 	nano::block_uniquer & uniquer;
-	nano::mutex mutex{ mutex_identifier (mutexes::vote_uniquer) };
-	std::unordered_map<std::remove_const_t<value_type::first_type>, value_type::second_type> votes;
-	static unsigned constexpr cleanup_count = 2;
+	nano::uniquer_table<nano::vote> votes{ mutex_identifier (mutexes::vote_uniquer) };
 };
 
 std::unique_ptr<container_info_component> collect_container_info (vote_uniquer & vote_uniquer, std::string const & name);
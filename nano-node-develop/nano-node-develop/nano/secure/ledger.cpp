@@ -37,11 +37,11 @@ public:
 			nano::account_info info;
 			[[maybe_unused]] auto error (ledger.store.account_get (transaction, pending.source, info));
 			debug_assert (!error);
-			ledger.store.pending_del (transaction, key);
+			ledger.pending_del (transaction, key);
 			ledger.cache.rep_weights.representation_add (info.representative, pending.amount.number ());
 			nano::account_info new_info (block_a.hashables.previous, info.representative, info.open_block, ledger.balance (transaction, block_a.hashables.previous), nano::seconds_since_epoch (), info.block_count - 1, nano::epoch::epoch_0);
 			ledger.update_account (transaction, pending.source, info, new_info);
-			ledger.store.block_del (transaction, hash);
+			ledger.block_del (transaction, hash, block_a);
 			ledger.store.frontier_del (transaction, hash);
 			ledger.store.frontier_put (transaction, block_a.hashables.previous, pending.source);
 			ledger.store.block_successor_clear (transaction, block_a.hashables.previous);
@@ -62,8 +62,8 @@ public:
 		ledger.cache.rep_weights.representation_add (info.representative, 0 - amount);
 		nano::account_info new_info (block_a.hashables.previous, info.representative, info.open_block, ledger.balance (transaction, block_a.hashables.previous), nano::seconds_since_epoch (), info.block_count - 1, nano::epoch::epoch_0);
 		ledger.update_account (transaction, destination_account, info, new_info);
-		ledger.store.block_del (transaction, hash);
-		ledger.store.pending_put (transaction, nano::pending_key (destination_account, block_a.hashables.source), { source_account, amount, nano::epoch::epoch_0 });
+		ledger.block_del (transaction, hash, block_a);
+		ledger.pending_put (transaction, nano::pending_key (destination_account, block_a.hashables.source), { source_account, amount, nano::epoch::epoch_0 });
 		ledger.store.frontier_del (transaction, hash);
 		ledger.store.frontier_put (transaction, block_a.hashables.previous, destination_account);
 		ledger.store.block_successor_clear (transaction, block_a.hashables.previous);
@@ -80,8 +80,8 @@ public:
 		ledger.cache.rep_weights.representation_add (block_a.representative (), 0 - amount);
 		nano::account_info new_info;
 		ledger.update_account (transaction, destination_account, new_info, new_info);
-		ledger.store.block_del (transaction, hash);
-		ledger.store.pending_put (transaction, nano::pending_key (destination_account, block_a.hashables.source), { source_account, amount, nano::epoch::epoch_0 });
+		ledger.block_del (transaction, hash, block_a);
+		ledger.pending_put (transaction, nano::pending_key (destination_account, block_a.hashables.source), { source_account, amount, nano::epoch::epoch_0 });
 		ledger.store.frontier_del (transaction, hash);
 		ledger.stats.inc (nano::stat::type::rollback, nano::stat::detail::open);
 	}
@@ -98,7 +98,7 @@ public:
 		release_assert (block != nullptr);
 		auto representative = block->representative ();
 		ledger.cache.rep_weights.representation_add_dual (block_a.representative (), 0 - balance, representative, balance);
-		ledger.store.block_del (transaction, hash);
+		ledger.block_del (transaction, hash, block_a);
 		nano::account_info new_info (block_a.hashables.previous, representative, info.open_block, info.balance, nano::seconds_since_epoch (), info.block_count - 1, nano::epoch::epoch_0);
 		ledger.update_account (transaction, account, info, new_info);
 		ledger.store.frontier_del (transaction, hash);
@@ -141,7 +141,7 @@ public:
 			{
 				error = ledger.rollback (transaction, ledger.latest (transaction, block_a.hashables.link.as_account ()), list);
 			}
-			ledger.store.pending_del (transaction, key);
+			ledger.pending_del (transaction, key);
 			ledger.stats.inc (nano::stat::type::rollback, nano::stat::detail::send);
 		}
 		else if (!block_a.hashables.link.is_zero () && !ledger.is_epoch_link (block_a.hashables.link))
@@ -150,7 +150,7 @@ public:
 			[[maybe_unused]] bool is_pruned (false);
 			auto source_account (ledger.account_safe (transaction, block_a.hashables.link.as_block_hash (), is_pruned));
 			nano::pending_info pending_info (source_account, block_a.hashables.balance.number () - balance, block_a.sideband ().source_epoch);
-			ledger.store.pending_put (transaction, nano::pending_key (block_a.hashables.account, block_a.hashables.link.as_block_hash ()), pending_info);
+			ledger.pending_put (transaction, nano::pending_key (block_a.hashables.account, block_a.hashables.link.as_block_hash ()), pending_info);
 			ledger.stats.inc (nano::stat::type::rollback, nano::stat::detail::receive);
 		}
 
@@ -172,7 +172,7 @@ public:
 		{
 			ledger.stats.inc (nano::stat::type::rollback, nano::stat::detail::open);
 		}
-		ledger.store.block_del (transaction, hash);
+		ledger.block_del (transaction, hash, block_a);
 	}
 	nano::write_transaction const & transaction;
 	nano::ledger & ledger;
@@ -351,7 +351,7 @@ void ledger_processor::state_block_impl (nano::state_block & block_a)
 					{
 						ledger.stats.inc (nano::stat::type::ledger, nano::stat::detail::state_block);
 						block_a.sideband_set (nano::block_sideband (block_a.hashables.account /* unused */, 0, 0 /* unused */, info.block_count + 1, nano::seconds_since_epoch (), block_details, source_epoch));
-						ledger.store.block_put (transaction, hash, block_a);
+						ledger.block_put (transaction, hash, block_a);
 
 						if (!info.head.is_zero ())
 						{
@@ -368,11 +368,11 @@ void ledger_processor::state_block_impl (nano::state_block & block_a)
 						{
 							nano::pending_key key (block_a.hashables.link.as_account (), hash);
 							nano::pending_info info (block_a.hashables.account, amount.number (), epoch);
-							ledger.store.pending_put (transaction, key, info);
+							ledger.pending_put (transaction, key, info);
 						}
 						else if (!block_a.hashables.link.is_zero ())
 						{
-							ledger.store.pending_del (transaction, nano::pending_key (block_a.hashables.account, block_a.hashables.link.as_block_hash ()));
+							ledger.pending_del (transaction, nano::pending_key (block_a.hashables.account, block_a.hashables.link.as_block_hash ()));
 						}
 
 						nano::account_info new_info (hash, block_a.representative (), info.open_block.is_zero () ? hash : info.open_block, block_a.hashables.balance, nano::seconds_since_epoch (), info.block_count + 1, epoch);
@@ -451,7 +451,7 @@ void ledger_processor::epoch_block_impl (nano::state_block & block_a)
 							{
 								ledger.stats.inc (nano::stat::type::ledger, nano::stat::detail::epoch_block);
 								block_a.sideband_set (nano::block_sideband (block_a.hashables.account /* unused */, 0, 0 /* unused */, info.block_count + 1, nano::seconds_since_epoch (), block_details, nano::epoch::epoch_0 /* unused */));
-								ledger.store.block_put (transaction, hash, block_a);
+								ledger.block_put (transaction, hash, block_a);
 								nano::account_info new_info (hash, block_a.representative (), info.open_block.is_zero () ? hash : info.open_block, info.balance, nano::seconds_since_epoch (), info.block_count + 1, epoch);
 								ledger.update_account (transaction, block_a.hashables.account, info, new_info);
 								if (!ledger.store.frontier_get (transaction, info.head).is_zero ())
@@ -504,7 +504,7 @@ void ledger_processor::change_block (nano::change_block & block_a)
 							debug_assert (!validate_message (account, hash, block_a.signature));
 							result.verified = nano::signature_verification::valid;
 							block_a.sideband_set (nano::block_sideband (account, 0, info.balance, info.block_count + 1, nano::seconds_since_epoch (), block_details, nano::epoch::epoch_0 /* unused */));
-							ledger.store.block_put (transaction, hash, block_a);
+							ledger.block_put (transaction, hash, block_a);
 							auto balance (ledger.balance (transaction, block_a.hashables.previous));
 							ledger.cache.rep_weights.representation_add_dual (block_a.representative (), balance, info.representative, 0 - balance);
 							nano::account_info new_info (hash, block_a.representative (), info.open_block, info.balance, nano::seconds_since_epoch (), info.block_count + 1, nano::epoch::epoch_0);
@@ -563,10 +563,10 @@ void ledger_processor::send_block (nano::send_block & block_a)
 								auto amount (info.balance.number () - block_a.hashables.balance.number ());
 								ledger.cache.rep_weights.representation_add (info.representative, 0 - amount);
 								block_a.sideband_set (nano::block_sideband (account, 0, block_a.hashables.balance /* unused */, info.block_count + 1, nano::seconds_since_epoch (), block_details, nano::epoch::epoch_0 /* unused */));
-								ledger.store.block_put (transaction, hash, block_a);
+								ledger.block_put (transaction, hash, block_a);
 								nano::account_info new_info (hash, info.representative, info.open_block, block_a.hashables.balance, nano::seconds_since_epoch (), info.block_count + 1, nano::epoch::epoch_0);
 								ledger.update_account (transaction, account, info, new_info);
-								ledger.store.pending_put (transaction, nano::pending_key (block_a.hashables.destination, hash), { account, amount, nano::epoch::epoch_0 });
+								ledger.pending_put (transaction, nano::pending_key (block_a.hashables.destination, hash), { account, amount, nano::epoch::epoch_0 });
 								ledger.store.frontier_del (transaction, block_a.hashables.previous);
 								ledger.store.frontier_put (transaction, hash, account);
 								result.previous_balance = info.balance;
@@ -636,9 +636,9 @@ void ledger_processor::receive_block (nano::receive_block & block_a)
 												debug_assert (!error);
 											}
 #endif
-											ledger.store.pending_del (transaction, key);
+											ledger.pending_del (transaction, key);
 											block_a.sideband_set (nano::block_sideband (account, 0, new_balance, info.block_count + 1, nano::seconds_since_epoch (), block_details, nano::epoch::epoch_0 /* unused */));
-											ledger.store.block_put (transaction, hash, block_a);
+											ledger.block_put (transaction, hash, block_a);
 											nano::account_info new_info (hash, info.representative, info.open_block, new_balance, nano::seconds_since_epoch (), info.block_count + 1, nano::epoch::epoch_0);
 											ledger.update_account (transaction, account, info, new_info);
 											ledger.cache.rep_weights.representation_add (info.representative, pending.amount.number ());
@@ -708,9 +708,9 @@ void ledger_processor::open_block (nano::open_block & block_a)
 										debug_assert (!error);
 									}
 #endif
-									ledger.store.pending_del (transaction, key);
+									ledger.pending_del (transaction, key);
 									block_a.sideband_set (nano::block_sideband (block_a.hashables.account, 0, pending.amount, 1, nano::seconds_since_epoch (), block_details, nano::epoch::epoch_0 /* unused */));
-									ledger.store.block_put (transaction, hash, block_a);
+									ledger.block_put (transaction, hash, block_a);
 									nano::account_info new_info (hash, block_a.representative (), hash, pending.amount.number (), nano::seconds_since_epoch (), 1, nano::epoch::epoch_0);
 									ledger.update_account (transaction, block_a.hashables.account, info, new_info);
 									ledger.cache.rep_weights.representation_add (block_a.representative (), pending.amount.number ());
@@ -784,6 +784,7 @@ void nano::ledger::initialize (nano::generate_cache const & generate_cache_a)
 
 	auto transaction (store.tx_begin_read ());
 	cache.pruned_count = store.pruned_count (transaction);
+	account_index = store.account_index_exists (transaction);
 }
 
 // Balance for account containing hash
@@ -1333,6 +1334,114 @@ bool nano::ledger::block_confirmed (nano::transaction const & transaction_a, nan
 	return confirmed;
 }
 
+void nano::ledger::block_put (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a, nano::block const & block_a)
+{
+	store.block_put (transaction_a, hash_a, block_a);
+	if (account_index)
+	{
+		auto account (block_a.account ().is_zero () ? block_a.sideband ().account : block_a.account ());
+		store.account_height_put (transaction_a, nano::account_height_key (account, block_a.sideband ().height), hash_a);
+	}
+}
+
+void nano::ledger::block_del (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a, nano::block const & block_a)
+{
+	store.block_del (transaction_a, hash_a);
+	if (account_index)
+	{
+		auto account (block_a.account ().is_zero () ? block_a.sideband ().account : block_a.account ());
+		store.account_height_del (transaction_a, nano::account_height_key (account, block_a.sideband ().height));
+	}
+}
+
+void nano::ledger::pending_put (nano::write_transaction const & transaction_a, nano::pending_key const & key_a, nano::pending_info const & pending_a)
+{
+	store.pending_put (transaction_a, key_a, pending_a);
+	if (account_index)
+	{
+		store.pending_amount_put (transaction_a, nano::pending_amount_key (key_a.account, pending_a.amount, key_a.hash));
+	}
+}
+
+void nano::ledger::pending_del (nano::write_transaction const & transaction_a, nano::pending_key const & key_a)
+{
+	if (account_index)
+	{
+		nano::pending_info pending;
+		[[maybe_unused]] auto error (store.pending_get (transaction_a, key_a, pending));
+		debug_assert (!error);
+		store.pending_amount_del (transaction_a, nano::pending_amount_key (key_a.account, pending.amount, key_a.hash));
+	}
+	store.pending_del (transaction_a, key_a);
+}
+
+void nano::ledger::account_index_build (nano::write_transaction & transaction_a, uint64_t batch_size_a)
+{
+	account_index_clear (transaction_a);
+	uint64_t written (0);
+	// Iterators do not survive a commit, so each batch seeks from the first account or pending entry not yet indexed
+	auto batch_full = [&written, batch_size_a]() {
+		return written >= batch_size_a;
+	};
+	auto commit = [&transaction_a, &written]() {
+		transaction_a.commit ();
+		transaction_a.renew ();
+		written = 0;
+	};
+	// Long chains can fill several batches, so the walk resumes from the account and block it stopped at
+	nano::account account (0);
+	nano::block_hash resume (0);
+	for (auto more (true); more;)
+	{
+		more = false;
+		for (auto i (store.accounts_begin (transaction_a, account)), n (store.accounts_end ()); i != n && !more; ++i)
+		{
+			account = i->first;
+			// Pruned blocks end the walk, their heights cannot be indexed
+			for (auto block (store.block_get (transaction_a, resume.is_zero () ? i->second.head : resume)); block != nullptr && !more; block = store.block_get (transaction_a, block->previous ()))
+			{
+				if (batch_full ())
+				{
+					resume = block->hash ();
+					more = true;
+				}
+				else
+				{
+					store.account_height_put (transaction_a, nano::account_height_key (account, block->sideband ().height), block->hash ());
+					++written;
+				}
+			}
+			if (!more)
+			{
+				resume = 0;
+			}
+		}
+		commit ();
+	}
+	for (boost::optional<nano::pending_key> start (nano::pending_key (0, 0)); start.is_initialized ();)
+	{
+		auto i (store.pending_begin (transaction_a, *start));
+		auto n (store.pending_end ());
+		for (; i != n && !batch_full (); ++i)
+		{
+			nano::pending_key const & key (i->first);
+			nano::pending_info const & info (i->second);
+			store.pending_amount_put (transaction_a, nano::pending_amount_key (key.account, info.amount, key.hash));
+			++written;
+		}
+		start = i != n ? boost::optional<nano::pending_key> (i->first) : boost::none;
+		commit ();
+	}
+	store.account_index_exists_set (transaction_a);
+	account_index = true;
+}
+
+void nano::ledger::account_index_clear (nano::write_transaction const & transaction_a)
+{
+	store.account_index_clear (transaction_a);
+	account_index = false;
+}
+
 uint64_t nano::ledger::pruning_action (nano::write_transaction & transaction_a, nano::block_hash const & hash_a, uint64_t const batch_size_a)
 {
 	uint64_t pruned_count (0);
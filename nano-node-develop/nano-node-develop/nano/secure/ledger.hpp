@@ -69,6 +69,14 @@ public:
 	nano::link const & epoch_link (nano::epoch) const;
 	std::multimap<uint64_t, uncemented_info, std::greater<>> unconfirmed_frontiers () const;
 	bool migrate_lmdb_to_rocksdb (boost::filesystem::path const &) const;
+	/** Store updates made while processing and rolling back blocks, these also keep the account index in sync when it exists */
+	void block_put (nano::write_transaction const &, nano::block_hash const &, nano::block const &);
+	void block_del (nano::write_transaction const &, nano::block_hash const &, nano::block const &);
+	void pending_put (nano::write_transaction const &, nano::pending_key const &, nano::pending_info const &);
+	void pending_del (nano::write_transaction const &, nano::pending_key const &);
+	/** (Re)builds the account index from the blocks and pending entries in the ledger, committing every \p batch_size_a writes */
+	void account_index_build (nano::write_transaction &, uint64_t batch_size_a = 100000);
+	void account_index_clear (nano::write_transaction const &);
 	static nano::uint128_t const unit;
 	nano::network_params network_params;
 	nano::block_store & store;
@@ -79,6 +87,8 @@ public:
 	uint64_t bootstrap_weight_max_blocks{ 1 };
 	std::atomic<bool> check_bootstrap_weights;
 	bool pruning{ false };
+	/** Set when the optional account index exists, which is then maintained by process and rollback */
+	bool account_index{ false };
 
 private:
 	void initialize (nano::generate_cache const &);
@@ -0,0 +1,362 @@
+#include <nano/lib/threading.hpp>
+#include <nano/lib/tomlconfig.hpp>
+#include <nano/node/testing.hpp>
+#include <nano/node/transport/simulated.hpp>
+#include <nano/secure/utility.hpp>
+#include <nano/test_common/testutil.hpp>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <unordered_map>
+
+namespace nano
+{
+void force_nano_dev_network ();
+}
+
+namespace
+{
+/** A network to simulate, read from a scenario file */
+class scenario final
+{
+public:
+	nano::error deserialize_toml (nano::tomlconfig & toml)
+	{
+		toml.get_optional<unsigned> ("nodes", nodes);
+		toml.get_optional<unsigned> ("representatives", representatives);
+		toml.get_optional<unsigned> ("seed", seed);
+		toml.get_optional<unsigned> ("blocks", blocks);
+		toml.get_optional<unsigned> ("publish_interval_ms", publish_interval_ms);
+		toml.get_optional<unsigned> ("peers_per_node", peers_per_node);
+		toml.get_optional<unsigned> ("settle_ms", settle_ms);
+		toml.get_optional<unsigned> ("timeout_s", timeout_s);
+		if (toml.has_key ("link"))
+		{
+			auto link_l (toml.get_required_child ("link"));
+			auto latency_ms (link.latency.count () / 1000.0);
+			auto jitter_ms (link.jitter.count () / 1000.0);
+			link_l.get_optional<double> ("latency_ms", latency_ms);
+			link_l.get_optional<double> ("jitter_ms", jitter_ms);
+			link_l.get_optional<unsigned> ("bandwidth", bandwidth);
+			link_l.get_optional<double> ("loss", link.loss);
+			link.latency = std::chrono::microseconds (static_cast<int64_t> (latency_ms * 1000));
+			link.jitter = std::chrono::microseconds (static_cast<int64_t> (jitter_ms * 1000));
+			link.bandwidth = bandwidth;
+		}
+		if (representatives == 0 || representatives > nodes)
+		{
+			toml.get_error ().set ("representatives must be between 1 and the number of nodes");
+		}
+		if (peers_per_node == 0 || peers_per_node >= nodes)
+		{
+			toml.get_error ().set ("peers_per_node must be between 1 and the number of nodes less one");
+		}
+		if (link.loss < 0.0 || link.loss >= 1.0)
+		{
+			toml.get_error ().set ("link.loss must be a probability below 1");
+		}
+		return toml.get_error ();
+	}
+
+	unsigned nodes{ 50 };
+	unsigned representatives{ 10 };
+	unsigned seed{ 1 };
+	unsigned blocks{ 100 };
+	unsigned publish_interval_ms{ 50 };
+	unsigned peers_per_node{ 8 };
+	/** Real time with no messages sent after which the nodes are considered done with the current virtual instant */
+	unsigned settle_ms{ 200 };
+	/** Real time after which unconfirmed blocks are given up on */
+	unsigned timeout_s{ 300 };
+	unsigned bandwidth{ 0 };
+	nano::transport::simulated::link link{ std::chrono::milliseconds (50), std::chrono::milliseconds (10), 0, 0.0 };
+};
+
+std::chrono::microseconds percentile (std::vector<std::chrono::microseconds> const & sorted_a, double fraction_a)
+{
+	debug_assert (!sorted_a.empty ());
+	auto index (std::min (sorted_a.size () - 1, static_cast<size_t> (fraction_a * sorted_a.size ())));
+	return sorted_a[index];
+}
+
+std::string message_name (nano::message_type type_a)
+{
+	std::string result ("other");
+	switch (type_a)
+	{
+		case nano::message_type::keepalive:
+			result = "keepalive";
+			break;
+		case nano::message_type::publish:
+			result = "publish";
+			break;
+		case nano::message_type::confirm_req:
+			result = "confirm_req";
+			break;
+		case nano::message_type::confirm_ack:
+			result = "confirm_ack";
+			break;
+		case nano::message_type::telemetry_req:
+			result = "telemetry_req";
+			break;
+		case nano::message_type::telemetry_ack:
+			result = "telemetry_ack";
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+std::string milliseconds (std::chrono::microseconds duration_a)
+{
+	return boost::str (boost::format ("%1$.1f ms") % (duration_a.count () / 1000.0));
+}
+
+int run (scenario const & scenario_a)
+{
+	nano::system system;
+	nano::transport::simulated::simulator simulator (scenario_a.seed);
+	std::mt19937_64 random (scenario_a.seed);
+
+	nano::node_flags flags;
+	flags.disable_udp = true;
+	flags.disable_tcp_realtime = true;
+	flags.disable_bootstrap_listener = true;
+	flags.disable_lazy_bootstrap = true;
+	flags.disable_legacy_bootstrap = true;
+	flags.disable_wallet_bootstrap = true;
+	flags.disable_ongoing_telemetry_requests = true;
+	flags.disable_max_peers_per_ip = true;
+	std::cout << "Starting " << scenario_a.nodes << " nodes..." << std::endl;
+	for (auto i (0u); i < scenario_a.nodes; ++i)
+	{
+		nano::node_config config (nano::get_available_port (), system.logging);
+		config.enable_voting = i < scenario_a.representatives;
+		config.vote_generator_delay = std::chrono::milliseconds (10);
+		config.network_threads = 1;
+		config.signature_checker_threads = 1;
+		config.online_weight_minimum = 0;
+		auto node (system.add_node (config, flags, nano::transport::transport_type::simulated));
+		simulator.add (*node);
+	}
+
+	// Each representative gets an equal share of the genesis balance, which it uses to publish its blocks
+	std::vector<nano::keypair> representatives (scenario_a.representatives);
+	std::vector<std::shared_ptr<nano::state_block>> setup;
+	std::vector<nano::block_hash> frontiers;
+	std::vector<nano::uint128_t> balances;
+	auto share (nano::genesis_amount / scenario_a.representatives);
+	auto genesis_previous (nano::genesis_hash);
+	auto genesis_balance (nano::genesis_amount);
+	for (auto const & representative : representatives)
+	{
+		genesis_balance -= share;
+		auto send (std::make_shared<nano::state_block> (nano::dev_genesis_key.pub, genesis_previous, nano::dev_genesis_key.pub, genesis_balance, representative.pub, nano::dev_genesis_key.prv, nano::dev_genesis_key.pub, *system.work.generate (genesis_previous)));
+		auto open (std::make_shared<nano::state_block> (representative.pub, 0, representative.pub, share, send->hash (), representative.prv, representative.pub, *system.work.generate (representative.pub)));
+		genesis_previous = send->hash ();
+		setup.push_back (send);
+		setup.push_back (open);
+		frontiers.push_back (open->hash ());
+		balances.push_back (share);
+	}
+	for (auto const & node : system.nodes)
+	{
+		for (auto const & block : setup)
+		{
+			if (node->process (*block).code != nano::process_result::progress)
+			{
+				std::cerr << "Failed to process setup block" << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	nano::thread_runner runner (system.io_ctx, std::max (2u, std::thread::hardware_concurrency ()));
+	for (auto i (0u); i < scenario_a.representatives; ++i)
+	{
+		system.wallet (i)->insert_adhoc (representatives[i].prv);
+	}
+
+	// Every node links to peers_per_node random others, so a node ends up with about twice as many peers
+	std::set<std::pair<size_t, size_t>> links;
+	std::uniform_int_distribution<size_t> peer_distribution (0, scenario_a.nodes - 1);
+	for (auto i (0u); i < scenario_a.nodes; ++i)
+	{
+		// Bounded, as the node may already be linked to most others
+		for (auto added (0u), attempts (0u); added < scenario_a.peers_per_node && attempts < scenario_a.nodes * 4; ++attempts)
+		{
+			auto peer (peer_distribution (random));
+			if (peer != i && links.emplace (std::min<size_t> (i, peer), std::max<size_t> (i, peer)).second)
+			{
+				simulator.connect (i, peer, scenario_a.link);
+				++added;
+			}
+		}
+	}
+
+	// Blocks are sent by the representatives in turn and published at a rotating node
+	std::cout << "Generating " << scenario_a.blocks << " blocks..." << std::endl;
+	nano::keypair destination;
+	std::vector<std::shared_ptr<nano::state_block>> blocks;
+	for (auto i (0u); i < scenario_a.blocks; ++i)
+	{
+		auto index (i % scenario_a.representatives);
+		auto const & representative (representatives[index]);
+		balances[index] -= 1;
+		auto send (std::make_shared<nano::state_block> (representative.pub, frontiers[index], representative.pub, balances[index], destination.pub, representative.prv, representative.pub, *system.work.generate (frontiers[index])));
+		frontiers[index] = send->hash ();
+		blocks.push_back (send);
+	}
+
+	nano::mutex mutex;
+	std::unordered_map<nano::block_hash, std::chrono::microseconds> published;
+	std::unordered_map<nano::block_hash, unsigned> confirmed_count;
+	std::vector<std::chrono::microseconds> latencies;
+	for (auto const & node : system.nodes)
+	{
+		node->observers.blocks.add ([&](nano::election_status const & status_a, std::vector<nano::vote_with_weight_info> const &, nano::account const &, nano::uint128_t const &, bool) {
+			auto now (simulator.now ());
+			nano::lock_guard<nano::mutex> lock (mutex);
+			auto existing (published.find (status_a.winner->hash ()));
+			if (existing != published.end ())
+			{
+				latencies.push_back (now - existing->second);
+				++confirmed_count[existing->first];
+			}
+		});
+	}
+	auto all_confirmed = [&]() {
+		nano::lock_guard<nano::mutex> lock (mutex);
+		return latencies.size () == static_cast<size_t> (scenario_a.blocks) * scenario_a.nodes;
+	};
+	auto nodes_busy = [&]() {
+		return std::any_of (system.nodes.begin (), system.nodes.end (), [](std::shared_ptr<nano::node> const & node_a) {
+			return node_a->block_processor.size () != 0 || !node_a->vote_processor.empty ();
+		});
+	};
+
+	// Virtual time only moves on once the nodes have stopped reacting to the last messages delivered
+	std::cout << "Running..." << std::endl;
+	auto interval (std::chrono::microseconds (std::chrono::milliseconds (scenario_a.publish_interval_ms)));
+	auto settle (std::chrono::milliseconds (scenario_a.settle_ms));
+	auto real_start (std::chrono::steady_clock::now ());
+	auto deadline (real_start + std::chrono::seconds (scenario_a.timeout_s));
+	size_t next (0);
+	while (!all_confirmed () && std::chrono::steady_clock::now () < deadline)
+	{
+		while (next < blocks.size () && interval * next <= simulator.now ())
+		{
+			{
+				nano::lock_guard<nano::mutex> lock (mutex);
+				published[blocks[next]->hash ()] = simulator.now ();
+			}
+			system.nodes[next % system.nodes.size ()]->process_active (blocks[next]);
+			++next;
+		}
+		auto sends (simulator.sends ());
+		auto last_change (std::chrono::steady_clock::now ());
+		while (std::chrono::steady_clock::now () - last_change < settle)
+		{
+			std::this_thread::sleep_for (std::chrono::milliseconds (5));
+			if (simulator.sends () != sends || nodes_busy ())
+			{
+				sends = simulator.sends ();
+				last_change = std::chrono::steady_clock::now ();
+			}
+		}
+		auto until (next < blocks.size () ? std::chrono::microseconds (interval * next) : simulator.now () + interval);
+		simulator.step (until);
+	}
+	auto real_elapsed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - real_start));
+
+	nano::lock_guard<nano::mutex> lock (mutex);
+	std::sort (latencies.begin (), latencies.end ());
+	auto traffic (simulator.traffic_by_type ());
+	auto total_bytes (std::accumulate (traffic.begin (), traffic.end (), uint64_t (0), [](uint64_t total_a, nano::transport::simulated::traffic const & traffic_a) { return total_a + traffic_a.bytes; }));
+	auto const & votes (traffic[static_cast<size_t> (nano::message_type::confirm_ack)]);
+	auto fully_confirmed (std::count_if (confirmed_count.begin (), confirmed_count.end (), [&scenario_a](auto const & entry_a) { return entry_a.second == scenario_a.nodes; }));
+
+	std::cout << boost::str (boost::format ("Simulated %1% of network time in %2% ms\n") % milliseconds (simulator.now ()) % real_elapsed.count ());
+	std::cout << boost::str (boost::format ("Confirmed %1% of %2% blocks on all nodes, %3% of %4% confirmations\n") % fully_confirmed % scenario_a.blocks % latencies.size () % (static_cast<size_t> (scenario_a.blocks) * scenario_a.nodes));
+	if (!latencies.empty ())
+	{
+		std::cout << boost::str (boost::format ("Confirmation latency: p50 %1%, p90 %2%, p99 %3%, max %4%\n") % milliseconds (percentile (latencies, 0.5)) % milliseconds (percentile (latencies, 0.9)) % milliseconds (percentile (latencies, 0.99)) % milliseconds (latencies.back ()));
+	}
+	if (fully_confirmed != 0)
+	{
+		std::cout << boost::str (boost::format ("Bytes per confirmed block: %1%\n") % (total_bytes / fully_confirmed));
+	}
+	// Each representative votes for each block at least once, every further confirm_ack sent amplifies that
+	std::cout << boost::str (boost::format ("Vote amplification: %1$.2f confirm_ack sent per representative vote\n") % (votes.sent / static_cast<double> (std::max<size_t> (1, static_cast<size_t> (scenario_a.blocks) * scenario_a.representatives))));
+	std::cout << std::left << std::setw (16) << "message" << std::setw (12) << "sent" << std::setw (12) << "lost" << std::setw (14) << "bytes" << std::endl;
+	for (auto i (0u); i < traffic.size (); ++i)
+	{
+		if (traffic[i].sent != 0)
+		{
+			std::cout << std::setw (16) << message_name (static_cast<nano::message_type> (i)) << std::setw (12) << traffic[i].sent << std::setw (12) << traffic[i].lost << std::setw (14) << traffic[i].bytes << std::endl;
+		}
+	}
+	runner.stop_event_processing ();
+	system.stop ();
+	runner.join ();
+	return fully_confirmed == scenario_a.blocks ? 0 : 1;
+}
+}
+
+int main (int argc, char * const * argv)
+{
+	nano::force_nano_dev_network ();
+	nano::set_umask ();
+
+	boost::program_options::options_description description ("Command line options");
+
+	// clang-format off
+	description.add_options ()
+		("help", "Print out options")
+		("scenario", boost::program_options::value<std::string> (), "Path to the scenario to simulate, see nano/simulator/scenarios")
+		("seed", boost::program_options::value<unsigned> (), "Overrides the seed of the scenario");
+	// clang-format on
+
+	boost::program_options::variables_map vm;
+	try
+	{
+		boost::program_options::store (boost::program_options::parse_command_line (argc, argv, description), vm);
+	}
+	catch (boost::program_options::error const & err)
+	{
+		std::cerr << err.what () << std::endl;
+		return 1;
+	}
+	boost::program_options::notify (vm);
+	if (vm.count ("help") || !vm.count ("scenario"))
+	{
+		std::cout << description << std::endl;
+		return vm.count ("help") ? 0 : 1;
+	}
+
+	scenario scenario_l;
+	nano::tomlconfig toml;
+	auto error (toml.read (boost::filesystem::path (vm["scenario"].as<std::string> ())));
+	if (!error)
+	{
+		error = scenario_l.deserialize_toml (toml);
+	}
+	if (error)
+	{
+		std::cerr << "Error reading scenario: " << error.get_message () << std::endl;
+		return 1;
+	}
+	if (vm.count ("seed"))
+	{
+		scenario_l.seed = vm["seed"].as<unsigned> ();
+	}
+	return run (scenario_l);
+}
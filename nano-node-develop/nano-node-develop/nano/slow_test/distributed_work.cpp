@@ -0,0 +1,82 @@
+#include <nano/core_test/fakes/work_peer.hpp>
+#include <nano/node/testing.hpp>
+#include <nano/test_common/testutil.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/format.hpp>
+
+#include <numeric>
+
+using namespace std::chrono_literals;
+
+/**
+ * End to end latency of distributed work generation, and the generation time spent by peers, as the number of
+ * peers and their failure rate vary. Each peer has its own single threaded work pool and a different latency.
+ */
+TEST (distributed_work, peer_benchmark)
+{
+	size_t const requests_count (32);
+	std::cout << boost::str (boost::format ("%1$6s %2$8s %3$8s %4$10s %5$10s %6$14s %7$12s\n") % "peers" % "failure" % "hedging" % "mean (ms)" % "p95 (ms)" % "peer cpu (ms)" % "requests") << std::flush;
+	for (auto peers_count : { 1, 2, 4 })
+	{
+		for (auto failure_rate : { 0.0, 0.2, 0.5 })
+		{
+			for (auto hedging : { false, true })
+			{
+				nano::system system;
+				nano::node_config node_config (nano::get_available_port (), system.logging);
+				node_config.work_threads = 0;
+				node_config.work_peer_hedging = hedging;
+				auto & node = *system.add_node (node_config);
+				auto difficulty (nano::difficulty::from_multiplier (64, node.network_params.network.publish_thresholds.base));
+				std::vector<std::unique_ptr<nano::work_pool>> pools;
+				std::vector<std::shared_ptr<fake_work_peer>> work_peers;
+				decltype (node.config.work_peers) peers;
+				for (auto i (0); i < peers_count; ++i)
+				{
+					work_peer_profile profile;
+					profile.latency = std::chrono::milliseconds (10 * (i + 1));
+					profile.jitter = 5ms;
+					profile.failure_rate = failure_rate;
+					profile.cancel_generation = true;
+					pools.push_back (std::make_unique<nano::work_pool> (1));
+					work_peers.push_back (std::make_shared<fake_work_peer> (*pools.back (), node.io_ctx, nano::get_available_port (), profile));
+					work_peers.back ()->start ();
+					peers.emplace_back ("::ffff:127.0.0.1", work_peers.back ()->port ());
+				}
+				std::vector<std::chrono::milliseconds> latencies;
+				for (size_t i (0); i < requests_count; ++i)
+				{
+					std::atomic<bool> done{ false };
+					nano::timer<std::chrono::milliseconds> timer (nano::timer_state::started);
+					ASSERT_FALSE (node.distributed_work.make (nano::work_version::work_1, nano::block_hash (i + 1), peers, difficulty, [&done](boost::optional<uint64_t> work_a) {
+						ASSERT_TRUE (work_a.is_initialized ());
+						done = true;
+					}));
+					system.deadline_set (60s);
+					while (!done)
+					{
+						ASSERT_NO_ERROR (system.poll ());
+					}
+					latencies.push_back (timer.stop ());
+				}
+				std::sort (latencies.begin (), latencies.end ());
+				auto mean (std::accumulate (latencies.begin (), latencies.end (), 0ms) / latencies.size ());
+				auto p95 (latencies[latencies.size () * 95 / 100]);
+				uint64_t generation_us (0);
+				size_t requests (0);
+				for (auto const & peer : work_peers)
+				{
+					generation_us += peer->generation_us;
+					requests += peer->generations_good + peer->generations_bad;
+				}
+				std::cout << boost::str (boost::format ("%1$6d %2$8.1f %3$8s %4$10d %5$10d %6$14.1f %7$12.2f\n") % peers_count % failure_rate % (hedging ? "yes" : "no") % mean.count () % p95.count () % (generation_us / 1000.0 / requests_count) % (static_cast<double> (requests) / requests_count)) << std::flush;
+				for (auto & pool : pools)
+				{
+					pool->stop ();
+				}
+			}
+		}
+	}
+}
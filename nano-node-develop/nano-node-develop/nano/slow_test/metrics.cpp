@@ -0,0 +1,91 @@
+#include <nano/boost/beast/core/flat_buffer.hpp>
+#include <nano/boost/beast/http.hpp>
+#include <nano/node/metrics.hpp>
+#include <nano/node/testing.hpp>
+#include <nano/test_common/testutil.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/format.hpp>
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+/**
+ * Block processing throughput with the metrics exporter disabled, then enabled while scraped continuously, so the
+ * overhead of instrumentation and scrapes can be compared
+ */
+TEST (metrics, overhead_benchmark)
+{
+#ifndef NDEBUG
+	auto const num_blocks = 5000;
+#else
+	auto const num_blocks = 50000;
+#endif
+	std::cout << boost::str (boost::format ("%1$10s %2$10s %3$14s %4$10s\n") % "exporter" % "time (ms)" % "blocks/s" % "scrapes") << std::flush;
+	for (auto enabled : { false, true })
+	{
+		nano::system system;
+		nano::node_config node_config (nano::get_available_port (), system.logging);
+		node_config.frontiers_confirmation = nano::frontiers_confirmation_mode::disabled;
+		node_config.metrics_config.enabled = enabled;
+		node_config.metrics_config.port = nano::get_available_port ();
+		node_config.metrics_config.collect_interval = 1s;
+		auto & node = *system.add_node (node_config);
+
+		nano::state_block_builder builder;
+		std::vector<std::shared_ptr<nano::state_block>> blocks;
+		auto latest (node.latest (nano::dev_genesis_key.pub));
+		for (auto i = 0; i < num_blocks; ++i)
+		{
+			auto send = builder.make_block ()
+			            .account (nano::dev_genesis_key.pub)
+			            .previous (latest)
+			            .balance (nano::genesis_amount - i - 1)
+			            .representative (nano::dev_genesis_key.pub)
+			            .link (nano::dev_genesis_key.pub)
+			            .sign (nano::dev_genesis_key.prv, nano::dev_genesis_key.pub)
+			            .work (*system.work.generate (latest))
+			            .build ();
+			latest = send->hash ();
+			blocks.push_back (std::move (send));
+		}
+
+		std::atomic<bool> done{ false };
+		std::atomic<unsigned> scrapes{ 0 };
+		std::thread scraper;
+		if (enabled)
+		{
+			scraper = std::thread ([&done, &scrapes, port = node_config.metrics_config.port]() {
+				boost::asio::io_context io_ctx;
+				while (!done)
+				{
+					boost::asio::ip::tcp::socket socket (io_ctx);
+					socket.connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v6::loopback (), port));
+					boost::beast::http::request<boost::beast::http::empty_body> request (boost::beast::http::verb::get, "/metrics", 11);
+					boost::beast::http::write (socket, request);
+					boost::beast::flat_buffer buffer;
+					boost::beast::http::response<boost::beast::http::string_body> response;
+					boost::beast::http::read (socket, buffer, response);
+					++scrapes;
+					std::this_thread::sleep_for (10ms);
+				}
+			});
+		}
+
+		auto start (std::chrono::steady_clock::now ());
+		for (auto const & block : blocks)
+		{
+			node.process_active (block);
+		}
+		ASSERT_TIMELY (200s, node.ledger.cache.block_count == num_blocks + 1);
+		auto elapsed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start));
+		done = true;
+		if (scraper.joinable ())
+		{
+			scraper.join ();
+		}
+		std::cout << boost::str (boost::format ("%1$10s %2$10d %3$14.0f %4$10d\n") % (enabled ? "scraped" : "disabled") % elapsed.count () % (num_blocks * 1000.0 / std::max<int64_t> (elapsed.count (), 1)) % scrapes) << std::flush;
+	}
+}
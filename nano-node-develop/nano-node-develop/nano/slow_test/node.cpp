@@ -1,5 +1,7 @@
 #include <nano/crypto_lib/random_pool.hpp>
+#include <nano/lib/memory.hpp>
 #include <nano/lib/threading.hpp>
+#include <nano/lib/tracing.hpp>
 #include <nano/node/election.hpp>
 #include <nano/node/testing.hpp>
 #include <nano/node/transport/udp.hpp>
@@ -11,6 +13,7 @@
 #include <boost/format.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <future>
 #include <numeric>
 #include <random>
 
@@ -1863,3 +1866,203 @@ TEST (node, wallet_create_block_confirm_conflicts)
 		t.join ();
 	}
 }
+
+/** Cost of a span when tracing is disabled, when it is enabled but not sampled, and when it is recorded */
+TEST (tracing, span_overhead)
+{
+	auto const count (10000000);
+	std::cout << boost::str (boost::format ("%1$12s %2$10s\n") % "tracing" % "ns/span") << std::flush;
+	for (auto sample_rate : { 0u, 1000000u, 1u })
+	{
+		nano::tracing_config config;
+		config.enable = sample_rate != 0;
+		config.sample_rate = std::max (sample_rate, 1u);
+		nano::tracing::configure (config);
+		auto start (std::chrono::steady_clock::now ());
+		for (auto i (0); i < count; ++i)
+		{
+			nano::tracing::span span (nano::tracing::span_type::block_process, i);
+		}
+		auto elapsed (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start));
+		std::cout << boost::str (boost::format ("%1$12s %2$10.1f\n") % (sample_rate == 0 ? "disabled" : sample_rate == 1 ? "recorded" : "unsampled") % (elapsed.count () / static_cast<double> (count))) << std::flush;
+	}
+	nano::tracing::configure (nano::tracing_config{});
+	nano::tracing::clear ();
+}
+
+// Write operations (one writev each) and io thread CPU time per flooded vote between nodes on loopback
+TEST (network, flood_vote_write_cost)
+{
+	nano::system system;
+	auto const node_count (8);
+	nano::node_flags node_flags;
+	node_flags.disable_udp = true;
+	for (auto i (0); i < node_count; ++i)
+	{
+		nano::node_config node_config (nano::get_available_port (), system.logging);
+		node_config.bandwidth_limit = 0;
+		system.add_node (node_config, node_flags);
+	}
+	auto & node (*system.nodes[0]);
+	ASSERT_TIMELY (10s, node.network.size () == node_count - 1);
+	auto received = [&system]() {
+		uint64_t result (0);
+		for (size_t i (1); i < system.nodes.size (); ++i)
+		{
+			result += system.nodes[i]->stats.count (nano::stat::type::message, nano::stat::detail::confirm_ack, nano::stat::dir::in);
+		}
+		return result;
+	};
+	auto const vote_count (20000);
+	nano::genesis genesis;
+	std::vector<std::shared_ptr<nano::vote>> votes;
+	for (auto i (0); i < vote_count; ++i)
+	{
+		votes.push_back (std::make_shared<nano::vote> (nano::dev_genesis_key.pub, nano::dev_genesis_key.prv, i, std::vector<nano::block_hash>{ genesis.hash () }));
+	}
+	auto sent_before (node.stats.count (nano::stat::type::message, nano::stat::detail::confirm_ack, nano::stat::dir::out));
+	auto received_before (received ());
+	auto batches_before (node.stats.count (nano::stat::type::tcp, nano::stat::detail::tcp_write_batch, nano::stat::dir::out));
+	auto cpu_before (nano::thread_role::cpu_time ()[nano::thread_role::name::io]);
+	auto start (std::chrono::steady_clock::now ());
+	for (auto const & vote : votes)
+	{
+		node.network.flood_vote (vote, 1.0f);
+	}
+	auto sent (node.stats.count (nano::stat::type::message, nano::stat::detail::confirm_ack, nano::stat::dir::out) - sent_before);
+	auto dropped ([&node]() { return node.stats.count (nano::stat::type::tcp, nano::stat::detail::tcp_write_drop, nano::stat::dir::out); });
+	ASSERT_TIMELY (60s, received () - received_before + dropped () >= sent);
+	auto elapsed (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start));
+	// CPU time of the io threads of all nodes in this process, as they share the role
+	auto cpu (nano::thread_role::cpu_time ()[nano::thread_role::name::io] - cpu_before);
+	auto batches (node.stats.count (nano::stat::type::tcp, nano::stat::detail::tcp_write_batch, nano::stat::dir::out) - batches_before);
+	std::cout << boost::str (boost::format ("%1% votes, %2% messages sent, %3% dropped in %4% ms\n") % vote_count % sent % dropped () % elapsed.count ());
+	std::cout << boost::str (boost::format ("%1% writes (%2$.2f messages per write, %3$.0f writes/s), io thread CPU %4$.1f us per vote\n") % batches % (sent / std::max<double> (batches, 1)) % (batches * 1000.0 / std::max<int64_t> (elapsed.count (), 1)) % (cpu.count () / 1000.0 / vote_count));
+}
+
+// Messages per second and io thread CPU time per message through nano::socket over loopback, for the IO backend of this build
+TEST (socket, loopback_throughput)
+{
+	auto node_flags = nano::inactive_node_flag_defaults ();
+	node_flags.read_only = false;
+	nano::inactive_node inactivenode (nano::unique_path (), node_flags);
+	auto node = inactivenode.node;
+	nano::thread_runner runner (node->io_ctx, 4);
+
+	auto const connection_count (8);
+	auto const message_count (100000); // Per connection
+	auto const message_size (256);
+	std::atomic<uint64_t> received{ 0 };
+	std::promise<void> done;
+	std::function<void(std::shared_ptr<nano::socket> const &, std::shared_ptr<std::vector<uint8_t>> const &)> reader = [&reader, &received, &done, connection_count, message_count, message_size](std::shared_ptr<nano::socket> const & socket_a, std::shared_ptr<std::vector<uint8_t>> const & buffer_a) {
+		socket_a->async_read (buffer_a, message_size, [&reader, &received, &done, connection_count, message_count, socket_a, buffer_a](boost::system::error_code const & ec, size_t size_a) {
+			if (!ec)
+			{
+				if (++received == connection_count * message_count)
+				{
+					done.set_value ();
+				}
+				reader (socket_a, buffer_a);
+			}
+		});
+	};
+
+	auto server_port (nano::get_available_port ());
+	auto server_socket = std::make_shared<nano::server_socket> (*node, boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v6::any (), server_port), connection_count);
+	boost::system::error_code ec;
+	server_socket->start (ec);
+	ASSERT_FALSE (ec);
+	std::vector<std::shared_ptr<nano::socket>> connections;
+	nano::mutex connections_mutex;
+	server_socket->on_connection ([&connections, &connections_mutex, &reader, message_size](std::shared_ptr<nano::socket> const & new_connection, boost::system::error_code const & ec_a) {
+		if (!ec_a)
+		{
+			nano::lock_guard<nano::mutex> guard (connections_mutex);
+			connections.push_back (new_connection);
+			reader (new_connection, std::make_shared<std::vector<uint8_t>> (message_size));
+		}
+		return true;
+	});
+
+	std::vector<std::shared_ptr<nano::socket>> clients;
+	nano::util::counted_completion connected (connection_count);
+	for (auto i (0); i < connection_count; ++i)
+	{
+		clients.push_back (std::make_shared<nano::socket> (*node, boost::none));
+		clients.back ()->async_connect (boost::asio::ip::tcp::endpoint (boost::asio::ip::address_v6::loopback (), server_port), [&connected](boost::system::error_code const & ec_a) {
+			if (!ec_a)
+			{
+				connected.increment ();
+			}
+		});
+	}
+	ASSERT_FALSE (connected.await_count_for (10s));
+
+	auto cpu_before (nano::thread_role::cpu_time ()[nano::thread_role::name::io]);
+	auto start (std::chrono::steady_clock::now ());
+	std::vector<std::thread> writers;
+	for (auto const & client : clients)
+	{
+		writers.emplace_back ([client, message_count, message_size]() {
+			nano::shared_const_buffer buffer (std::vector<uint8_t> (message_size, 0x55));
+			for (auto i (0); i < message_count; ++i)
+			{
+				// Keep the write queue bounded like channel_tcp does, without dropping
+				while (client->max ())
+				{
+					std::this_thread::yield ();
+				}
+				client->async_write (buffer);
+			}
+		});
+	}
+	for (auto & writer : writers)
+	{
+		writer.join ();
+	}
+	ASSERT_EQ (std::future_status::ready, done.get_future ().wait_for (60s));
+	auto elapsed (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start));
+	auto cpu (nano::thread_role::cpu_time ()[nano::thread_role::name::io] - cpu_before);
+	auto total (static_cast<double> (connection_count) * message_count);
+	std::cout << boost::str (boost::format ("%1%: %2$.0f messages/s, io thread CPU %3$.2f us per message, %4$.1f messages per write\n") % nano::io_backend () % (total * 1e6 / elapsed.count ()) % (cpu.count () / 1000.0 / total) % (total / node->stats.count (nano::stat::type::tcp, nano::stat::detail::tcp_write_batch, nano::stat::dir::out)));
+
+	node->stop ();
+	runner.stop_event_processing ();
+	runner.join ();
+}
+
+namespace
+{
+template <typename T, typename Allocate>
+std::chrono::nanoseconds time_allocations (Allocate allocate_a)
+{
+	std::vector<std::shared_ptr<T>> objects (1024);
+	auto start (std::chrono::steady_clock::now ());
+	for (auto round (0); round < 100; ++round)
+	{
+		for (auto & object : objects)
+		{
+			object = allocate_a ();
+		}
+		objects.assign (objects.size (), nullptr);
+	}
+	return std::chrono::steady_clock::now () - start;
+}
+}
+
+/** Compares allocating shared blocks and votes from the pools with the system allocator, times are printed for reference only */
+TEST (memory_pool, benchmark)
+{
+	if (!nano::get_use_memory_pools ())
+	{
+		return;
+	}
+	auto blocks_pooled (time_allocations<nano::state_block> ([]() { return nano::make_shared<nano::state_block> (); }));
+	auto blocks_system (time_allocations<nano::state_block> ([]() { return std::make_shared<nano::state_block> (); }));
+	auto votes_pooled (time_allocations<nano::vote> ([]() { return nano::make_shared<nano::vote> (); }));
+	auto votes_system (time_allocations<nano::vote> ([]() { return std::make_shared<nano::vote> (); }));
+	std::cout << "state_block pooled: " << blocks_pooled.count () / 102400 << "ns system: " << blocks_system.count () / 102400 << "ns" << std::endl;
+	std::cout << "vote pooled: " << votes_pooled.count () / 102400 << "ns system: " << votes_system.count () / 102400 << "ns" << std::endl;
+	nano::purge_shared_ptr_singleton_pool_memory<nano::state_block> ();
+	nano::purge_shared_ptr_singleton_pool_memory<nano::vote> ();
+}